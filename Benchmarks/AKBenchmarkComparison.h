@@ -0,0 +1,91 @@
+//
+//  AKBenchmarkComparison.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKBenchmarkResult;
+
+/**
+ *  How a benchmark changed since a baseline.
+ */
+typedef NS_ENUM(NSInteger, AKBenchmarkChange){
+    /**
+     *  The medians differ by less than the threshold, or by less than the noise in the samples.
+     */
+    AKBenchmarkChangeNone = 0,
+    AKBenchmarkChangeFaster,
+    AKBenchmarkChangeSlower,
+    /**
+     *  The benchmark didn't run in the baseline.
+     */
+    AKBenchmarkChangeAdded,
+    /**
+     *  The benchmark ran in the baseline but not this time.
+     */
+    AKBenchmarkChangeRemoved
+};
+
+/**
+ *  One benchmark's results compared with its baseline.
+ */
+@interface AKBenchmarkComparisonEntry : NSObject
+
+@property (copy, nonatomic, readonly) NSString *identifier;
+
+/**
+ *  The baseline result, or nil if the benchmark was added.
+ */
+@property (strong, nonatomic, readonly) AKBenchmarkResult *baseline;
+
+/**
+ *  The current result, or nil if the benchmark was removed.
+ */
+@property (strong, nonatomic, readonly) AKBenchmarkResult *current;
+
+/**
+ *  The baseline's median divided by the current median, so values above 1 are faster. This is 1 unless both results exist.
+ */
+@property (assign, nonatomic, readonly) double speedup;
+
+@property (assign, nonatomic, readonly) AKBenchmarkChange change;
+
+@end
+
+
+/**
+ *  Compares the results of a run against a baseline. A change is only significant if the medians differ by more than the threshold, and by more than three times the noise of the two runs, estimated from their median absolute deviations, so a noisy benchmark has to move further before it counts.
+ */
+@interface AKBenchmarkComparison : NSObject
+
+/**
+ *  Compares two sets of results, matching benchmarks by their identifiers.
+ *
+ *  @param baselineResults The AKBenchmarkResults of the baseline. This must not be nil.
+ *  @param currentResults  The AKBenchmarkResults of the current run. This must not be nil.
+ *  @param threshold       The smallest relative change in a median which is significant, like 0.05 for 5%.
+ */
+- (instancetype)initWithBaselineResults:(NSArray *)baselineResults currentResults:(NSArray *)currentResults threshold:(double)threshold NS_DESIGNATED_INITIALIZER;
+
+@property (assign, nonatomic, readonly) double threshold;
+
+/**
+ *  The AKBenchmarkComparisonEntries, in the order the current results ran followed by any removed benchmarks.
+ */
+@property (copy, nonatomic, readonly) NSArray *entries;
+
+/**
+ *  Whether any benchmark got significantly slower.
+ */
+- (BOOL)hasRegressions;
+
+/**
+ *  Returns a table of each benchmark's baseline and current medians, speedup and change, one per line.
+ */
+- (NSString *)tableDescription;
+
+@end
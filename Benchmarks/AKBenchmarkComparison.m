@@ -0,0 +1,167 @@
+//
+//  AKBenchmarkComparison.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKBenchmarkComparison.h"
+#import "AKBenchmarkRunner.h"
+
+// Scales a median absolute deviation to estimate the standard deviation of normally distributed samples.
+static const double AKBenchmarkDeviationScale = 1.4826;
+
+static const double AKBenchmarkNoiseFactor = 3.0;
+
+static AKBenchmarkChange AKBenchmarkChangeBetweenResults(AKBenchmarkResult *baseline, AKBenchmarkResult *current, double threshold)
+{
+    if (!baseline)
+    {
+        return AKBenchmarkChangeAdded;
+    }
+    
+    if (!current)
+    {
+        return AKBenchmarkChangeRemoved;
+    }
+    
+    double difference = current.median - baseline.median;
+    double baselineDeviation = AKBenchmarkDeviationScale * baseline.medianAbsoluteDeviation;
+    double currentDeviation = AKBenchmarkDeviationScale * current.medianAbsoluteDeviation;
+    double noise = AKBenchmarkNoiseFactor * sqrt(baselineDeviation * baselineDeviation + currentDeviation * currentDeviation);
+    
+    if (fabs(difference) <= MAX(threshold * baseline.median, noise))
+    {
+        return AKBenchmarkChangeNone;
+    }
+    
+    return (difference < 0.0) ? AKBenchmarkChangeFaster : AKBenchmarkChangeSlower;
+}
+
+static NSString *AKBenchmarkDescriptionOfChange(AKBenchmarkChange change)
+{
+    switch (change)
+    {
+        case AKBenchmarkChangeNone:
+            return @"";
+        case AKBenchmarkChangeFaster:
+            return @"faster";
+        case AKBenchmarkChangeSlower:
+            return @"SLOWER";
+        case AKBenchmarkChangeAdded:
+            return @"added";
+        case AKBenchmarkChangeRemoved:
+            return @"removed";
+    }
+    
+    return @"";
+}
+
+
+@interface AKBenchmarkComparisonEntry ()
+
+- (instancetype)initWithBaseline:(AKBenchmarkResult *)baseline current:(AKBenchmarkResult *)current threshold:(double)threshold;
+
+@end
+
+@implementation AKBenchmarkComparisonEntry
+
+- (instancetype)initWithBaseline:(AKBenchmarkResult *)baseline current:(AKBenchmarkResult *)current threshold:(double)threshold
+{
+    NSParameterAssert(baseline || current);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _identifier = [(current ?: baseline) identifier];
+    _baseline = baseline;
+    _current = current;
+    _speedup = (baseline && current && current.median > 0.0) ? baseline.median / current.median : 1.0;
+    _change = AKBenchmarkChangeBetweenResults(baseline, current, threshold);
+    
+    return self;
+}
+
+@end
+
+
+@implementation AKBenchmarkComparison
+
+- (instancetype)init
+{
+    return [self initWithBaselineResults:@[] currentResults:@[] threshold:0.05];
+}
+
+- (instancetype)initWithBaselineResults:(NSArray *)baselineResults currentResults:(NSArray *)currentResults threshold:(double)threshold
+{
+    NSParameterAssert(baselineResults);
+    NSParameterAssert(currentResults);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _threshold = threshold;
+    
+    NSMutableDictionary *baselinesByIdentifier = [NSMutableDictionary dictionaryWithCapacity:baselineResults.count];
+    for (AKBenchmarkResult *result in baselineResults)
+    {
+        baselinesByIdentifier[[result identifier]] = result;
+    }
+    
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:currentResults.count];
+    for (AKBenchmarkResult *result in currentResults)
+    {
+        NSString *identifier = [result identifier];
+        [entries addObject:[[AKBenchmarkComparisonEntry alloc] initWithBaseline:baselinesByIdentifier[identifier] current:result threshold:threshold]];
+        [baselinesByIdentifier removeObjectForKey:identifier];
+    }
+    
+    // Benchmarks skipped by a filter show up as removed, which is worth seeing but never a regression.
+    for (AKBenchmarkResult *result in baselineResults)
+    {
+        if (baselinesByIdentifier[[result identifier]])
+        {
+            [entries addObject:[[AKBenchmarkComparisonEntry alloc] initWithBaseline:result current:nil threshold:threshold]];
+        }
+    }
+    
+    _entries = [entries copy];
+    
+    return self;
+}
+
+- (BOOL)hasRegressions
+{
+    for (AKBenchmarkComparisonEntry *entry in self.entries)
+    {
+        if (entry.change == AKBenchmarkChangeSlower)
+        {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+- (NSString *)tableDescription
+{
+    NSMutableString *table = [NSMutableString stringWithFormat:@"%-64s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "speedup"];
+    
+    for (AKBenchmarkComparisonEntry *entry in self.entries)
+    {
+        NSString *baselineMedian = (entry.baseline) ? [NSString stringWithFormat:@"%.1f", entry.baseline.median] : @"-";
+        NSString *currentMedian = (entry.current) ? [NSString stringWithFormat:@"%.1f", entry.current.median] : @"-";
+        NSString *speedup = (entry.baseline && entry.current) ? [NSString stringWithFormat:@"%.2fx", entry.speedup] : @"-";
+        
+        [table appendFormat:@"%-64s %14s %14s %9s  %@\n", [entry.identifier UTF8String], [baselineMedian UTF8String], [currentMedian UTF8String], [speedup UTF8String], AKBenchmarkDescriptionOfChange(entry.change)];
+    }
+    
+    return table;
+}
+
+@end
@@ -0,0 +1,25 @@
+//
+//  AKBenchmarkFixtures.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+
+@interface AKBenchmarkPerson : AKAncestor
+
+@property (copy, nonatomic) NSString *firstName;
+@property (copy, nonatomic) NSString *lastName;
+@property (copy, nonatomic) NSString *nickname;
+@property (copy, nonatomic) NSString *title;
+
+/**
+ *  Returns the leaf of a chain where only the root has values, so reading from the leaf walks every ancestor.
+ *
+ *  @param depth The number of ancestors between the leaf and the root, where 0 returns the root itself.
+ */
++ (instancetype)chainWithDepth:(NSUInteger)depth;
+
+@end
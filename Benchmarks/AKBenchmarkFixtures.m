@@ -0,0 +1,29 @@
+//
+//  AKBenchmarkFixtures.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKBenchmarkFixtures.h"
+
+@implementation AKBenchmarkPerson
+
++ (instancetype)chainWithDepth:(NSUInteger)depth
+{
+    AKBenchmarkPerson *person = [self new];
+    person.firstName = @"Arthur";
+    person.lastName = @"Weasley";
+    person.nickname = @"Dad";
+    person.title = @"Mr.";
+    
+    for (NSUInteger i = 0; i < depth; i++)
+    {
+        person = [person descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    return person;
+}
+
+@end
@@ -0,0 +1,150 @@
+//
+//  AKBenchmarkRunner.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKBenchmarkComparison;
+
+/**
+ *  The timings of one benchmark, in nanoseconds per operation.
+ */
+@interface AKBenchmarkResult : NSObject
+
+@property (copy, nonatomic, readonly) NSString *name;
+@property (copy, nonatomic, readonly) NSDictionary *parameters;
+
+/**
+ *  The number of operations timed in each sample.
+ */
+@property (assign, nonatomic, readonly) NSUInteger iterations;
+
+/**
+ *  The time each sample took per operation, as NSNumbers in the order they were taken.
+ */
+@property (copy, nonatomic, readonly) NSArray *samples;
+
+@property (assign, nonatomic, readonly) double median;
+
+/**
+ *  The median absolute deviation of the samples from their median, which unlike a standard deviation isn't thrown off by the odd sample interrupted by the scheduler.
+ */
+@property (assign, nonatomic, readonly) double medianAbsoluteDeviation;
+
+@property (assign, nonatomic, readonly) double minimum;
+@property (assign, nonatomic, readonly) double maximum;
+@property (assign, nonatomic, readonly) double mean;
+
+- (instancetype)initWithName:(NSString *)name parameters:(NSDictionary *)parameters iterations:(NSUInteger)iterations samples:(NSArray *)samples NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Creates a result from a dictionary returned by -JSONObject, recomputing its statistics from the samples.
+ *
+ *  @return A new result, or nil if the dictionary is missing a name or samples.
+ */
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject;
+
+/**
+ *  The name followed by the parameters sorted by key, which tells apart results of the same benchmark across runs.
+ */
+- (NSString *)identifier;
+
+/**
+ *  Returns the result as a JSON compatible dictionary.
+ */
+- (NSDictionary *)JSONObject;
+
+@end
+
+
+/**
+ *  Runs benchmarks and collects their results. Each benchmark is first calibrated by doubling its number of iterations until one run takes at least minimumSampleDuration, and then run sampleCount more times at that number of iterations, so fast operations aren't drowned out by the clock's resolution.
+ */
+@interface AKBenchmarkRunner : NSObject
+
+/**
+ *  Creates a runner configured from command line arguments: "--samples N", "--min-time SECONDS", "--filter SUBSTRING" to only run benchmarks whose name contains it, "--max-nodes N" to skip workloads with larger trees, "--output PATH" to write the results somewhere other than standard output, "--save-baseline NAME" to store the results as a baseline, "--baseline NAME" to compare them against one, "--threshold PERCENT" for the smallest change in a median counted as a regression, and "--baseline-dir PATH" for where baselines are kept.
+ *
+ *  @param arguments The arguments, without the name of the executable.
+ *
+ *  @return A new runner, or nil if the arguments aren't understood.
+ */
+- (instancetype)initWithArguments:(NSArray *)arguments;
+
+@property (assign, nonatomic) NSUInteger sampleCount;
+@property (assign, nonatomic) NSTimeInterval minimumSampleDuration;
+@property (copy, nonatomic) NSString *filter;
+
+/**
+ *  The largest tree which workload benchmarks should build. Defaults to 200,000 nodes, which keeps a run to minutes; pass a larger number to extend cost curves to millions of nodes.
+ */
+@property (assign, nonatomic) NSUInteger maximumNodeCount;
+
+@property (copy, nonatomic) NSString *outputPath;
+
+/**
+ *  The name of a baseline to compare results against, if any.
+ */
+@property (copy, nonatomic) NSString *baselineName;
+
+/**
+ *  The name to store the results under as a baseline, if any.
+ */
+@property (copy, nonatomic) NSString *savedBaselineName;
+
+/**
+ *  The directory baselines are read from and written to. Defaults to "baselines" in the current directory.
+ */
+@property (copy, nonatomic) NSString *baselineDirectory;
+
+/**
+ *  The smallest relative change in a median, like 0.05 for 5%, which is reported as faster or slower. Defaults to 0.05.
+ */
+@property (assign, nonatomic) double regressionThreshold;
+
+/**
+ *  The results of the benchmarks which have run so far.
+ */
+@property (copy, nonatomic, readonly) NSArray *results;
+
+/**
+ *  Times a benchmark unless it's filtered out. The block is given a number of iterations and should perform the operation that many times, leaving any setup which shouldn't be timed outside of the block.
+ *
+ *  @param name       The name of the benchmark, with dots separating groups, like "getter.inherited". This must not be nil.
+ *  @param parameters Parameters telling apart benchmarks of the same name, like the depth of a chain. This may be nil.
+ *  @param block      The operation to time. This must not be nil.
+ */
+- (void)runBenchmarkNamed:(NSString *)name parameters:(NSDictionary *)parameters block:(void (^)(NSUInteger iterations))block;
+
+/**
+ *  Writes the results as a JSON object to outputPath, or to standard output if there isn't one.
+ *
+ *  @param error On failure, the error which occurred. This may be NULL.
+ *
+ *  @return YES if the results were written.
+ */
+- (BOOL)writeResultsWithError:(NSError **)error;
+
+/**
+ *  Stores the results as the baseline named savedBaselineName in baselineDirectory, replacing any baseline of the same name.
+ *
+ *  @param error On failure, the error which occurred. This may be NULL.
+ *
+ *  @return YES if the baseline was written.
+ */
+- (BOOL)saveBaselineWithError:(NSError **)error;
+
+/**
+ *  Reads the baseline named baselineName from baselineDirectory and compares the results against it.
+ *
+ *  @param error On failure, the error which occurred. This may be NULL.
+ *
+ *  @return The comparison, or nil if the baseline couldn't be read.
+ */
+- (AKBenchmarkComparison *)compareWithBaselineWithError:(NSError **)error;
+
+@end
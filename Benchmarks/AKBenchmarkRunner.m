@@ -0,0 +1,337 @@
+//
+//  AKBenchmarkRunner.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKBenchmarkRunner.h"
+#import "AKBenchmarkComparison.h"
+#import "AKAncestorPlatform.h"
+#import <dispatch/dispatch.h>
+
+static double AKBenchmarkNanoseconds(uint64_t duration)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    
+    return (double)duration * timebase.numer / timebase.denom;
+}
+
+static double AKBenchmarkMedian(NSArray *sortedValues)
+{
+    NSUInteger count = sortedValues.count;
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    
+    double middle = [sortedValues[count / 2] doubleValue];
+    return (count % 2 == 1) ? middle : ([sortedValues[count / 2 - 1] doubleValue] + middle) / 2.0;
+}
+
+static NSString *AKBenchmarkDescriptionOfParameters(NSDictionary *parameters)
+{
+    NSMutableArray *components = [NSMutableArray array];
+    for (NSString *key in [[parameters allKeys] sortedArrayUsingSelector:@selector(compare:)])
+    {
+        [components addObject:[NSString stringWithFormat:@"%@=%@", key, parameters[key]]];
+    }
+    
+    return [components componentsJoinedByString:@" "];
+}
+
+
+@implementation AKBenchmarkResult
+
+- (instancetype)initWithName:(NSString *)name parameters:(NSDictionary *)parameters iterations:(NSUInteger)iterations samples:(NSArray *)samples
+{
+    NSParameterAssert(name);
+    NSParameterAssert(samples.count > 0);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _name = [name copy];
+    _parameters = [parameters copy] ?: @{};
+    _iterations = iterations;
+    _samples = [samples copy];
+    
+    NSArray *sortedSamples = [samples sortedArrayUsingSelector:@selector(compare:)];
+    _median = AKBenchmarkMedian(sortedSamples);
+    _minimum = [sortedSamples.firstObject doubleValue];
+    _maximum = [sortedSamples.lastObject doubleValue];
+    _mean = [[samples valueForKeyPath:@"@avg.doubleValue"] doubleValue];
+    
+    NSMutableArray *deviations = [NSMutableArray arrayWithCapacity:samples.count];
+    for (NSNumber *sample in samples)
+    {
+        [deviations addObject:@(fabs([sample doubleValue] - _median))];
+    }
+    
+    _medianAbsoluteDeviation = AKBenchmarkMedian([deviations sortedArrayUsingSelector:@selector(compare:)]);
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithName:@"" parameters:nil iterations:0 samples:@[@0]];
+}
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject
+{
+    NSString *name = JSONObject[@"name"];
+    NSArray *samples = JSONObject[@"samples_ns"];
+    if (![name isKindOfClass:[NSString class]] || ![samples isKindOfClass:[NSArray class]] || samples.count == 0)
+    {
+        return nil;
+    }
+    
+    NSDictionary *parameters = JSONObject[@"parameters"];
+    return [self initWithName:name parameters:[parameters isKindOfClass:[NSDictionary class]] ? parameters : nil iterations:[JSONObject[@"iterations"] unsignedIntegerValue] samples:samples];
+}
+
+- (NSString *)identifier
+{
+    return (self.parameters.count > 0) ? [NSString stringWithFormat:@"%@ %@", self.name, AKBenchmarkDescriptionOfParameters(self.parameters)] : self.name;
+}
+
+- (NSDictionary *)JSONObject
+{
+    return @{@"name": self.name,
+             @"parameters": self.parameters,
+             @"iterations": @(self.iterations),
+             @"median_ns": @(self.median),
+             @"mad_ns": @(self.medianAbsoluteDeviation),
+             @"min_ns": @(self.minimum),
+             @"max_ns": @(self.maximum),
+             @"mean_ns": @(self.mean),
+             @"samples_ns": self.samples};
+}
+
+@end
+
+
+@interface AKBenchmarkRunner ()
+
+@property (strong, nonatomic, readonly) NSMutableArray *mutableResults;
+
+@end
+
+@implementation AKBenchmarkRunner
+
+- (instancetype)init
+{
+    return [self initWithArguments:@[]];
+}
+
+- (instancetype)initWithArguments:(NSArray *)arguments
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _sampleCount = 15;
+    _minimumSampleDuration = 0.01;
+    _maximumNodeCount = 200000;
+    _baselineDirectory = @"baselines";
+    _regressionThreshold = 0.05;
+    _mutableResults = [NSMutableArray array];
+    
+    for (NSUInteger index = 0; index < arguments.count; index += 2)
+    {
+        NSString *option = arguments[index];
+        NSString *value = (index + 1 < arguments.count) ? arguments[index + 1] : nil;
+        if (!value)
+        {
+            return nil;
+        }
+        
+        if ([option isEqualToString:@"--samples"])
+        {
+            _sampleCount = (NSUInteger)MAX([value integerValue], 1);
+        }
+        else if ([option isEqualToString:@"--min-time"])
+        {
+            _minimumSampleDuration = MAX([value doubleValue], 0.0);
+        }
+        else if ([option isEqualToString:@"--filter"])
+        {
+            _filter = [value copy];
+        }
+        else if ([option isEqualToString:@"--max-nodes"])
+        {
+            _maximumNodeCount = (NSUInteger)MAX([value integerValue], 1);
+        }
+        else if ([option isEqualToString:@"--output"])
+        {
+            _outputPath = [value copy];
+        }
+        else if ([option isEqualToString:@"--baseline"])
+        {
+            _baselineName = [value copy];
+        }
+        else if ([option isEqualToString:@"--save-baseline"])
+        {
+            _savedBaselineName = [value copy];
+        }
+        else if ([option isEqualToString:@"--baseline-dir"])
+        {
+            _baselineDirectory = [value copy];
+        }
+        else if ([option isEqualToString:@"--threshold"])
+        {
+            _regressionThreshold = MAX([value doubleValue], 0.0) / 100.0;
+        }
+        else
+        {
+            return nil;
+        }
+    }
+    
+    return self;
+}
+
+- (NSArray *)results
+{
+    return [self.mutableResults copy];
+}
+
+- (void)runBenchmarkNamed:(NSString *)name parameters:(NSDictionary *)parameters block:(void (^)(NSUInteger iterations))block
+{
+    NSParameterAssert(name);
+    NSParameterAssert(block);
+    
+    if (self.filter.length > 0 && [name rangeOfString:self.filter].location == NSNotFound)
+    {
+        return;
+    }
+    
+    double minimumDuration = self.minimumSampleDuration * NSEC_PER_SEC;
+    
+    // Calibrating doubles as a warm up, filling caches and faulting in pages before anything is recorded.
+    NSUInteger iterations = 1;
+    while (YES)
+    {
+        uint64_t start = mach_absolute_time();
+        @autoreleasepool {
+            block(iterations);
+        }
+        double duration = AKBenchmarkNanoseconds(mach_absolute_time() - start);
+        
+        if (duration >= minimumDuration || iterations >= (NSUIntegerMax / 2))
+        {
+            break;
+        }
+        
+        iterations *= 2;
+    }
+    
+    NSMutableArray *samples = [NSMutableArray arrayWithCapacity:self.sampleCount];
+    for (NSUInteger sample = 0; sample < self.sampleCount; sample++)
+    {
+        uint64_t start = mach_absolute_time();
+        @autoreleasepool {
+            block(iterations);
+        }
+        double duration = AKBenchmarkNanoseconds(mach_absolute_time() - start);
+        
+        [samples addObject:@(duration / iterations)];
+    }
+    
+    AKBenchmarkResult *result = [[AKBenchmarkResult alloc] initWithName:name parameters:parameters iterations:iterations samples:samples];
+    [self.mutableResults addObject:result];
+    
+    fprintf(stderr, "%-40s %-28s %12.1f ns/op (mad %.1f)\n", [name UTF8String], [AKBenchmarkDescriptionOfParameters(parameters) UTF8String], result.median, result.medianAbsoluteDeviation);
+}
+
+- (NSData *)_reportDataWithError:(NSError **)error
+{
+    NSMutableArray *benchmarks = [NSMutableArray arrayWithCapacity:self.mutableResults.count];
+    for (AKBenchmarkResult *result in self.mutableResults)
+    {
+        [benchmarks addObject:[result JSONObject]];
+    }
+    
+    NSProcessInfo *processInfo = [NSProcessInfo processInfo];
+    NSDictionary *report = @{@"suite": @"AncestorKit",
+                             @"date": @([[NSDate date] timeIntervalSince1970]),
+                             @"host": @{@"name": processInfo.hostName,
+                                        @"os": processInfo.operatingSystemVersionString,
+                                        @"processors": @(processInfo.activeProcessorCount)},
+                             @"sample_count": @(self.sampleCount),
+                             @"max_nodes": @(self.maximumNodeCount),
+                             @"benchmarks": benchmarks};
+    
+    return [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:error];
+}
+
+- (NSString *)_pathOfBaselineNamed:(NSString *)name
+{
+    return [self.baselineDirectory stringByAppendingPathComponent:[name stringByAppendingPathExtension:@"json"]];
+}
+
+- (BOOL)writeResultsWithError:(NSError **)error
+{
+    NSData *data = [self _reportDataWithError:error];
+    if (!data)
+    {
+        return NO;
+    }
+    
+    if (!self.outputPath)
+    {
+        fwrite(data.bytes, 1, data.length, stdout);
+        fputc('\n', stdout);
+        return YES;
+    }
+    
+    return [data writeToFile:self.outputPath options:NSDataWritingAtomic error:error];
+}
+
+- (BOOL)saveBaselineWithError:(NSError **)error
+{
+    NSParameterAssert(self.savedBaselineName);
+    
+    NSData *data = [self _reportDataWithError:error];
+    if (!data || ![[NSFileManager defaultManager] createDirectoryAtPath:self.baselineDirectory withIntermediateDirectories:YES attributes:nil error:error])
+    {
+        return NO;
+    }
+    
+    return [data writeToFile:[self _pathOfBaselineNamed:self.savedBaselineName] options:NSDataWritingAtomic error:error];
+}
+
+- (AKBenchmarkComparison *)compareWithBaselineWithError:(NSError **)error
+{
+    NSParameterAssert(self.baselineName);
+    
+    NSData *data = [NSData dataWithContentsOfFile:[self _pathOfBaselineNamed:self.baselineName] options:0 error:error];
+    NSDictionary *report = (data) ? [NSJSONSerialization JSONObjectWithData:data options:0 error:error] : nil;
+    if (![report isKindOfClass:[NSDictionary class]])
+    {
+        return nil;
+    }
+    
+    NSMutableArray *baselineResults = [NSMutableArray array];
+    for (NSDictionary *benchmark in report[@"benchmarks"])
+    {
+        AKBenchmarkResult *result = [benchmark isKindOfClass:[NSDictionary class]] ? [[AKBenchmarkResult alloc] initWithJSONObject:benchmark] : nil;
+        if (result)
+        {
+            [baselineResults addObject:result];
+        }
+    }
+    
+    return [[AKBenchmarkComparison alloc] initWithBaselineResults:baselineResults currentResults:self.results threshold:self.regressionThreshold];
+}
+
+@end
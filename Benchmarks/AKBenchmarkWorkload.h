@@ -0,0 +1,102 @@
+//
+//  AKBenchmarkWorkload.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+
+/**
+ *  A tree of instances built by an AKBenchmarkWorkload. Observers added while building are removed when the tree deallocates.
+ */
+@interface AKBenchmarkTree : NSObject
+
+@property (strong, nonatomic, readonly) AKAncestor *root;
+
+/**
+ *  Every instance in the tree, breadth first, starting with the root.
+ */
+@property (copy, nonatomic, readonly) NSArray *nodes;
+
+/**
+ *  The instances in the deepest level of the tree.
+ */
+@property (copy, nonatomic, readonly) NSArray *leaves;
+
+/**
+ *  The number of key value notifications the tree's observers have received.
+ */
+@property (assign, nonatomic, readonly) NSUInteger notificationCount;
+
+@end
+
+
+/**
+ *  Generates synthetic classes and trees of instances, so costs can be measured against numbers of properties and nodes far beyond those of hand written fixtures.
+ */
+@interface AKBenchmarkWorkload : NSObject
+
+/**
+ *  Returns a subclass of AKAncestor created at runtime with copied NSString properties named "property0" through "propertyN", spread evenly across a chain of synthesized classes. The same class is returned each time for the same arguments.
+ *
+ *  @param propertyCount  The total number of properties, which must be at least 1.
+ *  @param hierarchyDepth The number of synthesized classes between AKAncestor and the returned class, inclusive, which must be at least 1 and at most propertyCount.
+ */
++ (Class)classWithPropertyCount:(NSUInteger)propertyCount hierarchyDepth:(NSUInteger)hierarchyDepth;
+
+/**
+ *  Returns the names of the properties of a class returned by +classWithPropertyCount:hierarchyDepth:, in the order they were declared.
+ */
++ (NSArray *)propertyNamesOfClass:(Class)workloadClass;
+
+/**
+ *  Returns the number of nodes in a tree of the given shape, including the root.
+ */
++ (NSUInteger)nodeCountForDepth:(NSUInteger)depth fanOut:(NSUInteger)fanOut;
+
+/**
+ *  Creates a workload for trees of a synthesized class.
+ *
+ *  @param nodeClass A class returned by +classWithPropertyCount:hierarchyDepth:. This must not be nil.
+ *  @param depth     The number of levels below the root.
+ *  @param fanOut    The number of descendants of each node above the deepest level.
+ */
+- (instancetype)initWithClass:(Class)nodeClass depth:(NSUInteger)depth fanOut:(NSUInteger)fanOut NS_DESIGNATED_INITIALIZER;
+
+@property (assign, nonatomic, readonly) Class nodeClass;
+@property (assign, nonatomic, readonly) NSUInteger depth;
+@property (assign, nonatomic, readonly) NSUInteger fanOut;
+
+/**
+ *  The chance between 0 and 1 that a node below the root sets its own value for each property instead of inheriting it. The root always sets every property. Defaults to 0.
+ */
+@property (assign, nonatomic) double overrideDensity;
+
+/**
+ *  The chance between 0 and 1 that a node is watched by an observer of one of its properties. Defaults to 0.
+ */
+@property (assign, nonatomic) double observerDensity;
+
+/**
+ *  Whether nodes below the root inherit key value notifications from their ancestors. Defaults to NO.
+ */
+@property (assign, nonatomic) BOOL inheritsKeyValueNotifications;
+
+/**
+ *  Seeds the choice of overridden and observed properties, so the same workload builds the same tree every time. Defaults to 1.
+ */
+@property (assign, nonatomic) uint64_t seed;
+
+/**
+ *  Builds a new tree from the workload.
+ */
+- (AKBenchmarkTree *)buildTree;
+
+/**
+ *  Builds a new table holding the same instances and values as buildTree, in the same order as the tree's nodes. Observers aren't added, since tables don't send notifications of inherited changes.
+ */
+- (AKAncestorTable *)buildTable;
+
+@end
@@ -0,0 +1,381 @@
+//
+//  AKBenchmarkWorkload.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKBenchmarkWorkload.h"
+#import <dispatch/dispatch.h>
+#import <objc/runtime.h>
+
+static void *AKBenchmarkTreeContext = &AKBenchmarkTreeContext;
+
+static const char *AKBenchmarkValuesIvarName = "_ak_benchmarkValues";
+
+// xorshift64*, which is plenty for choosing properties and keeps trees reproducible across platforms.
+static uint64_t AKBenchmarkNextRandom(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    
+    return x * 2685821657736338717ull;
+}
+
+static double AKBenchmarkNextUniform(uint64_t *state)
+{
+    return (AKBenchmarkNextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline void ***AKBenchmarkValuesSlot(__unsafe_unretained id object, ptrdiff_t offset)
+{
+    return (void ***)((uint8_t *)(__bridge void *)object + offset);
+}
+
+static Class AKBenchmarkSynthesizeClass(Class superclass, NSString *className, NSArray *propertyNames)
+{
+    // Each synthesized class stores its own properties' values in a lazily allocated array, so reads cost a load and an index like a synthesized ivar instead of a trip through associated objects.
+    Class synthesizedClass = objc_allocateClassPair(superclass, [className UTF8String], 0);
+    NSCAssert(synthesizedClass, @"%@ already exists", className);
+    
+    class_addIvar(synthesizedClass, AKBenchmarkValuesIvarName, sizeof(void *), (uint8_t)log2(sizeof(void *)), @encode(void *));
+    objc_registerClassPair(synthesizedClass);
+    
+    ptrdiff_t offset = ivar_getOffset(class_getInstanceVariable(synthesizedClass, AKBenchmarkValuesIvarName));
+    NSUInteger valueCount = propertyNames.count;
+    
+    objc_property_attribute_t attributes[] = {{"T", "@\"NSString\""}, {"C", ""}, {"N", ""}};
+    
+    for (NSUInteger index = 0; index < valueCount; index++)
+    {
+        NSString *propertyName = propertyNames[index];
+        NSString *setterName = [NSString stringWithFormat:@"set%@%@:", [[propertyName substringToIndex:1] uppercaseString], [propertyName substringFromIndex:1]];
+        
+        IMP getter = imp_implementationWithBlock(^id (__unsafe_unretained id object) {
+            void **values = *AKBenchmarkValuesSlot(object, offset);
+            return values ? (__bridge id)values[index] : nil;
+        });
+        
+        IMP setter = imp_implementationWithBlock(^(__unsafe_unretained id object, NSString *value) {
+            void ***slot = AKBenchmarkValuesSlot(object, offset);
+            if (!*slot)
+            {
+                *slot = calloc(valueCount, sizeof(void *));
+            }
+            
+            void *previousValue = (*slot)[index];
+            (*slot)[index] = value ? (__bridge_retained void *)[value copy] : NULL;
+            
+            if (previousValue)
+            {
+                (void)(__bridge_transfer id)previousValue;
+            }
+        });
+        
+        class_addMethod(synthesizedClass, NSSelectorFromString(propertyName), getter, "@@:");
+        class_addMethod(synthesizedClass, NSSelectorFromString(setterName), setter, "v@:@");
+        class_addProperty(synthesizedClass, [propertyName UTF8String], attributes, sizeof(attributes) / sizeof(attributes[0]));
+    }
+    
+    // ARC can't write dealloc for us, so the values are released here before handing off to the superclass. Its implementation is looked up each time so later swizzling is respected.
+    SEL deallocSelector = sel_registerName("dealloc");
+    IMP dealloc = imp_implementationWithBlock(^(__unsafe_unretained id object) {
+        void ***slot = AKBenchmarkValuesSlot(object, offset);
+        if (*slot)
+        {
+            for (NSUInteger index = 0; index < valueCount; index++)
+            {
+                if ((*slot)[index])
+                {
+                    (void)(__bridge_transfer id)(*slot)[index];
+                }
+            }
+            
+            free(*slot);
+            *slot = NULL;
+        }
+        
+        IMP superclassDealloc = class_getMethodImplementation(superclass, deallocSelector);
+        ((void (*)(__unsafe_unretained id, SEL))superclassDealloc)(object, deallocSelector);
+    });
+    class_addMethod(synthesizedClass, deallocSelector, dealloc, "v@:");
+    
+    return synthesizedClass;
+}
+
+
+@interface AKBenchmarkTree ()
+
+@property (strong, nonatomic, readwrite) AKAncestor *root;
+@property (copy, nonatomic, readwrite) NSArray *nodes;
+@property (copy, nonatomic, readwrite) NSArray *leaves;
+@property (assign, nonatomic, readwrite) NSUInteger notificationCount;
+
+@property (strong, nonatomic, readonly) NSMutableArray *observedNodes;
+@property (strong, nonatomic, readonly) NSMutableArray *observedKeyPaths;
+
+- (void)_observeNode:(AKAncestor *)node keyPath:(NSString *)keyPath;
+
+@end
+
+@implementation AKBenchmarkTree
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _observedNodes = [NSMutableArray array];
+    _observedKeyPaths = [NSMutableArray array];
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger index = 0; index < _observedNodes.count; index++)
+    {
+        [_observedNodes[index] removeObserver:self forKeyPath:_observedKeyPaths[index] context:AKBenchmarkTreeContext];
+    }
+}
+
+- (void)_observeNode:(AKAncestor *)node keyPath:(NSString *)keyPath
+{
+    [node addObserver:self forKeyPath:keyPath options:0 context:AKBenchmarkTreeContext];
+    [self.observedNodes addObject:node];
+    [self.observedKeyPaths addObject:keyPath];
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (context != AKBenchmarkTreeContext)
+    {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+    
+    self.notificationCount++;
+}
+
+@end
+
+
+@implementation AKBenchmarkWorkload
+
++ (NSMutableDictionary *)_propertyNamesByClassName
+{
+    static NSMutableDictionary *propertyNamesByClassName;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        propertyNamesByClassName = [NSMutableDictionary dictionary];
+    });
+    
+    return propertyNamesByClassName;
+}
+
++ (Class)classWithPropertyCount:(NSUInteger)propertyCount hierarchyDepth:(NSUInteger)hierarchyDepth
+{
+    NSParameterAssert(propertyCount > 0);
+    NSParameterAssert(hierarchyDepth > 0 && hierarchyDepth <= propertyCount);
+    
+    NSString *className = [NSString stringWithFormat:@"AKBenchmarkSynthesized_%lu_%lu", (unsigned long)propertyCount, (unsigned long)hierarchyDepth];
+    
+    @synchronized(self)
+    {
+        Class existingClass = NSClassFromString(className);
+        if (existingClass)
+        {
+            return existingClass;
+        }
+        
+        NSMutableArray *propertyNames = [NSMutableArray arrayWithCapacity:propertyCount];
+        Class superclass = [AKAncestor class];
+        
+        for (NSUInteger level = 0; level < hierarchyDepth; level++)
+        {
+            NSUInteger start = level * propertyCount / hierarchyDepth;
+            NSUInteger end = (level + 1) * propertyCount / hierarchyDepth;
+            
+            NSMutableArray *levelPropertyNames = [NSMutableArray arrayWithCapacity:end - start];
+            for (NSUInteger index = start; index < end; index++)
+            {
+                [levelPropertyNames addObject:[NSString stringWithFormat:@"property%lu", (unsigned long)index]];
+            }
+            
+            NSString *levelClassName = (level + 1 == hierarchyDepth) ? className : [NSString stringWithFormat:@"%@_%lu", className, (unsigned long)level];
+            superclass = AKBenchmarkSynthesizeClass(superclass, levelClassName, levelPropertyNames);
+            
+            [propertyNames addObjectsFromArray:levelPropertyNames];
+        }
+        
+        [AKAncestor registerRuntimeSubclass:superclass];
+        [self _propertyNamesByClassName][className] = [propertyNames copy];
+        
+        return superclass;
+    }
+}
+
++ (NSArray *)propertyNamesOfClass:(Class)workloadClass
+{
+    @synchronized(self)
+    {
+        return [self _propertyNamesByClassName][NSStringFromClass(workloadClass)];
+    }
+}
+
++ (NSUInteger)nodeCountForDepth:(NSUInteger)depth fanOut:(NSUInteger)fanOut
+{
+    NSUInteger nodeCount = 1;
+    NSUInteger levelCount = 1;
+    for (NSUInteger level = 0; level < depth; level++)
+    {
+        levelCount *= fanOut;
+        nodeCount += levelCount;
+    }
+    
+    return nodeCount;
+}
+
+- (instancetype)init
+{
+    return [self initWithClass:[[self class] classWithPropertyCount:1 hierarchyDepth:1] depth:0 fanOut:0];
+}
+
+- (instancetype)initWithClass:(Class)nodeClass depth:(NSUInteger)depth fanOut:(NSUInteger)fanOut
+{
+    NSParameterAssert([[self class] propertyNamesOfClass:nodeClass]);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _nodeClass = nodeClass;
+    _depth = depth;
+    _fanOut = fanOut;
+    _seed = 1;
+    
+    return self;
+}
+
+- (AKBenchmarkTree *)buildTree
+{
+    NSArray *propertyNames = [[self class] propertyNamesOfClass:self.nodeClass];
+    NSUInteger propertyCount = propertyNames.count;
+    
+    // Values are shared between nodes so building measures AncestorKit rather than string allocation.
+    NSArray *values = @[@"Arthur", @"Molly", @"Bill", @"Charlie", @"Percy", @"Fred", @"George", @"Ron", @"Ginny"];
+    
+    // A zero state would make xorshift return zeros forever.
+    uint64_t state = self.seed ?: 1;
+    
+    AKBenchmarkTree *tree = [AKBenchmarkTree new];
+    NSMutableArray *nodes = [NSMutableArray arrayWithCapacity:[[self class] nodeCountForDepth:self.depth fanOut:self.fanOut]];
+    
+    AKAncestor *root = [self.nodeClass new];
+    for (NSUInteger index = 0; index < propertyCount; index++)
+    {
+        [root setValue:values[index % values.count] forKey:propertyNames[index]];
+    }
+    [nodes addObject:root];
+    
+    NSArray *level = @[root];
+    for (NSUInteger depth = 0; depth < self.depth; depth++)
+    {
+        NSMutableArray *nextLevel = [NSMutableArray arrayWithCapacity:level.count * self.fanOut];
+        for (AKAncestor *ancestor in level)
+        {
+            for (NSUInteger branch = 0; branch < self.fanOut; branch++)
+            {
+                AKAncestor *node = [ancestor descendantInheritingKeyValueNotifications:self.inheritsKeyValueNotifications];
+                
+                if (self.overrideDensity > 0.0)
+                {
+                    for (NSUInteger index = 0; index < propertyCount; index++)
+                    {
+                        if (AKBenchmarkNextUniform(&state) < self.overrideDensity)
+                        {
+                            [node setValue:values[(index + depth + 1) % values.count] forKey:propertyNames[index]];
+                        }
+                    }
+                }
+                
+                [nextLevel addObject:node];
+            }
+        }
+        
+        [nodes addObjectsFromArray:nextLevel];
+        level = nextLevel;
+    }
+    
+    if (self.observerDensity > 0.0)
+    {
+        for (AKAncestor *node in nodes)
+        {
+            if (AKBenchmarkNextUniform(&state) < self.observerDensity)
+            {
+                [tree _observeNode:node keyPath:propertyNames[AKBenchmarkNextRandom(&state) % propertyCount]];
+            }
+        }
+    }
+    
+    tree.root = root;
+    tree.nodes = nodes;
+    tree.leaves = level;
+    
+    return tree;
+}
+
+- (AKAncestorTable *)buildTable
+{
+    NSArray *propertyNames = [[self class] propertyNamesOfClass:self.nodeClass];
+    NSUInteger propertyCount = propertyNames.count;
+    NSArray *values = @[@"Arthur", @"Molly", @"Bill", @"Charlie", @"Percy", @"Fred", @"George", @"Ron", @"Ginny"];
+    
+    // The values are drawn in the same order as buildTree, so both hold the same overrides.
+    uint64_t state = self.seed ?: 1;
+    
+    AKAncestorTable *table = [[AKAncestorTable alloc] initWithAncestorClass:self.nodeClass];
+    
+    NSUInteger rootIndex = [table addInstanceWithAncestorIndex:NSNotFound];
+    for (NSUInteger index = 0; index < propertyCount; index++)
+    {
+        [table setValue:values[index % values.count] forPropertyName:propertyNames[index] atIndex:rootIndex];
+    }
+    
+    NSRange level = NSMakeRange(rootIndex, 1);
+    for (NSUInteger depth = 0; depth < self.depth; depth++)
+    {
+        NSUInteger nextLevelLocation = table.count;
+        for (NSUInteger ancestorIndex = level.location; ancestorIndex < NSMaxRange(level); ancestorIndex++)
+        {
+            for (NSUInteger branch = 0; branch < self.fanOut; branch++)
+            {
+                NSUInteger nodeIndex = [table addInstanceWithAncestorIndex:ancestorIndex];
+                
+                if (self.overrideDensity > 0.0)
+                {
+                    for (NSUInteger index = 0; index < propertyCount; index++)
+                    {
+                        if (AKBenchmarkNextUniform(&state) < self.overrideDensity)
+                        {
+                            [table setValue:values[(index + depth + 1) % values.count] forPropertyName:propertyNames[index] atIndex:nodeIndex];
+                        }
+                    }
+                }
+            }
+        }
+        
+        level = NSMakeRange(nextLevelLocation, table.count - nextLevelLocation);
+    }
+    
+    return table;
+}
+
+@end
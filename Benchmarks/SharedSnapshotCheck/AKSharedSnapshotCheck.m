@@ -0,0 +1,167 @@
+//
+//  AKSharedSnapshotCheck.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <spawn.h>
+#import <sys/wait.h>
+#import <unistd.h>
+#import "../AKBenchmarkFixtures.h"
+
+// Checks AKAncestorSharedSnapshot across real processes on one machine. This process publishes a family over and over while reader processes, spawned from this same executable, resolve values from the segment and verify that every read came from a single publication.
+
+extern char **environ;
+
+static const NSUInteger AKSharedSnapshotCheckChildCount = 100;
+
+// Publication n gives the root a last name of "Family n" and each child a nickname of "Child n", so a read mixing two publications finds them out of step.
+static NSDictionary *AKSharedSnapshotCheckFamily(NSUInteger publication, BOOL isLast)
+{
+    AKBenchmarkPerson *root = [AKBenchmarkPerson new];
+    root.lastName = [NSString stringWithFormat:@"Family %lu", (unsigned long)publication];
+    
+    NSMutableDictionary *family = [NSMutableDictionary dictionaryWithObject:root forKey:@"root"];
+    for (NSUInteger index = 0; index < AKSharedSnapshotCheckChildCount; index++)
+    {
+        AKBenchmarkPerson *child = [root descendantInheritingKeyValueNotifications:NO];
+        child.nickname = [NSString stringWithFormat:@"Child %lu", (unsigned long)publication];
+        family[[NSString stringWithFormat:@"child %lu", (unsigned long)index]] = child;
+    }
+    
+    if (isLast)
+    {
+        family[@"done"] = root;
+    }
+    
+    return family;
+}
+
+static int AKSharedSnapshotCheckRead(NSString *segmentName)
+{
+    NSError *error;
+    AKAncestorSharedSnapshot *reader = [[AKAncestorSharedSnapshot alloc] initWithName:segmentName error:&error];
+    if (!reader)
+    {
+        fprintf(stderr, "reader %d: %s\n", getpid(), [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+    
+    NSArray *propertyNames = @[@"lastName", @"nickname"];
+    NSUInteger readCount = 0;
+    NSUInteger inconsistentCount = 0;
+    NSUInteger previousPublication = 0;
+    
+    BOOL isDone = NO;
+    while (!isDone)
+    {
+        @autoreleasepool {
+            NSString *name = [NSString stringWithFormat:@"child %lu", (unsigned long)(readCount % AKSharedSnapshotCheckChildCount)];
+            NSDictionary *values = [reader valuesForPropertyNames:propertyNames ofAncestorNamed:name];
+            
+            NSInteger family = [[values[@"lastName"] substringFromIndex:7] integerValue];
+            NSInteger child = [[values[@"nickname"] substringFromIndex:6] integerValue];
+            
+            // Publications only move forward, so a reader never sees an older one after a newer one.
+            if (family != child || (NSUInteger)family < previousPublication)
+            {
+                inconsistentCount++;
+            }
+            
+            previousPublication = MAX(previousPublication, (NSUInteger)family);
+            readCount++;
+            
+            if (readCount % 1000 == 0)
+            {
+                isDone = [[reader names] containsObject:@"done"];
+            }
+        }
+    }
+    
+    fprintf(stderr, "reader %d: %lu reads through generation %llu, %lu inconsistent\n", getpid(), (unsigned long)readCount, (unsigned long long)reader.generation, (unsigned long)inconsistentCount);
+    return (inconsistentCount == 0) ? 0 : 1;
+}
+
+static int AKSharedSnapshotCheckPublish(const char *executablePath, NSUInteger readerCount, NSUInteger publicationCount)
+{
+    NSString *segmentName = [NSString stringWithFormat:@"ak-check-%d", getpid()];
+    
+    NSError *error;
+    AKAncestorSharedSnapshotPublisher *publisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:segmentName capacity:(1 << 20) error:&error];
+    if (!publisher || ![publisher publishAncestorsByName:AKSharedSnapshotCheckFamily(1, NO) error:&error])
+    {
+        fprintf(stderr, "publisher: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+    
+    NSMutableArray *readerIDs = [NSMutableArray array];
+    for (NSUInteger index = 0; index < readerCount; index++)
+    {
+        char *arguments[] = {(char *)executablePath, "--reader", (char *)[segmentName UTF8String], NULL};
+        
+        pid_t readerID;
+        if (posix_spawn(&readerID, executablePath, NULL, NULL, arguments, environ) != 0)
+        {
+            fprintf(stderr, "publisher: couldn't spawn a reader\n");
+            break;
+        }
+        
+        [readerIDs addObject:@(readerID)];
+    }
+    
+    for (NSUInteger publication = 2; publication <= publicationCount; publication++)
+    {
+        @autoreleasepool {
+            [publisher publishAncestorsByName:AKSharedSnapshotCheckFamily(publication, (publication == publicationCount)) error:NULL];
+        }
+    }
+    
+    int status = (readerIDs.count == readerCount) ? 0 : 1;
+    for (NSNumber *readerID in readerIDs)
+    {
+        int readerStatus = 0;
+        if (waitpid([readerID intValue], &readerStatus, 0) < 0 || !WIFEXITED(readerStatus) || WEXITSTATUS(readerStatus) != 0)
+        {
+            status = 1;
+        }
+    }
+    
+    [AKAncestorSharedSnapshotPublisher removeSegmentNamed:segmentName error:NULL];
+    
+    fprintf(stderr, "publisher: %llu generations to %lu readers, %s\n", (unsigned long long)publisher.generation, (unsigned long)readerIDs.count, (status == 0) ? "all consistent" : "FAILED");
+    return status;
+}
+
+int main(int argc, const char *argv[])
+{
+    @autoreleasepool {
+        NSUInteger readerCount = 4;
+        NSUInteger publicationCount = 2000;
+        
+        for (int index = 1; index < argc; index++)
+        {
+            if (strcmp(argv[index], "--reader") == 0 && index + 1 < argc)
+            {
+                return AKSharedSnapshotCheckRead([NSString stringWithUTF8String:argv[index + 1]]);
+            }
+            else if (strcmp(argv[index], "--readers") == 0 && index + 1 < argc)
+            {
+                readerCount = (NSUInteger)strtoul(argv[++index], NULL, 10);
+            }
+            else if (strcmp(argv[index], "--publications") == 0 && index + 1 < argc)
+            {
+                publicationCount = MAX((NSUInteger)strtoul(argv[++index], NULL, 10), 2);
+            }
+            else
+            {
+                fprintf(stderr, "usage: %s [--readers N] [--publications N]\n", argv[0]);
+                return 2;
+            }
+        }
+        
+        return AKSharedSnapshotCheckPublish(argv[0], readerCount, publicationCount);
+    }
+}
@@ -0,0 +1,660 @@
+//
+//  main.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <dispatch/dispatch.h>
+#import <objc/message.h>
+#import <objc/runtime.h>
+#import <unistd.h>
+#import "AKBenchmarkRunner.h"
+#import "AKBenchmarkComparison.h"
+#import "AKBenchmarkFixtures.h"
+#import "AKBenchmarkWorkload.h"
+
+// Results are stored here so the compiler can't prove reads are unused.
+static __unsafe_unretained id AKBenchmarkSink;
+
+static void AKBenchmarkInheritedGetters(AKBenchmarkRunner *runner)
+{
+    for (NSNumber *depth in @[@0, @1, @2, @4, @8, @16, @32, @64])
+    {
+        AKBenchmarkPerson *person = [AKBenchmarkPerson chainWithDepth:[depth unsignedIntegerValue]];
+        
+        [runner runBenchmarkNamed:@"getter.inherited" parameters:@{@"depth": depth} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                AKBenchmarkSink = person.lastName;
+            }
+        }];
+    }
+}
+
+static void AKBenchmarkDescendantLifecycle(AKBenchmarkRunner *runner)
+{
+    AKBenchmarkPerson *root = [AKBenchmarkPerson chainWithDepth:0];
+    
+    for (NSNumber *inheritsNotifications in @[@NO, @YES])
+    {
+        BOOL shouldInheritNotifications = [inheritsNotifications boolValue];
+        
+        [runner runBenchmarkNamed:@"descendant.create_destroy" parameters:@{@"inherits_kvo": inheritsNotifications} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                @autoreleasepool {
+                    AKBenchmarkPerson *descendant = [root descendantInheritingKeyValueNotifications:shouldInheritNotifications];
+                    AKBenchmarkSink = descendant;
+                }
+            }
+        }];
+    }
+}
+
+static void AKBenchmarkWriteFanOut(AKBenchmarkRunner *runner)
+{
+    for (NSNumber *descendantCount in @[@0, @10, @100, @1000])
+    {
+        AKBenchmarkPerson *root = [AKBenchmarkPerson chainWithDepth:0];
+        
+        NSMutableArray *descendants = [NSMutableArray array];
+        for (NSUInteger i = 0; i < [descendantCount unsignedIntegerValue]; i++)
+        {
+            [descendants addObject:[root descendantInheritingKeyValueNotifications:YES]];
+        }
+        
+        NSArray *names = @[@"Weasley", @"Prewett"];
+        
+        [runner runBenchmarkNamed:@"write.fan_out" parameters:@{@"descendants": descendantCount} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                root.lastName = names[i % 2];
+            }
+        }];
+    }
+}
+
+static void AKBenchmarkStopInheriting(AKBenchmarkRunner *runner)
+{
+    NSString *propertyName = NSStringFromSelector(@selector(lastName));
+    
+    for (NSNumber *depth in @[@1, @8])
+    {
+        AKBenchmarkPerson *person = [AKBenchmarkPerson chainWithDepth:[depth unsignedIntegerValue]];
+        
+        [runner runBenchmarkNamed:@"inheritance.stop_resume" parameters:@{@"depth": depth} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                [person stopInheritingValuesForPropertyName:propertyName];
+                [person resumeInheritingValuesForPropertyName:propertyName];
+            }
+        }];
+    }
+}
+
+static void AKBenchmarkStartup(AKBenchmarkRunner *runner)
+{
+    // Swizzling only happens once, in +load, so startup is measured through the work it's made of: scanning the runtime for subclasses, and reflecting on each of their properties.
+    [runner runBenchmarkNamed:@"startup.class_scan" parameters:nil block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++)
+        {
+            unsigned int classCount;
+            Class *classes = objc_copyClassList(&classCount);
+            
+            NSUInteger subclassCount = 0;
+            for (unsigned int index = 0; index < classCount; index++)
+            {
+                for (Class currentClass = class_getSuperclass(classes[index]); currentClass; currentClass = class_getSuperclass(currentClass))
+                {
+                    if (currentClass == [AKAncestor class])
+                    {
+                        subclassCount++;
+                        break;
+                    }
+                }
+            }
+            
+            free(classes);
+            AKBenchmarkSink = @(subclassCount);
+        }
+    }];
+    
+    [runner runBenchmarkNamed:@"startup.reflection" parameters:nil block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++)
+        {
+            @autoreleasepool {
+                AKBenchmarkSink = [AKPropertyDescription propertyDescriptionsOfClass:[AKBenchmarkPerson class]];
+            }
+        }
+    }];
+}
+
+static void AKBenchmarkThreadedReads(AKBenchmarkRunner *runner)
+{
+    AKBenchmarkPerson *person = [AKBenchmarkPerson chainWithDepth:4];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    
+    // Times are per read across all threads, so perfect scaling halves them each time the threads double.
+    for (NSNumber *threads in @[@1, @2, @4, @8])
+    {
+        size_t threadCount = [threads unsignedIntegerValue];
+        
+        [runner runBenchmarkNamed:@"getter.threaded" parameters:@{@"threads": threads, @"depth": @4} block:^(NSUInteger iterations) {
+            NSUInteger iterationsPerThread = (iterations + threadCount - 1) / threadCount;
+            
+            dispatch_apply(threadCount, queue, ^(size_t thread) {
+                NSUInteger start = thread * iterationsPerThread;
+                NSUInteger end = MIN(start + iterationsPerThread, iterations);
+                
+                for (NSUInteger i = start; i < end; i++)
+                {
+                    @autoreleasepool {
+                        [person lastName];
+                    }
+                }
+            });
+        }];
+    }
+}
+
+// Trees fan out by 10, so depths 0 through 6 span 1 to 1,111,111 nodes.
+static const NSUInteger AKBenchmarkWorkloadFanOut = 10;
+static const NSUInteger AKBenchmarkWorkloadMaximumDepth = 6;
+
+static NSArray *AKBenchmarkWorkloadDepths(AKBenchmarkRunner *runner)
+{
+    NSMutableArray *depths = [NSMutableArray array];
+    for (NSUInteger depth = 0; depth <= AKBenchmarkWorkloadMaximumDepth; depth++)
+    {
+        if ([AKBenchmarkWorkload nodeCountForDepth:depth fanOut:AKBenchmarkWorkloadFanOut] > runner.maximumNodeCount)
+        {
+            break;
+        }
+        
+        [depths addObject:@(depth)];
+    }
+    
+    return depths;
+}
+
+static void AKBenchmarkWorkloadGetters(AKBenchmarkRunner *runner)
+{
+    for (NSNumber *propertyCount in @[@10, @100, @1000])
+    {
+        for (NSNumber *classDepth in @[@1, @4])
+        {
+            Class nodeClass = [AKBenchmarkWorkload classWithPropertyCount:[propertyCount unsignedIntegerValue] hierarchyDepth:[classDepth unsignedIntegerValue]];
+            
+            // A single chain four deep, reading the last property so it's found in the most derived class.
+            AKBenchmarkWorkload *workload = [[AKBenchmarkWorkload alloc] initWithClass:nodeClass depth:4 fanOut:1];
+            AKBenchmarkTree *tree = [workload buildTree];
+            AKAncestor *leaf = tree.leaves.firstObject;
+            SEL getter = NSSelectorFromString([[AKBenchmarkWorkload propertyNamesOfClass:nodeClass] lastObject]);
+            
+            [runner runBenchmarkNamed:@"workload.getter" parameters:@{@"properties": propertyCount, @"class_depth": classDepth, @"depth": @4} block:^(NSUInteger iterations) {
+                for (NSUInteger i = 0; i < iterations; i++)
+                {
+                    AKBenchmarkSink = ((id (*)(id, SEL))objc_msgSend)(leaf, getter);
+                }
+            }];
+        }
+    }
+}
+
+static void AKBenchmarkWorkloadTrees(AKBenchmarkRunner *runner)
+{
+    NSArray *depths = AKBenchmarkWorkloadDepths(runner);
+    
+    for (NSNumber *propertyCount in @[@10, @100, @1000])
+    {
+        Class nodeClass = [AKBenchmarkWorkload classWithPropertyCount:[propertyCount unsignedIntegerValue] hierarchyDepth:1];
+        
+        for (NSNumber *depth in depths)
+        {
+            NSUInteger nodeCount = [AKBenchmarkWorkload nodeCountForDepth:[depth unsignedIntegerValue] fanOut:AKBenchmarkWorkloadFanOut];
+            
+            // Wide classes are only built into smaller trees, where the cost per property is already clear.
+            if (nodeCount * [propertyCount unsignedIntegerValue] > runner.maximumNodeCount * 10)
+            {
+                continue;
+            }
+            
+            for (NSNumber *inheritsNotifications in @[@NO, @YES])
+            {
+                AKBenchmarkWorkload *workload = [[AKBenchmarkWorkload alloc] initWithClass:nodeClass depth:[depth unsignedIntegerValue] fanOut:AKBenchmarkWorkloadFanOut];
+                workload.overrideDensity = 0.1;
+                workload.observerDensity = [inheritsNotifications boolValue] ? 0.01 : 0.0;
+                workload.inheritsKeyValueNotifications = [inheritsNotifications boolValue];
+                
+                NSDictionary *parameters = @{@"properties": propertyCount, @"nodes": @(nodeCount), @"fan_out": @(AKBenchmarkWorkloadFanOut), @"inherits_kvo": inheritsNotifications};
+                
+                [runner runBenchmarkNamed:@"workload.tree_build" parameters:parameters block:^(NSUInteger iterations) {
+                    for (NSUInteger i = 0; i < iterations; i++)
+                    {
+                        @autoreleasepool {
+                            AKBenchmarkTree *tree = [workload buildTree];
+                            AKBenchmarkSink = tree;
+                        }
+                    }
+                }];
+                
+                AKBenchmarkTree *tree = [workload buildTree];
+                NSArray *leaves = tree.leaves;
+                NSUInteger leafCount = leaves.count;
+                NSString *propertyName = [[AKBenchmarkWorkload propertyNamesOfClass:nodeClass] firstObject];
+                SEL getter = NSSelectorFromString(propertyName);
+                
+                // Reads stride across the leaves, so larger trees show the cost of missing the cache.
+                [runner runBenchmarkNamed:@"workload.leaf_reads" parameters:parameters block:^(NSUInteger iterations) {
+                    for (NSUInteger i = 0; i < iterations; i++)
+                    {
+                        AKBenchmarkSink = ((id (*)(id, SEL))objc_msgSend)(leaves[(i * 7919) % leafCount], getter);
+                    }
+                }];
+                
+                AKAncestor *root = tree.root;
+                NSArray *names = @[@"Weasley", @"Prewett"];
+                
+                [runner runBenchmarkNamed:@"workload.root_write" parameters:parameters block:^(NSUInteger iterations) {
+                    for (NSUInteger i = 0; i < iterations; i++)
+                    {
+                        [root setValue:names[i % 2] forKey:propertyName];
+                    }
+                }];
+            }
+        }
+    }
+}
+
+static void AKBenchmarkTables(AKBenchmarkRunner *runner)
+{
+    Class nodeClass = [AKBenchmarkWorkload classWithPropertyCount:10 hierarchyDepth:1];
+    NSString *propertyName = [[AKBenchmarkWorkload propertyNamesOfClass:nodeClass] firstObject];
+    SEL getter = NSSelectorFromString(propertyName);
+    
+    for (NSNumber *depth in AKBenchmarkWorkloadDepths(runner))
+    {
+        AKBenchmarkWorkload *workload = [[AKBenchmarkWorkload alloc] initWithClass:nodeClass depth:[depth unsignedIntegerValue] fanOut:AKBenchmarkWorkloadFanOut];
+        workload.overrideDensity = 0.1;
+        
+        AKBenchmarkTree *tree = [workload buildTree];
+        NSArray *nodes = tree.nodes;
+        NSUInteger nodeCount = nodes.count;
+        NSDictionary *parameters = @{@"properties": @10, @"nodes": @(nodeCount), @"fan_out": @(AKBenchmarkWorkloadFanOut)};
+        
+        // Each iteration resolves the property for every instance, first by walking each object's chain and then in one pass over the table's column.
+        [runner runBenchmarkNamed:@"objects.bulk_resolve" parameters:parameters block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                for (AKAncestor *node in nodes)
+                {
+                    AKBenchmarkSink = ((id (*)(id, SEL))objc_msgSend)(node, getter);
+                }
+            }
+        }];
+        
+        AKAncestorTable *table = [workload buildTable];
+        __unsafe_unretained id *values = (__unsafe_unretained id *)calloc(nodeCount, sizeof(id));
+        
+        [runner runBenchmarkNamed:@"table.bulk_resolve" parameters:parameters block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                [table getValues:values count:nodeCount forPropertyName:propertyName];
+                AKBenchmarkSink = values[nodeCount - 1];
+            }
+        }];
+        
+        free(values);
+    }
+}
+
+static void AKBenchmarkTableQueries(AKBenchmarkRunner *runner)
+{
+    Class nodeClass = [AKBenchmarkWorkload classWithPropertyCount:100 hierarchyDepth:1];
+    NSArray *propertyNames = [[AKBenchmarkWorkload propertyNamesOfClass:nodeClass] subarrayWithRange:NSMakeRange(0, 12)];
+    
+    for (NSNumber *depth in AKBenchmarkWorkloadDepths(runner))
+    {
+        AKBenchmarkWorkload *workload = [[AKBenchmarkWorkload alloc] initWithClass:nodeClass depth:[depth unsignedIntegerValue] fanOut:AKBenchmarkWorkloadFanOut];
+        workload.overrideDensity = 0.01;
+        
+        AKAncestorTable *table = [workload buildTable];
+        NSDictionary *parameters = @{@"properties": @(propertyNames.count), @"nodes": @(table.count), @"fan_out": @(AKBenchmarkWorkloadFanOut)};
+        
+        [runner runBenchmarkNamed:@"table.count_overriding" parameters:parameters block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                AKBenchmarkSink = @([table countOfIndexesOverridingPropertyNames:propertyNames match:AKAncestorTableMatchAny]);
+            }
+        }];
+        
+        [runner runBenchmarkNamed:@"table.indexes_inheriting" parameters:parameters block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                @autoreleasepool {
+                    AKBenchmarkSink = [table indexesInheritingPropertyNames:propertyNames fromIndex:0 match:AKAncestorTableMatchAll];
+                }
+            }
+        }];
+    }
+}
+
+static void AKBenchmarkResolvedValues(AKBenchmarkRunner *runner)
+{
+    Class nodeClass = [AKBenchmarkWorkload classWithPropertyCount:10 hierarchyDepth:1];
+    NSArray *propertyNames = [AKBenchmarkWorkload propertyNamesOfClass:nodeClass];
+    
+    NSUInteger getterCount = propertyNames.count;
+    SEL *getters = calloc(getterCount, sizeof(SEL));
+    for (NSUInteger index = 0; index < getterCount; index++)
+    {
+        getters[index] = NSSelectorFromString(propertyNames[index]);
+    }
+    
+    // Doubling the threads up to every active core shows how resolving scales, rather than only how fast it is with all of them.
+    NSUInteger coreCount = MAX([[NSProcessInfo processInfo] activeProcessorCount], (NSUInteger)1);
+    NSMutableArray *threadCounts = [NSMutableArray array];
+    for (NSUInteger threadCount = 1; threadCount < coreCount; threadCount *= 2)
+    {
+        [threadCounts addObject:@(threadCount)];
+    }
+    [threadCounts addObject:@(coreCount)];
+    
+    for (NSNumber *depth in AKBenchmarkWorkloadDepths(runner))
+    {
+        AKBenchmarkWorkload *workload = [[AKBenchmarkWorkload alloc] initWithClass:nodeClass depth:[depth unsignedIntegerValue] fanOut:AKBenchmarkWorkloadFanOut];
+        workload.overrideDensity = 0.1;
+        
+        AKBenchmarkTree *tree = [workload buildTree];
+        NSArray *leaves = tree.leaves;
+        NSDictionary *parameters = @{@"properties": @(getterCount), @"rows": @(leaves.count), @"fan_out": @(AKBenchmarkWorkloadFanOut), @"cores": @([[NSProcessInfo processInfo] activeProcessorCount])};
+        
+        // Each iteration resolves every property of every leaf, first one getter at a time on this thread and then all at once on each number of threads.
+        [runner runBenchmarkNamed:@"objects.materialize" parameters:parameters block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                for (AKAncestor *leaf in leaves)
+                {
+                    for (NSUInteger index = 0; index < getterCount; index++)
+                    {
+                        AKBenchmarkSink = ((id (*)(id, SEL))objc_msgSend)(leaf, getters[index]);
+                    }
+                }
+            }
+        }];
+        
+        for (NSNumber *threadCount in threadCounts)
+        {
+            NSMutableDictionary *threadParameters = [parameters mutableCopy];
+            threadParameters[@"threads"] = threadCount;
+            
+            [runner runBenchmarkNamed:@"resolved_values.materialize" parameters:threadParameters block:^(NSUInteger iterations) {
+                for (NSUInteger i = 0; i < iterations; i++)
+                {
+                    @autoreleasepool {
+                        AKBenchmarkSink = [[AKAncestorResolvedValues alloc] initWithAncestors:leaves propertyNames:propertyNames maximumThreadCount:[threadCount unsignedIntegerValue]];
+                    }
+                }
+            }];
+        }
+    }
+    
+    free(getters);
+}
+
+static void AKBenchmarkVersionedReads(AKBenchmarkRunner *runner)
+{
+    AKBenchmarkPerson *leaf = [AKBenchmarkPerson chainWithDepth:4];
+    AKBenchmarkPerson *root = leaf;
+    while (root.ancestor)
+    {
+        root = (AKBenchmarkPerson *)root.ancestor;
+    }
+    
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:root];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    size_t threadCount = 4;
+    
+    // Readers run on several threads while a writer, if any, changes the root as fast as it can. Pinned versions should read just as fast either way.
+    for (NSNumber *writes in @[@NO, @YES])
+    {
+        NSDictionary *parameters = @{@"threads": @(threadCount), @"depth": @4, @"writer": writes};
+        __block volatile BOOL isWriting = [writes boolValue];
+        dispatch_semaphore_t writerDone = dispatch_semaphore_create(0);
+        
+        dispatch_async(queue, ^{
+            NSUInteger commit = 0;
+            while (isWriting)
+            {
+                @autoreleasepool {
+                    NSString *lastName = (commit++ % 2 == 0) ? @"Prewett" : @"Weasley";
+                    [tree commitChanges:^{
+                        root.lastName = lastName;
+                    }];
+                }
+            }
+            dispatch_semaphore_signal(writerDone);
+        });
+        
+        [runner runBenchmarkNamed:@"objects.read_under_writes" parameters:parameters block:^(NSUInteger iterations) {
+            NSUInteger iterationsPerThread = (iterations + threadCount - 1) / threadCount;
+            
+            dispatch_apply(threadCount, queue, ^(size_t thread) {
+                NSUInteger start = thread * iterationsPerThread;
+                NSUInteger end = MIN(start + iterationsPerThread, iterations);
+                
+                for (NSUInteger i = start; i < end; i++)
+                {
+                    @autoreleasepool {
+                        AKBenchmarkSink = [leaf lastName];
+                    }
+                }
+            });
+        }];
+        
+        [runner runBenchmarkNamed:@"versioned.read_under_writes" parameters:parameters block:^(NSUInteger iterations) {
+            NSUInteger iterationsPerThread = (iterations + threadCount - 1) / threadCount;
+            
+            dispatch_apply(threadCount, queue, ^(size_t thread) {
+                NSUInteger start = thread * iterationsPerThread;
+                NSUInteger end = MIN(start + iterationsPerThread, iterations);
+                
+                for (NSUInteger i = start; i < end; i++)
+                {
+                    @autoreleasepool {
+                        AKAncestorVersion *version = tree.currentVersion;
+                        AKBenchmarkSink = [version valueForPropertyName:@"lastName" ofAncestor:leaf];
+                    }
+                }
+            });
+        }];
+        
+        isWriting = NO;
+        dispatch_semaphore_wait(writerDone, DISPATCH_TIME_FOREVER);
+    }
+}
+
+static void AKBenchmarkSnapshotColdStart(AKBenchmarkRunner *runner)
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    for (NSNumber *count in @[@1000, @10000, @100000])
+    {
+        NSUInteger descendantCount = [count unsignedIntegerValue];
+        if (descendantCount > runner.maximumNodeCount)
+        {
+            continue;
+        }
+        
+        NSString *lookupName = [NSString stringWithFormat:@"person %lu", (unsigned long)(descendantCount / 2)];
+        NSURL *snapshotURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[NSString stringWithFormat:@"ak-bench-%d.snapshot", getpid()]];
+        NSURL *propertyListURL = [snapshotURL URLByAppendingPathExtension:@"plist"];
+        
+        @autoreleasepool {
+            AKBenchmarkPerson *root = [AKBenchmarkPerson chainWithDepth:0];
+            NSMutableDictionary *ancestorsByName = [NSMutableDictionary dictionaryWithCapacity:descendantCount];
+            NSMutableDictionary *propertyList = [NSMutableDictionary dictionaryWithCapacity:descendantCount];
+            for (NSUInteger i = 0; i < descendantCount; i++)
+            {
+                AKBenchmarkPerson *person = [root descendantInheritingKeyValueNotifications:NO];
+                person.firstName = [NSString stringWithFormat:@"First %lu", (unsigned long)i];
+                
+                NSString *name = [NSString stringWithFormat:@"person %lu", (unsigned long)i];
+                ancestorsByName[name] = person;
+                propertyList[name] = @{firstName: person.firstName, lastName: root.lastName};
+            }
+            
+            [[AKAncestorSnapshot snapshotDataWithAncestorsByName:ancestorsByName error:NULL] writeToURL:snapshotURL atomically:YES];
+            [[NSPropertyListSerialization dataWithPropertyList:propertyList format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL] writeToURL:propertyListURL atomically:YES];
+        }
+        
+        // Each iteration starts from the file as a freshly launched process would, then reads one value. The files stay in the page cache, so this measures the work done after mapping rather than disk reads.
+        [runner runBenchmarkNamed:@"snapshot.cold_start" parameters:@{@"descendants": count} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                @autoreleasepool {
+                    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithContentsOfURL:snapshotURL error:NULL];
+                    AKBenchmarkSink = [[snapshot ancestorNamed:lookupName] lastName];
+                }
+            }
+        }];
+        
+        [runner runBenchmarkNamed:@"property_list.cold_start" parameters:@{@"descendants": count} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                @autoreleasepool {
+                    NSData *data = [NSData dataWithContentsOfURL:propertyListURL];
+                    NSDictionary *propertyList = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL];
+                    AKBenchmarkSink = propertyList[lookupName][lastName];
+                }
+            }
+        }];
+        
+        [[NSFileManager defaultManager] removeItemAtURL:snapshotURL error:NULL];
+        [[NSFileManager defaultManager] removeItemAtURL:propertyListURL error:NULL];
+    }
+}
+
+static void AKBenchmarkSharedSnapshots(AKBenchmarkRunner *runner)
+{
+    AKBenchmarkPerson *leaf = [AKBenchmarkPerson chainWithDepth:4];
+    NSDictionary *ancestorsByName = @{@"leaf": leaf};
+    
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:ancestorsByName error:NULL];
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:NULL];
+    NSUInteger leafIndex = [snapshot indexOfAncestorNamed:@"leaf"];
+    
+    NSString *segmentName = [NSString stringWithFormat:@"ak-bench-%d", getpid()];
+    AKAncestorSharedSnapshotPublisher *publisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:segmentName capacity:(1 << 16) error:NULL];
+    [publisher publishAncestorsByName:ancestorsByName error:NULL];
+    AKAncestorSharedSnapshot *reader = [[AKAncestorSharedSnapshot alloc] initWithName:segmentName error:NULL];
+    
+    [runner runBenchmarkNamed:@"snapshot.resolve" parameters:@{@"depth": @4} block:^(NSUInteger iterations) {
+        for (NSUInteger i = 0; i < iterations; i++)
+        {
+            @autoreleasepool {
+                AKBenchmarkSink = [snapshot valueForPropertyName:@"lastName" ofAncestorAtIndex:leafIndex];
+            }
+        }
+    }];
+    
+    // Reads are retried when the slot they read is rewritten, which a publisher republishing as fast as it can makes as likely as it gets.
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    for (NSNumber *publishes in @[@NO, @YES])
+    {
+        __block volatile BOOL isPublishing = [publishes boolValue];
+        dispatch_semaphore_t publisherDone = dispatch_semaphore_create(0);
+        
+        dispatch_async(queue, ^{
+            while (isPublishing)
+            {
+                @autoreleasepool {
+                    [publisher publishAncestorsByName:ancestorsByName error:NULL];
+                }
+            }
+            dispatch_semaphore_signal(publisherDone);
+        });
+        
+        [runner runBenchmarkNamed:@"shared_snapshot.resolve" parameters:@{@"depth": @4, @"publisher": publishes} block:^(NSUInteger iterations) {
+            for (NSUInteger i = 0; i < iterations; i++)
+            {
+                @autoreleasepool {
+                    AKBenchmarkSink = [reader valueForPropertyName:@"lastName" ofAncestorNamed:@"leaf"];
+                }
+            }
+        }];
+        
+        isPublishing = NO;
+        dispatch_semaphore_wait(publisherDone, DISPATCH_TIME_FOREVER);
+    }
+    
+    [AKAncestorSharedSnapshotPublisher removeSegmentNamed:segmentName error:NULL];
+}
+
+int main(int argc, const char *argv[])
+{
+    @autoreleasepool {
+        NSArray *arguments = [[NSProcessInfo processInfo] arguments];
+        arguments = [arguments subarrayWithRange:NSMakeRange(1, arguments.count - 1)];
+        
+        AKBenchmarkRunner *runner = [[AKBenchmarkRunner alloc] initWithArguments:arguments];
+        if (!runner)
+        {
+            fprintf(stderr, "usage: %s [--samples N] [--min-time SECONDS] [--filter SUBSTRING] [--max-nodes N] [--output PATH] [--save-baseline NAME] [--baseline NAME] [--threshold PERCENT] [--baseline-dir PATH]\n", argv[0]);
+            return 2;
+        }
+        
+        AKBenchmarkInheritedGetters(runner);
+        AKBenchmarkDescendantLifecycle(runner);
+        AKBenchmarkWriteFanOut(runner);
+        AKBenchmarkStopInheriting(runner);
+        AKBenchmarkStartup(runner);
+        AKBenchmarkThreadedReads(runner);
+        AKBenchmarkWorkloadGetters(runner);
+        AKBenchmarkWorkloadTrees(runner);
+        AKBenchmarkTables(runner);
+        AKBenchmarkTableQueries(runner);
+        AKBenchmarkResolvedValues(runner);
+        AKBenchmarkVersionedReads(runner);
+        AKBenchmarkSnapshotColdStart(runner);
+        AKBenchmarkSharedSnapshots(runner);
+        
+        NSError *error;
+        if (![runner writeResultsWithError:&error])
+        {
+            fprintf(stderr, "Couldn't write results: %s\n", [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+        
+        if (runner.savedBaselineName && ![runner saveBaselineWithError:&error])
+        {
+            fprintf(stderr, "Couldn't save baseline \"%s\": %s\n", [runner.savedBaselineName UTF8String], [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+        
+        if (runner.baselineName)
+        {
+            AKBenchmarkComparison *comparison = [runner compareWithBaselineWithError:&error];
+            if (!comparison)
+            {
+                fprintf(stderr, "Couldn't read baseline \"%s\": %s\n", [runner.baselineName UTF8String], [[error localizedDescription] UTF8String]);
+                return 1;
+            }
+            
+            fprintf(stderr, "\n%s", [[comparison tableDescription] UTF8String]);
+            
+            // A distinct status lets scripts tell a regression apart from a run which failed.
+            if ([comparison hasRegressions])
+            {
+                fprintf(stderr, "\nRegressed against baseline \"%s\" by more than %.1f%%.\n", [runner.baselineName UTF8String], runner.regressionThreshold * 100.0);
+                return 3;
+            }
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorDescriptionWriter.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorImporter.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorResolutionHistogram.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorResolvedValues.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorSharedSnapshot.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorSnapshot.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorStatistics.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorTable.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorTrace.h
\ No newline at end of file
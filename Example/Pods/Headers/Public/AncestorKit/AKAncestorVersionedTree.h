@@ -0,0 +1 @@
+../../../../../Pod/Classes/AKAncestorVersionedTree.h
\ No newline at end of file
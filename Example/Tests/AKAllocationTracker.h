@@ -0,0 +1,50 @@
+//
+//  AKAllocationTracker.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  Counts the Objective-C objects and heap blocks allocated on the current thread while a block runs, and remembers where the first of them were allocated so a blown budget can say why.
+ *
+ *  Objects are counted through +allocWithZone:, so objects created by CoreFoundation directly only show up as heap blocks. Heap blocks are counted through the malloc logger, which sees every malloc, calloc and realloc, including those made for objects.
+ */
+@interface AKAllocationTracker : NSObject
+
+/**
+ *  Runs a block once to fill any caches it uses, and then again while counting allocations.
+ *
+ *  @param block The block to track. This must not be nil.
+ *
+ *  @return A tracker holding the counts of the second run.
+ */
++ (instancetype)trackAllocationsInBlock:(void (^)(void))block;
+
+@property (assign, nonatomic, readonly) NSUInteger objectCount;
+@property (assign, nonatomic, readonly) NSUInteger mallocCount;
+
+/**
+ *  The total size in bytes of the heap blocks counted in mallocCount.
+ */
+@property (assign, nonatomic, readonly) NSUInteger mallocByteCount;
+
+/**
+ *  Describes each recorded allocation with its class or size and symbolicated call stack, suitable as the message of a failed assertion.
+ */
+- (NSString *)callSiteReport;
+
+@end
+
+/**
+ *  Fails the current test if a block allocates more objects or heap blocks than budgeted, printing the allocating call sites.
+ */
+#define AKAssertAllocationBudget(block, objectBudget, mallocBudget) \
+    do { \
+        AKAllocationTracker *_tracker = [AKAllocationTracker trackAllocationsInBlock:(block)]; \
+        XCTAssertLessThanOrEqual(_tracker.objectCount, (NSUInteger)(objectBudget), @"Allocated %lu objects:\n%@", (unsigned long)_tracker.objectCount, [_tracker callSiteReport]); \
+        XCTAssertLessThanOrEqual(_tracker.mallocCount, (NSUInteger)(mallocBudget), @"Allocated %lu heap blocks:\n%@", (unsigned long)_tracker.mallocCount, [_tracker callSiteReport]); \
+    } while (0)
@@ -0,0 +1,232 @@
+//
+//  AKAllocationTracker.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAllocationTracker.h"
+#import <dlfcn.h>
+#import <execinfo.h>
+#import <objc/runtime.h>
+#import <pthread.h>
+
+typedef void (AKMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip);
+
+// The malloc logger isn't declared in a public header, but it's how MallocStackLogging and Instruments see every heap allocation, and it's called on the allocating thread.
+extern AKMallocLogger *malloc_logger;
+
+static const uint32_t AKMallocLogTypeAllocate = 2;
+static const uint32_t AKMallocLogTypeDeallocate = 4;
+
+#define AKAllocationTrackerMaximumRecords 64
+#define AKAllocationTrackerMaximumFrames 24
+
+typedef struct
+{
+    __unsafe_unretained Class objectClass;
+    size_t size;
+    int frameCount;
+    void *frames[AKAllocationTrackerMaximumFrames];
+} AKAllocationRecord;
+
+// Everything touched while tracking lives in statics, since allocating to record an allocation would count itself. Only one thread is tracked at a time.
+static pthread_t AKAllocationTrackerThread;
+static volatile BOOL AKAllocationTrackerIsTracking;
+static BOOL AKAllocationTrackerIsRecording;
+static AKMallocLogger *AKAllocationTrackerPreviousLogger;
+
+static NSUInteger AKAllocationTrackerObjectCount;
+static NSUInteger AKAllocationTrackerMallocCount;
+static NSUInteger AKAllocationTrackerMallocByteCount;
+static NSUInteger AKAllocationTrackerRecordCount;
+static AKAllocationRecord AKAllocationTrackerRecords[AKAllocationTrackerMaximumRecords];
+
+static BOOL AKAllocationTrackerBeginRecording(void)
+{
+    if (!AKAllocationTrackerIsTracking || AKAllocationTrackerIsRecording || !pthread_equal(pthread_self(), AKAllocationTrackerThread))
+    {
+        return NO;
+    }
+    
+    AKAllocationTrackerIsRecording = YES;
+    return YES;
+}
+
+static void AKAllocationTrackerRecord(Class objectClass, size_t size)
+{
+    if (AKAllocationTrackerRecordCount >= AKAllocationTrackerMaximumRecords)
+    {
+        return;
+    }
+    
+    AKAllocationRecord *record = &AKAllocationTrackerRecords[AKAllocationTrackerRecordCount++];
+    record->objectClass = objectClass;
+    record->size = size;
+    record->frameCount = backtrace(record->frames, AKAllocationTrackerMaximumFrames);
+}
+
+static void AKAllocationTrackerMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip)
+{
+    if (AKAllocationTrackerPreviousLogger)
+    {
+        AKAllocationTrackerPreviousLogger(type, arg1, arg2, arg3, result, numberOfFramesToSkip + 1);
+    }
+    
+    if (!(type & AKMallocLogTypeAllocate) || !AKAllocationTrackerBeginRecording())
+    {
+        return;
+    }
+    
+    // Reallocations are logged as both an allocation and a deallocation, with the new size third rather than second.
+    size_t size = (type & AKMallocLogTypeDeallocate) ? arg3 : arg2;
+    
+    AKAllocationTrackerMallocCount++;
+    AKAllocationTrackerMallocByteCount += size;
+    AKAllocationTrackerRecord(Nil, size);
+    
+    AKAllocationTrackerIsRecording = NO;
+}
+
+
+@interface NSObject (AKAllocationTracker)
+
++ (id)ak_trackedAllocWithZone:(NSZone *)zone NS_RETURNS_RETAINED;
+
+@end
+
+@implementation NSObject (AKAllocationTracker)
+
++ (id)ak_trackedAllocWithZone:(NSZone *)zone
+{
+    if (AKAllocationTrackerBeginRecording())
+    {
+        AKAllocationTrackerObjectCount++;
+        AKAllocationTrackerRecord(self, class_getInstanceSize(self));
+        
+        AKAllocationTrackerIsRecording = NO;
+    }
+    
+    // The implementations were exchanged, so this calls the original +allocWithZone:.
+    return [self ak_trackedAllocWithZone:zone];
+}
+
+@end
+
+
+@interface AKAllocationTracker ()
+
+@property (assign, nonatomic, readwrite) NSUInteger objectCount;
+@property (assign, nonatomic, readwrite) NSUInteger mallocCount;
+@property (assign, nonatomic, readwrite) NSUInteger mallocByteCount;
+
+@property (copy, nonatomic) NSData *records;
+
+@end
+
+@implementation AKAllocationTracker
+
++ (void)_installHooks
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // The runtime notices +allocWithZone: being replaced and stops skipping it when allocating, so every +alloc passes through here.
+        Method originalMethod = class_getClassMethod([NSObject class], @selector(allocWithZone:));
+        Method trackedMethod = class_getClassMethod([NSObject class], @selector(ak_trackedAllocWithZone:));
+        method_exchangeImplementations(originalMethod, trackedMethod);
+        
+        // Walking the stack the first time may bind symbols lazily, which shouldn't happen while tracking.
+        void *frames[AKAllocationTrackerMaximumFrames];
+        backtrace(frames, AKAllocationTrackerMaximumFrames);
+    });
+}
+
++ (instancetype)trackAllocationsInBlock:(void (^)(void))block
+{
+    NSParameterAssert(block);
+    
+    [self _installHooks];
+    
+    @autoreleasepool {
+        block();
+    }
+    
+    AKAllocationTracker *tracker = [self new];
+    
+    AKAllocationTrackerObjectCount = 0;
+    AKAllocationTrackerMallocCount = 0;
+    AKAllocationTrackerMallocByteCount = 0;
+    AKAllocationTrackerRecordCount = 0;
+    
+    // The pool is pushed before tracking starts and popped after it stops, so only the block's own allocations are counted.
+    @autoreleasepool {
+        AKAllocationTrackerThread = pthread_self();
+        AKAllocationTrackerPreviousLogger = malloc_logger;
+        malloc_logger = AKAllocationTrackerMallocLogger;
+        AKAllocationTrackerIsTracking = YES;
+        
+        block();
+        
+        AKAllocationTrackerIsTracking = NO;
+        malloc_logger = AKAllocationTrackerPreviousLogger;
+        AKAllocationTrackerPreviousLogger = NULL;
+    }
+    
+    tracker.objectCount = AKAllocationTrackerObjectCount;
+    tracker.mallocCount = AKAllocationTrackerMallocCount;
+    tracker.mallocByteCount = AKAllocationTrackerMallocByteCount;
+    tracker.records = [NSData dataWithBytes:AKAllocationTrackerRecords length:AKAllocationTrackerRecordCount * sizeof(AKAllocationRecord)];
+    
+    return tracker;
+}
+
+- (NSString *)callSiteReport
+{
+    const AKAllocationRecord *records = self.records.bytes;
+    NSUInteger recordCount = self.records.length / sizeof(AKAllocationRecord);
+    
+    NSMutableString *report = [NSMutableString string];
+    for (NSUInteger index = 0; index < recordCount; index++)
+    {
+        const AKAllocationRecord *record = &records[index];
+        if (record->objectClass)
+        {
+            [report appendFormat:@"%@ (%zu bytes)\n", NSStringFromClass(record->objectClass), record->size];
+        }
+        else
+        {
+            [report appendFormat:@"malloc (%zu bytes)\n", record->size];
+        }
+        
+        // The first frames are the tracker's own hooks, and the allocator's frames only repeat that an allocation happened.
+        for (int frame = 2; frame < record->frameCount; frame++)
+        {
+            Dl_info info;
+            if (!dladdr(record->frames[frame], &info) || !info.dli_sname)
+            {
+                [report appendFormat:@"    %p\n", record->frames[frame]];
+                continue;
+            }
+            
+            if (strstr(info.dli_fname, "libsystem_malloc"))
+            {
+                continue;
+            }
+            
+            const char *imageName = strrchr(info.dli_fname, '/');
+            imageName = (imageName) ? imageName + 1 : info.dli_fname;
+            [report appendFormat:@"    %-24s %s + %ld\n", imageName, info.dli_sname, (long)((uintptr_t)record->frames[frame] - (uintptr_t)info.dli_saddr)];
+        }
+    }
+    
+    NSUInteger unrecordedCount = (self.objectCount + self.mallocCount) - recordCount;
+    if (unrecordedCount > 0)
+    {
+        [report appendFormat:@"...and %lu more\n", (unsigned long)unrecordedCount];
+    }
+    
+    return report;
+}
+
+@end
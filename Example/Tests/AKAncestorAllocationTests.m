@@ -0,0 +1,108 @@
+//
+//  AKAncestorAllocationTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKAllocationTracker.h"
+#import "AKTestFixtures.h"
+
+@interface AKAncestorAllocationTests : XCTestCase
+
+@end
+
+@implementation AKAncestorAllocationTests
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+}
+
+- (void)testTrackerCountsAllocations
+{
+    AKAllocationTracker *tracker = [AKAllocationTracker trackAllocationsInBlock:^{
+        NSObject *object = [NSObject new];
+        free(malloc(64));
+        [object self];
+    }];
+    
+    XCTAssertEqual(tracker.objectCount, (NSUInteger)1);
+    XCTAssertGreaterThanOrEqual(tracker.mallocCount, (NSUInteger)2);
+    XCTAssertGreaterThanOrEqual(tracker.mallocByteCount, (NSUInteger)64);
+    XCTAssertTrue([[tracker callSiteReport] rangeOfString:@"NSObject"].location != NSNotFound);
+    XCTAssertTrue([[tracker callSiteReport] rangeOfString:@"testTrackerCountsAllocations"].location != NSNotFound);
+}
+
+- (void)testLocalReadAllocatesNothing
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    AKAssertAllocationBudget(^{
+        [person lastName];
+    }, 0, 0);
+}
+
+- (void)testInheritedReadAllocatesNothing
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    AKTestPerson *person = root;
+    for (NSUInteger depth = 0; depth < 5; depth++)
+    {
+        person = [person descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    AKAssertAllocationBudget(^{
+        [person lastName];
+        [person firstName];
+    }, 0, 0);
+}
+
+- (void)testIgnoredReadAllocatesNothing
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    AKTestPerson *person = [root descendantInheritingKeyValueNotifications:NO];
+    [person stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    AKAssertAllocationBudget(^{
+        [person lastName];
+    }, 0, 0);
+}
+
+- (void)testKeyValueForwardAllocatesAtMostOneObject
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSKeyValueObservingOptions options = NSKeyValueObservingOptionPrior|NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld;
+    
+    // Foundation allocates for every notification, so the forward is measured against a write seen by an ordinary observer with the same options.
+    AKTestPerson *observedPerson = [AKTestPerson new];
+    observedPerson.lastName = @"Weasley";
+    [observedPerson addObserver:self forKeyPath:lastName options:options context:NULL];
+    
+    AKAllocationTracker *baseline = [AKAllocationTracker trackAllocationsInBlock:^{
+        observedPerson.lastName = [observedPerson.lastName isEqualToString:@"Weasley"] ? @"Prewett" : @"Weasley";
+    }];
+    
+    [observedPerson removeObserver:self forKeyPath:lastName context:NULL];
+    
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    AKTestPerson *person = [root descendantInheritingKeyValueNotifications:YES];
+    
+    AKAllocationTracker *forward = [AKAllocationTracker trackAllocationsInBlock:^{
+        root.lastName = [root.lastName isEqualToString:@"Weasley"] ? @"Prewett" : @"Weasley";
+    }];
+    
+    XCTAssertEqualObjects(person.lastName, root.lastName);
+    XCTAssertLessThanOrEqual(forward.objectCount, baseline.objectCount + 1, @"Forwarding allocated:\n%@", [forward callSiteReport]);
+    XCTAssertLessThanOrEqual(forward.mallocCount, baseline.mallocCount + 1, @"Forwarding allocated:\n%@", [forward callSiteReport]);
+}
+
+@end
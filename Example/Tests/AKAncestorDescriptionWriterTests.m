@@ -0,0 +1,194 @@
+//
+//  AKAncestorDescriptionWriterTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKTestRelative : AKAncestor
+@property (copy, nonatomic) NSString *name;
+@property (strong, nonatomic) AKAncestor *relative;
+@end
+
+@implementation AKTestRelative
+@end
+
+
+@interface AKAncestorDescriptionWriterTests : XCTestCase
+
+@end
+
+@implementation AKAncestorDescriptionWriterTests
+
++ (AKTestPerson *)familyChainWithDepth:(NSUInteger)depth
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    for (NSUInteger i = 1; i < depth; i++)
+    {
+        person = [person descendantInheritingKeyValueNotifications:NO];
+        person.firstName = [NSString stringWithFormat:@"Weasley %lu", (unsigned long)i];
+    }
+    
+    return person;
+}
+
+- (void)testDescription
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.lastName = @"Potter";
+    
+    AKTestPerson *personB = [personA descendant];
+    personB.firstName = @"Harry";
+    
+    NSString *expectedDescription = [NSString stringWithFormat:@"<AKTestPerson:%p>\n\tProperties\n\t\tfirstName: Harry,\n\t\tlastName: Potter,\n\tAncestor <AKTestPerson:%p>\n\t\tProperties\n\t\t\tlastName: Potter,", personB, personA];
+    
+    XCTAssertEqualObjects([personB debugDescription], expectedDescription);
+    XCTAssertEqualObjects([[AKAncestorDescriptionWriter new] descriptionOfAncestor:personB], expectedDescription);
+}
+
+- (void)testIgnoredProperties
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.lastName = @"Ciccone";
+    
+    AKTestPerson *personB = [personA descendant];
+    [personB stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    XCTAssertTrue([[personB debugDescription] containsString:@"lastName: nil (ignoring inheritance),"]);
+}
+
+- (void)testSharedAncestorsAreDescribedByReference
+{
+    AKTestRelative *parent = [AKTestRelative new];
+    parent.name = @"Arthur";
+    
+    AKTestRelative *child = [parent descendant];
+    child.name = @"Ron";
+    child.relative = parent;
+    
+    NSString *description = [[AKAncestorDescriptionWriter new] descriptionOfAncestor:child];
+    NSString *reference = [NSString stringWithFormat:@"<AKTestRelative:%p> (described above)", parent];
+    
+    XCTAssertTrue([description hasSuffix:reference]);
+    XCTAssertEqual([description componentsSeparatedByString:@"name: Arthur,"].count, (NSUInteger)2);
+}
+
+- (void)testCyclesAreDescribedByReference
+{
+    AKTestRelative *parent = [AKTestRelative new];
+    AKTestRelative *child = [parent descendant];
+    
+    child.relative = parent;
+    parent.relative = child;
+    
+    NSString *description = [[AKAncestorDescriptionWriter new] descriptionOfAncestor:child];
+    XCTAssertEqual([description componentsSeparatedByString:@"(described above)"].count, (NSUInteger)3);
+    
+    parent.relative = nil;
+}
+
+- (void)testMaximumDepth
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:10];
+    
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    writer.maximumDepth = 2;
+    
+    NSString *description = [writer descriptionOfAncestor:person];
+    XCTAssertEqual([description componentsSeparatedByString:@"Ancestor "].count, (NSUInteger)3);
+    XCTAssertTrue([description hasSuffix:@"> ..."]);
+    XCTAssertTrue([description containsString:@"Weasley 8"]);
+    XCTAssertFalse([description containsString:@"Weasley 7"]);
+}
+
+- (void)testMaximumLength
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:10];
+    person.firstName = @"Ærwyn Weasley";
+    
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    NSString *fullDescription = [writer descriptionOfAncestor:person];
+    
+    for (NSUInteger length = 3; length < 60; length++)
+    {
+        writer.maximumLength = length;
+        NSString *description = [writer descriptionOfAncestor:person];
+        
+        XCTAssertNotNil(description, @"Output cut at %lu bytes isn't valid UTF-8", (unsigned long)length);
+        XCTAssertLessThanOrEqual([description lengthOfBytesUsingEncoding:NSUTF8StringEncoding], length);
+        XCTAssertTrue([description hasSuffix:@"..."]);
+        XCTAssertTrue([fullDescription hasPrefix:[description substringToIndex:(description.length - 3)]]);
+    }
+}
+
+- (void)testWriteToBuffer
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:100];
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    
+    char buffer[64];
+    memset(buffer, 'x', sizeof(buffer));
+    
+    NSUInteger length = [writer writeDescriptionOfAncestor:person toBuffer:buffer length:sizeof(buffer)];
+    XCTAssertEqual(length, (NSUInteger)63);
+    XCTAssertEqual(buffer[63], '\0');
+    XCTAssertEqual(strlen(buffer), (size_t)63);
+    
+    NSString *description = [writer descriptionOfAncestor:person];
+    XCTAssertTrue([description hasPrefix:[[NSString stringWithUTF8String:buffer] substringToIndex:60]]);
+    
+    length = [writer writeDescriptionOfAncestor:person toBuffer:buffer length:1];
+    XCTAssertEqual(length, (NSUInteger)0);
+    XCTAssertEqual(buffer[0], '\0');
+}
+
+- (void)testWriteToStream
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:100];
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    
+    NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+    [stream open];
+    XCTAssertTrue([writer writeDescriptionOfAncestor:person toStream:stream]);
+    [stream close];
+    
+    NSData *data = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+    NSString *description = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    
+    XCTAssertEqualObjects(description, [writer descriptionOfAncestor:person]);
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testDescribeDeepChain
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:500];
+    
+    [self measureBlock:^{
+        [person descriptionWithLocale:nil indent:0];
+    }];
+}
+
+- (void)testWriteDeepChainToBuffer
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:500];
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    writer.maximumDepth = 8;
+    
+    // Blocks can't capture arrays, so the buffer lives on the heap.
+    NSMutableData *buffer = [NSMutableData dataWithLength:4096];
+    
+    [self measureBlock:^{
+        [writer writeDescriptionOfAncestor:person toBuffer:buffer.mutableBytes length:buffer.length];
+    }];
+}
+
+@end
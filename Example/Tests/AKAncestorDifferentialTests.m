@@ -0,0 +1,375 @@
+//
+//  AKAncestorDifferentialTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+static const NSUInteger AKDifferentialThreadCount = 4;
+static const NSUInteger AKDifferentialStepCount = 1500;
+static const NSUInteger AKDifferentialMaximumNodeCount = 24;
+
+typedef NS_ENUM(NSUInteger, AKDifferentialOperation){
+    AKDifferentialOperationCreate = 0,
+    AKDifferentialOperationWrite,
+    AKDifferentialOperationClear,
+    AKDifferentialOperationStopInheriting,
+    AKDifferentialOperationResumeInheriting,
+    AKDifferentialOperationObserve,
+    AKDifferentialOperationCount
+};
+
+// xorshift64*, so a failing run can be replayed from its seed as far as the thread interleaving allows.
+static uint64_t AKDifferentialNextRandom(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    
+    return x * 2685821657736338717ull;
+}
+
+
+/**
+ *  The simplest possible model of inheritance: a node's value is its own, or nothing if it stopped inheriting, or else its parent's.
+ */
+@interface AKReferenceTree : NSObject
+
+- (instancetype)initWithRootValues:(NSDictionary *)rootValues;
+
+/**
+ *  Adds a node, where a parent index of NSNotFound is the shared root.
+ */
+- (void)addNodeWithParentIndex:(NSUInteger)parentIndex;
+
+- (void)setValue:(id)value forKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index;
+- (void)setIgnoresKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index ignores:(BOOL)ignores;
+
+- (id)resolvedValueForKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index;
+- (NSArray *)resolvedValuesForKey:(NSString *)key;
+
+@end
+
+@implementation AKReferenceTree
+{
+    NSDictionary *_rootValues;
+    NSMutableArray *_parentIndexes;
+    NSMutableArray *_values;
+    NSMutableArray *_ignoredKeys;
+}
+
+- (instancetype)init
+{
+    return [self initWithRootValues:@{}];
+}
+
+- (instancetype)initWithRootValues:(NSDictionary *)rootValues
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _rootValues = [rootValues copy];
+    _parentIndexes = [NSMutableArray array];
+    _values = [NSMutableArray array];
+    _ignoredKeys = [NSMutableArray array];
+    
+    return self;
+}
+
+- (void)addNodeWithParentIndex:(NSUInteger)parentIndex
+{
+    [_parentIndexes addObject:@(parentIndex)];
+    [_values addObject:[NSMutableDictionary dictionary]];
+    [_ignoredKeys addObject:[NSMutableSet set]];
+}
+
+- (void)setValue:(id)value forKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index
+{
+    if (value)
+    {
+        _values[index][key] = value;
+    }
+    else
+    {
+        [_values[index] removeObjectForKey:key];
+    }
+}
+
+- (void)setIgnoresKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index ignores:(BOOL)ignores
+{
+    if (ignores)
+    {
+        [_ignoredKeys[index] addObject:key];
+    }
+    else
+    {
+        [_ignoredKeys[index] removeObject:key];
+    }
+}
+
+- (id)resolvedValueForKey:(NSString *)key ofNodeAtIndex:(NSUInteger)index
+{
+    while (index != NSNotFound)
+    {
+        id value = _values[index][key];
+        if (value)
+        {
+            return value;
+        }
+        
+        if ([_ignoredKeys[index] containsObject:key])
+        {
+            return nil;
+        }
+        
+        index = [_parentIndexes[index] unsignedIntegerValue];
+    }
+    
+    return _rootValues[key];
+}
+
+- (NSArray *)resolvedValuesForKey:(NSString *)key
+{
+    NSMutableArray *resolvedValues = [NSMutableArray arrayWithCapacity:_values.count];
+    for (NSUInteger index = 0; index < _values.count; index++)
+    {
+        [resolvedValues addObject:[self resolvedValueForKey:key ofNodeAtIndex:index] ?: [NSNull null]];
+    }
+    
+    return resolvedValues;
+}
+
+@end
+
+
+/**
+ *  Records the notifications of nodes observed with their index plus one as the context.
+ */
+@interface AKDifferentialObserver : NSObject
+
+@property (strong, nonatomic, readonly) NSMutableArray *notifications;
+
+@end
+
+@implementation AKDifferentialObserver
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _notifications = [NSMutableArray array];
+    
+    return self;
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    [self.notifications addObject:@[@((uintptr_t)context - 1), keyPath, change[NSKeyValueChangeNewKey] ?: [NSNull null]]];
+}
+
+@end
+
+
+@interface AKAncestorDifferentialTests : XCTestCase
+
+@end
+
+@implementation AKAncestorDifferentialTests
+
+- (void)tearDown
+{
+    [AKAncestorStatistics setEnabled:NO];
+    [AKAncestorStatistics resetStatistics];
+    [AKAncestorTrace setEnabled:NO];
+    [AKAncestorTrace clear];
+    [AKAncestorResolutionHistogram setEnabled:NO];
+    [AKAncestorResolutionHistogram setSampleInterval:16];
+    [AKAncestorResolutionHistogram resetHistograms];
+    
+    [super tearDown];
+}
+
+- (NSArray *)failuresOfRunWithSeed:(uint64_t)seed root:(AKTestPerson *)root
+{
+    NSArray *keys = @[NSStringFromSelector(@selector(firstName)), NSStringFromSelector(@selector(lastName))];
+    NSArray *values = @[@"Bill", @"Charlie", @"Percy", @"Ron"];
+    
+    uint64_t state = seed ?: 1;
+    AKReferenceTree *model = [[AKReferenceTree alloc] initWithRootValues:@{keys[0]: root.firstName, keys[1]: root.lastName}];
+    NSMutableArray *nodes = [NSMutableArray array];
+    
+    AKDifferentialObserver *observer = [AKDifferentialObserver new];
+    NSMutableArray *observedNodes = [NSMutableArray array];
+    NSMutableArray *observedKeys = [NSMutableArray array];
+    NSMutableSet *observations = [NSMutableSet set];
+    
+    NSMutableArray *failures = [NSMutableArray array];
+    
+    for (NSUInteger step = 0; step < AKDifferentialStepCount && failures.count == 0; step++)
+    {
+        @autoreleasepool {
+            AKDifferentialOperation operation = (nodes.count == 0) ? AKDifferentialOperationCreate : (AKDifferentialOperation)(AKDifferentialNextRandom(&state) % AKDifferentialOperationCount);
+            if (operation == AKDifferentialOperationCreate && nodes.count >= AKDifferentialMaximumNodeCount)
+            {
+                operation = AKDifferentialOperationWrite;
+            }
+            
+            NSString *key = keys[AKDifferentialNextRandom(&state) % keys.count];
+            NSUInteger index = (nodes.count > 0) ? AKDifferentialNextRandom(&state) % nodes.count : 0;
+            NSString *description = nil;
+            
+            NSArray *resolvedValuesBefore = [model resolvedValuesForKey:key];
+            [observer.notifications removeAllObjects];
+            
+            switch (operation)
+            {
+                case AKDifferentialOperationCreate:
+                {
+                    NSUInteger parentIndex = (nodes.count > 0 && AKDifferentialNextRandom(&state) % 4 != 0) ? AKDifferentialNextRandom(&state) % nodes.count : NSNotFound;
+                    AKTestPerson *parent = (parentIndex != NSNotFound) ? nodes[parentIndex] : root;
+                    
+                    [nodes addObject:[parent descendantInheritingKeyValueNotifications:YES]];
+                    [model addNodeWithParentIndex:parentIndex];
+                    
+                    description = [NSString stringWithFormat:@"create node %lu under %ld", (unsigned long)(nodes.count - 1), (long)((parentIndex != NSNotFound) ? (NSInteger)parentIndex : -1)];
+                    break;
+                }
+                case AKDifferentialOperationWrite:
+                case AKDifferentialOperationClear:
+                {
+                    id value = (operation == AKDifferentialOperationWrite) ? values[AKDifferentialNextRandom(&state) % values.count] : nil;
+                    
+                    [nodes[index] setValue:value forKey:key];
+                    [model setValue:value forKey:key ofNodeAtIndex:index];
+                    
+                    description = [NSString stringWithFormat:@"set %@ of node %lu to %@", key, (unsigned long)index, value];
+                    break;
+                }
+                case AKDifferentialOperationStopInheriting:
+                {
+                    [nodes[index] stopInheritingValuesForPropertyName:key];
+                    [model setIgnoresKey:key ofNodeAtIndex:index ignores:YES];
+                    
+                    description = [NSString stringWithFormat:@"stop inheriting %@ in node %lu", key, (unsigned long)index];
+                    break;
+                }
+                case AKDifferentialOperationResumeInheriting:
+                {
+                    [nodes[index] resumeInheritingValuesForPropertyName:key];
+                    [model setIgnoresKey:key ofNodeAtIndex:index ignores:NO];
+                    
+                    description = [NSString stringWithFormat:@"resume inheriting %@ in node %lu", key, (unsigned long)index];
+                    break;
+                }
+                case AKDifferentialOperationObserve:
+                case AKDifferentialOperationCount:
+                {
+                    NSString *observation = [NSString stringWithFormat:@"%lu %@", (unsigned long)index, key];
+                    if (![observations containsObject:observation])
+                    {
+                        [nodes[index] addObserver:observer forKeyPath:key options:NSKeyValueObservingOptionNew context:(void *)(uintptr_t)(index + 1)];
+                        [observations addObject:observation];
+                        [observedNodes addObject:nodes[index]];
+                        [observedKeys addObject:key];
+                    }
+                    
+                    description = [NSString stringWithFormat:@"observe %@ of node %lu", key, (unsigned long)index];
+                    break;
+                }
+            }
+            
+            NSString *context = [NSString stringWithFormat:@"seed %llu, step %lu (%@)", (unsigned long long)seed, (unsigned long)step, description];
+            
+            // A write notifies the node written to, and every observed node whose resolved value changed as a result. Nothing else notifies.
+            NSArray *resolvedValuesAfter = [model resolvedValuesForKey:key];
+            BOOL isWrite = (operation == AKDifferentialOperationWrite || operation == AKDifferentialOperationClear);
+            
+            NSCountedSet *expectedNotifications = [NSCountedSet set];
+            for (NSUInteger nodeIndex = 0; isWrite && nodeIndex < resolvedValuesBefore.count; nodeIndex++)
+            {
+                BOOL isObserved = [observations containsObject:[NSString stringWithFormat:@"%lu %@", (unsigned long)nodeIndex, key]];
+                if (isObserved && (nodeIndex == index || ![resolvedValuesBefore[nodeIndex] isEqual:resolvedValuesAfter[nodeIndex]]))
+                {
+                    [expectedNotifications addObject:@[@(nodeIndex), key, resolvedValuesAfter[nodeIndex]]];
+                }
+            }
+            
+            NSCountedSet *receivedNotifications = [[NSCountedSet alloc] initWithArray:observer.notifications];
+            if (![receivedNotifications isEqual:expectedNotifications])
+            {
+                [failures addObject:[NSString stringWithFormat:@"%@: expected notifications %@, received %@", context, [expectedNotifications allObjects], observer.notifications]];
+            }
+            
+            for (NSUInteger nodeIndex = 0; nodeIndex < nodes.count; nodeIndex++)
+            {
+                for (NSString *readKey in keys)
+                {
+                    id expectedValue = [model resolvedValueForKey:readKey ofNodeAtIndex:nodeIndex];
+                    id value = [nodes[nodeIndex] valueForKey:readKey];
+                    if (value != expectedValue && ![value isEqual:expectedValue])
+                    {
+                        [failures addObject:[NSString stringWithFormat:@"%@: node %lu read %@ as %@, expected %@", context, (unsigned long)nodeIndex, readKey, value, expectedValue]];
+                    }
+                }
+            }
+        }
+    }
+    
+    for (NSUInteger index = 0; index < observedNodes.count; index++)
+    {
+        [observedNodes[index] removeObserver:observer forKeyPath:observedKeys[index]];
+    }
+    
+    return failures;
+}
+
+- (void)runDifferentialTest
+{
+    // Every thread grows its own tree under a shared root which is never written to, so their reads can be checked exactly while their descendants and observers still contend for the root and AncestorKit's shared tables.
+    AKTestPerson *root = [AKTestPerson new];
+    root.firstName = @"Arthur";
+    root.lastName = @"Weasley";
+    
+    uint64_t baseSeed = (uint64_t)[NSDate timeIntervalSinceReferenceDate];
+    NSMutableArray *failures = [NSMutableArray array];
+    NSLock *failuresLock = [NSLock new];
+    
+    dispatch_apply(AKDifferentialThreadCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+        NSArray *threadFailures = [self failuresOfRunWithSeed:baseSeed + thread root:root];
+        
+        [failuresLock lock];
+        [failures addObjectsFromArray:threadFailures];
+        [failuresLock unlock];
+    });
+    
+    XCTAssertEqual(failures.count, (NSUInteger)0, @"%@", [failures componentsJoinedByString:@"\n"]);
+}
+
+- (void)testDifferentialInheritance
+{
+    [self runDifferentialTest];
+}
+
+- (void)testDifferentialInheritanceWithInstrumentation
+{
+    [AKAncestorStatistics setEnabled:YES];
+    [AKAncestorTrace setEnabled:YES];
+    [AKAncestorResolutionHistogram setSampleInterval:1];
+    [AKAncestorResolutionHistogram setEnabled:YES];
+    
+    [self runDifferentialTest];
+}
+
+@end
@@ -0,0 +1,182 @@
+//
+//  AKAncestorImporterTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorImporterTests : XCTestCase
+
+@end
+
+@implementation AKAncestorImporterTests
+
++ (NSDictionary *)familyDescriptionWithCount:(NSUInteger)count fanOut:(NSUInteger)fanOut
+{
+    NSMutableDictionary *description = [NSMutableDictionary dictionaryWithCapacity:count];
+    description[@"0"] = @{AKAncestorImporterValuesKey: @{@"lastName": @"Weasley"}};
+    
+    for (NSUInteger i = 1; i < count; i++)
+    {
+        NSString *name = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+        NSString *parentName = [NSString stringWithFormat:@"%lu", (unsigned long)((i - 1) / fanOut)];
+        description[name] = @{AKAncestorImporterParentKey: parentName, AKAncestorImporterValuesKey: @{@"firstName": name}};
+    }
+    
+    return description;
+}
+
+- (void)testImport
+{
+    NSDictionary *description = @{@"arthur": @{AKAncestorImporterValuesKey: @{@"firstName": @"Arthur", @"lastName": @"Weasley"}},
+                                  @"bill": @{AKAncestorImporterParentKey: @"arthur", AKAncestorImporterValuesKey: @{@"firstName": @"William"}},
+                                  @"victoire": @{AKAncestorImporterParentKey: @"bill", AKAncestorImporterClassKey: NSStringFromClass([AKTestPersonSubclass class]), AKAncestorImporterValuesKey: @{@"firstName": @"Victoire"}},
+                                  @"dominique": @{AKAncestorImporterParentKey: @"victoire", AKAncestorImporterIgnoredPropertiesKey: @[@"lastName"]}};
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    
+    NSError *error;
+    NSDictionary *family = [importer ancestorsFromDictionary:description error:&error];
+    XCTAssertNotNil(family, @"%@", error);
+    XCTAssertEqual(family.count, (NSUInteger)4);
+    
+    AKTestPerson *bill = family[@"bill"];
+    XCTAssertEqualObjects([bill fullName], @"William Weasley");
+    XCTAssertEqual(bill.ancestor, family[@"arthur"]);
+    XCTAssertTrue(bill.inheritsKeyValueNotifications);
+    
+    AKTestPersonSubclass *victoire = family[@"victoire"];
+    XCTAssertTrue([victoire isKindOfClass:[AKTestPersonSubclass class]]);
+    XCTAssertEqualObjects(victoire.firstName, @"VICTOIRE");
+    
+    AKTestPersonSubclass *dominique = family[@"dominique"];
+    XCTAssertTrue([dominique isKindOfClass:[AKTestPersonSubclass class]]);
+    XCTAssertNil(dominique.lastName);
+}
+
+- (void)testImportJSON
+{
+    NSData *data = [@"{\"root\": {\"values\": {\"lastName\": \"Potter\"}}, \"harry\": {\"parent\": \"root\", \"values\": {\"firstName\": \"Harry\"}}}" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    NSDictionary *family = [importer ancestorsFromJSONData:data error:NULL];
+    
+    XCTAssertEqualObjects([family[@"harry"] fullName], @"Harry Potter");
+}
+
+- (void)testImportedKVC
+{
+    NSDictionary *description = @{@"lily": @{AKAncestorImporterValuesKey: @{@"lastName": @"Potter"}},
+                                  @"harry": @{AKAncestorImporterParentKey: @"lily"}};
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    NSDictionary *family = [importer ancestorsFromDictionary:description error:NULL];
+    
+    [self keyValueObservingExpectationForObject:family[@"harry"] keyPath:NSStringFromSelector(@selector(lastName)) expectedValue:@"Evans"];
+    
+    [family[@"lily"] setLastName:@"Evans"];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testImportWithoutKVC
+{
+    NSDictionary *description = [[self class] familyDescriptionWithCount:10 fanOut:2];
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    importer.inheritsKeyValueNotifications = NO;
+    
+    NSDictionary *family = [importer ancestorsFromDictionary:description error:NULL];
+    
+    XCTAssertFalse([family[@"9"] inheritsKeyValueNotifications]);
+    XCTAssertEqualObjects([family[@"9"] lastName], @"Weasley");
+}
+
+- (void)testValueTransformer
+{
+    NSDictionary *description = @{@"harry": @{AKAncestorImporterValuesKey: @{@"birthDate": @0}}};
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPersonSubclass class]];
+    
+    NSError *error;
+    XCTAssertNil([importer ancestorsFromDictionary:description error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorInvalidValue);
+    
+    importer.valueTransformer = ^id (AKPropertyDescription *property, id value) {
+        return ([property.propertyClass isSubclassOfClass:[NSDate class]]) ? [NSDate dateWithTimeIntervalSince1970:[value doubleValue]] : value;
+    };
+    
+    NSDictionary *family = [importer ancestorsFromDictionary:description error:NULL];
+    XCTAssertEqualObjects([family[@"harry"] birthDate], [NSDate dateWithTimeIntervalSince1970:0.0]);
+}
+
+- (void)testInvalidDescriptions
+{
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    NSError *error;
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterParentKey: @"lily"}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorUnknownParent);
+    XCTAssertEqualObjects(error.userInfo[AKAncestorImporterNodeNameErrorKey], @"harry");
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterParentKey: @"lily"}, @"lily": @{AKAncestorImporterParentKey: @"harry"}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorCycle);
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterValuesKey: @{@"middleName": @"James"}}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorUnknownProperty);
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterIgnoredPropertiesKey: @[@"middleName"]}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorUnknownProperty);
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterClassKey: @"NSObject"}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorUnknownClass);
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{@"firstName": @"Harry"}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorInvalidDescription);
+    
+    XCTAssertNil([importer ancestorsFromDictionary:@{@"harry": @{AKAncestorImporterValuesKey: @{@"firstName": @7}}} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorImporterErrorInvalidValue);
+}
+
+- (void)testLargeTree
+{
+    NSDictionary *description = [[self class] familyDescriptionWithCount:5000 fanOut:3];
+    
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    NSDictionary *family = [importer ancestorsFromDictionary:description error:NULL];
+    
+    XCTAssertEqual(family.count, (NSUInteger)5000);
+    XCTAssertEqual([family[@"4999"] ancestor], family[@"1666"]);
+    XCTAssertEqualObjects([family[@"4999"] lastName], @"Weasley");
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testImportWideTree
+{
+    NSDictionary *description = [[self class] familyDescriptionWithCount:100000 fanOut:16];
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    importer.inheritsKeyValueNotifications = NO;
+    
+    [self measureBlock:^{
+        [importer ancestorsFromDictionary:description error:NULL];
+    }];
+}
+
+- (void)testImportWideTreeWithKVC
+{
+    NSDictionary *description = [[self class] familyDescriptionWithCount:100000 fanOut:16];
+    AKAncestorImporter *importer = [[AKAncestorImporter alloc] initWithDefaultClass:[AKTestPerson class]];
+    
+    [self measureBlock:^{
+        [importer ancestorsFromDictionary:description error:NULL];
+    }];
+}
+
+@end
@@ -0,0 +1,172 @@
+//
+//  AKAncestorResolutionHistogramTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorResolutionHistogramTests : XCTestCase
+
+@end
+
+@implementation AKAncestorResolutionHistogramTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    [AKAncestorResolutionHistogram resetHistograms];
+    [AKAncestorResolutionHistogram setSampleInterval:1];
+    [AKAncestorResolutionHistogram setEnabled:YES];
+}
+
+- (void)tearDown
+{
+    [AKAncestorResolutionHistogram setEnabled:NO];
+    [AKAncestorResolutionHistogram setSampleInterval:16];
+    [AKAncestorResolutionHistogram resetHistograms];
+    
+    [super tearDown];
+}
+
++ (AKTestPerson *)familyChainWithDepth:(NSUInteger)depth
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    for (NSUInteger i = 1; i < depth; i++)
+    {
+        person = [person descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    return person;
+}
+
+- (void)testDisabledByDefault
+{
+    [AKAncestorResolutionHistogram setEnabled:NO];
+    
+    [[[self class] familyChainWithDepth:3] lastName];
+    
+    XCTAssertFalse([AKAncestorResolutionHistogram isEnabled]);
+    XCTAssertEqual([AKAncestorResolutionHistogram histogramsForClass:[AKTestPerson class]].count, (NSUInteger)0);
+}
+
+- (void)testDepths
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:3];
+    person.firstName = @"Ron";
+    
+    [person firstName];
+    [person lastName];
+    [person lastName];
+    
+    AKAncestorResolutionHistogram *firstNames = [AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(firstName))];
+    XCTAssertEqual(firstNames.sampleCount, (uint64_t)1);
+    XCTAssertEqual([firstNames countAtDepth:0], (uint64_t)1);
+    
+    // The ancestors consulted along the way aren't recorded themselves.
+    AKAncestorResolutionHistogram *lastNames = [AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(lastName))];
+    XCTAssertEqual(lastNames.sampleCount, (uint64_t)2);
+    XCTAssertEqual([lastNames countAtDepth:2], (uint64_t)2);
+    XCTAssertEqual([lastNames countAtDepth:0], (uint64_t)0);
+    XCTAssertEqual(lastNames.maximumDepth, (NSUInteger)2);
+}
+
+- (void)testMisses
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:3];
+    [person firstName];
+    
+    [person stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    [person lastName];
+    
+    NSDictionary *histograms = [AKAncestorResolutionHistogram histogramsForClass:[AKTestPerson class]];
+    XCTAssertEqual([histograms[NSStringFromSelector(@selector(firstName))] missCount], (uint64_t)1);
+    XCTAssertEqual([histograms[NSStringFromSelector(@selector(lastName))] missCount], (uint64_t)1);
+    XCTAssertEqual([histograms[NSStringFromSelector(@selector(lastName))] maximumDepth], (NSUInteger)NSNotFound);
+}
+
+- (void)testFallbackAncestors
+{
+    AKTestPerson *primary = [AKTestPerson new];
+    AKTestPerson *fallback = [[self class] familyChainWithDepth:2];
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[primary, fallback]];
+    [person lastName];
+    
+    AKAncestorResolutionHistogram *histogram = [AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(lastName))];
+    XCTAssertEqual([histogram countAtDepth:2], (uint64_t)1);
+}
+
+- (void)testPercentiles
+{
+    AKTestPerson *shallowPerson = [AKTestPerson new];
+    shallowPerson.lastName = @"Potter";
+    
+    AKTestPerson *deepPerson = [[self class] familyChainWithDepth:40];
+    
+    for (NSUInteger i = 0; i < 99; i++)
+    {
+        [shallowPerson lastName];
+    }
+    
+    [deepPerson lastName];
+    
+    AKAncestorResolutionHistogram *histogram = [AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(lastName))];
+    XCTAssertEqual([histogram depthAtPercentile:0.5], (NSUInteger)0);
+    XCTAssertEqual([histogram depthAtPercentile:0.99], (NSUInteger)0);
+    XCTAssertEqual([histogram depthAtPercentile:1.0], AKAncestorResolutionDepthLimit);
+    XCTAssertEqual([histogram countAtDepth:39], (uint64_t)1);
+}
+
+- (void)testSampling
+{
+    [AKAncestorResolutionHistogram setSampleInterval:4];
+    
+    AKTestPerson *person = [[self class] familyChainWithDepth:2];
+    for (NSUInteger i = 0; i < 8; i++)
+    {
+        [person lastName];
+    }
+    
+    XCTAssertEqual([AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(lastName))].sampleCount, (uint64_t)2);
+}
+
+- (void)testSamplesFromAllThreads
+{
+    AKTestPerson *person = [[self class] familyChainWithDepth:2];
+    
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        for (NSUInteger i = 0; i < 100; i++)
+        {
+            [person lastName];
+        }
+    });
+    
+    XCTAssertEqual([[AKAncestorResolutionHistogram histogramForClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(lastName))] countAtDepth:1], (uint64_t)400);
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testSampledDeepReads
+{
+    [AKAncestorResolutionHistogram setSampleInterval:16];
+    
+    AKTestPerson *person = [[self class] familyChainWithDepth:10];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,151 @@
+//
+//  AKAncestorResolvedValuesTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorResolvedValuesTests : XCTestCase
+
+@end
+
+@implementation AKAncestorResolvedValuesTests
+
+- (void)assertResolvedValues:(AKAncestorResolvedValues *)resolvedValues matchGettersOfAncestors:(NSArray *)ancestors
+{
+    XCTAssertEqual(resolvedValues.count, ancestors.count);
+    
+    for (NSString *propertyName in resolvedValues.propertyNames)
+    {
+        __unsafe_unretained id const *values = [resolvedValues valuesForPropertyName:propertyName];
+        
+        [ancestors enumerateObjectsUsingBlock:^(AKAncestor *ancestor, NSUInteger index, BOOL *stop) {
+            id expectedValue = ([ancestor respondsToSelector:NSSelectorFromString(propertyName)]) ? [ancestor valueForKey:propertyName] : nil;
+            XCTAssertEqualObjects(values[index], expectedValue, @"%@ of %lu", propertyName, (unsigned long)index);
+            XCTAssertEqualObjects([resolvedValues valueForPropertyName:propertyName atIndex:index], expectedValue, @"%@ of %lu", propertyName, (unsigned long)index);
+        }];
+    }
+}
+
+- (void)testResolvingSharedAncestors
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.firstName = @"Arthur";
+    arthur.lastName = @"Weasley";
+    
+    // Enough descendants to spread each level across several batches, with overrides and ignored properties along the way.
+    NSMutableArray *people = [NSMutableArray arrayWithObject:arthur];
+    for (NSUInteger index = 1; index < 2000; index++)
+    {
+        AKTestPerson *person = [people[(index - 1) / 4] descendantInheritingKeyValueNotifications:NO];
+        if (index % 9 == 0)
+        {
+            person.firstName = [NSString stringWithFormat:@"Weasley %lu", (unsigned long)index];
+        }
+        
+        if (index % 31 == 0)
+        {
+            [person stopInheritingValuesForPropertyName:lastName];
+        }
+        
+        [people addObject:person];
+    }
+    
+    // The list holds the people in a different order, with repeats, and without some of their ancestors.
+    NSMutableArray *rows = [NSMutableArray array];
+    for (NSUInteger index = 0; index < 3000; index++)
+    {
+        [rows addObject:people[(index * 7919) % 1500 + 500]];
+    }
+    
+    AKAncestorResolvedValues *resolvedValues = [[AKAncestorResolvedValues alloc] initWithAncestors:rows propertyNames:nil];
+    XCTAssertEqualObjects(resolvedValues.propertyNames, (@[firstName, lastName]));
+    [self assertResolvedValues:resolvedValues matchGettersOfAncestors:rows];
+    
+    AKAncestorResolvedValues *lastNames = [[AKAncestorResolvedValues alloc] initWithAncestors:rows propertyNames:@[lastName]];
+    XCTAssertEqualObjects(lastNames.propertyNames, @[lastName]);
+    [self assertResolvedValues:lastNames matchGettersOfAncestors:rows];
+    XCTAssertThrowsSpecificNamed([lastNames valueForPropertyName:firstName atIndex:0], NSException, AKAncestorUnknownPropertyException);
+    XCTAssertThrowsSpecificNamed([lastNames valueForPropertyName:lastName atIndex:rows.count], NSException, NSRangeException);
+    
+    XCTAssertEqual(resolvedValues.maximumThreadCount, [[NSProcessInfo processInfo] activeProcessorCount]);
+    for (NSNumber *maximumThreadCount in @[@1, @3])
+    {
+        AKAncestorResolvedValues *limitedValues = [[AKAncestorResolvedValues alloc] initWithAncestors:rows propertyNames:nil maximumThreadCount:[maximumThreadCount unsignedIntegerValue]];
+        XCTAssertEqual(limitedValues.maximumThreadCount, [maximumThreadCount unsignedIntegerValue]);
+        [self assertResolvedValues:limitedValues matchGettersOfAncestors:rows];
+    }
+}
+
+- (void)testResolvingMixedClasses
+{
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.firstName = @"Arthur";
+    arthur.lastName = @"Weasley";
+    
+    // The subclass transforms its first name, and its deep subclass doesn't pass its middle name on.
+    AKTestPersonSubclass *ron = [AKTestPersonSubclass descendantOf:arthur];
+    ron.birthDate = [NSDate dateWithTimeIntervalSince1970:0];
+    
+    AKTestPersonDeepSubclass *hugo = [AKTestPersonDeepSubclass descendantOf:ron];
+    hugo.middleName = @"Bilius";
+    
+    NSArray *rows = @[hugo, arthur, ron];
+    AKAncestorResolvedValues *resolvedValues = [[AKAncestorResolvedValues alloc] initWithAncestors:rows propertyNames:nil];
+    
+    XCTAssertTrue([resolvedValues.propertyNames containsObject:NSStringFromSelector(@selector(birthDate))]);
+    XCTAssertEqualObjects([resolvedValues valueForPropertyName:NSStringFromSelector(@selector(firstName)) atIndex:2], @"ARTHUR");
+    XCTAssertNil([resolvedValues valueForPropertyName:NSStringFromSelector(@selector(birthDate)) atIndex:1]);
+    [self assertResolvedValues:resolvedValues matchGettersOfAncestors:rows];
+}
+
+- (void)testResolvingWithGetters
+{
+    NSString *fontName = NSStringFromSelector(@selector(fontName));
+    NSString *fontFeatures = NSStringFromSelector(@selector(fontFeatures));
+    
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontFeatures = @[@"liga"];
+    
+    AKTestStyle *caption = [AKTestStyle new];
+    caption.fontSize = @12;
+    
+    // Merged features, fallback ancestors and provided values all need the getters.
+    AKTestStyle *heading = [body descendantInheritingKeyValueNotifications:NO];
+    heading.fontFeatures = @[@"smcp"];
+    
+    AKTestStyle *footnote = [AKTestStyle descendantOfAncestors:@[heading, caption]];
+    
+    AKTestStyle *quote = [heading descendantInheritingKeyValueNotifications:NO];
+    [quote setValueProvider:^id{
+        return @"Georgia";
+    } forPropertyName:fontName];
+    
+    NSArray *rows = @[body, heading, footnote, quote, caption];
+    AKAncestorResolvedValues *resolvedValues = [[AKAncestorResolvedValues alloc] initWithAncestors:rows propertyNames:nil];
+    
+    XCTAssertEqualObjects([resolvedValues valueForPropertyName:fontFeatures atIndex:1], (@[@"liga", @"smcp"]));
+    XCTAssertEqualObjects([resolvedValues valueForPropertyName:NSStringFromSelector(@selector(fontSize)) atIndex:2], @12);
+    XCTAssertEqualObjects([resolvedValues valueForPropertyName:fontName atIndex:3], @"Georgia");
+    [self assertResolvedValues:resolvedValues matchGettersOfAncestors:rows];
+}
+
+- (void)testInvalidArguments
+{
+    AKAncestorResolvedValues *resolvedValues = [[AKAncestorResolvedValues alloc] initWithAncestors:@[] propertyNames:@[@"lastName"]];
+    XCTAssertEqual(resolvedValues.count, (NSUInteger)0);
+    
+    XCTAssertThrowsSpecificNamed([[AKAncestorResolvedValues alloc] initWithAncestors:@[[AKTestPerson new]] propertyNames:@[@"fontName"]], NSException, AKAncestorUnknownPropertyException);
+    XCTAssertThrowsSpecificNamed([[AKAncestorResolvedValues alloc] initWithAncestors:@[[NSObject new]] propertyNames:nil], NSException, NSInvalidArgumentException);
+}
+
+@end
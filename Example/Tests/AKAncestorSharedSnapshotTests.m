@@ -0,0 +1,163 @@
+//
+//  AKAncestorSharedSnapshotTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorSharedSnapshotTests : XCTestCase
+
+@property (copy, nonatomic) NSString *segmentName;
+
+@end
+
+@implementation AKAncestorSharedSnapshotTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    // Segment names are short on some platforms, and have to be unique across concurrently running test processes.
+    self.segmentName = [NSString stringWithFormat:@"ak-%d-%u", getpid(), arc4random()];
+}
+
+- (void)tearDown
+{
+    [AKAncestorSharedSnapshotPublisher removeSegmentNamed:self.segmentName error:NULL];
+    
+    [super tearDown];
+}
+
++ (NSDictionary *)familyWithLastName:(NSString *)lastName firstName:(NSString *)firstName
+{
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.firstName = @"Arthur";
+    arthur.lastName = lastName;
+    
+    AKTestPerson *ron = [arthur descendantInheritingKeyValueNotifications:NO];
+    ron.firstName = firstName;
+    
+    return @{@"arthur": arthur, @"ron": ron};
+}
+
+- (void)testPublishingAndReading
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    NSError *error;
+    AKAncestorSharedSnapshotPublisher *publisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:self.segmentName capacity:4096 error:&error];
+    XCTAssertNotNil(publisher, @"%@", error);
+    
+    // A separate mapping of the segment sees exactly what a reader in another process would.
+    AKAncestorSharedSnapshot *reader = [[AKAncestorSharedSnapshot alloc] initWithName:self.segmentName error:&error];
+    XCTAssertNotNil(reader, @"%@", error);
+    XCTAssertEqual(reader.generation, (uint64_t)0);
+    XCTAssertEqualObjects(reader.names, @[]);
+    XCTAssertNil([reader valueForPropertyName:lastName ofAncestorNamed:@"ron"]);
+    XCTAssertNil([reader currentSnapshot]);
+    
+    XCTAssertTrue([publisher publishAncestorsByName:[[self class] familyWithLastName:@"Weasley" firstName:@"Ron"] error:&error], @"%@", error);
+    XCTAssertEqual(reader.generation, (uint64_t)1);
+    XCTAssertEqualObjects(reader.names, (@[@"arthur", @"ron"]));
+    XCTAssertEqualObjects([reader valueForPropertyName:lastName ofAncestorNamed:@"ron"], @"Weasley");
+    XCTAssertEqualObjects([reader valuesForPropertyNames:@[firstName, lastName] ofAncestorNamed:@"ron"], (@{firstName: @"Ron", lastName: @"Weasley"}));
+    XCTAssertNil([reader valueForPropertyName:lastName ofAncestorNamed:@"ginny"]);
+    XCTAssertThrowsSpecificNamed([reader valueForPropertyName:@"fontName" ofAncestorNamed:@"ron"], NSException, AKAncestorUnknownPropertyException);
+    
+    // Publications alternate between the two slots, so the third one overwrites the first.
+    XCTAssertTrue([publisher publishAncestorsByName:[[self class] familyWithLastName:@"Prewett" firstName:@"Fabian"] error:&error], @"%@", error);
+    XCTAssertTrue([publisher publishAncestorsByName:[[self class] familyWithLastName:@"Granger" firstName:@"Hugo"] error:&error], @"%@", error);
+    XCTAssertEqual(publisher.generation, (uint64_t)3);
+    XCTAssertEqual(reader.generation, (uint64_t)3);
+    XCTAssertEqualObjects([reader valuesForPropertyNames:@[firstName, lastName] ofAncestorNamed:@"ron"], (@{firstName: @"Hugo", lastName: @"Granger"}));
+    
+    AKTestPerson *ron = [[reader currentSnapshot] ancestorNamed:@"ron"];
+    XCTAssertEqualObjects(ron.lastName, @"Granger");
+    XCTAssertEqualObjects([ron.ancestor firstName], @"Arthur");
+    
+    // A restarted publisher continues the segment's generations.
+    AKAncestorSharedSnapshotPublisher *restartedPublisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:self.segmentName capacity:4096 error:&error];
+    XCTAssertEqual(restartedPublisher.generation, (uint64_t)3);
+}
+
+- (void)testErrors
+{
+    NSError *error;
+    XCTAssertNil([[AKAncestorSharedSnapshot alloc] initWithName:self.segmentName error:&error]);
+    XCTAssertEqualObjects(error.domain, AKAncestorSnapshotErrorDomain);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorSharedMemory);
+    
+    AKAncestorSharedSnapshotPublisher *publisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:self.segmentName capacity:64 error:&error];
+    XCTAssertNotNil(publisher, @"%@", error);
+    
+    error = nil;
+    XCTAssertFalse([publisher publishAncestorsByName:[[self class] familyWithLastName:@"Weasley" firstName:@"Ron"] error:&error]);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorCapacityExceeded);
+    XCTAssertEqual(publisher.generation, (uint64_t)0);
+    
+    error = nil;
+    XCTAssertNil([[AKAncestorSharedSnapshotPublisher alloc] initWithName:self.segmentName capacity:4096 error:&error]);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorCapacityExceeded);
+}
+
+- (void)testReadersSeeWholePublications
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKAncestorSharedSnapshotPublisher *publisher = [[AKAncestorSharedSnapshotPublisher alloc] initWithName:self.segmentName capacity:4096 error:NULL];
+    [publisher publishAncestorsByName:[[self class] familyWithLastName:@"Family 0" firstName:@"Child 0"] error:NULL];
+    
+    AKAncestorSharedSnapshot *reader = [[AKAncestorSharedSnapshot alloc] initWithName:self.segmentName error:NULL];
+    
+    __block volatile BOOL isPublishing = YES;
+    __block NSUInteger inconsistentReads = 0;
+    NSObject *countsLock = [NSObject new];
+    
+    dispatch_group_t readers = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    for (NSUInteger thread = 0; thread < 4; thread++)
+    {
+        dispatch_group_async(readers, queue, ^{
+            while (isPublishing)
+            {
+                @autoreleasepool {
+                    // Both values change with every publication, so a torn read would find them out of step.
+                    NSDictionary *values = [reader valuesForPropertyNames:@[firstName, lastName] ofAncestorNamed:@"ron"];
+                    NSString *family = [values[lastName] substringFromIndex:7];
+                    NSString *child = [values[firstName] substringFromIndex:6];
+                    
+                    if (![family isEqualToString:child])
+                    {
+                        @synchronized(countsLock) {
+                            inconsistentReads++;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    
+    for (NSUInteger publication = 1; publication <= 500; publication++)
+    {
+        @autoreleasepool {
+            NSString *family = [NSString stringWithFormat:@"Family %lu", (unsigned long)publication];
+            NSString *child = [NSString stringWithFormat:@"Child %lu", (unsigned long)publication];
+            [publisher publishAncestorsByName:[[self class] familyWithLastName:family firstName:child] error:NULL];
+        }
+    }
+    
+    isPublishing = NO;
+    dispatch_group_wait(readers, DISPATCH_TIME_FOREVER);
+    
+    XCTAssertEqual(inconsistentReads, (NSUInteger)0);
+    XCTAssertEqual(reader.generation, (uint64_t)501);
+}
+
+@end
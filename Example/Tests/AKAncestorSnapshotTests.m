@@ -0,0 +1,227 @@
+//
+//  AKAncestorSnapshotTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorSnapshotTests : XCTestCase
+
+@end
+
+@implementation AKAncestorSnapshotTests
+
++ (NSDictionary *)familyTreeWithCount:(NSUInteger)count
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSMutableDictionary *family = [NSMutableDictionary dictionaryWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        AKTestPerson *descendant = [root descendantInheritingKeyValueNotifications:NO];
+        descendant.firstName = [NSString stringWithFormat:@"Weasley %lu", (unsigned long)i];
+        family[descendant.firstName] = descendant;
+    }
+    
+    return family;
+}
+
++ (NSData *)propertyListDataWithFamilyTree:(NSDictionary *)family
+{
+    NSMutableDictionary *propertyList = [NSMutableDictionary dictionaryWithCapacity:family.count];
+    [family enumerateKeysAndObjectsUsingBlock:^(NSString *name, AKTestPerson *person, BOOL *stop) {
+        propertyList[name] = @{@"parent": @{@"lastName": [person.ancestor lastName]}, @"firstName": person.firstName};
+    }];
+    
+    return [NSPropertyListSerialization dataWithPropertyList:propertyList format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+}
+
+- (void)testRoundTrip
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.firstName = @"James";
+    personA.lastName = @"Potter";
+    
+    AKTestPerson *personB = [personA descendant];
+    personB.firstName = @"Harry";
+    
+    NSError *error;
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:@{@"james": personA, @"harry": personB} error:&error];
+    XCTAssertNotNil(data, @"%@", error);
+    
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:&error];
+    XCTAssertNotNil(snapshot, @"%@", error);
+    
+    XCTAssertEqual(snapshot.count, (NSUInteger)2);
+    XCTAssertEqualObjects(snapshot.names, (@[@"harry", @"james"]));
+    
+    AKTestPerson *harry = [snapshot ancestorNamed:@"harry"];
+    XCTAssertEqualObjects(harry.firstName, @"Harry");
+    XCTAssertEqualObjects(harry.lastName, @"Potter");
+    XCTAssertTrue(harry.inheritsKeyValueNotifications);
+    
+    XCTAssertEqual(harry.ancestor, [snapshot ancestorNamed:@"james"]);
+    XCTAssertEqual(harry, [snapshot ancestorNamed:@"harry"]);
+    XCTAssertNil([snapshot ancestorNamed:@"lily"]);
+}
+
+- (void)testSharedAncestorsAreStoredOnce
+{
+    NSDictionary *family = [[self class] familyTreeWithCount:10];
+    
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:family error:NULL];
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:NULL];
+    
+    XCTAssertEqual(snapshot.count, (NSUInteger)11);
+    XCTAssertEqual([[snapshot ancestorNamed:@"Weasley 1"] ancestor], [[snapshot ancestorNamed:@"Weasley 2"] ancestor]);
+    XCTAssertEqualObjects([[snapshot ancestorNamed:@"Weasley 9"] lastName], @"Weasley");
+}
+
+- (void)testIgnoredPropertiesAndOptions
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.lastName = @"Ciccone";
+    
+    AKTestPersonSubclass *personB = [AKTestPersonSubclass descendantOf:personA];
+    personB.firstName = @"Madonna";
+    personB.birthDate = [NSDate dateWithTimeIntervalSince1970:0.0];
+    [personB stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    AKTestPerson *personC = [personA descendantInheritingKeyValueNotifications:NO];
+    
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:@{@"madonna": personB, @"other": personC} error:NULL];
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:NULL];
+    
+    AKTestPersonSubclass *madonna = [snapshot ancestorNamed:@"madonna"];
+    XCTAssertTrue([madonna isKindOfClass:[AKTestPersonSubclass class]]);
+    XCTAssertEqualObjects(madonna.firstName, @"MADONNA");
+    XCTAssertEqualObjects(madonna.birthDate, [NSDate dateWithTimeIntervalSince1970:0.0]);
+    XCTAssertNil(madonna.lastName);
+    
+    XCTAssertFalse([[snapshot ancestorNamed:@"other"] inheritsKeyValueNotifications]);
+}
+
+- (void)testResolvingValuesWithoutInstances
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSString *birthDate = NSStringFromSelector(@selector(birthDate));
+    
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.lastName = @"Ciccone";
+    
+    AKTestPersonSubclass *personB = [AKTestPersonSubclass descendantOf:personA];
+    personB.firstName = @"Madonna";
+    personB.birthDate = [NSDate dateWithTimeIntervalSince1970:0.0];
+    [personB stopInheritingValuesForPropertyName:lastName];
+    
+    AKTestPerson *personC = [personA descendantInheritingKeyValueNotifications:NO];
+    
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:@{@"madonna": personB, @"other": personC} error:NULL];
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:NULL];
+    
+    NSUInteger madonna = [snapshot indexOfAncestorNamed:@"madonna"];
+    NSUInteger other = [snapshot indexOfAncestorNamed:@"other"];
+    XCTAssertEqual([snapshot indexOfAncestorNamed:@"lily"], (NSUInteger)NSNotFound);
+    
+    // Values come straight from the records, so the subclass doesn't get to transform them.
+    XCTAssertEqualObjects([snapshot valueForPropertyName:firstName ofAncestorAtIndex:madonna], @"Madonna");
+    XCTAssertEqualObjects([snapshot valueForPropertyName:birthDate ofAncestorAtIndex:madonna], [NSDate dateWithTimeIntervalSince1970:0.0]);
+    XCTAssertNil([snapshot valueForPropertyName:lastName ofAncestorAtIndex:madonna]);
+    XCTAssertEqualObjects([snapshot valueForPropertyName:lastName ofAncestorAtIndex:other], @"Ciccone");
+    XCTAssertNil([snapshot valueForPropertyName:firstName ofAncestorAtIndex:other]);
+    
+    XCTAssertThrowsSpecificNamed([snapshot valueForPropertyName:birthDate ofAncestorAtIndex:other], NSException, AKAncestorUnknownPropertyException);
+    XCTAssertThrowsSpecificNamed([snapshot valueForPropertyName:lastName ofAncestorAtIndex:snapshot.count], NSException, NSRangeException);
+}
+
+- (void)testMappedFile
+{
+    NSDictionary *family = [[self class] familyTreeWithCount:100];
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:family error:NULL];
+    
+    NSURL *url = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    XCTAssertTrue([data writeToURL:url atomically:YES]);
+    
+    NSError *error;
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithContentsOfURL:url error:&error];
+    XCTAssertNotNil(snapshot, @"%@", error);
+    XCTAssertEqualObjects([[snapshot ancestorNamed:@"Weasley 42"] firstName], @"Weasley 42");
+    
+    [[NSFileManager defaultManager] removeItemAtURL:url error:NULL];
+}
+
+- (void)testCorruptData
+{
+    NSDictionary *family = [[self class] familyTreeWithCount:10];
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:family error:NULL];
+    
+    NSError *error;
+    XCTAssertNil([[AKAncestorSnapshot alloc] initWithData:[data subdataWithRange:NSMakeRange(0, data.length / 2)] error:&error]);
+    XCTAssertEqualObjects(error.domain, AKAncestorSnapshotErrorDomain);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorCorruptData);
+    
+    error = nil;
+    XCTAssertNil([[AKAncestorSnapshot alloc] initWithData:[@"not a snapshot" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorCorruptData);
+}
+
+- (void)testUnsupportedValue
+{
+    AKTestPersonSubclass *person = [AKTestPersonSubclass new];
+    person.birthDate = (id)[NSObject new];
+    
+    NSError *error;
+    XCTAssertNil([AKAncestorSnapshot snapshotDataWithAncestorsByName:@{@"person": person} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorUnsupportedValue);
+    
+    // Archived values are decoded securely, so properties declared as id can't store them.
+    AKTestTaggedItem *item = [AKTestTaggedItem new];
+    item.tag = [NSDate dateWithTimeIntervalSince1970:0.0];
+    
+    error = nil;
+    XCTAssertNil([AKAncestorSnapshot snapshotDataWithAncestorsByName:@{@"item": item} error:&error]);
+    XCTAssertEqual(error.code, AKAncestorSnapshotErrorUnsupportedValue);
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testLoadSnapshot
+{
+    NSDictionary *family = [[self class] familyTreeWithCount:10000];
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:family error:NULL];
+    
+    [self measureBlock:^{
+        AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:NULL];
+        [snapshot ancestorNamed:@"Weasley 42"];
+    }];
+}
+
+- (void)testLoadPropertyList
+{
+    NSDictionary *family = [[self class] familyTreeWithCount:10000];
+    NSData *data = [[self class] propertyListDataWithFamilyTree:family];
+    
+    [self measureBlock:^{
+        NSDictionary *propertyList = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL];
+        
+        NSMutableDictionary *decodedFamily = [NSMutableDictionary dictionaryWithCapacity:propertyList.count];
+        [propertyList enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSDictionary *values, BOOL *stop) {
+            AKTestPerson *parent = [AKTestPerson new];
+            parent.lastName = values[@"parent"][@"lastName"];
+            
+            AKTestPerson *person = [parent descendantInheritingKeyValueNotifications:NO];
+            person.firstName = values[@"firstName"];
+            decodedFamily[name] = person;
+        }];
+    }];
+}
+
+@end
@@ -0,0 +1,154 @@
+//
+//  AKAncestorStatisticsTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorStatisticsTests : XCTestCase
+
+@end
+
+@implementation AKAncestorStatisticsTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    [AKAncestorStatistics resetStatistics];
+    [AKAncestorStatistics setEnabled:YES];
+}
+
+- (void)tearDown
+{
+    [AKAncestorStatistics setEnabled:NO];
+    [AKAncestorStatistics resetStatistics];
+    
+    [super tearDown];
+}
+
+- (void)testDisabledByDefault
+{
+    [AKAncestorStatistics setEnabled:NO];
+    
+    AKTestPerson *person = [[AKTestPerson new] descendant];
+    [person lastName];
+    
+    XCTAssertFalse([AKAncestorStatistics isEnabled]);
+    XCTAssertEqual([[AKAncestorStatistics currentStatistics] countOfEvent:AKAncestorStatisticsEventGetterCall], (uint64_t)0);
+}
+
+- (void)testGetterCallsAndHops
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    AKTestPerson *person = [[root descendantInheritingKeyValueNotifications:NO] descendantInheritingKeyValueNotifications:NO];
+    [person lastName];
+    
+    AKAncestorStatistics *statistics = [AKAncestorStatistics currentStatistics];
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventGetterCall forClass:[AKTestPerson class] propertyName:lastName], (uint64_t)3);
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventAncestorHop forClass:[AKTestPerson class] propertyName:lastName], (uint64_t)2);
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventDescendantCreation forClass:[AKTestPerson class]], (uint64_t)2);
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventGetterCall forClass:[AKTestStyle class]], (uint64_t)0);
+}
+
+- (void)testCacheHitsAndMisses
+{
+    AKTestStyle *style = [AKTestStyle new];
+    style.fontName = @"Helvetica";
+    
+    [style displayName];
+    [style displayName];
+    
+    AKAncestorStatistics *statistics = [AKAncestorStatistics currentStatistics];
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventCacheMiss forClass:[AKTestStyle class] propertyName:@"displayName"], (uint64_t)1);
+    XCTAssertEqual([statistics countOfEvent:AKAncestorStatisticsEventCacheHit forClass:[AKTestStyle class] propertyName:@"displayName"], (uint64_t)1);
+}
+
+- (void)testKeyValueForwards
+{
+    AKTestPerson *root = [AKTestPerson new];
+    AKTestPerson *person = [root descendant];
+    
+    [self keyValueObservingExpectationForObject:person keyPath:NSStringFromSelector(@selector(lastName)) expectedValue:@"Weasley"];
+    root.lastName = @"Weasley";
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    XCTAssertEqual([[AKAncestorStatistics currentStatistics] countOfEvent:AKAncestorStatisticsEventKeyValueForward], (uint64_t)1);
+}
+
+- (void)testCountsFromAllThreads
+{
+    AKTestPerson *person = [AKTestPerson new];
+    
+    dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        for (NSUInteger i = 0; i < 100; i++)
+        {
+            [person firstName];
+        }
+    });
+    
+    XCTAssertEqual([[AKAncestorStatistics currentStatistics] countOfEvent:AKAncestorStatisticsEventGetterCall forClass:[AKTestPerson class] propertyName:NSStringFromSelector(@selector(firstName))], (uint64_t)800);
+    
+    [AKAncestorStatistics resetStatistics];
+    XCTAssertEqual([[AKAncestorStatistics currentStatistics] countOfEvent:AKAncestorStatisticsEventGetterCall], (uint64_t)0);
+}
+
+- (void)testPrometheusText
+{
+    AKTestPerson *person = [[AKTestPerson new] descendantInheritingKeyValueNotifications:NO];
+    [person lastName];
+    
+    NSString *text = [[AKAncestorStatistics currentStatistics] prometheusText];
+    XCTAssertTrue([text containsString:@"# TYPE ancestorkit_getter_calls_total counter\n"]);
+    XCTAssertTrue([text containsString:@"ancestorkit_getter_calls_total{class=\"AKTestPerson\",property=\"lastName\"} 2\n"]);
+    XCTAssertTrue([text containsString:@"ancestorkit_descendant_creations_total{class=\"AKTestPerson\"} 1\n"]);
+    
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSError *error;
+    XCTAssertTrue([[AKAncestorStatistics currentStatistics] writePrometheusTextToURL:fileURL error:&error], @"%@", error);
+    XCTAssertEqualObjects([NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:NULL], text);
+    
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testDisabledGetters
+{
+    [AKAncestorStatistics setEnabled:NO];
+    
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+- (void)testEnabledGetters
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,342 @@
+//
+//  AKAncestorTableTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorTableTests : XCTestCase
+
+@property (strong, nonatomic) AKAncestorTable *table;
+
+@end
+
+@implementation AKAncestorTableTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.table = [[AKAncestorTable alloc] initWithAncestorClass:[AKTestPerson class]];
+}
+
+- (void)tearDown
+{
+    self.table = nil;
+    
+    [super tearDown];
+}
+
+- (void)testColumns
+{
+    XCTAssertEqualObjects(self.table.ancestorClass, [AKTestPerson class]);
+    XCTAssertEqualObjects(self.table.propertyNames, (@[@"firstName", @"lastName"]));
+    XCTAssertEqual(self.table.count, (NSUInteger)0);
+    
+    XCTAssertThrowsSpecificNamed([[AKAncestorTable alloc] initWithAncestorClass:[NSObject class]], NSException, NSInvalidArgumentException);
+}
+
+- (void)testInheritingValues
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    NSUInteger ron = [self.table addInstanceWithAncestorIndex:arthur];
+    NSUInteger hugo = [self.table addInstanceWithAncestorIndex:ron];
+    
+    XCTAssertEqual([self.table ancestorIndexAtIndex:arthur], (NSUInteger)NSNotFound);
+    XCTAssertEqual([self.table ancestorIndexAtIndex:hugo], ron);
+    XCTAssertNil([self.table valueForPropertyName:lastName atIndex:hugo]);
+    
+    [self.table setValue:@"Weasley" forPropertyName:lastName atIndex:arthur];
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:hugo], @"Weasley");
+    XCTAssertNil([self.table localValueForPropertyName:lastName atIndex:hugo]);
+    
+    [self.table setValue:@"Granger-Weasley" forPropertyName:lastName atIndex:ron];
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:arthur], @"Weasley");
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:hugo], @"Granger-Weasley");
+    
+    [self.table setValue:nil forPropertyName:lastName atIndex:ron];
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:hugo], @"Weasley");
+}
+
+- (void)testCopyingValues
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSUInteger ron = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    
+    NSMutableString *name = [NSMutableString stringWithString:@"Ron"];
+    [self.table setValue:name forPropertyName:firstName atIndex:ron];
+    [name appendString:@"ald"];
+    
+    XCTAssertEqualObjects([self.table valueForPropertyName:firstName atIndex:ron], @"Ron");
+}
+
+- (void)testStoppingInheritance
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    NSUInteger ron = [self.table addInstanceWithAncestorIndex:arthur];
+    NSUInteger hugo = [self.table addInstanceWithAncestorIndex:ron];
+    [self.table setValue:@"Weasley" forPropertyName:lastName atIndex:arthur];
+    
+    [self.table stopInheritingValuesForPropertyName:lastName atIndex:ron];
+    XCTAssertNil([self.table valueForPropertyName:lastName atIndex:ron]);
+    XCTAssertNil([self.table valueForPropertyName:lastName atIndex:hugo]);
+    
+    [self.table setValue:@"Granger-Weasley" forPropertyName:lastName atIndex:ron];
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:hugo], @"Granger-Weasley");
+    
+    [self.table setValue:nil forPropertyName:lastName atIndex:ron];
+    [self.table resumeInheritingValuesForPropertyName:lastName atIndex:ron];
+    XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:hugo], @"Weasley");
+}
+
+- (void)testInvalidArguments
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    
+    XCTAssertThrowsSpecificNamed([self.table addInstanceWithAncestorIndex:arthur + 1], NSException, NSRangeException);
+    XCTAssertThrowsSpecificNamed([self.table valueForPropertyName:lastName atIndex:arthur + 1], NSException, NSRangeException);
+    XCTAssertThrowsSpecificNamed([self.table valueForPropertyName:@"fullName" atIndex:arthur], NSException, AKAncestorUnknownPropertyException);
+    XCTAssertThrowsSpecificNamed([self.table stopInheritingValuesForPropertyName:@"nickname" atIndex:arthur], NSException, AKAncestorUnknownPropertyException);
+}
+
+- (void)testBulkResolutionMatchesObjects
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSArray *names = @[@"Weasley", @"Prewett", @"Granger"];
+    
+    // A table and a tree of objects are built alike, with enough instances to grow the table a few times.
+    NSMutableArray *people = [NSMutableArray array];
+    for (NSUInteger index = 0; index < 1000; index++)
+    {
+        NSUInteger ancestorIndex = (index > 0) ? (index - 1) / 3 : NSNotFound;
+        XCTAssertEqual([self.table addInstanceWithAncestorIndex:ancestorIndex], index);
+        
+        AKTestPerson *person = (ancestorIndex != NSNotFound) ? [people[ancestorIndex] descendantInheritingKeyValueNotifications:NO] : [AKTestPerson new];
+        [people addObject:person];
+        
+        if (index % 7 == 0)
+        {
+            NSString *name = names[index % names.count];
+            [self.table setValue:name forPropertyName:lastName atIndex:index];
+            person.lastName = name;
+        }
+        else if (index % 11 == 0)
+        {
+            [self.table stopInheritingValuesForPropertyName:lastName atIndex:index];
+            [person stopInheritingValuesForPropertyName:lastName];
+        }
+    }
+    
+    __unsafe_unretained id values[1000];
+    [self.table getValues:values count:1000 forPropertyName:lastName];
+    
+    NSArray *valueArray = [self.table valuesForPropertyName:lastName];
+    XCTAssertEqual(valueArray.count, (NSUInteger)1000);
+    
+    for (NSUInteger index = 0; index < 1000; index++)
+    {
+        id expectedValue = [people[index] lastName];
+        XCTAssertEqualObjects(values[index], expectedValue, @"Index %lu", (unsigned long)index);
+        XCTAssertEqualObjects([self.table valueForPropertyName:lastName atIndex:index], expectedValue, @"Index %lu", (unsigned long)index);
+        XCTAssertEqualObjects(valueArray[index], expectedValue ?: [NSNull null], @"Index %lu", (unsigned long)index);
+    }
+    
+    XCTAssertThrowsSpecificNamed([self.table getValues:values count:1001 forPropertyName:lastName], NSException, NSRangeException);
+}
+
+- (void)testFacades
+{
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    NSUInteger ron = [self.table addInstanceWithAncestorIndex:arthur];
+    
+    AKTestPerson *arthurFacade = [self.table ancestorAtIndex:arthur];
+    AKTestPerson *ronFacade = [self.table ancestorAtIndex:ron];
+    XCTAssertTrue([ronFacade isKindOfClass:[AKTestPerson class]]);
+    XCTAssertEqualObjects([ronFacade class], [AKTestPerson class]);
+    
+    arthurFacade.lastName = @"Weasley";
+    ronFacade.firstName = @"Ron";
+    XCTAssertEqualObjects([self.table localValueForPropertyName:NSStringFromSelector(@selector(lastName)) atIndex:arthur], @"Weasley");
+    XCTAssertEqualObjects(ronFacade.lastName, @"Weasley");
+    XCTAssertEqualObjects([ronFacade fullName], @"Ron Weasley");
+    
+    XCTAssertEqualObjects([ronFacade.ancestor lastName], @"Weasley");
+    XCTAssertNil(arthurFacade.ancestor);
+    
+    [ronFacade stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    XCTAssertNil(ronFacade.lastName);
+    XCTAssertNil([self.table valueForPropertyName:NSStringFromSelector(@selector(lastName)) atIndex:ron]);
+}
+
+- (void)testFacadesKeepTheirTable
+{
+    __weak AKAncestorTable *weakTable = self.table;
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    [self.table setValue:@"Weasley" forPropertyName:NSStringFromSelector(@selector(lastName)) atIndex:arthur];
+    
+    AKTestPerson *facade;
+    @autoreleasepool {
+        facade = [self.table ancestorAtIndex:arthur];
+        self.table = nil;
+    }
+    
+    XCTAssertNotNil(weakTable);
+    XCTAssertEqualObjects(facade.lastName, @"Weasley");
+    
+    @autoreleasepool {
+        facade = nil;
+    }
+    
+    XCTAssertNil(weakTable);
+}
+
+
+#pragma mark - Queries
+
+- (void)testOverridingQueries
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    // Enough instances to span several vectors of words, plus a partial word.
+    NSMutableIndexSet *firstNameIndexes = [NSMutableIndexSet indexSet];
+    NSMutableIndexSet *lastNameIndexes = [NSMutableIndexSet indexSet];
+    for (NSUInteger index = 0; index < 1100; index++)
+    {
+        [self.table addInstanceWithAncestorIndex:(index > 0) ? index - 1 : NSNotFound];
+        
+        if (index % 3 == 0 || (index >= 256 && index < 512))
+        {
+            [self.table setValue:@"Ron" forPropertyName:firstName atIndex:index];
+            [firstNameIndexes addIndex:index];
+        }
+        
+        if (index % 5 == 0)
+        {
+            [self.table setValue:@"Weasley" forPropertyName:lastName atIndex:index];
+            [lastNameIndexes addIndex:index];
+        }
+    }
+    
+    NSMutableIndexSet *anyIndexes = [firstNameIndexes mutableCopy];
+    [anyIndexes addIndexes:lastNameIndexes];
+    
+    NSMutableIndexSet *allIndexes = [NSMutableIndexSet indexSet];
+    [firstNameIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        if ([lastNameIndexes containsIndex:index])
+        {
+            [allIndexes addIndex:index];
+        }
+    }];
+    
+    NSArray *propertyNames = @[firstName, lastName];
+    XCTAssertEqualObjects([self.table indexesOverridingPropertyNames:@[firstName] match:AKAncestorTableMatchAny], firstNameIndexes);
+    XCTAssertEqualObjects([self.table indexesOverridingPropertyNames:propertyNames match:AKAncestorTableMatchAny], anyIndexes);
+    XCTAssertEqualObjects([self.table indexesOverridingPropertyNames:propertyNames match:AKAncestorTableMatchAll], allIndexes);
+    XCTAssertEqual([self.table countOfIndexesOverridingPropertyNames:propertyNames match:AKAncestorTableMatchAny], anyIndexes.count);
+    XCTAssertEqual([self.table countOfIndexesOverridingPropertyNames:propertyNames match:AKAncestorTableMatchAll], allIndexes.count);
+    
+    XCTAssertEqual([self.table indexesOverridingPropertyNames:@[] match:AKAncestorTableMatchAny].count, (NSUInteger)0);
+    XCTAssertEqualObjects([self.table indexesOverridingPropertyNames:@[] match:AKAncestorTableMatchAll], [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 1100)]);
+    XCTAssertThrowsSpecificNamed([self.table indexesOverridingPropertyNames:@[@"nickname"] match:AKAncestorTableMatchAny], NSException, AKAncestorUnknownPropertyException);
+}
+
+- (void)testIgnoringQueries
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    NSUInteger arthur = [self.table addInstanceWithAncestorIndex:NSNotFound];
+    NSUInteger ron = [self.table addInstanceWithAncestorIndex:arthur];
+    [self.table addInstanceWithAncestorIndex:ron];
+    [self.table stopInheritingValuesForPropertyName:lastName atIndex:ron];
+    
+    XCTAssertEqualObjects([self.table indexesIgnoringPropertyNames:@[lastName] match:AKAncestorTableMatchAll], [NSIndexSet indexSetWithIndex:ron]);
+    XCTAssertEqual([self.table indexesOverridingPropertyNames:@[lastName] match:AKAncestorTableMatchAny].count, (NSUInteger)0);
+}
+
+- (void)testInheritingQueriesMatchObjects
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSArray *propertyNames = @[firstName, lastName];
+    
+    // Two roots, so instances outside the queried subtree are never reported.
+    NSMutableArray *people = [NSMutableArray array];
+    for (NSUInteger index = 0; index < 700; index++)
+    {
+        NSUInteger ancestorIndex = (index > 1) ? (index - 2) / 3 : NSNotFound;
+        [self.table addInstanceWithAncestorIndex:ancestorIndex];
+        
+        AKTestPerson *person = (ancestorIndex != NSNotFound) ? [people[ancestorIndex] descendantInheritingKeyValueNotifications:NO] : [AKTestPerson new];
+        [people addObject:person];
+        
+        if (index % 13 == 0)
+        {
+            [self.table setValue:@"Ron" forPropertyName:firstName atIndex:index];
+            person.firstName = @"Ron";
+        }
+        
+        if (index % 17 == 0)
+        {
+            [self.table stopInheritingValuesForPropertyName:lastName atIndex:index];
+            [person stopInheritingValuesForPropertyName:lastName];
+        }
+    }
+    
+    NSArray *queriedIndexes = @[@0, @1, @5, @40];
+    for (NSNumber *queriedIndex in queriedIndexes)
+    {
+        // The queried instances have their own values, so the objects can report which instance provides each value.
+        for (NSString *propertyName in propertyNames)
+        {
+            [self.table setValue:@"Weasley" forPropertyName:propertyName atIndex:[queriedIndex unsignedIntegerValue]];
+            [people[[queriedIndex unsignedIntegerValue]] setValue:@"Weasley" forKey:propertyName];
+        }
+    }
+    
+    for (NSNumber *queriedIndex in queriedIndexes)
+    {
+        AKTestPerson *queriedPerson = people[[queriedIndex unsignedIntegerValue]];
+        
+        // The objects are asked one by one which of their values come from the queried instance.
+        NSMutableIndexSet *anyIndexes = [NSMutableIndexSet indexSet];
+        NSMutableIndexSet *allIndexes = [NSMutableIndexSet indexSet];
+        [people enumerateObjectsUsingBlock:^(AKTestPerson *person, NSUInteger index, BOOL *stop) {
+            if (person == queriedPerson)
+            {
+                return;
+            }
+            
+            NSUInteger inheritedCount = 0;
+            for (NSString *propertyName in propertyNames)
+            {
+                inheritedCount += ([person ancestorProvidingValueForPropertyName:propertyName] == queriedPerson) ? 1 : 0;
+            }
+            
+            if (inheritedCount > 0)
+            {
+                [anyIndexes addIndex:index];
+            }
+            
+            if (inheritedCount == propertyNames.count)
+            {
+                [allIndexes addIndex:index];
+            }
+        }];
+        
+        XCTAssertEqualObjects([self.table indexesInheritingPropertyNames:propertyNames fromIndex:[queriedIndex unsignedIntegerValue] match:AKAncestorTableMatchAny], anyIndexes, @"Index %@", queriedIndex);
+        XCTAssertEqualObjects([self.table indexesInheritingPropertyNames:propertyNames fromIndex:[queriedIndex unsignedIntegerValue] match:AKAncestorTableMatchAll], allIndexes, @"Index %@", queriedIndex);
+    }
+}
+
+@end
@@ -8,6 +8,7 @@
 
 #import <AncestorKit/AncestorKit.h>
 #import <XCTest/XCTest.h>
+#import <objc/runtime.h>
 #import "AKTestFixtures.h"
 
 @interface AKAncestorTests : XCTestCase
@@ -27,6 +28,44 @@
     return dateFormatter;
 }
 
++ (id)secureRoundTripObject:(id)object ofClass:(Class)objectClass
+{
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:object];
+    
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    unarchiver.requiresSecureCoding = YES;
+    id decodedObject = [unarchiver decodeObjectOfClass:objectClass forKey:NSKeyedArchiveRootObjectKey];
+    [unarchiver finishDecoding];
+    
+    return decodedObject;
+}
+
++ (NSArray *)flattenedValuesOfDescendants:(NSArray *)descendants
+{
+    NSArray *propertyNames = @[NSStringFromSelector(@selector(firstName)), NSStringFromSelector(@selector(lastName))];
+    
+    NSMutableArray *flattenedDescendants = [NSMutableArray arrayWithCapacity:descendants.count];
+    for (AKTestPerson *descendant in descendants)
+    {
+        [flattenedDescendants addObject:[descendant dictionaryWithValuesForKeys:propertyNames]];
+    }
+    
+    return flattenedDescendants;
+}
+
++ (NSArray *)familyTreeWithRoot:(AKTestPerson *)root count:(NSUInteger)count
+{
+    NSMutableArray *descendants = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        AKTestPerson *descendant = [root descendantInheritingKeyValueNotifications:NO];
+        descendant.firstName = [NSString stringWithFormat:@"Weasley %lu", (unsigned long)i];
+        [descendants addObject:descendant];
+    }
+    
+    return descendants;
+}
+
 
 #pragma mark - Creating ancestors
 
@@ -374,8 +413,999 @@
 }
 
 
+#pragma mark - Runtime subclasses
+
+- (void)testRegisterRuntimeSubclass
+{
+    // Registered classes can't be disposed of while AKAncestor caches their info, so each run gets a name no other run or test process has used.
+    static NSUInteger runtimeClassCount = 0;
+    NSString *className = [NSString stringWithFormat:@"AKTestRuntimePerson_%d_%lu", [[NSProcessInfo processInfo] processIdentifier], (unsigned long)runtimeClassCount++];
+    
+    Class runtimeClass = objc_allocateClassPair([AKTestPerson class], [className UTF8String], 0);
+    XCTAssertNotNil(runtimeClass);
+    
+    SEL getter = NSSelectorFromString(@"nickname");
+    const void *key = (const void *)getter;
+    class_addMethod(runtimeClass, getter, imp_implementationWithBlock(^id (id person) {
+        return objc_getAssociatedObject(person, key);
+    }), "@@:");
+    class_addMethod(runtimeClass, NSSelectorFromString(@"setNickname:"), imp_implementationWithBlock(^(id person, id nickname) {
+        objc_setAssociatedObject(person, key, nickname, OBJC_ASSOCIATION_COPY_NONATOMIC);
+    }), "v@:@");
+    
+    objc_property_attribute_t attributes[] = {{"T", "@\"NSString\""}, {"C", ""}, {"N", ""}};
+    XCTAssertTrue(class_addProperty(runtimeClass, "nickname", attributes, 3));
+    
+    objc_registerClassPair(runtimeClass);
+    [AKAncestor registerRuntimeSubclass:runtimeClass];
+    [AKAncestor registerRuntimeSubclass:runtimeClass];
+    
+    AKTestPerson *personA = [runtimeClass new];
+    personA.lastName = @"Weasley";
+    [personA setValue:@"Ron" forKey:@"nickname"];
+    
+    AKTestPerson *personB = [personA descendant];
+    XCTAssertEqualObjects(personB.lastName, @"Weasley");
+    XCTAssertEqualObjects([personB valueForKey:@"nickname"], @"Ron");
+    
+    [personB setValue:@"Ronald" forKey:@"nickname"];
+    XCTAssertEqualObjects([personA valueForKey:@"nickname"], @"Ron");
+    XCTAssertEqualObjects([personB valueForKey:@"nickname"], @"Ronald");
+}
+
+- (void)testRegisterRuntimeSubclassRejectsOtherClasses
+{
+    XCTAssertThrowsSpecificNamed([AKAncestor registerRuntimeSubclass:[NSObject class]], NSException, NSInvalidArgumentException);
+    XCTAssertThrowsSpecificNamed([AKAncestor registerRuntimeSubclass:[AKAncestor class]], NSException, NSInvalidArgumentException);
+}
+
+#pragma mark - Fallback ancestors
+
+- (void)testFallbackAncestorsConsultedInOrder
+{
+    AKTestPerson *theme = [AKTestPerson new];
+    theme.lastName = @"Weasley";
+    
+    AKTestPerson *base = [AKTestPerson new];
+    base.firstName = @"Ginny";
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[[theme descendant], base]];
+    XCTAssertEqualObjects(person.ancestors, (@[person.ancestor, base]));
+    XCTAssertEqualObjects(person.fallbackAncestors, @[base]);
+    
+    XCTAssertEqualObjects(person.lastName, @"Weasley");
+    XCTAssertEqualObjects(person.firstName, @"Ginny");
+    XCTAssertEqual([person ancestorProvidingValueForPropertyName:NSStringFromSelector(@selector(lastName))], theme);
+    XCTAssertEqual([person ancestorProvidingValueForPropertyName:NSStringFromSelector(@selector(firstName))], base);
+    
+    theme.lastName = nil;
+    XCTAssertEqualObjects(person.lastName, @"Potter");
+    
+    theme.firstName = @"Ron";
+    XCTAssertEqualObjects(person.firstName, @"Ron");
+    
+    [person stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    XCTAssertNil(person.lastName);
+}
+
+- (void)testFallbackAncestorKVC
+{
+    AKTestPerson *theme = [AKTestPerson new];
+    AKTestPerson *base = [AKTestPerson new];
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[theme, base]];
+    XCTAssertTrue(person.inheritsKeyValueNotifications);
+    
+    [self keyValueObservingExpectationForObject:person keyPath:NSStringFromSelector(@selector(lastName)) expectedValue:@"Evans"];
+    
+    base.lastName = @"Evans";
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testFallbackAncestorChangesHiddenByEarlierAncestors
+{
+    AKTestPerson *theme = [AKTestPerson new];
+    theme.lastName = @"Weasley";
+    AKTestPerson *base = [AKTestPerson new];
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[theme, base]];
+    
+    __block NSUInteger notificationCount = 0;
+    [self keyValueObservingExpectationForObject:person keyPath:NSStringFromSelector(@selector(lastName)) handler:^BOOL(id observedObject, NSDictionary *change) {
+        notificationCount++;
+        return [[observedObject lastName] isEqualToString:@"Evans"];
+    }];
+    
+    base.lastName = @"Potter";
+    XCTAssertEqual(notificationCount, (NSUInteger)0);
+    
+    theme.lastName = @"Evans";
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testFallbackAncestorDescendants
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *theme = [AKTestPerson new];
+    AKTestPerson *base = [AKTestPerson new];
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[theme, base]];
+    AKTestPerson *child = [person descendant];
+    
+    XCTAssertEqualObjects([base descendants], (@[person, child]));
+    XCTAssertEqualObjects([base descendantsInheritingValueForPropertyName:lastName], (@[person, child]));
+    
+    theme.lastName = @"Weasley";
+    XCTAssertEqual([base descendantsInheritingValueForPropertyName:lastName].count, (NSUInteger)0);
+    XCTAssertEqualObjects([theme descendantsInheritingValueForPropertyName:lastName], (@[person, child]));
+    
+    child.lastName = @"Evans";
+    XCTAssertEqualObjects([base descendantsOverridingPropertyName:lastName], @[child]);
+}
+
+- (void)testArchivingPreservesFallbackAncestors
+{
+    AKTestPerson *theme = [AKTestPerson new];
+    AKTestPerson *base = [AKTestPerson new];
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[theme, base]];
+    AKTestPerson *decodedPerson = [[self class] secureRoundTripObject:person ofClass:[AKTestPerson class]];
+    
+    XCTAssertEqual(decodedPerson.fallbackAncestors.count, (NSUInteger)1);
+    XCTAssertEqualObjects(decodedPerson.lastName, @"Potter");
+}
+
+
+#pragma mark - Lazy values
+
+- (void)testValueProviderRunsOnFirstAccess
+{
+    AKTestPerson *root = [AKTestPerson new];
+    AKTestPerson *person = [[root descendant] descendant];
+    
+    __block NSUInteger providerCallCount = 0;
+    [root setValueProvider:^id{
+        providerCallCount++;
+        return @"Weasley";
+    } forPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    XCTAssertNil(person.firstName);
+    XCTAssertEqual(providerCallCount, (NSUInteger)0);
+    
+    XCTAssertEqualObjects(person.lastName, @"Weasley");
+    XCTAssertEqualObjects(root.lastName, @"Weasley");
+    XCTAssertEqual(providerCallCount, (NSUInteger)1);
+    XCTAssertEqual([person ancestorProvidingValueForPropertyName:NSStringFromSelector(@selector(lastName))], root);
+    
+    XCTAssertThrowsSpecificNamed([root setValueProvider:^id{ return nil; } forPropertyName:@"middleName"], NSException, AKAncestorUnknownPropertyException);
+}
+
+- (void)testValueProviderReturningNil
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    AKTestPerson *person = [root descendant];
+    
+    __block NSUInteger providerCallCount = 0;
+    [person setValueProvider:^id{
+        providerCallCount++;
+        return nil;
+    } forPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    XCTAssertEqualObjects(person.lastName, @"Weasley");
+    XCTAssertEqualObjects(person.lastName, @"Weasley");
+    XCTAssertEqual(providerCallCount, (NSUInteger)1);
+}
+
+- (void)testValueProviderOnFallbackAncestor
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *theme = [AKTestPerson new];
+    AKTestPerson *base = [AKTestPerson new];
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [AKTestPerson descendantOfAncestors:@[theme, base]];
+    XCTAssertEqualObjects(person.lastName, @"Potter");
+    
+    // The pending provider makes the first ancestor supply the value, even though the cached provenance had it coming from the fallback.
+    __block NSUInteger providerCallCount = 0;
+    [theme setValueProvider:^id{
+        providerCallCount++;
+        return @"Weasley";
+    } forPropertyName:lastName];
+    
+    XCTAssertEqual([person ancestorProvidingValueForPropertyName:lastName], theme);
+    XCTAssertEqual(providerCallCount, (NSUInteger)0);
+    XCTAssertEqualObjects(person.lastName, @"Weasley");
+    XCTAssertEqual(providerCallCount, (NSUInteger)1);
+    
+    // A provider which supplies nothing leaves the property to the fallback once it has run.
+    theme.lastName = nil;
+    [theme setValueProvider:^id{
+        providerCallCount++;
+        return nil;
+    } forPropertyName:lastName];
+    
+    XCTAssertEqualObjects(person.lastName, @"Potter");
+    XCTAssertEqual(providerCallCount, (NSUInteger)2);
+    XCTAssertEqual([person ancestorProvidingValueForPropertyName:lastName], base);
+}
+
+- (void)testConcurrentFirstAccessesShareOneComputation
+{
+    AKTestPerson *root = [AKTestPerson new];
+    
+    NSMutableArray *descendants = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 8; i++)
+    {
+        [descendants addObject:[root descendantInheritingKeyValueNotifications:NO]];
+    }
+    
+    __block NSUInteger providerCallCount = 0;
+    [root setValueProvider:^id{
+        @synchronized(descendants) {
+            providerCallCount++;
+        }
+        
+        [NSThread sleepForTimeInterval:0.1];
+        return [NSString stringWithFormat:@"Weasley"];
+    } forPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    NSHashTable *values = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    dispatch_apply(descendants.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        NSString *value = [descendants[index] lastName];
+        @synchronized(values) {
+            [values addObject:value];
+        }
+    });
+    
+    XCTAssertEqual(providerCallCount, (NSUInteger)1);
+    XCTAssertEqual(values.count, (NSUInteger)1);
+    XCTAssertEqual(values.anyObject, root.lastName);
+}
+
+
+#pragma mark - Querying descendants
+
+- (void)testDescendantsOrderedByGeneration
+{
+    AKTestPerson *grandparent = [AKTestPerson new];
+    AKTestPerson *parent = [grandparent descendant];
+    AKTestPerson *uncle = [grandparent descendant];
+    AKTestPerson *child = [parent descendant];
+    
+    NSArray *descendants = [grandparent descendants];
+    XCTAssertEqual(descendants.count, (NSUInteger)3);
+    XCTAssertEqualObjects([NSSet setWithArray:[descendants subarrayWithRange:NSMakeRange(0, 2)]], ([NSSet setWithObjects:parent, uncle, nil]));
+    XCTAssertEqual(descendants.lastObject, child);
+    XCTAssertEqual([child descendants].count, (NSUInteger)0);
+}
+
+- (void)testDescendantsAreWeak
+{
+    AKTestPerson *parent = [AKTestPerson new];
+    
+    @autoreleasepool {
+        [parent descendant];
+    }
+    
+    XCTAssertEqual([parent descendants].count, (NSUInteger)0);
+}
+
+- (void)testDescendantsInheritingValue
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.lastName = @"Weasley";
+    
+    AKTestPerson *ron = [arthur descendant];
+    AKTestPerson *rose = [ron descendant];
+    
+    AKTestPerson *ginny = [arthur descendant];
+    ginny.lastName = @"Potter";
+    AKTestPerson *james = [ginny descendant];
+    
+    AKTestPerson *percy = [arthur descendant];
+    [percy stopInheritingValuesForPropertyName:lastName];
+    AKTestPerson *molly = [percy descendant];
+    
+    NSArray *descendants = [arthur descendantsInheritingValueForPropertyName:lastName];
+    XCTAssertEqualObjects([NSSet setWithArray:descendants], ([NSSet setWithObjects:ron, rose, nil]));
+    
+    XCTAssertEqualObjects([ginny descendantsInheritingValueForPropertyName:lastName], @[james]);
+    XCTAssertEqualObjects([percy descendantsInheritingValueForPropertyName:lastName], @[molly]);
+    XCTAssertThrowsSpecificNamed([arthur descendantsInheritingValueForPropertyName:@"middleName"], NSException, AKAncestorUnknownPropertyException);
+}
+
+- (void)testDescendantsOverridingAndIgnoring
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    AKTestPerson *ginny = [arthur descendant];
+    AKTestPerson *james = [ginny descendant];
+    AKTestPerson *percy = [arthur descendant];
+    AKTestPerson *stranger = [AKTestPerson new];
+    
+    james.lastName = @"Potter";
+    stranger.lastName = @"Malfoy";
+    [percy stopInheritingValuesForPropertyName:lastName];
+    
+    XCTAssertEqualObjects([arthur descendantsOverridingPropertyName:lastName], @[james]);
+    XCTAssertEqualObjects([ginny descendantsOverridingPropertyName:lastName], @[james]);
+    XCTAssertEqual([percy descendantsOverridingPropertyName:lastName].count, (NSUInteger)0);
+    XCTAssertEqualObjects([arthur descendantsIgnoringPropertyName:lastName], @[percy]);
+    
+    // Replacing a value leaves the index alone, and each tree only indexes its own descendants.
+    james.lastName = @"Sirius";
+    XCTAssertEqualObjects([arthur descendantsOverridingPropertyName:lastName], @[james]);
+    XCTAssertEqual([stranger descendantsOverridingPropertyName:lastName].count, (NSUInteger)0);
+    
+    james.lastName = nil;
+    [percy resumeInheritingValuesForPropertyName:lastName];
+    
+    XCTAssertEqual([arthur descendantsOverridingPropertyName:lastName].count, (NSUInteger)0);
+    XCTAssertEqual([arthur descendantsIgnoringPropertyName:lastName].count, (NSUInteger)0);
+}
+
+
+#pragma mark - Value provenance
+
+- (void)testProvenance
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    NSString *birthDate = NSStringFromSelector(@selector(birthDate));
+    
+    AKTestPersonSubclass *arthur = [AKTestPersonSubclass new];
+    arthur.lastName = @"Weasley";
+    
+    AKTestPersonSubclass *ron = [arthur descendant];
+    AKTestPersonSubclass *rose = [ron descendant];
+    rose.firstName = @"Rose";
+    
+    AKAncestorValueProvenance provenance;
+    XCTAssertEqual([rose ancestorProvidingValueForPropertyName:lastName provenance:&provenance], arthur);
+    XCTAssertEqual(provenance, AKAncestorValueProvenanceInherited);
+    
+    XCTAssertEqual([rose ancestorProvidingValueForPropertyName:firstName provenance:&provenance], rose);
+    XCTAssertEqual(provenance, AKAncestorValueProvenanceLocal);
+    
+    XCTAssertNil([rose ancestorProvidingValueForPropertyName:birthDate provenance:&provenance]);
+    XCTAssertEqual(provenance, AKAncestorValueProvenanceNone);
+    
+    [ron stopInheritingValuesForPropertyName:lastName];
+    XCTAssertNil([ron ancestorProvidingValueForPropertyName:lastName provenance:&provenance]);
+    XCTAssertEqual(provenance, AKAncestorValueProvenanceIgnored);
+    XCTAssertNil([rose ancestorProvidingValueForPropertyName:lastName provenance:&provenance]);
+    XCTAssertEqual(provenance, AKAncestorValueProvenanceNone);
+    
+    XCTAssertThrowsSpecificNamed([rose ancestorProvidingValueForPropertyName:@"middleName"], NSException, AKAncestorUnknownPropertyException);
+}
+
+- (void)testProvenanceFollowsAncestors
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    AKTestPerson *ron = [arthur descendant];
+    AKTestPerson *rose = [ron descendant];
+    
+    XCTAssertNil([rose ancestorProvidingValueForPropertyName:lastName]);
+    
+    arthur.lastName = @"Weasley";
+    XCTAssertEqual([rose ancestorProvidingValueForPropertyName:lastName], arthur);
+    
+    ron.lastName = @"Weasley";
+    XCTAssertEqual([rose ancestorProvidingValueForPropertyName:lastName], ron);
+    
+    ron.lastName = nil;
+    XCTAssertEqual([rose ancestorProvidingValueForPropertyName:lastName], arthur);
+}
+
+- (void)testBulkProvenance
+{
+    AKTestPersonSubclass *arthur = [AKTestPersonSubclass new];
+    arthur.lastName = @"Weasley";
+    
+    AKTestPersonSubclass *ron = [arthur descendant];
+    ron.firstName = @"Ron";
+    [ron stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(birthDate))];
+    
+    NSDictionary *expectedProvenances = @{NSStringFromSelector(@selector(firstName)): @(AKAncestorValueProvenanceLocal),
+                                          NSStringFromSelector(@selector(lastName)): @(AKAncestorValueProvenanceInherited),
+                                          NSStringFromSelector(@selector(birthDate)): @(AKAncestorValueProvenanceIgnored)};
+    XCTAssertEqualObjects([ron provenanceOfValues], expectedProvenances);
+    
+    NSDictionary *providers = [ron ancestorsProvidingValues];
+    XCTAssertEqual(providers.count, (NSUInteger)2);
+    XCTAssertEqual(providers[NSStringFromSelector(@selector(firstName))], ron);
+    XCTAssertEqual(providers[NSStringFromSelector(@selector(lastName))], arthur);
+}
+
+
+#pragma mark - Comparing instances
+
+- (void)testSiblingsDifferOnlyInOverrides
+{
+    AKTestPerson *parent = [AKTestPerson new];
+    parent.firstName = @"Arthur";
+    parent.lastName = @"Weasley";
+    
+    AKTestPerson *personA = [parent descendant];
+    personA.firstName = @"Ron";
+    
+    AKTestPerson *personB = [parent descendant];
+    
+    XCTAssertEqualObjects([personA propertyNamesDifferingFrom:personB], [NSSet setWithObject:NSStringFromSelector(@selector(firstName))]);
+    XCTAssertEqualObjects([personB propertyNamesDifferingFrom:personA], [NSSet setWithObject:NSStringFromSelector(@selector(firstName))]);
+    
+    personB.firstName = @"Ron";
+    
+    XCTAssertEqual([personA propertyNamesDifferingFrom:personB].count, 0);
+}
+
+- (void)testDescendantDiffersFromAncestor
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.firstName = @"James";
+    personA.lastName = @"Potter";
+    
+    AKTestPerson *personB = [personA descendant];
+    
+    XCTAssertEqual([personB propertyNamesDifferingFrom:personA].count, 0);
+    
+    personB.firstName = @"Harry";
+    
+    XCTAssertEqualObjects([personB propertyNamesDifferingFrom:personA], [NSSet setWithObject:NSStringFromSelector(@selector(firstName))]);
+    XCTAssertEqualObjects([personA propertyNamesDifferingFrom:personB], [NSSet setWithObject:NSStringFromSelector(@selector(firstName))]);
+}
+
+- (void)testIgnoredPropertiesDiffer
+{
+    AKTestPerson *parent = [AKTestPerson new];
+    parent.lastName = @"Ciccone";
+    
+    AKTestPerson *personA = [parent descendant];
+    AKTestPerson *personB = [parent descendant];
+    
+    [personA stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    XCTAssertEqualObjects([personA propertyNamesDifferingFrom:personB], [NSSet setWithObject:NSStringFromSelector(@selector(lastName))]);
+}
+
+- (void)testProvidedValuesDiffer
+{
+    AKTestPerson *parent = [AKTestPerson new];
+    parent.lastName = @"Weasley";
+    
+    AKTestPerson *personA = [parent descendant];
+    AKTestPerson *personB = [parent descendant];
+    
+    [personA setValueProvider:^id{
+        return @"Granger";
+    } forPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    XCTAssertEqualObjects([personB propertyNamesDifferingFrom:personA], [NSSet setWithObject:NSStringFromSelector(@selector(lastName))]);
+    
+    // Losing an override takes the property off the list again.
+    personA.lastName = nil;
+    XCTAssertEqual([personA propertyNamesDifferingFrom:personB].count, 0);
+}
+
+- (void)testTransformingGettersDiffer
+{
+    AKTestPerson *parent = [AKTestPerson new];
+    parent.firstName = @"Harry";
+    
+    AKTestPerson *personA = [parent descendant];
+    AKTestPersonSubclass *personB = [AKTestPersonSubclass descendantOf:parent];
+    
+    XCTAssertEqualObjects([personA propertyNamesDifferingFrom:personB], [NSSet setWithObject:NSStringFromSelector(@selector(firstName))]);
+}
+
+- (void)testUnrelatedInstancesCompareAllProperties
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.firstName = @"Harry";
+    personA.lastName = @"Potter";
+    
+    AKTestPerson *personB = [AKTestPerson new];
+    personB.firstName = @"Harry";
+    personB.lastName = @"Osborn";
+    
+    XCTAssertEqualObjects([personA propertyNamesDifferingFrom:personB], [NSSet setWithObject:NSStringFromSelector(@selector(lastName))]);
+}
+
+
+#pragma mark - Value semantics
+
+- (void)testIdentityEqualityByDefault
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.firstName = @"Harry";
+    
+    AKTestPerson *personB = [AKTestPerson new];
+    personB.firstName = @"Harry";
+    
+    XCTAssertNotEqualObjects(personA, personB);
+    XCTAssertTrue([personA isEqualToAncestor:personB]);
+    XCTAssertEqual([personA effectiveValueHash], [personB effectiveValueHash]);
+}
+
+- (void)testEffectiveValueEquality
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontSize = @12;
+    
+    AKTestStyle *caption = [body descendant];
+    caption.fontSize = @10;
+    
+    AKTestStyle *footnote = [AKTestStyle new];
+    footnote.fontName = @"Helvetica";
+    footnote.fontSize = @10;
+    
+    XCTAssertEqualObjects(caption, footnote);
+    XCTAssertEqual([caption hash], [footnote hash]);
+    XCTAssertNotEqualObjects(caption, body);
+    
+    NSSet *styles = [NSSet setWithObjects:body, caption, footnote, nil];
+    XCTAssertEqual(styles.count, (NSUInteger)2);
+}
+
+- (void)testHashChangesWithAncestors
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    
+    AKTestStyle *caption = [body descendant];
+    caption.fontSize = @10;
+    
+    AKTestStyle *footnote = [AKTestStyle new];
+    footnote.fontName = @"Helvetica";
+    footnote.fontSize = @10;
+    
+    NSUInteger hash = [caption hash];
+    XCTAssertEqual([caption hash], hash);
+    
+    body.fontName = @"Avenir";
+    XCTAssertNotEqual([caption hash], hash);
+    XCTAssertNotEqualObjects(caption, footnote);
+    
+    footnote.fontName = @"Avenir";
+    XCTAssertEqualObjects(caption, footnote);
+    
+    [caption stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(fontName))];
+    XCTAssertNotEqualObjects(caption, footnote);
+    
+    [caption resumeInheritingValuesForPropertyName:NSStringFromSelector(@selector(fontName))];
+    XCTAssertEqualObjects(caption, footnote);
+}
+
+- (void)testEffectiveValueKeys
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    
+    AKTestStyle *caption = [body descendant];
+    
+    NSMapTable *layoutCache = [NSMapTable strongToStrongObjectsMapTable];
+    [layoutCache setObject:@"layout" forKey:caption];
+    
+    AKTestStyle *otherCaption = [AKTestStyle new];
+    otherCaption.fontName = @"Helvetica";
+    XCTAssertEqualObjects([layoutCache objectForKey:otherCaption], @"layout");
+}
+
+
+#pragma mark - Merging collections
+
+- (void)testMergePolicies
+{
+    AKTestStyle *base = [AKTestStyle new];
+    base.fontFeatures = @[@"kern"];
+    base.attributes = @{@"weight": @"regular", @"slant": @"none"};
+    base.traits = [NSSet setWithObject:@"serif"];
+    
+    AKTestStyle *style = [base descendant];
+    XCTAssertEqualObjects(style.fontFeatures, @[@"kern"]);
+    
+    style.fontFeatures = @[@"liga"];
+    style.attributes = @{@"weight": @"bold"};
+    style.traits = [NSSet setWithObject:@"italic"];
+    
+    XCTAssertEqualObjects(style.fontFeatures, (@[@"kern", @"liga"]));
+    XCTAssertEqualObjects(style.attributes, (@{@"weight": @"bold", @"slant": @"none"}));
+    XCTAssertEqualObjects(style.traits, ([NSSet setWithObjects:@"serif", @"italic", nil]));
+    
+    AKTestStyle *grandchild = [style descendant];
+    grandchild.fontFeatures = @[@"smcp"];
+    XCTAssertEqualObjects(grandchild.fontFeatures, (@[@"kern", @"liga", @"smcp"]));
+    
+    // Descendants without a value of their own inherit the merged value as is, rather than merging it with itself.
+    AKTestStyle *sibling = [style descendant];
+    XCTAssertEqualObjects(sibling.fontFeatures, (@[@"kern", @"liga"]));
+    XCTAssertEqualObjects([[sibling descendant] fontFeatures], (@[@"kern", @"liga"]));
+    
+    [grandchild stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(fontFeatures))];
+    XCTAssertEqualObjects(grandchild.fontFeatures, @[@"smcp"]);
+}
+
+- (void)testMergedValuesAreCached
+{
+    AKTestStyle *base = [AKTestStyle new];
+    base.fontFeatures = @[@"kern"];
+    
+    AKTestStyle *style = [base descendant];
+    style.fontFeatures = @[@"liga"];
+    
+    NSArray *fontFeatures = style.fontFeatures;
+    XCTAssertEqual(style.fontFeatures, fontFeatures);
+    
+    base.fontName = @"Helvetica";
+    XCTAssertEqual(style.fontFeatures, fontFeatures);
+    
+    base.fontFeatures = @[@"onum"];
+    XCTAssertEqualObjects(style.fontFeatures, (@[@"onum", @"liga"]));
+}
+
+- (void)testMergedValueKVC
+{
+    AKTestStyle *base = [AKTestStyle new];
+    base.fontFeatures = @[@"kern"];
+    
+    AKTestStyle *style = [base descendant];
+    style.fontFeatures = @[@"liga"];
+    
+    [self keyValueObservingExpectationForObject:style keyPath:NSStringFromSelector(@selector(fontFeatures)) expectedValue:(@[@"onum", @"liga"])];
+    
+    base.fontFeatures = @[@"onum"];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+
+#pragma mark - Derived properties
+
+- (void)testDerivedValuesAreCached
+{
+    AKTestStyle *style = [AKTestStyle new];
+    style.fontName = @"Helvetica";
+    style.fontSize = @12;
+    
+    XCTAssertEqualObjects([style displayName], @"Helvetica 12");
+    XCTAssertEqualObjects([style displayName], @"Helvetica 12");
+    XCTAssertEqual(style.displayNameComputationCount, (NSUInteger)1);
+    
+    style.fontSize = @14;
+    XCTAssertEqualObjects([style displayName], @"Helvetica 14");
+    XCTAssertEqual(style.displayNameComputationCount, (NSUInteger)2);
+}
+
+- (void)testDerivedValuesFollowAncestors
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontSize = @12;
+    
+    AKTestStyle *caption = [body descendantInheritingKeyValueNotifications:NO];
+    XCTAssertEqualObjects([caption displayName], @"Helvetica 12");
+    
+    body.fontName = @"Avenir";
+    XCTAssertEqualObjects([caption displayName], @"Avenir 12");
+    XCTAssertEqual(caption.displayNameComputationCount, (NSUInteger)2);
+    
+    [caption stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(fontName))];
+    XCTAssertEqualObjects([caption displayName], @"(null) 12");
+}
+
+- (void)testUnrelatedChangesDontRecompute
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontSize = @12;
+    
+    AKTestStyle *caption = [body descendant];
+    [caption displayName];
+    
+    body.textColorName = @"red";
+    caption.textColorName = @"blue";
+    body.fontSize = @12;
+    
+    XCTAssertEqualObjects([caption displayName], @"Helvetica 12");
+    XCTAssertEqual(caption.displayNameComputationCount, (NSUInteger)1);
+}
+
+- (void)testNestedDerivedValues
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontSize = @12;
+    body.textColorName = @"red";
+    
+    AKTestStyle *caption = [body descendant];
+    XCTAssertEqualObjects([caption summary], @"Helvetica 12 in red");
+    
+    body.fontSize = @10;
+    XCTAssertEqualObjects([caption summary], @"Helvetica 10 in red");
+    XCTAssertEqual(caption.displayNameComputationCount, (NSUInteger)2);
+}
+
+- (void)testDerivedValuesDontRetainTheirDependencies
+{
+    __weak AKTestStyle *weakBody;
+    __weak AKTestStyle *weakCaption;
+    
+    @autoreleasepool {
+        AKTestStyle *body = [AKTestStyle new];
+        body.fontName = @"Helvetica";
+        
+        AKTestStyle *caption = [body descendantInheritingKeyValueNotifications:NO];
+        XCTAssertEqualObjects([caption summary], @"Helvetica (null) in (null)");
+        XCTAssertEqualObjects([caption summary], @"Helvetica (null) in (null)");
+        XCTAssertEqual(caption.displayNameComputationCount, (NSUInteger)1);
+        
+        weakBody = body;
+        weakCaption = caption;
+    }
+    
+    // The caption's cached values depend on both instances, so holding them strongly would keep both alive.
+    XCTAssertNil(weakCaption);
+    XCTAssertNil(weakBody);
+}
+
+- (void)testDerivedKVC
+{
+    AKTestStyle *body = [AKTestStyle new];
+    body.fontName = @"Helvetica";
+    body.fontSize = @12;
+    
+    AKTestStyle *caption = [body descendant];
+    [caption displayName];
+    
+    [self keyValueObservingExpectationForObject:caption keyPath:NSStringFromSelector(@selector(displayName)) expectedValue:@"Avenir 12"];
+    
+    body.fontName = @"Avenir";
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testInvalidateDerivedValues
+{
+    AKTestStyle *style = [AKTestStyle new];
+    [style displayName];
+    
+    [style invalidateDerivedValues];
+    [style displayName];
+    
+    XCTAssertEqual(style.displayNameComputationCount, (NSUInteger)2);
+}
+
+
+#pragma mark - Archiving
+
+- (void)testArchivingPreservesOverridesAndInheritance
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.firstName = @"James";
+    personA.lastName = @"Potter";
+    
+    AKTestPerson *personB = [personA descendant];
+    personB.firstName = @"Harry";
+    
+    AKTestPerson *decodedPerson = [[self class] secureRoundTripObject:personB ofClass:[AKTestPerson class]];
+    
+    XCTAssertEqualObjects(decodedPerson.firstName, @"Harry");
+    XCTAssertEqualObjects(decodedPerson.lastName, @"Potter");
+    XCTAssertEqualObjects([decodedPerson.ancestor firstName], @"James");
+    XCTAssertTrue(decodedPerson.inheritsKeyValueNotifications);
+    
+    [decodedPerson.ancestor setLastName:@"Evans"];
+    
+    XCTAssertEqualObjects(decodedPerson.lastName, @"Evans");
+}
+
+- (void)testArchivingPreservesIgnoredProperties
+{
+    AKTestPerson *personA = [AKTestPerson new];
+    personA.lastName = @"Ciccone";
+    
+    AKTestPerson *personB = [personA descendantInheritingKeyValueNotifications:NO];
+    personB.firstName = @"Madonna";
+    [personB stopInheritingValuesForPropertyName:NSStringFromSelector(@selector(lastName))];
+    
+    AKTestPerson *decodedPerson = [[self class] secureRoundTripObject:personB ofClass:[AKTestPerson class]];
+    
+    XCTAssertNil(decodedPerson.lastName);
+    XCTAssertEqualObjects([decodedPerson.ancestor lastName], @"Ciccone");
+    XCTAssertEqualObjects([decodedPerson.propertiesIgnoringInheritedValues valueForKey:NSStringFromSelector(@selector(propertyName))], [NSSet setWithObject:NSStringFromSelector(@selector(lastName))]);
+    XCTAssertFalse(decodedPerson.inheritsKeyValueNotifications);
+}
+
+- (void)testArchivingSharesAncestors
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSArray *descendants = [[self class] familyTreeWithRoot:root count:3];
+    NSArray *decodedDescendants = [[self class] secureRoundTripObject:descendants ofClass:[NSArray class]];
+    
+    XCTAssertEqual(decodedDescendants.count, (NSUInteger)3);
+    XCTAssertEqual([decodedDescendants[0] ancestor], [decodedDescendants[1] ancestor]);
+    XCTAssertEqual([decodedDescendants[1] ancestor], [decodedDescendants[2] ancestor]);
+    XCTAssertEqualObjects([decodedDescendants[2] lastName], @"Weasley");
+}
+
+- (void)testArchiveIsSmallerThanFlattenedValues
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSArray *descendants = [[self class] familyTreeWithRoot:root count:1000];
+    NSArray *flattenedDescendants = [[self class] flattenedValuesOfDescendants:descendants];
+    
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:descendants];
+    NSData *flattenedArchive = [NSKeyedArchiver archivedDataWithRootObject:flattenedDescendants];
+    
+    XCTAssertGreaterThan(archive.length, (NSUInteger)0);
+    XCTAssertLessThan(archive.length, flattenedArchive.length);
+}
+
+- (void)testSecureCodingRejectsUntypedProperties
+{
+    NSString *title = NSStringFromSelector(@selector(title));
+    NSString *tag = NSStringFromSelector(@selector(tag));
+    XCTAssertEqualObjects([AKTestTaggedItem allowedClassesForDecodingPropertyName:title], [NSSet setWithObject:[NSString class]]);
+    XCTAssertNil([AKTestTaggedItem allowedClassesForDecodingPropertyName:tag]);
+    XCTAssertThrowsSpecificNamed([AKTestTaggedItem allowedClassesForDecodingPropertyName:@"fontName"], NSException, AKAncestorUnknownPropertyException);
+    
+    AKTestTaggedItem *item = [AKTestTaggedItem new];
+    item.title = @"Quidditch";
+    
+    AKTestTaggedItem *decodedItem = [[self class] secureRoundTripObject:item ofClass:[AKTestTaggedItem class]];
+    XCTAssertEqualObjects(decodedItem.title, @"Quidditch");
+    
+    // Without a class list any class could be instantiated from the archive, so secure decoding refuses the value.
+    item.tag = [NSDate dateWithTimeIntervalSince1970:0.0];
+    XCTAssertThrowsSpecificNamed([[self class] secureRoundTripObject:item ofClass:[AKTestTaggedItem class]], NSException, NSInvalidUnarchiveOperationException);
+    
+    decodedItem = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:item]];
+    XCTAssertEqualObjects(decodedItem.tag, [NSDate dateWithTimeIntervalSince1970:0.0]);
+}
+
+
 #pragma mark - Performance tests
 
+- (void)testCachedDerivedValue
+{
+    AKTestStyle *style = [AKTestStyle new];
+    style.fontName = @"Helvetica";
+    style.fontSize = @12;
+    
+    for (NSUInteger i = 0; i < 100; i++)
+    {
+        style = [style descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [style displayName];
+        }
+    }];
+}
+
+- (void)testCachedEffectiveValueHash
+{
+    AKTestStyle *style = [AKTestStyle new];
+    style.fontName = @"Helvetica";
+    
+    for (NSUInteger i = 0; i < 100; i++)
+    {
+        style = [style descendantInheritingKeyValueNotifications:NO];
+    }
+    style.fontSize = @10;
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [style hash];
+        }
+    }];
+}
+
+- (void)testQueryLargeTree
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    
+    AKTestPerson *root = [AKTestPerson new];
+    NSMutableArray *people = [NSMutableArray arrayWithObject:root];
+    for (NSUInteger i = 1; i < 100000; i++)
+    {
+        AKTestPerson *person = [people[(i - 1) / 16] descendantInheritingKeyValueNotifications:NO];
+        if (i % 1000 == 0)
+        {
+            person.firstName = @"Weasley";
+        }
+        [people addObject:person];
+    }
+    
+    [self measureBlock:^{
+        XCTAssertEqual([root descendantsOverridingPropertyName:firstName].count, (NSUInteger)99);
+    }];
+}
+
+- (void)testCachedProvenance
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    for (NSUInteger i = 0; i < 100; i++)
+    {
+        person = [person descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person ancestorProvidingValueForPropertyName:@"lastName"];
+        }
+    }];
+}
+
+- (void)testCachedFallbackResolution
+{
+    AKTestPerson *theme = [AKTestPerson new];
+    for (NSUInteger i = 0; i < 50; i++)
+    {
+        theme = [theme descendantInheritingKeyValueNotifications:NO];
+    }
+    
+    AKTestPerson *base = [AKTestPerson new];
+    base.lastName = @"Potter";
+    
+    AKTestPerson *person = [[AKTestPerson alloc] initWithAncestors:@[theme, base] inheritKeyValueNotifications:NO];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+- (void)testCachedMergedValue
+{
+    AKTestStyle *style = [AKTestStyle new];
+    style.attributes = @{@"weight": @"regular"};
+    
+    for (NSUInteger i = 0; i < 100; i++)
+    {
+        style = [style descendantInheritingKeyValueNotifications:NO];
+        style.attributes = @{[NSString stringWithFormat:@"%lu", (unsigned long)i]: @(i)};
+    }
+    
+    [style attributes];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [style attributes];
+        }
+    }];
+}
+
 - (void)testInitWithWithKVC
 {
     AKTestPerson *baseDescendant = [AKTestPerson new];
@@ -394,4 +1424,40 @@
     }];
 }
 
+- (void)testArchiveTree
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSArray *descendants = [[self class] familyTreeWithRoot:root count:10000];
+    
+    [self measureBlock:^{
+        [NSKeyedArchiver archivedDataWithRootObject:descendants];
+    }];
+}
+
+- (void)testArchiveFlattenedTree
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSArray *descendants = [[self class] familyTreeWithRoot:root count:10000];
+    
+    [self measureBlock:^{
+        [NSKeyedArchiver archivedDataWithRootObject:[[self class] flattenedValuesOfDescendants:descendants]];
+    }];
+}
+
+- (void)testUnarchiveTree
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    NSArray *descendants = [[self class] familyTreeWithRoot:root count:10000];
+    
+    [self measureBlock:^{
+        [[self class] secureRoundTripObject:descendants ofClass:[NSArray class]];
+    }];
+}
+
 @end
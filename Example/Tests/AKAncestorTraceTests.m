@@ -0,0 +1,185 @@
+//
+//  AKAncestorTraceTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorTraceTests : XCTestCase
+
+@end
+
+@implementation AKAncestorTraceTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    [AKAncestorTrace clear];
+    [AKAncestorTrace setEnabled:YES];
+}
+
+- (void)tearDown
+{
+    [AKAncestorTrace setEnabled:NO];
+    [AKAncestorTrace setBufferCapacity:8192];
+    [AKAncestorTrace clear];
+    
+    [super tearDown];
+}
+
++ (NSArray *)tracedEventsNamed:(NSString *)name
+{
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[AKAncestorTrace chromeTraceData] options:0 error:NULL];
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"name == %@", name];
+    return [trace[@"traceEvents"] filteredArrayUsingPredicate:predicate];
+}
+
+- (void)testDisabledByDefault
+{
+    [AKAncestorTrace setEnabled:NO];
+    
+    AKTestPerson *person = [[AKTestPerson new] descendant];
+    [person lastName];
+    
+    XCTAssertFalse([AKAncestorTrace isEnabled]);
+    XCTAssertEqual([[self class] tracedEventsNamed:@"Resolve lastName"].count, (NSUInteger)0);
+}
+
+- (void)testResolutions
+{
+    AKTestPerson *root = [AKTestPerson new];
+    root.lastName = @"Weasley";
+    
+    AKTestPerson *person = [[root descendantInheritingKeyValueNotifications:NO] descendantInheritingKeyValueNotifications:NO];
+    
+    [AKAncestorTrace clear];
+    [person lastName];
+    
+    NSArray *events = [[self class] tracedEventsNamed:@"Resolve lastName"];
+    XCTAssertEqual(events.count, (NSUInteger)3);
+    
+    // Inner resolutions finish first, and the outermost one contains them.
+    NSDictionary *outermost = events.lastObject;
+    XCTAssertEqualObjects(outermost[@"ph"], @"X");
+    XCTAssertEqualObjects(outermost[@"cat"], @"resolution");
+    XCTAssertEqualObjects(outermost[@"args"][@"class"], @"AKTestPerson");
+    XCTAssertEqualObjects(outermost[@"args"][@"instance"], ([NSString stringWithFormat:@"%p", person]));
+    XCTAssertGreaterThanOrEqual([outermost[@"dur"] doubleValue], [events.firstObject[@"dur"] doubleValue]);
+    XCTAssertLessThanOrEqual([outermost[@"ts"] doubleValue], [events.firstObject[@"ts"] doubleValue]);
+}
+
+- (void)testWritesAndForwardedNotifications
+{
+    AKTestPerson *root = [AKTestPerson new];
+    AKTestPerson *person = [root descendant];
+    
+    root.lastName = @"Weasley";
+    
+    NSArray *writes = [[self class] tracedEventsNamed:@"Write lastName"];
+    NSArray *forwards = [[self class] tracedEventsNamed:@"Forward lastName"];
+    XCTAssertEqual(writes.count, (NSUInteger)1);
+    XCTAssertEqual(forwards.count, (NSUInteger)1);
+    XCTAssertEqualObjects(forwards.firstObject[@"args"][@"instance"], ([NSString stringWithFormat:@"%p", person]));
+    XCTAssertGreaterThanOrEqual([forwards.firstObject[@"ts"] doubleValue], [writes.firstObject[@"ts"] doubleValue]);
+}
+
+- (void)testDescendantLifecycle
+{
+    AKTestPerson *root = [AKTestPerson new];
+    
+    @autoreleasepool {
+        AKTestPerson *person = [root descendant];
+        person.firstName = @"Ron";
+    }
+    
+    NSArray *creations = [[self class] tracedEventsNamed:@"Create AKTestPerson"];
+    NSArray *deallocations = [[self class] tracedEventsNamed:@"Deallocate AKTestPerson"];
+    XCTAssertEqual(creations.count, (NSUInteger)1);
+    XCTAssertEqual(deallocations.count, (NSUInteger)1);
+    XCTAssertEqualObjects(creations.firstObject[@"ph"], @"i");
+    XCTAssertEqualObjects(creations.firstObject[@"args"][@"instance"], deallocations.firstObject[@"args"][@"instance"]);
+}
+
+- (void)testBuffersKeepTheNewestEvents
+{
+    [AKAncestorTrace setBufferCapacity:4];
+    
+    AKTestPerson *person = [AKTestPerson new];
+    for (NSUInteger i = 0; i < 10; i++)
+    {
+        [person firstName];
+    }
+    
+    XCTAssertEqual([[self class] tracedEventsNamed:@"Resolve firstName"].count, (NSUInteger)4);
+    
+    [AKAncestorTrace clear];
+    XCTAssertEqual([[self class] tracedEventsNamed:@"Resolve firstName"].count, (NSUInteger)0);
+}
+
+- (void)testEventsFromAllThreads
+{
+    AKTestPerson *person = [AKTestPerson new];
+    
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        for (NSUInteger i = 0; i < 100; i++)
+        {
+            [person lastName];
+        }
+    });
+    
+    XCTAssertEqual([[self class] tracedEventsNamed:@"Resolve lastName"].count, (NSUInteger)400);
+    XCTAssertGreaterThan([[self class] tracedEventsNamed:@"thread_name"].count, (NSUInteger)0);
+}
+
+- (void)testWriteChromeTrace
+{
+    [[AKTestPerson new] lastName];
+    
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSError *error;
+    XCTAssertTrue([AKAncestorTrace writeChromeTraceToURL:fileURL error:&error], @"%@", error);
+    
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfURL:fileURL] options:0 error:NULL];
+    XCTAssertTrue([trace[@"traceEvents"] isKindOfClass:[NSArray class]]);
+    
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+
+#pragma mark - Performance tests
+
+- (void)testDisabledGetters
+{
+    [AKAncestorTrace setEnabled:NO];
+    
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+- (void)testTracedGetters
+{
+    AKTestPerson *person = [AKTestPerson new];
+    person.lastName = @"Weasley";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [person lastName];
+        }
+    }];
+}
+
+@end
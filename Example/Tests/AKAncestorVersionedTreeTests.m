@@ -0,0 +1,198 @@
+//
+//  AKAncestorVersionedTreeTests.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <AncestorKit/AncestorKit.h>
+#import <XCTest/XCTest.h>
+#import "AKTestFixtures.h"
+
+@interface AKAncestorVersionedTreeTests : XCTestCase
+
+@end
+
+@implementation AKAncestorVersionedTreeTests
+
+- (void)testPinnedVersionsDontChange
+{
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.firstName = @"Arthur";
+    arthur.lastName = @"Weasley";
+    
+    AKTestPerson *ron = [arthur descendantInheritingKeyValueNotifications:NO];
+    
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:arthur];
+    AKAncestorVersion *firstVersion = tree.currentVersion;
+    XCTAssertEqual(firstVersion.number, (uint64_t)1);
+    XCTAssertEqualObjects(firstVersion.ancestors, (@[arthur, ron]));
+    XCTAssertEqualObjects([firstVersion valueForPropertyName:firstName ofAncestor:ron], @"Arthur");
+    
+    __block AKTestPerson *hugo = nil;
+    AKAncestorVersion *secondVersion = [tree commitChanges:^{
+        arthur.lastName = @"Prewett";
+        ron.firstName = @"Ron";
+        [ron stopInheritingValuesForPropertyName:lastName];
+        hugo = [ron descendantInheritingKeyValueNotifications:NO];
+    }];
+    
+    XCTAssertEqual(secondVersion.number, (uint64_t)2);
+    XCTAssertEqual(tree.currentVersion, secondVersion);
+    
+    // The pinned version still resolves everything as it was before the commit.
+    XCTAssertEqualObjects([firstVersion valueForPropertyName:lastName ofAncestor:ron], @"Weasley");
+    XCTAssertEqualObjects([firstVersion valueForPropertyName:firstName ofAncestor:ron], @"Arthur");
+    XCTAssertNil([firstVersion localValueForPropertyName:firstName ofAncestor:ron]);
+    XCTAssertFalse([firstVersion containsAncestor:hugo]);
+    
+    XCTAssertEqualObjects([secondVersion valueForPropertyName:lastName ofAncestor:arthur], @"Prewett");
+    XCTAssertNil([secondVersion valueForPropertyName:lastName ofAncestor:ron]);
+    XCTAssertNil([secondVersion valueForPropertyName:lastName ofAncestor:hugo]);
+    XCTAssertEqualObjects([secondVersion valueForPropertyName:firstName ofAncestor:hugo], @"Ron");
+    XCTAssertTrue([secondVersion containsAncestor:hugo]);
+    
+    // Changes made outside a commit are only published by the next one.
+    hugo.firstName = @"Hugo";
+    XCTAssertEqualObjects([tree.currentVersion valueForPropertyName:firstName ofAncestor:hugo], @"Ron");
+    XCTAssertEqualObjects([[tree commitChanges:nil] valueForPropertyName:firstName ofAncestor:hugo], @"Hugo");
+}
+
+- (void)testOldVersionsAreReclaimed
+{
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.lastName = @"Weasley";
+    
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:arthur];
+    
+    __weak AKAncestorVersion *weakVersion = nil;
+    AKAncestorVersion *pinnedVersion = nil;
+    @autoreleasepool {
+        weakVersion = tree.currentVersion;
+        pinnedVersion = tree.currentVersion;
+        
+        [tree commitChanges:^{
+            arthur.lastName = @"Prewett";
+        }];
+    }
+    
+    // A reader still holds the old version, so it stays valid until the reader lets go.
+    XCTAssertNotNil(weakVersion);
+    XCTAssertEqualObjects([weakVersion valueForPropertyName:NSStringFromSelector(@selector(lastName)) ofAncestor:arthur], @"Weasley");
+    
+    @autoreleasepool {
+        pinnedVersion = nil;
+    }
+    
+    XCTAssertNil(weakVersion);
+}
+
+- (void)testVersionsDontRetainAncestors
+{
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.lastName = @"Weasley";
+    
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:arthur];
+    
+    __weak AKTestPerson *weakRon = nil;
+    AKAncestorVersion *pinnedVersion = nil;
+    @autoreleasepool {
+        AKTestPerson *ron = [AKTestPerson descendantOf:arthur];
+        weakRon = ron;
+        
+        pinnedVersion = [tree commitChanges:nil];
+        XCTAssertTrue([pinnedVersion containsAncestor:ron]);
+        XCTAssertEqualObjects([pinnedVersion valueForPropertyName:lastName ofAncestor:ron], @"Weasley");
+    }
+    
+    // The pinned version doesn't keep the released descendant alive, so the next commit no longer finds it among the descendants.
+    AKAncestorVersion *version = [tree commitChanges:nil];
+    XCTAssertNil(weakRon);
+    XCTAssertEqualObjects(version.ancestors, @[arthur]);
+    XCTAssertEqualObjects(pinnedVersion.ancestors, @[arthur]);
+    XCTAssertEqualObjects([pinnedVersion valueForPropertyName:lastName ofAncestor:arthur], @"Weasley");
+}
+
+- (void)testReadersSeeWholeCommits
+{
+    AKTestPerson *arthur = [AKTestPerson new];
+    arthur.lastName = @"Family 0";
+    
+    AKTestPerson *ron = [AKTestPerson descendantOf:arthur];
+    AKTestPerson *hugo = [AKTestPerson descendantOf:ron];
+    hugo.firstName = @"Child 0";
+    
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:arthur];
+    NSString *firstName = NSStringFromSelector(@selector(firstName));
+    NSString *lastName = NSStringFromSelector(@selector(lastName));
+    
+    __block volatile BOOL isWriting = YES;
+    __block NSUInteger inconsistentReads = 0;
+    __block NSUInteger regressedVersions = 0;
+    NSObject *countsLock = [NSObject new];
+    
+    dispatch_group_t readers = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    for (NSUInteger thread = 0; thread < 4; thread++)
+    {
+        dispatch_group_async(readers, queue, ^{
+            uint64_t lastNumber = 0;
+            while (isWriting)
+            {
+                @autoreleasepool {
+                    // Both values change in every commit, so a torn read would find them out of step.
+                    AKAncestorVersion *version = tree.currentVersion;
+                    NSString *family = [[version valueForPropertyName:lastName ofAncestor:hugo] substringFromIndex:7];
+                    NSString *child = [[version valueForPropertyName:firstName ofAncestor:hugo] substringFromIndex:6];
+                    
+                    BOOL isInconsistent = ![family isEqualToString:child];
+                    BOOL hasRegressed = (version.number < lastNumber);
+                    lastNumber = version.number;
+                    
+                    if (isInconsistent || hasRegressed)
+                    {
+                        @synchronized(countsLock) {
+                            inconsistentReads += (isInconsistent) ? 1 : 0;
+                            regressedVersions += (hasRegressed) ? 1 : 0;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    
+    for (NSUInteger commit = 1; commit <= 500; commit++)
+    {
+        @autoreleasepool {
+            [tree commitChanges:^{
+                arthur.lastName = [NSString stringWithFormat:@"Family %lu", (unsigned long)commit];
+                hugo.firstName = [NSString stringWithFormat:@"Child %lu", (unsigned long)commit];
+            }];
+        }
+    }
+    
+    isWriting = NO;
+    dispatch_group_wait(readers, DISPATCH_TIME_FOREVER);
+    
+    XCTAssertEqual(inconsistentReads, (NSUInteger)0);
+    XCTAssertEqual(regressedVersions, (NSUInteger)0);
+    XCTAssertEqual(tree.currentVersion.number, (uint64_t)501);
+}
+
+- (void)testInvalidArguments
+{
+    AKTestPerson *arthur = [AKTestPerson new];
+    AKAncestorVersionedTree *tree = [[AKAncestorVersionedTree alloc] initWithRoot:arthur];
+    
+    XCTAssertThrowsSpecificNamed([tree.currentVersion valueForPropertyName:@"lastName" ofAncestor:[AKTestPerson new]], NSException, NSInvalidArgumentException);
+    XCTAssertThrowsSpecificNamed([tree.currentVersion valueForPropertyName:@"fontName" ofAncestor:arthur], NSException, AKAncestorUnknownPropertyException);
+    XCTAssertThrows([[AKAncestorVersionedTree alloc] init]);
+}
+
+@end
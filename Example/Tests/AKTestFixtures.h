@@ -32,3 +32,22 @@
 @interface AKCollectionViewAttributes : AKAncestor
 @property (assign, nonatomic) UIEdgeInsets sectionInsets;
 @end
+
+@interface AKTestStyle : AKAncestor
+@property (copy, nonatomic) NSString *fontName;
+@property (strong, nonatomic) NSNumber *fontSize;
+@property (copy, nonatomic) NSString *textColorName;
+@property (copy, nonatomic) NSArray *fontFeatures;
+@property (copy, nonatomic) NSDictionary *attributes;
+@property (copy, nonatomic) NSSet *traits;
+
+@property (assign, nonatomic) NSUInteger displayNameComputationCount;
+
+- (NSString *)displayName;
+- (NSString *)summary;
+@end
+
+@interface AKTestTaggedItem : AKAncestor
+@property (copy, nonatomic) NSString *title;
+@property (strong, nonatomic) id tag;
+@end
@@ -185,3 +185,49 @@ static void *AKTestPersonDeepSubclassKVOContext = &AKTestPersonDeepSubclassKVOCo
 @end
 
 
+@implementation AKTestStyle
+
++ (BOOL)comparesEffectiveValues
+{
+    return YES;
+}
+
++ (NSSet *)derivedPropertyNames
+{
+    return [NSSet setWithObjects:NSStringFromSelector(@selector(displayName)), NSStringFromSelector(@selector(summary)), nil];
+}
+
++ (AKAncestorMergePolicy)mergePolicyForPropertyName:(NSString *)propertyName
+{
+    if ([propertyName isEqualToString:NSStringFromSelector(@selector(fontFeatures))])
+    {
+        return AKAncestorMergePolicyConcatenate;
+    }
+    else if ([propertyName isEqualToString:NSStringFromSelector(@selector(attributes))])
+    {
+        return AKAncestorMergePolicyMergeDictionaries;
+    }
+    else if ([propertyName isEqualToString:NSStringFromSelector(@selector(traits))])
+    {
+        return AKAncestorMergePolicyUnionSets;
+    }
+    
+    return [super mergePolicyForPropertyName:propertyName];
+}
+
+- (NSString *)displayName
+{
+    self.displayNameComputationCount++;
+    return [NSString stringWithFormat:@"%@ %@", self.fontName, self.fontSize];
+}
+
+- (NSString *)summary
+{
+    return [NSString stringWithFormat:@"%@ in %@", [self displayName], self.textColorName];
+}
+
+@end
+
+
+@implementation AKTestTaggedItem
+@end
@@ -18,6 +18,55 @@ FOUNDATION_EXPORT NSString *const AKAncestorNonObjectPropertyException;
  */
 FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
 
+/**
+ *  Exception raised when a merge policy is declared for a property whose class it can't merge.
+ */
+FOUNDATION_EXPORT NSString *const AKAncestorInvalidMergePolicyException;
+
+/**
+ *  Describes where an instance's value for an inheritable property comes from.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorValueProvenance){
+    /**
+     *  Neither the instance nor any of its ancestors have a value for the property.
+     */
+    AKAncestorValueProvenanceNone = 0,
+    /**
+     *  The instance has its own value for the property.
+     */
+    AKAncestorValueProvenanceLocal,
+    /**
+     *  The value is inherited from one of the instance's ancestors.
+     */
+    AKAncestorValueProvenanceInherited,
+    /**
+     *  The instance has no value for the property and stopped inheriting it with -stopInheritingValuesForPropertyName:.
+     */
+    AKAncestorValueProvenanceIgnored
+};
+
+/**
+ *  Describes how an instance's own value for an inheritable property combines with the value it would otherwise inherit.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorMergePolicy){
+    /**
+     *  The instance's own value replaces the inherited one. This is the default.
+     */
+    AKAncestorMergePolicyReplace = 0,
+    /**
+     *  The instance's own array is appended to the inherited array.
+     */
+    AKAncestorMergePolicyConcatenate,
+    /**
+     *  The instance's own dictionary is merged over the inherited dictionary, so its entries win for keys in both.
+     */
+    AKAncestorMergePolicyMergeDictionaries,
+    /**
+     *  The instance's own set is combined with the inherited set.
+     */
+    AKAncestorMergePolicyUnionSets
+};
+
 
 /**
  *  AKAncestor a base class designed for subclasses to use as models or configuration objects. Subclasses can then inheirt property values from ancestor instances to limit the amount of configuration needed. Whenever a valid property on a descendant is nil, it will consult it's ancestor to try and find a value. In this way, you can view creating descendants as creating copies which remember their parent instance. This behavior can also be disabled per-property on individual instances. This ancestor is strongly retained by its descendants, so some caution is advised to avoid creating retain cycles.
@@ -25,8 +74,10 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
  *  AKAncestor also provides special attention to KVC if your descendants and ancestors need it. If a descendant is inheriting a property value from an ancestor, and that ancestor changes it's property value, the descendant also sends out a key-value notification so any observers on the descendant are properly informed. This behavior can also be disabled per-instance if KVC is not necessary. The inheritsKeyValueNotifications property indicates whether the receiver was configured to vend these notifications or not.
  *
  *  Subclasses should be aware that only object properties can be inherited. This happens automatically when a subclass is created, and the properties which can be inherited form the +propertiesPassedToDescendants set.
+ *
+ *  AKAncestor supports NSSecureCoding. Archives only contain each instance's own property values, the properties ignoring inherited values, and a reference to its ancestor. Keyed archivers encode each shared ancestor once, so a large tree sharing one root archives to roughly the size of its overrides. Subclasses with state outside of +propertiesPassedToDescendants should override -encodeWithCoder: and -initWithCoder: and call super.
  */
-@interface AKAncestor : NSObject
+@interface AKAncestor : NSObject <NSSecureCoding>
 
 #pragma mark - Creating descendants
 
@@ -39,6 +90,15 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
  */
 + (instancetype)descendantOf:(AKAncestor *)ancestor;
 
+/**
+ *  Creates a descendant of several ancestors. Equivalent to calling -initWithAncestors:inheritKeyValueNotifications: passing the given ancestors and the first ancestor's inheritsKeyValueNotifications value.
+ *
+ *  @param ancestors The ancestors to inherit from, in the order they're consulted. This may be nil or empty.
+ *
+ *  @return A new instance of the receiver which derives attributes from its ancestors.
+ */
++ (instancetype)descendantOfAncestors:(NSArray *)ancestors;
+
 /**
  *  Designated initializer. Connects an instance to a given ancestor, and optionally adds key-value observations on the ancestor to vend notifications about property changes. If performance is important or key-value compliance is not an issue, then it may be more efficient to pass NO for shouldInheritKeyValueNotifications, since it will remove the additional overhead of adding and processing those notifications. All convenience initializers of this class pass YES for shouldInheritKeyValueNotifications.
  *
@@ -49,6 +109,16 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
  */
 - (instancetype)initWithAncestor:(AKAncestor *)ancestor inheritKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications NS_DESIGNATED_INITIALIZER;
 
+/**
+ *  Connects an instance to several ancestors which are consulted in order, so a value can combine two sources like a theme and a feature's base configuration without building an artificial chain. The first ancestor becomes the ancestor property and the rest the fallbackAncestors, and each ancestor's chain is consulted in full before moving on to the next. Which ancestor supplies each property is cached alongside the receiver's value provenance, so reads don't probe each ancestor in turn. When inheriting key-value notifications, every ancestor is observed, and a fallback's change is only forwarded if no ancestor before it has a value. This calls -initWithAncestor:inheritKeyValueNotifications: with the first ancestor, so subclasses overriding it are still initialized. AKAncestorSnapshot and AKAncestorImporter describe trees with a single parent per node, so they only keep the first ancestor.
+ *
+ *  @param ancestors                          The AKAncestor instances to inherit property values from, in the order they're consulted. This may be nil or empty.
+ *  @param shouldInheritKeyValueNotifications YES to add key-value observations on each ancestor and vend notifications when inherited property values change, or NO to not add any key-value observations.
+ *
+ *  @return An initialized instance of the receiver which will inherit property values from its ancestors.
+ */
+- (instancetype)initWithAncestors:(NSArray *)ancestors inheritKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications;
+
 /**
  *  Equivalent to calling -initWithAncestor:inheritKeyValueNotifications: with nil and YES as the arguments.
  *
@@ -80,6 +150,16 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
  */
 @property (strong, nonatomic, readonly) id ancestor;
 
+/**
+ *  Returns the ancestors consulted after the ancestor property when the receiver was initialized with -initWithAncestors:inheritKeyValueNotifications:, or an empty array.
+ */
+@property (copy, nonatomic, readonly) NSArray *fallbackAncestors;
+
+/**
+ *  Returns every ancestor the receiver was initialized with in the order they're consulted, starting with the ancestor property.
+ */
+@property (copy, nonatomic, readonly) NSArray *ancestors;
+
 /**
  *  YES if the receiver inherits key-value notifications of inherited property values from its ancestor, or NO if it does not. Note that even if the ancestor property is nil, this can still be set to YES.
  */
@@ -114,6 +194,171 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
 @property (copy, nonatomic, readonly) NSSet *propertiesIgnoringInheritedValues;
 
 
+#pragma mark - Lazy values
+
+/**
+ *  Registers a block which provides the receiver's own value for a property the first time it's needed, either by reading the property on the receiver or by a descendant inheriting it. This avoids paying for expensive values, like decoded images or parsed fonts, which only some descendants use. The result is assigned with -setValue:forKey:, so it behaves exactly like a value set by hand afterwards, and the provider is discarded.
+ *
+ *  Concurrent first reads on different threads are coalesced: the block runs once, and every thread waiting on it receives the same result. If the block returns nil, the property keeps inheriting. A provider is only consulted while the receiver has no value of its own, so one registered after a value is assigned runs only if the value is later set back to nil. The block must not read the property it provides. Until it runs, provenance lookups report the receiver as providing the property, since reading it will run the block.
+ *
+ *  @param provider     The block computing the value, or nil to remove a provider which hasn't run yet.
+ *  @param propertyName The name of a property in the receiver's +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ */
+- (void)setValueProvider:(id (^)(void))provider forPropertyName:(NSString *)propertyName;
+
+
+#pragma mark - Querying descendants
+
+/**
+ *  Returns every live instance which has the receiver somewhere in its chain of ancestors, ordered by generation. Instances register with their ancestor when they're initialized, and the registry only holds them weakly, so descendants which have been deallocated are never returned.
+ */
+- (NSArray *)descendants;
+
+/**
+ *  Returns the live descendants whose value for the given property resolves from the receiver, meaning neither they nor any instance between them and the receiver have a value for the property or ignore it. Subtrees which hide the receiver's value are skipped entirely, so the cost is proportional to the number of matching descendants rather than the size of the tree. Subclass getters which transform inherited values are still considered to resolve from the receiver.
+ *
+ *  @param propertyName The name of a property in the receiver's +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ *
+ *  @return An array of descendants, ordered by generation.
+ */
+- (NSArray *)descendantsInheritingValueForPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the live descendants with their own value for the given property. This consults an index of the instances with a value for each property, kept by the root of each tree and updated by setters when an instance gains or loses a value, so the cost is proportional to the number of overriding instances in the tree rather than its size. Replacing one value with another doesn't touch the index, and writes to different trees never share a lock. Values assigned directly to instance variables aren't indexed.
+ *
+ *  @param propertyName The name of a property in the receiver's +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ *
+ *  @return An array of descendants in no particular order.
+ */
+- (NSArray *)descendantsOverridingPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the live descendants which stopped inheriting values for the given property with -stopInheritingValuesForPropertyName:. Like -descendantsOverridingPropertyName:, this consults an index rather than walking the tree.
+ *
+ *  @param propertyName The name of a property in the receiver's +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ *
+ *  @return An array of descendants in no particular order.
+ */
+- (NSArray *)descendantsIgnoringPropertyName:(NSString *)propertyName;
+
+
+#pragma mark - Value provenance
+
+/**
+ *  Returns the instance supplying the receiver's value for the given property: the receiver itself if it has its own value, the nearest ancestor with a value if it's inherited, or nil if the property is ignored or has no value anywhere in the chain. Provenance for every property is cached per instance, built from the ancestor's cached provenance, and rebuilt only after a setter or -stopInheritingValuesForPropertyName: is called on the receiver or one of its ancestors. Writes count themselves on every descendant they could affect, so checking that the cache is current reads a single counter and repeated lookups cost O(1) however deep the chain is. In exchange, each write costs time proportional to the number of the instance's descendants. Subclass getters which transform inherited values still report the ancestor the untransformed value came from.
+ *
+ *  @param propertyName The name of a property in the receiver's +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ *  @param provenance   On return, where the value comes from. This may be NULL.
+ *
+ *  @return The instance supplying the value, or nil.
+ */
+- (AKAncestor *)ancestorProvidingValueForPropertyName:(NSString *)propertyName provenance:(AKAncestorValueProvenance *)provenance;
+
+/**
+ *  Equivalent to calling -ancestorProvidingValueForPropertyName:provenance: passing NULL for the provenance.
+ */
+- (AKAncestor *)ancestorProvidingValueForPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the provenance of every property in +propertiesPassedToDescendants from the same cache as -ancestorProvidingValueForPropertyName:provenance:.
+ *
+ *  @return A dictionary mapping property names to NSNumbers wrapping AKAncestorValueProvenance values.
+ */
+- (NSDictionary *)provenanceOfValues;
+
+/**
+ *  Returns the instances supplying the receiver's values, from the same cache as -ancestorProvidingValueForPropertyName:provenance:.
+ *
+ *  @return A dictionary mapping the names of properties with a value to the instance supplying it. Ignored properties and those without a value anywhere in the chain are omitted.
+ */
+- (NSDictionary *)ancestorsProvidingValues;
+
+
+#pragma mark - Comparing instances
+
+/**
+ *  Returns the names of inheritable properties whose effective values differ between the receiver and another instance. Rather than resolving every property on both instances, this locates the nearest ancestor the two instances share and only compares properties which are overridden, waiting on a value provider, ignored, or transformed by a subclass getter somewhere between that ancestor and either instance. Each instance keeps these properties as sets, so for instances of the same class the cost is proportional to the overrides between them rather than to the number of properties multiplied by the depth of the chain. Each instance between them whose class differs from the common ancestor's also costs one visit per property, to find the properties the ancestor doesn't pass on.
+ *
+ *  Values are compared using -isEqual:, and only properties which both classes pass to descendants are considered.
+ *
+ *  @param otherAncestor The instance to compare against. This must not be nil.
+ *
+ *  @return A set of property names whose values differ. The set is empty if the instances resolve identical values.
+ */
+- (NSSet *)propertyNamesDifferingFrom:(AKAncestor *)otherAncestor;
+
+
+#pragma mark - Value semantics
+
+/**
+ *  Returns YES if -isEqual: and -hash should compare the effective values of +propertiesPassedToDescendants rather than identity. Defaults to NO. Subclasses used as keys of caches, for example to memoize layout computed from a configuration, can override this to return YES.
+ *
+ *  Equal instances must have the same class, but needn't share ancestors or overrides as long as every inheritable property resolves to an equal value. Like any mutable key, an instance shouldn't change while it's stored in a hashed collection, and this includes changes to its ancestors. Since NSDictionary copies its keys, use NSMapTable, NSCache or NSSet for instances.
+ */
++ (BOOL)comparesEffectiveValues;
+
+/**
+ *  Returns YES if the receiver and another instance have the same class and resolve equal values for every inheritable property, regardless of +comparesEffectiveValues. Instances whose cached hashes differ are rejected without resolving any values.
+ *
+ *  @param otherAncestor The instance to compare against. This may be nil.
+ *
+ *  @return YES if the instances have equal effective values, or NO if they do not.
+ */
+- (BOOL)isEqualToAncestor:(AKAncestor *)otherAncestor;
+
+/**
+ *  Returns a hash of the receiver's class and the effective values of its inheritable properties, regardless of +comparesEffectiveValues. The hash is cached, and is only calculated again after a value of the receiver or one of its ancestors changes through a setter, or when inheritance is stopped or resumed along the chain. Checking the cache reads a single counter and doesn't resolve any values. Values assigned directly to instance variables aren't noticed.
+ */
+- (NSUInteger)effectiveValueHash;
+
+
+#pragma mark - Merging collections
+
+/**
+ *  Returns how an instance's own value for the given property combines with the value it would otherwise inherit. Defaults to AKAncestorMergePolicyReplace. Subclasses can override this so descendants extend collections they inherit, like adding attributes over inherited ones, rather than replacing them.
+ *
+ *  Policies other than AKAncestorMergePolicyReplace require properties whose class is NSArray, NSDictionary, or NSSet respectively, or id, or an AKAncestorInvalidMergePolicyException is raised when AKAncestor loads. Values of other classes found at runtime simply replace the inherited value. Merging applies at each link of the chain, so a value accumulates the contributions of every ancestor which doesn't ignore the property.
+ *
+ *  Each merged result is cached per instance along with the values it was merged from, and reused as long as nothing along the receiver's chain or its fallbacks changed since. Checking this reads a single counter which writes along the chain keep current, so a steady state read doesn't call the ancestors' getters or take their locks. When something else along the chain changed, the inherited value is resolved again and the cached result is still reused if both sources are the same objects. Values are compared by identity, so collections must not be mutated after they're assigned; declaring the properties copy avoids this.
+ *
+ *  @param propertyName The name of a property in +propertiesPassedToDescendants.
+ *
+ *  @return The merge policy of the property.
+ */
++ (AKAncestorMergePolicy)mergePolicyForPropertyName:(NSString *)propertyName;
+
+
+#pragma mark - Derived properties
+
+/**
+ *  Returns the names of methods whose results should be cached per instance. Defaults to an empty set. Subclasses can override this for methods which compute an expensive object, like a font or an attributed string, from inheritable properties.
+ *
+ *  Each name must be an instance method taking no arguments and returning an object. Derived values declared as properties should also be removed from +propertiesPassedToDescendants, or they'll be treated as inheritable instead. Like inherited getters, a derived getter overridden by a further subclass isn't cached. Unknown names raise an AKAncestorUnknownPropertyException, and methods returning anything other than an object raise an AKAncestorNonObjectPropertyException when AKAncestor loads.
+ *
+ *  While a derived value is computed, every inheritable property it reads on any instance is recorded, including those read through other derived properties. Later calls first check whether anything changed along the ancestor chains of those instances, which doesn't resolve any values. Only if something did are the recorded properties resolved again, and the value is only computed again if one of them changed. State outside of +propertiesPassedToDescendants isn't tracked, so call -invalidateDerivedValues when it changes.
+ *
+ *  Derived properties send key-value notifications whenever one of the receiver's inheritable properties changes, including changes inherited from ancestors if the receiver inherits key-value notifications.
+ */
++ (NSSet *)derivedPropertyNames;
+
+/**
+ *  Discards the cached values of every derived property of the receiver, sending key-value notifications for each of them.
+ */
+- (void)invalidateDerivedValues;
+
+
+#pragma mark - Archiving
+
+/**
+ *  Returns the classes a value of the given property may have when an instance is decoded with NSSecureCoding. Defaults to the property's declared class. Properties declared as id have no declared class, so this returns nil for them and secure decoding of an archive holding their value raises an NSInvalidUnarchiveOperationException. Subclasses with such properties can override this to list the classes they expect.
+ *
+ *  @param propertyName The name of a property in +propertiesPassedToDescendants, or an AKAncestorUnknownPropertyException is raised.
+ *
+ *  @return The classes allowed for the property's value, or nil if none are.
+ */
++ (NSSet *)allowedClassesForDecodingPropertyName:(NSString *)propertyName;
+
+
 #pragma mark - Reflection
 
 /**
@@ -123,4 +368,11 @@ FOUNDATION_EXPORT NSString *const AKAncestorUnknownPropertyException;
  */
 + (NSSet *)propertiesPassedToDescendants;
 
+/**
+ *  Prepares a subclass created at runtime, such as with objc_allocateClassPair(), to inherit values. Subclasses which exist when AKAncestor loads are prepared automatically, but classes registered afterwards must be passed here once they're registered with the runtime and before any instances are created. Superclasses which haven't been prepared yet are prepared along with the subclass, and classes which already were are left alone, so this is safe to call more than once.
+ *
+ *  @param subclass The subclass to prepare. If this isn't a subclass of AKAncestor an NSInvalidArgumentException is raised, and if one of its properties can't be inherited an AKAncestorNonObjectPropertyException or AKAncestorInvalidMergePolicyException is raised.
+ */
++ (void)registerRuntimeSubclass:(Class)subclass;
+
 @end
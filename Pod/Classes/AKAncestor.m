@@ -7,29 +7,332 @@
 //
 
 #import "AKAncestor.h"
+#import "AKAncestor_Private.h"
 #import "AKPropertyDescription.h"
+#import "AKAncestorClassInfo.h"
+#import "AKAncestorDescriptionWriter.h"
+#import "AKAncestorDependencyRecorder.h"
+#import "AKAncestorStatistics_Private.h"
+#import "AKAncestorTrace_Private.h"
+#import "AKAncestorResolutionHistogram_Private.h"
+#import "AKAncestorPlatform.h"
+#import <objc/message.h>
 #import <objc/runtime.h>
-#import <libkern/OSAtomic.h>
 
 NSString *const AKAncestorNonObjectPropertyException = @"AKAncestorNonObjectPropertyException";
 NSString *const AKAncestorUnknownPropertyException = @"AKAncestorUnknownPropertyException";
+NSString *const AKAncestorInvalidMergePolicyException = @"AKAncestorInvalidMergePolicyException";
 
 static void *AKAncestorKVOContext = &AKAncestorKVOContext;
 
+static NSString *const AKAncestorIgnoredPropertyNamesCodingKey = @"ak_ignoredPropertyNames";
+static NSString *const AKAncestorIgnoresKeyValueNotificationsCodingKey = @"ak_ignoresKeyValueNotifications";
+static NSString *const AKAncestorPropertyValueCodingKeyPrefix = @"ak_value.";
+
+static volatile int64_t AKAncestorLastSerialNumber = 0;
+
+@class AKAncestorProvenanceTable;
+@class AKAncestorPropertyIndex;
+
 @interface AKAncestor ()
 {
     // Spin locks require using an Ivar or a static variable, so unfortunately we can't enjoy property goodness here.
     OSSpinLock _ak_spinLock;
+    
+    // Unique among every instance the process creates, unlike addresses which are reused once an instance is deallocated.
+    int64_t _ak_serialNumber;
+    
+    // Incremented whenever the receiver's own values or ignored properties change.
+    volatile int64_t _ak_mutationCount;
+    
+    // Incremented along with the mutation count of the receiver or any instance it inherits from, so it changes whenever anything the receiver resolves could have changed. Writes push it down to descendants so that caches check it with a single read.
+    volatile int64_t _ak_lineageMutationCount;
+    
+    NSUInteger _ak_effectiveValueHash;
+    int64_t _ak_effectiveValueHashMutationCount;
+    
+    // Set once while initializing and never changed, so it's read without the spin lock. Nil unless there are fallbacks.
+    NSArray *_ak_fallbackAncestors;
+    
+    // Written under the spin lock, but getters read it without one to skip looking for value providers when there aren't any.
+    volatile NSUInteger _ak_valueProviderCount;
+    
+    // The roots of every chain the receiver inherits from, whose property indexes list it. Set once while initializing and never changed, so it's read without the spin lock. Nil for roots, which index their own descendants.
+    NSArray *_ak_indexRoots;
 }
 
 @property (strong, nonatomic, readonly) NSMutableSet *ak_ignoredPropertyNames;
+@property (strong, nonatomic) NSMutableSet *ak_overriddenPropertyNames;
+@property (strong, nonatomic) NSMutableDictionary *ak_derivedValues;
+@property (strong, nonatomic) NSHashTable *ak_descendants;
+@property (strong, nonatomic) AKAncestorProvenanceTable *ak_provenanceTable;
+@property (strong, nonatomic) NSMutableDictionary *ak_mergedValues;
+@property (strong, nonatomic) NSMutableDictionary *ak_valueProviders;
+@property (strong, nonatomic) AKAncestorPropertyIndex *ak_propertyIndex;
+
+@end
+
+
+/**
+ *  A cached result of a derived property, along with what it was computed from. Instances are immutable so they can be read outside of the spin lock.
+ */
+@interface AKAncestorDerivedValue : NSObject
+
+@property (strong, nonatomic, readonly) id value;
+@property (strong, nonatomic, readonly) AKAncestorDependencyRecorder *dependencies;
+@property (assign, nonatomic, readonly) int64_t lineageMutationCount;
+
+@end
+
+@implementation AKAncestorDerivedValue
+
+- (instancetype)initWithValue:(id)value dependencies:(AKAncestorDependencyRecorder *)dependencies lineageMutationCount:(int64_t)lineageMutationCount
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _value = value;
+    _dependencies = dependencies;
+    _lineageMutationCount = lineageMutationCount;
+    
+    return self;
+}
+
+@end
+
+
+/**
+ *  The cached provenance of every inheritable property of an instance, indexed like its class info, along with the index of the ancestor the instance resolves each inherited value from. Providers aren't retained since they're the instance itself or one of its ancestors, which it already retains. Instances are immutable so they can be read outside of the spin lock.
+ */
+@interface AKAncestorProvenanceTable : NSObject
+{
+    @public
+    AKAncestorValueProvenance *_provenances;
+    __unsafe_unretained AKAncestor **_providers;
+    NSUInteger *_ancestorIndexes;
+}
+
+@property (assign, nonatomic, readonly) NSUInteger count;
+@property (assign, nonatomic, readonly) int64_t lineageMutationCount;
+
+@end
+
+@implementation AKAncestorProvenanceTable
+
+- (instancetype)initWithCount:(NSUInteger)count lineageMutationCount:(int64_t)lineageMutationCount
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _count = count;
+    _lineageMutationCount = lineageMutationCount;
+    _provenances = calloc(MAX(count, 1), sizeof(AKAncestorValueProvenance));
+    _providers = (__unsafe_unretained AKAncestor **)calloc(MAX(count, 1), sizeof(AKAncestor *));
+    _ancestorIndexes = malloc(MAX(count, 1) * sizeof(NSUInteger));
+    
+    for (NSUInteger index = 0; index < count; index++)
+    {
+        _ancestorIndexes[index] = NSNotFound;
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_provenances);
+    free(_providers);
+    free(_ancestorIndexes);
+}
+
+@end
+
+
+/**
+ *  A cached result of merging a collection property, along with the values it was merged from and the lineage mutation count read before they were resolved. Retaining the source values keeps their addresses from being reused, so comparing them by identity is safe. Instances are immutable so they can be read outside of the spin lock.
+ */
+@interface AKAncestorMergedValue : NSObject
+
+@property (strong, nonatomic, readonly) id value;
+@property (strong, nonatomic, readonly) id localValue;
+@property (strong, nonatomic, readonly) id inheritedValue;
+@property (assign, nonatomic, readonly) int64_t lineageMutationCount;
+
+@end
+
+@implementation AKAncestorMergedValue
+
+- (instancetype)initWithValue:(id)value localValue:(id)localValue inheritedValue:(id)inheritedValue lineageMutationCount:(int64_t)lineageMutationCount
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _value = value;
+    _localValue = localValue;
+    _inheritedValue = inheritedValue;
+    _lineageMutationCount = lineageMutationCount;
+    
+    return self;
+}
+
+@end
+
+
+/**
+ *  A value provider registered with -setValueProvider:forPropertyName:. The lock is held while the block runs, so threads arriving meanwhile wait for its result instead of running it again. The spin lock isn't suitable since waiters could spin for as long as the block takes.
+ */
+@interface AKAncestorValueProvider : NSObject
+
+@property (copy, nonatomic, readonly) id (^block)(void);
+@property (strong, nonatomic, readonly) NSLock *lock;
+@property (assign, nonatomic, getter=isResolved) BOOL resolved;
+@property (strong, nonatomic) id value;
+
+@end
+
+@implementation AKAncestorValueProvider
+
+- (instancetype)initWithBlock:(id (^)(void))block
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _block = [block copy];
+    _lock = [NSLock new];
+    
+    return self;
+}
+
+@end
+
+/**
+ *  The instances with a local value for, or ignoring inheritance of, each property among the descendants of one root. Each root keeps its own index behind its own lock, so writes to different trees never contend. Tables hold instances weakly and compare them by identity, since instances with value semantics change their hash.
+ */
+@interface AKAncestorPropertyIndex : NSObject
+{
+    OSSpinLock _spinLock;
+}
+
+@property (strong, nonatomic, readonly) NSMutableDictionary *overridingInstancesByPropertyName;
+@property (strong, nonatomic, readonly) NSMutableDictionary *ignoringInstancesByPropertyName;
+
+@end
+
+@implementation AKAncestorPropertyIndex
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _spinLock = OS_SPINLOCK_INIT;
+    _overridingInstancesByPropertyName = [NSMutableDictionary dictionary];
+    _ignoringInstancesByPropertyName = [NSMutableDictionary dictionary];
+    
+    return self;
+}
+
+- (void)setInstance:(AKAncestor *)instance isIndexed:(BOOL)isIndexed forPropertyName:(NSString *)propertyName inInstancesByPropertyName:(NSMutableDictionary *)instancesByPropertyName
+{
+    OSSpinLockLock(&_spinLock);
+    
+    NSHashTable *instances = instancesByPropertyName[propertyName];
+    if (isIndexed)
+    {
+        if (!instances)
+        {
+            instances = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality];
+            instancesByPropertyName[propertyName] = instances;
+        }
+        
+        [instances addObject:instance];
+    }
+    else
+    {
+        [instances removeObject:instance];
+    }
+    
+    OSSpinLockUnlock(&_spinLock);
+}
+
+- (NSArray *)instancesForPropertyName:(NSString *)propertyName inInstancesByPropertyName:(NSMutableDictionary *)instancesByPropertyName
+{
+    OSSpinLockLock(&_spinLock);
+    NSArray *instances = [instancesByPropertyName[propertyName] allObjects];
+    OSSpinLockUnlock(&_spinLock);
+    
+    return instances ?: @[];
+}
 
 @end
 
+
 @implementation AKAncestor
 
+#pragma mark - Merging
+
+static Class AKAncestorMergedClass(AKAncestorMergePolicy policy)
+{
+    switch (policy)
+    {
+        case AKAncestorMergePolicyConcatenate:
+            return [NSArray class];
+        case AKAncestorMergePolicyMergeDictionaries:
+            return [NSDictionary class];
+        case AKAncestorMergePolicyUnionSets:
+            return [NSSet class];
+        case AKAncestorMergePolicyReplace:
+            return Nil;
+    }
+    
+    return Nil;
+}
+
+static id AKAncestorMergeValues(AKAncestorMergePolicy policy, id inheritedValue, id localValue)
+{
+    Class mergedClass = AKAncestorMergedClass(policy);
+    if (!mergedClass || ![inheritedValue isKindOfClass:mergedClass] || ![localValue isKindOfClass:mergedClass])
+    {
+        return localValue;
+    }
+    
+    switch (policy)
+    {
+        case AKAncestorMergePolicyConcatenate:
+            return [(NSArray *)inheritedValue arrayByAddingObjectsFromArray:localValue];
+        case AKAncestorMergePolicyMergeDictionaries:
+        {
+            NSMutableDictionary *mergedValue = [inheritedValue mutableCopy];
+            [mergedValue addEntriesFromDictionary:localValue];
+            return [mergedValue copy];
+        }
+        case AKAncestorMergePolicyUnionSets:
+            return [(NSSet *)inheritedValue setByAddingObjectsFromSet:localValue];
+        case AKAncestorMergePolicyReplace:
+            return localValue;
+    }
+    
+    return localValue;
+}
+
+
 #pragma mark - Swizzling
 
+// While resolution histograms are enabled, each getter leaves the depth it resolved at for the descendant which consulted it, and the nesting level tells the outermost getter apart so only it's sampled. The depth is unknown if the ancestor's getter wasn't swizzled, or started measuring after histograms were enabled.
+static const NSInteger AKAncestorResolutionDepthUnknown = -2;
+static __thread NSInteger AKAncestorLastResolutionDepth = AKAncestorResolutionDepthUnknown;
+static __thread NSUInteger AKAncestorResolutionNestingLevel;
+
 static NSArray *AKAncestorSubclasses()
 {
     unsigned int classCount;
@@ -83,15 +386,7 @@ static NSArray *AKAncestorSubclasses()
     return subclasses;
 }
 
-static SEL AKAncestorSwizzledPropertyGetter(AKPropertyDescription *property)
-{
-    NSCParameterAssert(property);
-    
-    NSString *selectorString = [NSString stringWithFormat:@"_ak_%@", NSStringFromSelector(property.propertyGetter)];
-    return NSSelectorFromString(selectorString);
-}
-
-static void AKAncestorSwizzlePropertyGetter(Class class, AKPropertyDescription *property)
+static void AKAncestorSwizzlePropertyGetter(Class class, AKPropertyDescription *property, BOOL mergesValues)
 {
     NSCParameterAssert(class);
     NSCParameterAssert(property);
@@ -117,32 +412,102 @@ static void AKAncestorSwizzlePropertyGetter(Class class, AKPropertyDescription *
     IMP originalImplementation = class_getMethodImplementation(class, originalGetter);
     
     NSString *propertyName = property.propertyName;
+    const char *tracedPropertyName = AKAncestorTraceInternedName(propertyName);
     IMP swizzledImplementation = imp_implementationWithBlock(^id (id self) {
-        NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self methodSignatureForSelector:swizzledGetter]];
+        uint64_t traceTimestamp = AKAncestorTraceBegin();
+        BOOL measuresDepth = AKAncestorResolutionHistogramIsEnabled();
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventGetterCall, self, propertyName);
+        
+        // While a derived property is being computed, the value resolved here is recorded as one of its dependencies. The count is read first so that changes made after it are always noticed, and recording is paused so ancestors resolving the value don't record it again.
+        AKAncestorDependencyRecorder *recorder = AKAncestorCurrentDependencyRecorder();
+        int64_t lineageMutationCount = 0;
+        if (recorder)
+        {
+            lineageMutationCount = [self _lineageMutationCount];
+            AKAncestorSetCurrentDependencyRecorder(nil);
+        }
+        
+        // Using the swizzled getter will act as though we are retreiving the property normally. Inherited properties are always objects without arguments, so the getters are messaged directly rather than through an NSInvocation, which would allocate on every read.
+        id returnValue = ((id (*)(id, SEL))objc_msgSend)(self, swizzledGetter);
         
-        // Using the swizzled getter will act as though we are retreiving the property normally.
-        [invocation setSelector:swizzledGetter];
-        [invocation invokeWithTarget:self];
+        // A lazily provided value counts as the receiver's own, so it's looked for before consulting ancestors.
+        if (!returnValue && ((AKAncestor *)self)->_ak_valueProviderCount > 0)
+        {
+            returnValue = [self _providedValueForPropertyName:propertyName];
+        }
         
-        __unsafe_unretained id returnValue;
-        [invocation getReturnValue:&returnValue];
+        // Only the receiver's own value is merged with the inherited one. A value found on an ancestor has already been merged there, if at all.
+        BOOL hasOwnValue = (returnValue != nil);
+        NSInteger resolutionDepth = (hasOwnValue) ? 0 : AKAncestorResolutionDepthMiss;
         
         OSSpinLockLock(&((AKAncestor *)self)->_ak_spinLock);
         BOOL isIgnoredProperty = [[self ak_ignoredPropertyNames] containsObject:propertyName];
         OSSpinLockUnlock(&((AKAncestor *)self)->_ak_spinLock);
         
-        // If there isn't a return value, we'll check the ancestor for a value
-        if (!returnValue && [self ancestor] && !isIgnoredProperty)
+        // If there isn't a return value, we'll check the ancestor for a value. With fallback ancestors, the cached provenance says which of them supplies it.
+        AKAncestor *ancestor = (!returnValue && !isIgnoredProperty) ? [self ancestor] : nil;
+        if (ancestor && ((AKAncestor *)self)->_ak_fallbackAncestors)
         {
-            // Note that we change the selector to the original getter, this ensures that if the ancestor doesn't have a value it can continue down the chain.
-            [invocation setSelector:originalGetter];
-            [invocation invokeWithTarget:[self ancestor]];
-            [invocation getReturnValue:&returnValue];
+            ancestor = [self _ancestorResolvingPropertyName:propertyName];
         }
         
+        if (ancestor)
+        {
+            AKAncestorStatisticsRecord(AKAncestorStatisticsEventAncestorHop, self, propertyName);
+            
+            if (measuresDepth)
+            {
+                AKAncestorResolutionNestingLevel++;
+                AKAncestorLastResolutionDepth = AKAncestorResolutionDepthUnknown;
+            }
+            
+            // Note that we use the original getter on the ancestor, this ensures that if the ancestor doesn't have a value it can continue down the chain.
+            returnValue = ((id (*)(id, SEL))objc_msgSend)(ancestor, originalGetter);
+            
+            if (measuresDepth)
+            {
+                AKAncestorResolutionNestingLevel--;
+                
+                NSInteger ancestorDepth = AKAncestorLastResolutionDepth;
+                if (ancestorDepth == AKAncestorResolutionDepthUnknown)
+                {
+                    resolutionDepth = (returnValue) ? 1 : AKAncestorResolutionDepthMiss;
+                }
+                else
+                {
+                    resolutionDepth = (ancestorDepth == AKAncestorResolutionDepthMiss) ? AKAncestorResolutionDepthMiss : ancestorDepth + 1;
+                }
+            }
+        }
+        
+        // Properties with a merge policy in some class combine their own value with the inherited one. Other properties don't pay for the check.
+        if (mergesValues && hasOwnValue && !isIgnoredProperty && [self ancestor])
+        {
+            returnValue = [self _mergedValueForPropertyName:propertyName localValue:returnValue];
+        }
+        
+        if (recorder)
+        {
+            AKAncestorSetCurrentDependencyRecorder(recorder);
+            [recorder recordValue:returnValue ofGetter:originalGetter onInstance:self lineageMutationCount:lineageMutationCount];
+        }
+        
+        if (measuresDepth)
+        {
+            AKAncestorLastResolutionDepth = resolutionDepth;
+            if (AKAncestorResolutionNestingLevel == 0)
+            {
+                AKAncestorResolutionHistogramSample(self, propertyName, resolutionDepth);
+            }
+        }
+        
+        AKAncestorTraceEnd(AKAncestorTraceEventResolution, self, tracedPropertyName, traceTimestamp);
+        
         return returnValue;
     });
     
+    AKAncestorRegisterInheritingImplementation(swizzledImplementation);
+    
     // Though this really shouldn't happen, first we try and add a method with the original selector to the class.
     if (!class_addMethod(class, originalGetter, swizzledImplementation, method_getTypeEncoding(originalMethod)))
     {
@@ -154,240 +519,1509 @@ static void AKAncestorSwizzlePropertyGetter(Class class, AKPropertyDescription *
     class_addMethod(class, swizzledGetter, originalImplementation, method_getTypeEncoding(originalMethod));
 }
 
-+ (void)load
+static void AKAncestorSwizzlePropertySetter(Class class, AKPropertyDescription *property)
 {
-    // Following the wisdom of http://nshipster.com/method-swizzling/ we put all swizzling in +load and a dispatch_once block
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
+    NSCParameterAssert(class);
+    NSCParameterAssert(property);
+    
+    if (property.isReadonly)
+    {
+        return;
+    }
+    
+    SEL originalSetter = property.propertySetter;
+    SEL swizzledSetter = AKAncestorSwizzledPropertySetter(property);
+    
+    Method originalMethod = class_getInstanceMethod(class, originalSetter);
+    Method swizzledMethod = class_getInstanceMethod(class, swizzledSetter);
+    
+    // Like getters, setters are only swizzled once. Properties without a setter implementation can't be changed through one, so there's nothing to wrap.
+    if (swizzledMethod || !originalMethod)
+    {
+        return;
+    }
+    
+    IMP originalImplementation = class_getMethodImplementation(class, originalSetter);
+    
+    NSString *propertyName = property.propertyName;
+    SEL localGetter = AKAncestorSwizzledPropertyGetter(property);
+    const char *tracedPropertyName = AKAncestorTraceInternedName(propertyName);
+    IMP swizzledImplementation = imp_implementationWithBlock(^(id self, id value) {
+        uint64_t traceTimestamp = AKAncestorTraceBegin();
         
-        // Following the wisdom of https://www.mikeash.com/pyblog/friday-qa-2009-05-22-objective-c-class-loading-and-initialization.html we wrap this in an autorelease pool since we're creating autoreleased objects in it.
-        @autoreleasepool {
-            
-            // We iterate through each subclass of AKAncestor and swizzle it's properties' getter methods.
-            for (Class subclass in AKAncestorSubclasses())
-            {
-                NSSet *propertiesToSwizzle = [subclass propertiesPassedToDescendants];
-                for (AKPropertyDescription *property in propertiesToSwizzle)
-                {
-                    AKAncestorSwizzlePropertyGetter(subclass, property);
-                }
-            }
-            
+        BOOL hadValue = (((id (*)(id, SEL))objc_msgSend)(self, localGetter) != nil);
+        ((void (*)(id, SEL, id))objc_msgSend)(self, swizzledSetter, value);
+        [self _noteLocalValuesDidChange];
+        
+        // Only gaining or losing a value changes the index, so replacing one value with another never takes its lock.
+        if (hadValue != (value != nil))
+        {
+            [self _setIndexed:(value != nil) forPropertyName:propertyName ignoring:NO];
         }
+        
+        AKAncestorTraceEnd(AKAncestorTraceEventWrite, self, tracedPropertyName, traceTimestamp);
     });
+    
+    if (!class_addMethod(class, originalSetter, swizzledImplementation, method_getTypeEncoding(originalMethod)))
+    {
+        originalImplementation = class_replaceMethod(class, originalSetter, swizzledImplementation, method_getTypeEncoding(originalMethod));
+    }
+    
+    class_addMethod(class, swizzledSetter, originalImplementation, method_getTypeEncoding(originalMethod));
 }
 
-
-#pragma mark - Lifecyle
-
-+ (instancetype)descendantOf:(AKAncestor *)ancestor
-{
-    return [[self alloc] initWithAncestor:ancestor inheritKeyValueNotifications:ancestor.inheritsKeyValueNotifications];
-}
-
-- (instancetype)initWithAncestor:(AKAncestor *)ancestor inheritKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications
+static void AKAncestorSwizzleDerivedPropertyGetter(Class class, NSString *propertyName)
 {
-    if (!(self = [super init]))
+    NSCParameterAssert(class);
+    NSCParameterAssert(propertyName);
+    
+    SEL originalGetter = NSSelectorFromString(propertyName);
+    SEL swizzledGetter = NSSelectorFromString([@"_ak_" stringByAppendingString:propertyName]);
+    
+    Method originalMethod = class_getInstanceMethod(class, originalGetter);
+    if (!originalMethod)
     {
-        return nil;
+        [NSException raise:AKAncestorUnknownPropertyException format:@"Derived property \"%@\" has no getter in %@", propertyName, class];
+        return;
     }
     
-    _ancestor = ancestor;
-    _ak_spinLock = OS_SPINLOCK_INIT;
-    _ak_ignoredPropertyNames = [NSMutableSet set];
+    char returnType[2] = {0};
+    method_getReturnType(originalMethod, returnType, sizeof(returnType));
+    if (returnType[0] != _C_ID || method_getNumberOfArguments(originalMethod) != 2)
+    {
+        [NSException raise:AKAncestorNonObjectPropertyException format:@"Derived property \"%@\" of %@ must be a getter returning an object", propertyName, class];
+        return;
+    }
     
-    _inheritsKeyValueNotifications = shouldInheritKeyValueNotifications;
-    if (_inheritsKeyValueNotifications && _ancestor)
+    // Like inherited getters, derived getters are only swizzled once, so overrides in subclasses aren't cached.
+    if (class_getInstanceMethod(class, swizzledGetter))
     {
-        [self _setupKeyValueObservationsOnAncestor:_ancestor];
+        return;
     }
     
-    return self;
-}
-
-- (instancetype)init
-{
-    return [self initWithAncestor:nil inheritKeyValueNotifications:YES];
-}
-
-- (instancetype)descendant
+    IMP originalImplementation = class_getMethodImplementation(class, originalGetter);
+    
+    IMP swizzledImplementation = imp_implementationWithBlock(^id (id self) {
+        return [self _derivedValueForKey:propertyName computingSelector:swizzledGetter];
+    });
+    
+    if (!class_addMethod(class, originalGetter, swizzledImplementation, method_getTypeEncoding(originalMethod)))
+    {
+        originalImplementation = class_replaceMethod(class, originalGetter, swizzledImplementation, method_getTypeEncoding(originalMethod));
+    }
+    
+    class_addMethod(class, swizzledGetter, originalImplementation, method_getTypeEncoding(originalMethod));
+}
+
+static NSMutableSet *AKAncestorMergedPropertyNames()
+{
+    static NSMutableSet *mergedPropertyNames;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mergedPropertyNames = [NSMutableSet set];
+    });
+    
+    return mergedPropertyNames;
+}
+
+static void AKAncestorCollectMergedPropertyNames(Class subclass)
+{
+    for (AKPropertyDescription *property in [subclass propertiesPassedToDescendants])
+    {
+        AKAncestorMergePolicy policy = [subclass mergePolicyForPropertyName:property.propertyName];
+        if (policy == AKAncestorMergePolicyReplace)
+        {
+            continue;
+        }
+        
+        Class mergedClass = AKAncestorMergedClass(policy);
+        if (!mergedClass || (property.propertyClass && ![property.propertyClass isSubclassOfClass:mergedClass]))
+        {
+            [NSException raise:AKAncestorInvalidMergePolicyException format:@"Property \"%@\" of %@ can't be merged with policy %ld", property.propertyName, subclass, (long)policy];
+        }
+        
+        [AKAncestorMergedPropertyNames() addObject:property.propertyName];
+    }
+}
+
+static void AKAncestorSwizzleSubclass(Class subclass)
+{
+    NSSet *mergedPropertyNames = AKAncestorMergedPropertyNames();
+    
+    NSSet *propertiesToSwizzle = [subclass propertiesPassedToDescendants];
+    for (AKPropertyDescription *property in propertiesToSwizzle)
+    {
+        AKAncestorSwizzlePropertyGetter(subclass, property, [mergedPropertyNames containsObject:property.propertyName]);
+        AKAncestorSwizzlePropertySetter(subclass, property);
+    }
+    
+    for (NSString *propertyName in [subclass derivedPropertyNames])
+    {
+        AKAncestorSwizzleDerivedPropertyGetter(subclass, propertyName);
+    }
+}
+
++ (void)load
+{
+    // Following the wisdom of http://nshipster.com/method-swizzling/ we put all swizzling in +load and a dispatch_once block
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        
+        // Following the wisdom of https://www.mikeash.com/pyblog/friday-qa-2009-05-22-objective-c-class-loading-and-initialization.html we wrap this in an autorelease pool since we're creating autoreleased objects in it.
+        @autoreleasepool {
+            
+            NSArray *subclasses = AKAncestorSubclasses();
+            
+            // Getters are shared between a class and its subclasses, so a property's getter merges values if any class declares a merge policy for it.
+            for (Class subclass in subclasses)
+            {
+                AKAncestorCollectMergedPropertyNames(subclass);
+            }
+            
+            // We iterate through each subclass of AKAncestor and swizzle it's properties' getter methods, and the setters so changes to values can be tracked.
+            for (Class subclass in subclasses)
+            {
+                AKAncestorSwizzleSubclass(subclass);
+            }
+            
+        }
+    });
+}
+
++ (void)registerRuntimeSubclass:(Class)subclass
+{
+    if (!subclass || subclass == [AKAncestor class] || ![subclass isSubclassOfClass:[AKAncestor class]])
+    {
+        [NSException raise:NSInvalidArgumentException format:@"%@ is not a subclass of AKAncestor.", subclass];
+    }
+    
+    // Like in +load, superclasses are swizzled first. Swizzling is skipped for properties which already were, so classes which existed at load time pass through untouched.
+    NSMutableArray *subclasses = [NSMutableArray array];
+    for (Class currentClass = subclass; currentClass != [AKAncestor class]; currentClass = class_getSuperclass(currentClass))
+    {
+        [subclasses insertObject:currentClass atIndex:0];
+    }
+    
+    // Subclasses may be registered from any thread, and an invalid merge policy raises, which @synchronized unlocks for.
+    @synchronized([AKAncestor class])
+    {
+        for (Class currentClass in subclasses)
+        {
+            AKAncestorCollectMergedPropertyNames(currentClass);
+        }
+        
+        for (Class currentClass in subclasses)
+        {
+            AKAncestorSwizzleSubclass(currentClass);
+        }
+    }
+}
+
+
+#pragma mark - Lifecyle
+
++ (instancetype)descendantOf:(AKAncestor *)ancestor
+{
+    return [[self alloc] initWithAncestor:ancestor inheritKeyValueNotifications:ancestor.inheritsKeyValueNotifications];
+}
+
++ (instancetype)descendantOfAncestors:(NSArray *)ancestors
+{
+    return [[self alloc] initWithAncestors:ancestors inheritKeyValueNotifications:[ancestors.firstObject inheritsKeyValueNotifications]];
+}
+
+- (instancetype)initWithAncestor:(AKAncestor *)ancestor inheritKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _ancestor = ancestor;
+    _ak_serialNumber = OSAtomicIncrement64Barrier(&AKAncestorLastSerialNumber);
+    _ak_spinLock = OS_SPINLOCK_INIT;
+    _ak_ignoredPropertyNames = [NSMutableSet set];
+    _ak_effectiveValueHashMutationCount = -1;
+    
+    if (_ancestor)
+    {
+        _ak_indexRoots = [_ancestor _indexRoots];
+        [_ancestor _registerDescendant:self];
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventDescendantCreation, self, nil);
+        AKAncestorTraceInstant(AKAncestorTraceEventDescendantCreation, self);
+    }
+    
+    _inheritsKeyValueNotifications = shouldInheritKeyValueNotifications;
+    if (_inheritsKeyValueNotifications && _ancestor)
+    {
+        [self _setupKeyValueObservationsOnAncestor:_ancestor];
+    }
+    
+    return self;
+}
+
+- (instancetype)initWithAncestors:(NSArray *)ancestors inheritKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications
+{
+    for (id ancestor in ancestors)
+    {
+        if (![ancestor isKindOfClass:[AKAncestor class]])
+        {
+            [NSException raise:NSInvalidArgumentException format:@"Ancestors must be AKAncestor instances, but got %@.", [ancestor class]];
+        }
+    }
+    
+    if (!(self = [self initWithAncestor:ancestors.firstObject inheritKeyValueNotifications:shouldInheritKeyValueNotifications]))
+    {
+        return nil;
+    }
+    
+    if (ancestors.count < 2)
+    {
+        return self;
+    }
+    
+    // The fallbacks are connected before the instance is handed out, so nothing can observe it with only its first ancestor.
+    _ak_fallbackAncestors = [ancestors subarrayWithRange:NSMakeRange(1, ancestors.count - 1)];
+    for (AKAncestor *fallbackAncestor in _ak_fallbackAncestors)
+    {
+        for (AKAncestor *root in [fallbackAncestor _indexRoots])
+        {
+            if ([_ak_indexRoots indexOfObjectIdenticalTo:root] == NSNotFound)
+            {
+                _ak_indexRoots = [_ak_indexRoots arrayByAddingObject:root];
+            }
+        }
+        
+        [fallbackAncestor _registerDescendant:self];
+        
+        if (_inheritsKeyValueNotifications)
+        {
+            [self _setupKeyValueObservationsOnAncestor:fallbackAncestor];
+        }
+    }
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithAncestor:nil inheritKeyValueNotifications:YES];
+}
+
+- (instancetype)descendant
 {
     return [self descendantInheritingKeyValueNotifications:self.inheritsKeyValueNotifications];
 }
 
-- (instancetype)descendantInheritingKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications
+- (instancetype)descendantInheritingKeyValueNotifications:(BOOL)shouldInheritKeyValueNotifications
+{
+    return [[[self class] alloc] initWithAncestor:self inheritKeyValueNotifications:shouldInheritKeyValueNotifications];
+}
+
+- (void)dealloc
+{
+    if (_ancestor)
+    {
+        AKAncestorTraceInstant(AKAncestorTraceEventDescendantDeallocation, self);
+    }
+    
+    if (_inheritsKeyValueNotifications && _ancestor)
+    {
+        [self _removeKeyValueObservationsOnAncestor:_ancestor];
+    }
+    
+    if (_inheritsKeyValueNotifications)
+    {
+        for (AKAncestor *fallbackAncestor in _ak_fallbackAncestors)
+        {
+            [self _removeKeyValueObservationsOnAncestor:fallbackAncestor];
+        }
+    }
+}
+
+
+#pragma mark - Initialization properties
+
+- (NSArray *)fallbackAncestors
+{
+    return _ak_fallbackAncestors ?: @[];
+}
+
+- (NSArray *)ancestors
+{
+    if (!_ancestor)
+    {
+        return @[];
+    }
+    
+    return (_ak_fallbackAncestors) ? [@[_ancestor] arrayByAddingObjectsFromArray:_ak_fallbackAncestors] : @[_ancestor];
+}
+
+
+#pragma mark - Limiting property inheritance
+
+- (void)stopInheritingValuesForPropertyName:(NSString *)propertyName
+{
+    // Create a copy to prevent any shady business
+    NSString *name = [propertyName copy];
+    
+    if ([[AKAncestorClassInfo classInfoForClass:[self class]] indexOfPropertyName:name] == NSNotFound)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", name, [self class]];
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    [self.ak_ignoredPropertyNames addObject:name];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    [self _noteLocalValuesDidChange];
+    [self _setIndexed:YES forPropertyName:name ignoring:YES];
+}
+
+- (void)resumeInheritingValuesForPropertyName:(NSString *)propertyName
+{
+    // Create a copy to prevent any shady business
+    NSString *name = [propertyName copy];
+    
+    OSSpinLockLock(&_ak_spinLock);
+    [self.ak_ignoredPropertyNames removeObject:name];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    [self _noteLocalValuesDidChange];
+    [self _setIndexed:NO forPropertyName:name ignoring:YES];
+}
+
+- (NSSet *)propertiesIgnoringInheritedValues
+{
+    OSSpinLockLock(&_ak_spinLock);
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K IN %@", NSStringFromSelector(@selector(propertyName)), self.ak_ignoredPropertyNames];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    return [[[self class] propertiesPassedToDescendants] filteredSetUsingPredicate:predicate];
+}
+
+
+#pragma mark - Comparing instances
+
+- (NSSet *)propertyNamesDifferingFrom:(AKAncestor *)otherAncestor
+{
+    NSParameterAssert(otherAncestor);
+    
+    if (otherAncestor == self)
+    {
+        return [NSSet set];
+    }
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    AKAncestorClassInfo *otherClassInfo = [AKAncestorClassInfo classInfoForClass:[otherAncestor class]];
+    
+    NSMutableSet *candidateNames = [NSMutableSet set];
+    
+    AKAncestor *commonAncestor = [self _commonAncestorWith:otherAncestor];
+    if (commonAncestor)
+    {
+        // Both instances resolve the same value from the common ancestor, so only something between it and either instance can make their values differ.
+        [self _addPropertyNamesAffectingValuesInheritedFrom:commonAncestor toSet:candidateNames];
+        [otherAncestor _addPropertyNamesAffectingValuesInheritedFrom:commonAncestor toSet:candidateNames];
+    }
+    else
+    {
+        [candidateNames addObjectsFromArray:classInfo.propertyNames];
+    }
+    
+    NSMutableSet *differingNames = [NSMutableSet set];
+    for (NSString *propertyName in candidateNames)
+    {
+        NSUInteger index = [classInfo indexOfPropertyName:propertyName];
+        NSUInteger otherIndex = [otherClassInfo indexOfPropertyName:propertyName];
+        
+        // Only properties that both instances pass to descendants can be compared.
+        if (index == NSNotFound || otherIndex == NSNotFound)
+        {
+            continue;
+        }
+        
+        id value = ((id (*)(id, SEL))objc_msgSend)(self, [classInfo getterAtIndex:index]);
+        id otherValue = ((id (*)(id, SEL))objc_msgSend)(otherAncestor, [otherClassInfo getterAtIndex:otherIndex]);
+        
+        if (value != otherValue && ![value isEqual:otherValue])
+        {
+            [differingNames addObject:propertyName];
+        }
+    }
+    
+    return [differingNames copy];
+}
+
+
+#pragma mark - Lazy values
+
+- (void)setValueProvider:(id (^)(void))provider forPropertyName:(NSString *)propertyName
+{
+    [self _validatePropertyName:propertyName];
+    
+    AKAncestorValueProvider *valueProvider = (provider) ? [[AKAncestorValueProvider alloc] initWithBlock:provider] : nil;
+    
+    OSSpinLockLock(&_ak_spinLock);
+    if (!self.ak_valueProviders)
+    {
+        self.ak_valueProviders = [NSMutableDictionary dictionary];
+    }
+    self.ak_valueProviders[propertyName] = valueProvider;
+    _ak_valueProviderCount = self.ak_valueProviders.count;
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    // A pending provider counts as a local value, so caches which resolved the property without it are stale.
+    [self _noteLocalValuesDidChange];
+}
+
+
+#pragma mark - Querying descendants
+
+- (NSArray *)descendants
+{
+    NSMutableArray *descendants = [NSMutableArray array];
+    NSHashTable *visitedDescendants = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    
+    // The array doubles as the queue of a breadth first walk, so each generation follows the one before it. Descendants with fallback ancestors can be reached more than once, but are only listed the first time.
+    NSArray *generation = [self _directDescendants];
+    for (NSUInteger index = 0; generation; index++)
+    {
+        for (AKAncestor *descendant in generation)
+        {
+            if (![visitedDescendants containsObject:descendant])
+            {
+                [visitedDescendants addObject:descendant];
+                [descendants addObject:descendant];
+            }
+        }
+        
+        generation = (index < descendants.count) ? [descendants[index] _directDescendants] : nil;
+    }
+    
+    return [descendants copy];
+}
+
+- (NSArray *)descendantsInheritingValueForPropertyName:(NSString *)propertyName
+{
+    [self _validatePropertyName:propertyName];
+    
+    NSMutableArray *descendants = [NSMutableArray array];
+    NSMutableArray *queue = [NSMutableArray arrayWithArray:[self _directDescendants]];
+    NSMutableArray *parents = [NSMutableArray array];
+    for (NSUInteger index = 0; index < queue.count; index++)
+    {
+        [parents addObject:self];
+    }
+    
+    for (NSUInteger index = 0; index < queue.count; index++)
+    {
+        AKAncestor *descendant = queue[index];
+        AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[descendant class]];
+        
+        NSUInteger propertyIndex = [classInfo indexOfPropertyName:propertyName];
+        if (propertyIndex == NSNotFound)
+        {
+            continue;
+        }
+        
+        // A descendant which overrides or ignores the property hides the receiver's value from its whole subtree, so the walk never enters it.
+        if (((id (*)(id, SEL))objc_msgSend)(descendant, [classInfo localGetterAtIndex:propertyIndex]) || [[descendant _ignoredPropertyNames] containsObject:propertyName])
+        {
+            continue;
+        }
+        
+        // A descendant with fallback ancestors only sees the value through the ancestor which wins the property.
+        if (descendant->_ak_fallbackAncestors && [descendant _ancestorResolvingPropertyName:propertyName] != parents[index])
+        {
+            continue;
+        }
+        
+        [descendants addObject:descendant];
+        
+        NSArray *directDescendants = [descendant _directDescendants];
+        [queue addObjectsFromArray:directDescendants];
+        for (NSUInteger count = 0; count < directDescendants.count; count++)
+        {
+            [parents addObject:descendant];
+        }
+    }
+    
+    return [descendants copy];
+}
+
+- (NSArray *)descendantsOverridingPropertyName:(NSString *)propertyName
+{
+    [self _validatePropertyName:propertyName];
+    AKAncestorPropertyIndex *propertyIndex = [self _propertyIndex];
+    return [self _descendantsAmongInstances:[propertyIndex instancesForPropertyName:propertyName inInstancesByPropertyName:propertyIndex.overridingInstancesByPropertyName]];
+}
+
+- (NSArray *)descendantsIgnoringPropertyName:(NSString *)propertyName
+{
+    [self _validatePropertyName:propertyName];
+    AKAncestorPropertyIndex *propertyIndex = [self _propertyIndex];
+    return [self _descendantsAmongInstances:[propertyIndex instancesForPropertyName:propertyName inInstancesByPropertyName:propertyIndex.ignoringInstancesByPropertyName]];
+}
+
+
+#pragma mark - Value provenance
+
+- (AKAncestor *)ancestorProvidingValueForPropertyName:(NSString *)propertyName provenance:(AKAncestorValueProvenance *)provenance
+{
+    NSUInteger index = [[AKAncestorClassInfo classInfoForClass:[self class]] indexOfPropertyName:propertyName];
+    if (index == NSNotFound)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, [self class]];
+    }
+    
+    AKAncestorProvenanceTable *table = [self _provenanceTable];
+    if (provenance)
+    {
+        *provenance = table->_provenances[index];
+    }
+    
+    return table->_providers[index];
+}
+
+- (AKAncestor *)ancestorProvidingValueForPropertyName:(NSString *)propertyName
+{
+    return [self ancestorProvidingValueForPropertyName:propertyName provenance:NULL];
+}
+
+- (NSDictionary *)provenanceOfValues
+{
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    AKAncestorProvenanceTable *table = [self _provenanceTable];
+    
+    NSMutableDictionary *provenances = [NSMutableDictionary dictionaryWithCapacity:table.count];
+    for (NSUInteger index = 0; index < table.count; index++)
+    {
+        provenances[classInfo.propertyNames[index]] = @(table->_provenances[index]);
+    }
+    
+    return [provenances copy];
+}
+
+- (NSDictionary *)ancestorsProvidingValues
+{
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    AKAncestorProvenanceTable *table = [self _provenanceTable];
+    
+    NSMutableDictionary *providers = [NSMutableDictionary dictionaryWithCapacity:table.count];
+    for (NSUInteger index = 0; index < table.count; index++)
+    {
+        if (table->_providers[index])
+        {
+            providers[classInfo.propertyNames[index]] = table->_providers[index];
+        }
+    }
+    
+    return [providers copy];
+}
+
+
+#pragma mark - Value semantics
+
++ (BOOL)comparesEffectiveValues
+{
+    return NO;
+}
+
+- (BOOL)isEqualToAncestor:(AKAncestor *)otherAncestor
+{
+    if (otherAncestor == self)
+    {
+        return YES;
+    }
+    
+    if (!otherAncestor || [otherAncestor class] != [self class])
+    {
+        return NO;
+    }
+    
+    // Both hashes are usually cached, so most unequal instances are rejected without resolving a single value.
+    if ([self effectiveValueHash] != [otherAncestor effectiveValueHash])
+    {
+        return NO;
+    }
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    for (NSUInteger index = 0; index < classInfo.propertyCount; index++)
+    {
+        SEL getter = [classInfo getterAtIndex:index];
+        id value = ((id (*)(id, SEL))objc_msgSend)(self, getter);
+        id otherValue = ((id (*)(id, SEL))objc_msgSend)(otherAncestor, getter);
+        
+        if (value != otherValue && ![value isEqual:otherValue])
+        {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
+
+- (NSUInteger)effectiveValueHash
+{
+    // The count is read before any values, so a change racing with the calculation leaves a stale count behind and the next call recalculates.
+    int64_t mutationCount = [self _lineageMutationCount];
+    
+    OSSpinLockLock(&_ak_spinLock);
+    BOOL isCached = (_ak_effectiveValueHashMutationCount == mutationCount);
+    NSUInteger effectiveValueHash = _ak_effectiveValueHash;
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    if (isCached)
+    {
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheHit, self, nil);
+        return effectiveValueHash;
+    }
+    
+    AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheMiss, self, nil);
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    
+    effectiveValueHash = [[self class] hash];
+    for (NSUInteger index = 0; index < classInfo.propertyCount; index++)
+    {
+        id value = ((id (*)(id, SEL))objc_msgSend)(self, [classInfo getterAtIndex:index]);
+        effectiveValueHash = (effectiveValueHash * 31) + [value hash];
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    _ak_effectiveValueHash = effectiveValueHash;
+    _ak_effectiveValueHashMutationCount = mutationCount;
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    return effectiveValueHash;
+}
+
+
+#pragma mark - Merging collections
+
++ (AKAncestorMergePolicy)mergePolicyForPropertyName:(NSString *)propertyName
+{
+    return AKAncestorMergePolicyReplace;
+}
+
+
+#pragma mark - Derived properties
+
++ (NSSet *)derivedPropertyNames
+{
+    return [NSSet set];
+}
+
+- (void)invalidateDerivedValues
+{
+    NSSet *propertyNames = [[self class] derivedPropertyNames];
+    for (NSString *propertyName in propertyNames)
+    {
+        [self willChangeValueForKey:propertyName];
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    [self.ak_derivedValues removeAllObjects];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    for (NSString *propertyName in propertyNames)
+    {
+        [self didChangeValueForKey:propertyName];
+    }
+}
+
+
+#pragma mark - Reflection
+
++ (NSSet *)propertiesPassedToDescendants
+{
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %i", NSStringFromSelector(@selector(propertyType)), AKPropertyTypeObject];
+    return [[self _allInheritedProperties] filteredSetUsingPredicate:predicate];
+}
+
+
+#pragma mark - NSObject
+
+- (BOOL)isEqual:(id)object
+{
+    if (![[self class] comparesEffectiveValues])
+    {
+        return [super isEqual:object];
+    }
+    
+    return [object isKindOfClass:[AKAncestor class]] && [self isEqualToAncestor:object];
+}
+
+- (NSUInteger)hash
+{
+    return ([[self class] comparesEffectiveValues]) ? [self effectiveValueHash] : [super hash];
+}
+
+- (NSString *)description
+{
+    return [self descriptionWithLocale:[NSLocale currentLocale] indent:0];
+}
+
+- (NSString *)debugDescription
+{
+    return [self descriptionWithLocale:[NSLocale currentLocale] indent:0];
+}
+
+- (NSString *)descriptionWithLocale:(id)locale indent:(NSUInteger)level
+{
+    AKAncestorDescriptionWriter *writer = [AKAncestorDescriptionWriter new];
+    writer.locale = locale;
+    writer.indentLevel = level;
+    
+    return [writer descriptionOfAncestor:self];
+}
+
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding
+{
+    return YES;
+}
+
++ (NSSet *)allowedClassesForDecodingPropertyName:(NSString *)propertyName
+{
+    AKPropertyDescription *property = [[AKAncestorClassInfo classInfoForClass:self] propertyNamed:propertyName];
+    if (!property)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, self];
+    }
+    
+    return (property.propertyClass) ? [NSSet setWithObject:property.propertyClass] : nil;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder
+{
+    // Keyed archivers unique the objects they encode, so an ancestor shared by many descendants is only written once.
+    if (self.ancestor)
+    {
+        [aCoder encodeObject:self.ancestor forKey:NSStringFromSelector(@selector(ancestor))];
+    }
+    
+    if (_ak_fallbackAncestors)
+    {
+        [aCoder encodeObject:_ak_fallbackAncestors forKey:NSStringFromSelector(@selector(fallbackAncestors))];
+    }
+    
+    // Most instances inherit notifications, so only the exception is written to keep archives small.
+    if (!self.inheritsKeyValueNotifications)
+    {
+        [aCoder encodeBool:YES forKey:AKAncestorIgnoresKeyValueNotificationsCodingKey];
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    NSSet *ignoredPropertyNames = [self.ak_ignoredPropertyNames copy];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    if (ignoredPropertyNames.count > 0)
+    {
+        [aCoder encodeObject:ignoredPropertyNames forKey:AKAncestorIgnoredPropertyNamesCodingKey];
+    }
+    
+    // Only the receiver's own values are encoded, inherited values come back with the ancestor.
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    for (NSUInteger index = 0; index < classInfo.propertyCount; index++)
+    {
+        id value = ((id (*)(id, SEL))objc_msgSend)(self, [classInfo localGetterAtIndex:index]);
+        if (value)
+        {
+            [aCoder encodeObject:value forKey:[AKAncestorPropertyValueCodingKeyPrefix stringByAppendingString:classInfo.propertyNames[index]]];
+        }
+    }
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder
+{
+    AKAncestor *ancestor = [aDecoder decodeObjectOfClass:[AKAncestor class] forKey:NSStringFromSelector(@selector(ancestor))];
+    NSArray *fallbackAncestors = [aDecoder decodeObjectOfClasses:[NSSet setWithObjects:[NSArray class], [AKAncestor class], nil] forKey:NSStringFromSelector(@selector(fallbackAncestors))];
+    BOOL shouldInheritKeyValueNotifications = ![aDecoder decodeBoolForKey:AKAncestorIgnoresKeyValueNotificationsCodingKey];
+    
+    NSArray *ancestors = (ancestor) ? [@[ancestor] arrayByAddingObjectsFromArray:fallbackAncestors ?: @[]] : nil;
+    if (!(self = [self initWithAncestors:ancestors inheritKeyValueNotifications:shouldInheritKeyValueNotifications]))
+    {
+        return nil;
+    }
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    for (AKPropertyDescription *property in classInfo.properties)
+    {
+        NSString *key = [AKAncestorPropertyValueCodingKeyPrefix stringByAppendingString:property.propertyName];
+        if (![aDecoder containsValueForKey:key])
+        {
+            continue;
+        }
+        
+        // Allowing NSObject for properties declared as id would let an archive instantiate any class, so secure decoding needs an explicit list.
+        NSSet *allowedClasses = [[self class] allowedClassesForDecodingPropertyName:property.propertyName];
+        if (allowedClasses.count == 0 && aDecoder.requiresSecureCoding)
+        {
+            [NSException raise:NSInvalidUnarchiveOperationException format:@"Property \"%@\" of %@ has no allowed classes, so its value can't be decoded securely.", property.propertyName, [self class]];
+        }
+        
+        id value = (allowedClasses.count > 0) ? [aDecoder decodeObjectOfClasses:allowedClasses forKey:key] : [aDecoder decodeObjectForKey:key];
+        if (value)
+        {
+            [self setValue:value forKey:property.propertyName];
+        }
+    }
+    
+    NSSet *ignoredPropertyNames = [aDecoder decodeObjectOfClasses:[NSSet setWithObjects:[NSSet class], [NSString class], nil] forKey:AKAncestorIgnoredPropertyNamesCodingKey];
+    for (NSString *propertyName in ignoredPropertyNames)
+    {
+        // Archives from other versions of a class may name properties which are no longer inherited, so they're dropped rather than raising.
+        if ([classInfo indexOfPropertyName:propertyName] != NSNotFound)
+        {
+            [self.ak_ignoredPropertyNames addObject:propertyName];
+            [self _setIndexed:YES forPropertyName:propertyName ignoring:YES];
+        }
+    }
+    
+    return self;
+}
+
+
+#pragma mark - NSKeyValueObserving
+
++ (NSSet *)keyPathsForValuesAffectingValueForKey:(NSString *)key
+{
+    NSSet *keyPaths = [super keyPathsForValuesAffectingValueForKey:key];
+    
+    // Dependencies are only known once a value is computed, so derived properties announce changes to any inheritable property. Observers of the receiver's own inheritable properties also hear about inherited changes when the receiver inherits key-value notifications.
+    if ([[self derivedPropertyNames] containsObject:key])
+    {
+        keyPaths = [keyPaths setByAddingObjectsFromArray:[AKAncestorClassInfo classInfoForClass:self].propertyNames];
+    }
+    
+    return keyPaths;
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (context != AKAncestorKVOContext)
+    {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    BOOL isIgnoredProperty = [self.ak_ignoredPropertyNames containsObject:keyPath];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    // If we're ignoring inheritance on this property, then it's value won't change with key value notifications
+    if (isIgnoredProperty)
+    {
+        return;
+    }
+    
+    // Class info is looked up rather than filtering the inherited properties, since this runs for every change to every ancestor.
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    NSUInteger propertyIndex = [classInfo indexOfPropertyName:keyPath];
+    
+    if (propertyIndex == NSNotFound)
+    {
+        // Somehow we're observing an unknown property!
+        [NSException raise:AKAncestorUnknownPropertyException format:@"Received key-value notification for unknown property \"%@\" in %@", keyPath, [self class]];
+        
+        [object removeObserver:self forKeyPath:keyPath context:context];
+        return;
+    }
+    
+    id existingValue = ((id (*)(id, SEL))objc_msgSend)(self, [classInfo localGetterAtIndex:propertyIndex]);
+    
+    // There is an override, so we can ignore the ancestor's key value notification, unless the override is merged with the inherited value
+    if (existingValue && [classInfo mergePolicyAtIndex:propertyIndex] == AKAncestorMergePolicyReplace)
+    {
+        return;
+    }
+    
+    // Likewise, a fallback ancestor's change is hidden if an ancestor consulted before it has a value.
+    if (_ak_fallbackAncestors && object != _ancestor && [self _ancestorBefore:object providesValueForPropertyName:keyPath])
+    {
+        return;
+    }
+    
+    BOOL isPriorToChange = [change[NSKeyValueChangeNotificationIsPriorKey] boolValue];
+    if (isPriorToChange)
+    {
+        [self willChangeValueForKey:keyPath];
+    }
+    else
+    {
+        id newValue = change[NSKeyValueChangeNewKey];
+        id oldValue = change[NSKeyValueChangeOldKey];
+        
+        if ((newValue || oldValue) && (!oldValue || ![newValue isEqual:oldValue]))
+        {
+            AKAncestorStatisticsRecord(AKAncestorStatisticsEventKeyValueForward, self, keyPath);
+            
+            uint64_t traceTimestamp = AKAncestorTraceBegin();
+            [self didChangeValueForKey:keyPath];
+            
+            if (traceTimestamp)
+            {
+                AKAncestorTraceEnd(AKAncestorTraceEventKeyValueForward, self, AKAncestorTraceInternedName(keyPath), traceTimestamp);
+            }
+        }
+    }
+}
+
+
+#pragma mark - Private
+
+- (void)_setupKeyValueObservationsOnAncestor:(AKAncestor *)ancestor
+{
+    NSParameterAssert(ancestor);
+    
+    NSMutableSet *propertiesToObserve = [NSMutableSet setWithSet:[[self class] propertiesPassedToDescendants]];
+    [propertiesToObserve intersectSet:[[ancestor class] propertiesPassedToDescendants]];
+    
+    NSKeyValueObservingOptions options = NSKeyValueObservingOptionPrior|NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld;
+    for (AKPropertyDescription *propertyDescription in propertiesToObserve)
+    {
+        [ancestor addObserver:self forKeyPath:propertyDescription.propertyName options:options context:AKAncestorKVOContext];
+    }
+}
+
+- (void)_beginInheritingKeyValueNotifications
+{
+    if (_inheritsKeyValueNotifications)
+    {
+        return;
+    }
+    
+    _inheritsKeyValueNotifications = YES;
+    if (_ancestor)
+    {
+        [self _setupKeyValueObservationsOnAncestor:_ancestor];
+    }
+    
+    for (AKAncestor *fallbackAncestor in _ak_fallbackAncestors)
+    {
+        [self _setupKeyValueObservationsOnAncestor:fallbackAncestor];
+    }
+}
+
+- (void)_noteLocalValuesDidChange
+{
+    OSAtomicIncrement64Barrier(&_ak_mutationCount);
+    OSAtomicIncrement64Barrier(&_ak_lineageMutationCount);
+    
+    NSArray *directDescendants = [self _directDescendants];
+    if (directDescendants.count == 0)
+    {
+        return;
+    }
+    
+    // Every instance inheriting through the receiver counts the change as well, so a write costs time in proportion to the descendants it reaches while checking a cache stays a single read.
+    NSMutableArray *descendants = [directDescendants mutableCopy];
+    NSHashTable *countedDescendants = nil;
+    for (NSUInteger index = 0; index < descendants.count; index++)
+    {
+        AKAncestor *descendant = descendants[index];
+        
+        // Instances with fallback ancestors can be reached along several paths, and so can their descendants, but they're only counted once.
+        if (descendant->_ak_fallbackAncestors)
+        {
+            if (!countedDescendants)
+            {
+                countedDescendants = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+            }
+            
+            if ([countedDescendants containsObject:descendant])
+            {
+                continue;
+            }
+            [countedDescendants addObject:descendant];
+        }
+        
+        OSAtomicIncrement64Barrier(&descendant->_ak_lineageMutationCount);
+        [descendants addObjectsFromArray:[descendant _directDescendants]];
+    }
+}
+
+- (int64_t)_mutationCount
+{
+    return _ak_mutationCount;
+}
+
+- (int64_t)_serialNumber
+{
+    return _ak_serialNumber;
+}
+
+- (int64_t)_lineageMutationCount
+{
+    return _ak_lineageMutationCount;
+}
+
+- (BOOL)_hasAncestor:(AKAncestor *)ancestor
+{
+    for (AKAncestor *instance = self; instance; instance = instance->_ancestor)
+    {
+        if (instance != self && instance == ancestor)
+        {
+            return YES;
+        }
+        
+        for (AKAncestor *fallbackAncestor in instance->_ak_fallbackAncestors)
+        {
+            if (fallbackAncestor == ancestor || [fallbackAncestor _hasAncestor:ancestor])
+            {
+                return YES;
+            }
+        }
+    }
+    
+    return NO;
+}
+
+- (AKAncestor *)_ancestorResolvingPropertyName:(NSString *)propertyName
+{
+    NSUInteger index = [[AKAncestorClassInfo classInfoForClass:[self class]] indexOfPropertyName:propertyName];
+    if (index == NSNotFound)
+    {
+        return _ancestor;
+    }
+    
+    NSUInteger ancestorIndex = [self _provenanceTable]->_ancestorIndexes[index];
+    if (ancestorIndex == NSNotFound)
+    {
+        return nil;
+    }
+    
+    return (ancestorIndex == 0) ? _ancestor : _ak_fallbackAncestors[ancestorIndex - 1];
+}
+
+- (AKAncestorProvenanceTable *)_provenanceTable
+{
+    // Writes along the chain and its fallbacks are counted by the receiver itself, so validating the cached table is a single read.
+    int64_t mutationCount = [self _lineageMutationCount];
+    
+    OSSpinLockLock(&_ak_spinLock);
+    AKAncestorProvenanceTable *table = self.ak_provenanceTable;
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    if (table && table.lineageMutationCount == mutationCount)
+    {
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheHit, self, nil);
+        return table;
+    }
+    
+    AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheMiss, self, nil);
+    
+    NSMutableArray *lineage = [NSMutableArray array];
+    for (AKAncestor *ancestor = self; ancestor; ancestor = ancestor->_ancestor)
+    {
+        [lineage addObject:ancestor];
+    }
+    
+    // Tables are built from the root down, reusing any which are still current, so each instance only consults its ancestor's table. Each count is read before the values of its instance, so a racing change leaves a stale count behind and the table is rebuilt next time.
+    AKAncestorProvenanceTable *ancestorTable = nil;
+    for (AKAncestor *instance in [lineage reverseObjectEnumerator])
+    {
+        int64_t lineageMutationCount = [instance _lineageMutationCount];
+        
+        OSSpinLockLock(&instance->_ak_spinLock);
+        table = instance.ak_provenanceTable;
+        OSSpinLockUnlock(&instance->_ak_spinLock);
+        
+        if (!table || table.lineageMutationCount != lineageMutationCount)
+        {
+            table = [instance _provenanceTableWithAncestorTable:ancestorTable lineageMutationCount:lineageMutationCount];
+            
+            OSSpinLockLock(&instance->_ak_spinLock);
+            instance.ak_provenanceTable = table;
+            OSSpinLockUnlock(&instance->_ak_spinLock);
+        }
+        
+        ancestorTable = table;
+    }
+    
+    return table;
+}
+
+- (AKAncestorProvenanceTable *)_provenanceTableWithAncestorTable:(AKAncestorProvenanceTable *)ancestorTable lineageMutationCount:(int64_t)lineageMutationCount
 {
-    return [[[self class] alloc] initWithAncestor:self inheritKeyValueNotifications:shouldInheritKeyValueNotifications];
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    NSSet *ignoredPropertyNames = [self _ignoredPropertyNames];
+    
+    // A provider which hasn't run yet supplies the receiver's own value as soon as the property is read, so it's local like an assigned value.
+    OSSpinLockLock(&_ak_spinLock);
+    NSArray *providedPropertyNames = [self.ak_valueProviders allKeys];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    // Fallback ancestors are consulted in order after the first, each with its own cached table.
+    NSArray *ancestors = [self ancestors];
+    NSMutableArray *ancestorClassInfos = [NSMutableArray arrayWithCapacity:ancestors.count];
+    NSMutableArray *ancestorTables = [NSMutableArray arrayWithCapacity:ancestors.count];
+    for (AKAncestor *ancestor in ancestors)
+    {
+        [ancestorClassInfos addObject:[AKAncestorClassInfo classInfoForClass:[ancestor class]]];
+        [ancestorTables addObject:(ancestor == _ancestor && ancestorTable) ? ancestorTable : [ancestor _provenanceTable]];
+    }
+    
+    AKAncestorProvenanceTable *table = [[AKAncestorProvenanceTable alloc] initWithCount:classInfo.propertyCount lineageMutationCount:lineageMutationCount];
+    for (NSUInteger index = 0; index < classInfo.propertyCount; index++)
+    {
+        NSString *propertyName = classInfo.propertyNames[index];
+        
+        if (((id (*)(id, SEL))objc_msgSend)(self, [classInfo localGetterAtIndex:index]) || [providedPropertyNames containsObject:propertyName])
+        {
+            table->_provenances[index] = AKAncestorValueProvenanceLocal;
+            table->_providers[index] = self;
+            continue;
+        }
+        
+        if ([ignoredPropertyNames containsObject:propertyName])
+        {
+            table->_provenances[index] = AKAncestorValueProvenanceIgnored;
+            continue;
+        }
+        
+        for (NSUInteger ancestorIndex = 0; ancestorIndex < ancestors.count; ancestorIndex++)
+        {
+            AKAncestor *ancestor = ancestors[ancestorIndex];
+            AKAncestor *provider = nil;
+            
+            NSUInteger ancestorPropertyIndex = [ancestorClassInfos[ancestorIndex] indexOfPropertyName:propertyName];
+            if (ancestorPropertyIndex != NSNotFound)
+            {
+                AKAncestorProvenanceTable *currentAncestorTable = ancestorTables[ancestorIndex];
+                AKAncestorValueProvenance ancestorProvenance = currentAncestorTable->_provenances[ancestorPropertyIndex];
+                if (ancestorProvenance == AKAncestorValueProvenanceLocal || ancestorProvenance == AKAncestorValueProvenanceInherited)
+                {
+                    provider = currentAncestorTable->_providers[ancestorPropertyIndex];
+                }
+            }
+            else
+            {
+                // An ancestor which doesn't pass the property on still answers the getter itself, and ends its chain.
+                SEL getter = [classInfo getterAtIndex:index];
+                if ([ancestor respondsToSelector:getter] && ((id (*)(id, SEL))objc_msgSend)(ancestor, getter))
+                {
+                    provider = ancestor;
+                }
+            }
+            
+            if (provider)
+            {
+                table->_provenances[index] = AKAncestorValueProvenanceInherited;
+                table->_providers[index] = provider;
+                table->_ancestorIndexes[index] = ancestorIndex;
+                break;
+            }
+        }
+    }
+    
+    return table;
 }
 
-- (void)dealloc
+- (id)_providedValueForPropertyName:(NSString *)propertyName
 {
-    if (_inheritsKeyValueNotifications && _ancestor)
+    NSParameterAssert(propertyName);
+    
+    OSSpinLockLock(&_ak_spinLock);
+    AKAncestorValueProvider *valueProvider = self.ak_valueProviders[propertyName];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    if (!valueProvider)
     {
-        [self _removeKeyValueObservationsOnAncestor:_ancestor];
+        return nil;
+    }
+    
+    [valueProvider.lock lock];
+    
+    BOOL needsAssignment = NO;
+    if (!valueProvider.isResolved)
+    {
+        valueProvider.value = valueProvider.block();
+        valueProvider.resolved = YES;
+        needsAssignment = YES;
+    }
+    
+    id value = valueProvider.value;
+    [valueProvider.lock unlock];
+    
+    // The value is assigned outside of the lock, since key value observers notified by the setter read the property again. Until the provider is removed those reads find it resolved and return its value without running the block, and readers which no longer find it find the assigned value instead.
+    if (needsAssignment)
+    {
+        if (value)
+        {
+            [self setValue:value forKey:propertyName];
+        }
+        
+        OSSpinLockLock(&_ak_spinLock);
+        if (self.ak_valueProviders[propertyName] == valueProvider)
+        {
+            [self.ak_valueProviders removeObjectForKey:propertyName];
+            _ak_valueProviderCount = self.ak_valueProviders.count;
+        }
+        OSSpinLockUnlock(&_ak_spinLock);
+        
+        // The setter already noted an assigned value, but a provider which supplied nothing leaves the property to ancestors after all.
+        if (!value)
+        {
+            [self _noteLocalValuesDidChange];
+        }
     }
+    
+    return value;
 }
 
-
-#pragma mark - Limiting property inheritance
-
-- (void)stopInheritingValuesForPropertyName:(NSString *)propertyName
+- (id)_mergedValueForPropertyName:(NSString *)propertyName localValue:(id)localValue
 {
-    // Create a copy to prevent any shady business
-    NSString *name = [propertyName copy];
+    NSParameterAssert(propertyName);
+    NSParameterAssert(localValue);
     
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", NSStringFromSelector(@selector(propertyName)), name];
-    if ([[[self class] propertiesPassedToDescendants] filteredSetUsingPredicate:predicate].count == 0)
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[self class]];
+    NSUInteger index = [classInfo indexOfPropertyName:propertyName];
+    AKAncestorMergePolicy policy = (index != NSNotFound) ? [classInfo mergePolicyAtIndex:index] : AKAncestorMergePolicyReplace;
+    if (policy == AKAncestorMergePolicyReplace)
     {
-        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", name, [self class]];
+        return localValue;
     }
     
+    // The count is read before the inherited value is resolved, so a change racing with the merge leaves a stale count behind and the value is merged again next time.
+    int64_t lineageMutationCount = [self _lineageMutationCount];
+    
     OSSpinLockLock(&_ak_spinLock);
-    [self.ak_ignoredPropertyNames addObject:name];
+    AKAncestorMergedValue *mergedValue = self.ak_mergedValues[propertyName];
+    OSSpinLockUnlock(&_ak_spinLock);
+    
+    // Nothing along the chain changed since the value was merged, so the inherited value is still the same and the ancestors' getters aren't called at all.
+    if (mergedValue && mergedValue.lineageMutationCount == lineageMutationCount && mergedValue.localValue == localValue)
+    {
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheHit, self, propertyName);
+        return mergedValue.value;
+    }
+    
+    AKAncestor *ancestor = (_ak_fallbackAncestors) ? [self _ancestorResolvingPropertyName:propertyName] : _ancestor;
+    SEL getter = [classInfo getterAtIndex:index];
+    id inheritedValue = ([ancestor respondsToSelector:getter]) ? ((id (*)(id, SEL))objc_msgSend)(ancestor, getter) : nil;
+    if (!inheritedValue)
+    {
+        return localValue;
+    }
+    
+    // Ancestors return their own cached results, so a change elsewhere along the chain still hands back the same objects and the merge is reused.
+    if (mergedValue.localValue == localValue && mergedValue.inheritedValue == inheritedValue)
+    {
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheHit, self, propertyName);
+        mergedValue = [[AKAncestorMergedValue alloc] initWithValue:mergedValue.value localValue:localValue inheritedValue:inheritedValue lineageMutationCount:lineageMutationCount];
+    }
+    else
+    {
+        AKAncestorStatisticsRecord(AKAncestorStatisticsEventCacheMiss, self, propertyName);
+        mergedValue = [[AKAncestorMergedValue alloc] initWithValue:AKAncestorMergeValues(policy, inheritedValue, localValue) localValue:localValue inheritedValue:inheritedValue lineageMutationCount:lineageMutationCount];
+    }
+    
+    OSSpinLockLock(&_ak_spinLock);
+    if (!self.ak_mergedValues)
+    {
+        self.ak_mergedValues = [NSMutableDictionary dictionary];
+    }
+    self.ak_mergedValues[propertyName] = mergedValue;
     OSSpinLockUnlock(&_ak_spinLock);
+    
+    return mergedValue.value;
 }
 
-- (void)resumeInheritingValuesForPropertyName:(NSString *)propertyName
+- (void)_registerDescendant:(AKAncestor *)descendant
 {
-    // Create a copy to prevent any shady business
-    NSString *name = [propertyName copy];
+    NSParameterAssert(descendant);
     
     OSSpinLockLock(&_ak_spinLock);
-    [self.ak_ignoredPropertyNames removeObject:name];
+    if (!self.ak_descendants)
+    {
+        self.ak_descendants = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality];
+    }
+    [self.ak_descendants addObject:descendant];
     OSSpinLockUnlock(&_ak_spinLock);
 }
 
-- (NSSet *)propertiesIgnoringInheritedValues
+- (NSArray *)_directDescendants
 {
     OSSpinLockLock(&_ak_spinLock);
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K IN %@", NSStringFromSelector(@selector(propertyName)), self.ak_ignoredPropertyNames];
+    NSArray *descendants = [self.ak_descendants allObjects];
     OSSpinLockUnlock(&_ak_spinLock);
     
-    return [[[self class] propertiesPassedToDescendants] filteredSetUsingPredicate:predicate];
-}
-
-
-#pragma mark - Reflection
-
-+ (NSSet *)propertiesPassedToDescendants
-{
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %i", NSStringFromSelector(@selector(propertyType)), AKPropertyTypeObject];
-    return [[self _allInheritedProperties] filteredSetUsingPredicate:predicate];
+    return descendants ?: @[];
 }
 
-
-#pragma mark - NSObject
-
-- (NSString *)description
+- (NSArray *)_indexRoots
 {
-    return [self descriptionWithLocale:[NSLocale currentLocale] indent:0];
+    return _ak_indexRoots ?: @[self];
 }
 
-- (NSString *)debugDescription
+- (AKAncestorPropertyIndex *)_propertyIndex
 {
-    return [self descriptionWithLocale:[NSLocale currentLocale] indent:0];
+    // Every descendant of the receiver inherits from all of its roots, so any one of their indexes lists them.
+    AKAncestor *root = _ak_indexRoots.firstObject ?: self;
+    
+    OSSpinLockLock(&root->_ak_spinLock);
+    if (!root.ak_propertyIndex)
+    {
+        root.ak_propertyIndex = [AKAncestorPropertyIndex new];
+    }
+    AKAncestorPropertyIndex *propertyIndex = root.ak_propertyIndex;
+    OSSpinLockUnlock(&root->_ak_spinLock);
+    
+    return propertyIndex;
 }
 
-- (NSString *)descriptionWithLocale:(id)locale indent:(NSUInteger)level
+- (void)_setIndexed:(BOOL)isIndexed forPropertyName:(NSString *)propertyName ignoring:(BOOL)isIgnoring
 {
-    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@:%p>", [self class], self];
-    
-    NSString *padding = [@"" stringByPaddingToLength:(level + 1) withString:@"\t" startingAtIndex:0];
-    
-    NSString *propertiesDescription = [self _descriptionOfPropertiesWithLocale:locale indent:level];
-    if (propertiesDescription.length > 0)
+    // The receiver keeps its own list of overrides as well, so comparing instances only visits what each of them overrides.
+    if (!isIgnoring)
     {
-        [description appendFormat:@"\n%@Properties", padding];
-        [description appendString:propertiesDescription];
+        OSSpinLockLock(&_ak_spinLock);
+        if (!self.ak_overriddenPropertyNames)
+        {
+            self.ak_overriddenPropertyNames = [NSMutableSet set];
+        }
+        
+        if (isIndexed)
+        {
+            [self.ak_overriddenPropertyNames addObject:propertyName];
+        }
+        else
+        {
+            [self.ak_overriddenPropertyNames removeObject:propertyName];
+        }
+        OSSpinLockUnlock(&_ak_spinLock);
     }
     
-    if (self.ancestor)
+    // Queries can start from any ancestor, so the receiver is listed by the root of each chain it inherits from. Roots list themselves, which queries never return.
+    for (AKAncestor *root in [self _indexRoots])
     {
-        [description appendFormat:@"\n%@Ancestor ", padding];
-        [description appendString:[[self class] _descriptionOfValue:self.ancestor withLocale:locale indent:level]];
+        AKAncestorPropertyIndex *propertyIndex = [root _propertyIndex];
+        NSMutableDictionary *instancesByPropertyName = (isIgnoring) ? propertyIndex.ignoringInstancesByPropertyName : propertyIndex.overridingInstancesByPropertyName;
+        [propertyIndex setInstance:self isIndexed:isIndexed forPropertyName:propertyName inInstancesByPropertyName:instancesByPropertyName];
     }
-    
-    return [description copy];
 }
 
-#pragma mark - NSKeyValueObserving
+- (NSArray *)_descendantsAmongInstances:(NSArray *)instances
+{
+    // Indexed instances are usually far fewer than the nodes of a tree, so checking each one's chain beats walking the subtree.
+    NSMutableArray *descendants = [NSMutableArray array];
+    for (AKAncestor *instance in instances)
+    {
+        if ([instance _hasAncestor:self])
+        {
+            [descendants addObject:instance];
+        }
+    }
+    
+    return [descendants copy];
+}
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+- (void)_validatePropertyName:(NSString *)propertyName
 {
-    if (context != AKAncestorKVOContext)
+    if ([[AKAncestorClassInfo classInfoForClass:[self class]] indexOfPropertyName:propertyName] == NSNotFound)
     {
-        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
-        return;
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, [self class]];
     }
+}
+
+- (id)_derivedValueForKey:(NSString *)key computingSelector:(SEL)computingSelector
+{
+    NSParameterAssert(key);
     
     OSSpinLockLock(&_ak_spinLock);
-    BOOL isIgnoredProperty = [self.ak_ignoredPropertyNames containsObject:keyPath];
+    AKAncestorDerivedValue *derivedValue = self.ak_derivedValues[key];
     OSSpinLockUnlock(&_ak_spinLock);
     
-    // If we're ignoring inheritance on this property, then it's value won't change with key value notifications
-    if (isIgnoredProperty)
+    if (derivedValue)
     {
-        return;
+        int64_t lineageMutationCount = [derivedValue.dependencies currentLineageMutationCount];
+        
+        // Something changed along the chain of a dependency, but it may not have been anything the value was computed from. Re-resolving the recorded values is still far cheaper than computing the value again.
+        if (lineageMutationCount != derivedValue.lineageMutationCount)
+        {
+            if ([derivedValue.dependencies recordedValuesAreCurrent])
+            {
+                derivedValue = [[AKAncestorDerivedValue alloc] initWithValue:derivedValue.value dependencies:derivedValue.dependencies lineageMutationCount:lineageMutationCount];
+                [self _setDerivedValue:derivedValue forKey:key];
+            }
+            else
+            {
+                derivedValue = nil;
+            }
+        }
     }
     
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", NSStringFromSelector(@selector(propertyName)), keyPath];
-    AKPropertyDescription *property = [[[[self class] propertiesPassedToDescendants] filteredSetUsingPredicate:predicate] anyObject];
+    AKAncestorStatisticsRecord((derivedValue) ? AKAncestorStatisticsEventCacheHit : AKAncestorStatisticsEventCacheMiss, self, key);
     
-    if (!property)
+    if (!derivedValue)
     {
-        // Somehow we're observing an unknown property!
-        [NSException raise:AKAncestorUnknownPropertyException format:@"Received key-value notification for unknown property \"%@\" in %@", keyPath, [self class]];
+        AKAncestorDependencyRecorder *dependencies = [AKAncestorDependencyRecorder new];
         
-        [object removeObserver:self forKeyPath:keyPath context:context];
-        return;
+        AKAncestorDependencyRecorder *previousRecorder = AKAncestorSetCurrentDependencyRecorder(dependencies);
+        id value = ((id (*)(id, SEL))objc_msgSend)(self, computingSelector);
+        AKAncestorSetCurrentDependencyRecorder(previousRecorder);
+        
+        derivedValue = [[AKAncestorDerivedValue alloc] initWithValue:value dependencies:dependencies lineageMutationCount:dependencies.lineageMutationCount];
+        [self _setDerivedValue:derivedValue forKey:key];
     }
     
-    SEL swizzledGetter = AKAncestorSwizzledPropertyGetter(property);
-    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self methodSignatureForSelector:swizzledGetter]];
-    [invocation setSelector:swizzledGetter];
-    
-    __unsafe_unretained id existingValue;
-    [invocation invokeWithTarget:self];
-    [invocation getReturnValue:&existingValue];
-    
-    // There is an override, so we can ignore the ancestor's key value notification
-    if (existingValue)
+    // A derived property computed from this one depends on everything this one read.
+    AKAncestorDependencyRecorder *recorder = AKAncestorCurrentDependencyRecorder();
+    if (recorder)
     {
-        return;
+        [recorder recordDependenciesOfRecorder:derivedValue.dependencies];
     }
     
-    BOOL isPriorToChange = [change[NSKeyValueChangeNotificationIsPriorKey] boolValue];
-    if (isPriorToChange)
-    {
-        [self willChangeValueForKey:keyPath];
-    }
-    else
+    return derivedValue.value;
+}
+
+- (void)_setDerivedValue:(AKAncestorDerivedValue *)derivedValue forKey:(NSString *)key
+{
+    OSSpinLockLock(&_ak_spinLock);
+    if (!self.ak_derivedValues)
     {
-        id newValue = change[NSKeyValueChangeNewKey];
-        id oldValue = change[NSKeyValueChangeOldKey];
-        
-        if ((newValue || oldValue) && (!oldValue || ![newValue isEqual:oldValue]))
-        {
-            [self didChangeValueForKey:keyPath];
-        }
+        self.ak_derivedValues = [NSMutableDictionary dictionary];
     }
+    self.ak_derivedValues[key] = derivedValue;
+    OSSpinLockUnlock(&_ak_spinLock);
 }
 
+- (BOOL)_resolvesValuesFromFirstAncestorOnly
+{
+    return !_ak_fallbackAncestors && _ak_valueProviderCount == 0;
+}
 
-#pragma mark - Private
-
-- (void)_setupKeyValueObservationsOnAncestor:(AKAncestor *)ancestor
+- (NSSet *)_ignoredPropertyNames
 {
-    NSParameterAssert(ancestor);
-    
-    NSMutableSet *propertiesToObserve = [NSMutableSet setWithSet:[[self class] propertiesPassedToDescendants]];
-    [propertiesToObserve intersectSet:[[ancestor class] propertiesPassedToDescendants]];
+    OSSpinLockLock(&_ak_spinLock);
+    NSSet *ignoredPropertyNames = (self.ak_ignoredPropertyNames.count > 0) ? [self.ak_ignoredPropertyNames copy] : nil;
+    OSSpinLockUnlock(&_ak_spinLock);
     
-    NSKeyValueObservingOptions options = NSKeyValueObservingOptionPrior|NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld;
-    for (AKPropertyDescription *propertyDescription in propertiesToObserve)
+    return ignoredPropertyNames;
+}
+
+- (BOOL)_ancestorBefore:(AKAncestor *)ancestor providesValueForPropertyName:(NSString *)propertyName
+{
+    for (AKAncestor *precedingAncestor in [self ancestors])
     {
-        [ancestor addObserver:self forKeyPath:propertyDescription.propertyName options:options context:AKAncestorKVOContext];
+        if (precedingAncestor == ancestor)
+        {
+            break;
+        }
+        
+        AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[precedingAncestor class]];
+        NSUInteger index = [classInfo indexOfPropertyName:propertyName];
+        if (index != NSNotFound && ((id (*)(id, SEL))objc_msgSend)(precedingAncestor, [classInfo getterAtIndex:index]))
+        {
+            return YES;
+        }
     }
+    
+    return NO;
 }
 
 - (void)_removeKeyValueObservationsOnAncestor:(AKAncestor *)ancestor
@@ -403,72 +2037,73 @@ static void AKAncestorSwizzlePropertyGetter(Class class, AKPropertyDescription *
     }
 }
 
-- (NSString *)_descriptionOfPropertiesWithLocale:(id)locale indent:(NSUInteger)level
+- (AKAncestor *)_commonAncestorWith:(AKAncestor *)otherAncestor
 {
-    NSMutableString *description = [NSMutableString string];
+    NSParameterAssert(otherAncestor);
     
-    OSSpinLockLock(&_ak_spinLock);
-    NSSet *ignoredPropertyNames = [NSSet setWithSet:self.ak_ignoredPropertyNames];
-    OSSpinLockUnlock(&_ak_spinLock);
+    NSHashTable *lineage = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    for (AKAncestor *ancestor = self; ancestor; ancestor = ancestor.ancestor)
+    {
+        [lineage addObject:ancestor];
+    }
     
-    NSSet *propertyNames = [[[self class] _allInheritedProperties] valueForKey:NSStringFromSelector(@selector(propertyName))];
-    NSArray *sortedPropertyNames = [[propertyNames allObjects] sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)];
+    AKAncestor *commonAncestor = otherAncestor;
+    while (commonAncestor && ![lineage containsObject:commonAncestor])
+    {
+        commonAncestor = commonAncestor.ancestor;
+    }
     
-    id propertyValue;
-    for (NSString *propertyName in sortedPropertyNames)
+    // Values may come from fallback ancestors below the common ancestor, in which case it says nothing about which values are shared.
+    for (AKAncestor *ancestor = self; commonAncestor && ancestor != commonAncestor; ancestor = ancestor.ancestor)
     {
-        propertyValue = [self valueForKey:propertyName];
-        
-        if (!propertyValue && [ignoredPropertyNames containsObject:propertyName])
+        if (ancestor->_ak_fallbackAncestors)
         {
-            propertyValue = @"nil";
+            return nil;
         }
-        
-        if (propertyValue)
+    }
+    
+    for (AKAncestor *ancestor = otherAncestor; commonAncestor && ancestor != commonAncestor; ancestor = ancestor.ancestor)
+    {
+        if (ancestor->_ak_fallbackAncestors)
         {
-            NSString *padding = [@"" stringByPaddingToLength:(level + 2) withString:@"\t" startingAtIndex:0];
-            NSString *valueDescription = [[self class] _descriptionOfValue:propertyValue withLocale:locale indent:level];
-            
-            [description appendFormat:@"\n%@%@: %@", padding, propertyName, valueDescription];
-            
-            if ([ignoredPropertyNames containsObject:propertyName])
-            {
-                [description appendString:@" (ignoring inheritance)"];
-            }
-            
-            [description appendString:@","];
+            return nil;
         }
     }
     
-    return description;
+    return commonAncestor;
 }
 
-+ (NSString *)_descriptionOfValue:(id)value withLocale:(id)locale indent:(NSUInteger)level
+- (void)_addPropertyNamesAffectingValuesInheritedFrom:(AKAncestor *)ancestor toSet:(NSMutableSet *)propertyNames
 {
-    NSString *valueDescription;
-    if ([value isKindOfClass:[NSString class]])
-    {
-        valueDescription = value;
-    }
-    else if ([value respondsToSelector:@selector(descriptionWithLocale:indent:)])
-    {
-        valueDescription = [value descriptionWithLocale:locale indent:(level + 1)];
-    }
-    else if ([value respondsToSelector:@selector(descriptionWithLocale:)])
-    {
-        valueDescription = [value descriptionWithLocale:locale];
-    }
-    else
-    {
-        valueDescription = [value description];
-    }
+    NSParameterAssert(ancestor);
+    NSParameterAssert(propertyNames);
     
-    if (!valueDescription)
+    AKAncestorClassInfo *ancestorClassInfo = [AKAncestorClassInfo classInfoForClass:[ancestor class]];
+    
+    for (AKAncestor *descendant = self; descendant && descendant != ancestor; descendant = descendant.ancestor)
     {
-        valueDescription = [NSString stringWithFormat:@"<%@:%p>", [value class], value];
+        // A value can diverge from the ancestor's if it's overridden, about to be provided, ignored, or transformed by a subclass getter. Each of these is kept as a set, so only the properties they name are visited.
+        OSSpinLockLock(&descendant->_ak_spinLock);
+        [propertyNames unionSet:descendant.ak_overriddenPropertyNames];
+        [propertyNames addObjectsFromArray:[descendant.ak_valueProviders allKeys]];
+        [propertyNames unionSet:descendant.ak_ignoredPropertyNames];
+        OSSpinLockUnlock(&descendant->_ak_spinLock);
+        
+        AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[descendant class]];
+        [propertyNames unionSet:classInfo.transformingPropertyNames];
+        
+        // Properties the ancestor doesn't pass on at all can only diverge where the classes differ, which is the only case that visits every property.
+        if (classInfo != ancestorClassInfo)
+        {
+            for (NSString *propertyName in classInfo.propertyNames)
+            {
+                if ([ancestorClassInfo indexOfPropertyName:propertyName] == NSNotFound)
+                {
+                    [propertyNames addObject:propertyName];
+                }
+            }
+        }
     }
-    
-    return valueDescription;
 }
 
 + (NSSet *)_allInheritedProperties
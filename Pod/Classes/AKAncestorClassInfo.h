@@ -0,0 +1,126 @@
+//
+//  AKAncestorClassInfo.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "AKAncestor.h"
+
+@class AKPropertyDescription;
+
+/**
+ *  Returns the selector which the original implementation of a swizzled property getter is moved to. Invoking this selector returns the receiver's own value for the property without consulting ancestors.
+ *
+ *  @param property The property whose getter was swizzled. This must not be nil.
+ *
+ *  @return The selector for the unswizzled getter.
+ */
+FOUNDATION_EXPORT SEL AKAncestorSwizzledPropertyGetter(AKPropertyDescription *property);
+
+/**
+ *  Returns the selector which the original implementation of a swizzled property setter is moved to.
+ *
+ *  @param property The property whose setter was swizzled. This must not be nil.
+ *
+ *  @return The selector for the unswizzled setter.
+ */
+FOUNDATION_EXPORT SEL AKAncestorSwizzledPropertySetter(AKPropertyDescription *property);
+
+/**
+ *  Records an implementation created by AKAncestor to resolve inherited values. This should only be called while AKAncestor swizzles a subclass.
+ *
+ *  @param implementation The swizzled implementation.
+ */
+FOUNDATION_EXPORT void AKAncestorRegisterInheritingImplementation(IMP implementation);
+
+/**
+ *  Returns YES if the given implementation was created by AKAncestor to resolve inherited values, or NO if it belongs to a subclass.
+ *
+ *  @param implementation The implementation to check.
+ */
+FOUNDATION_EXPORT BOOL AKAncestorIsInheritingImplementation(IMP implementation);
+
+
+/**
+ *  Internal class which caches the reflection AKAncestor performs on a subclass, so that hot paths can work with property indexes and precomputed selectors instead of filtering +propertiesPassedToDescendants on every call. Instances are immutable and shared per class.
+ */
+@interface AKAncestorClassInfo : NSObject
+
+/**
+ *  Returns the cached information for the given AKAncestor subclass, creating it if necessary.
+ *
+ *  @param ancestorClass The class to describe. This must be AKAncestor or one of its subclasses.
+ *
+ *  @return The shared class info of the class.
+ */
++ (instancetype)classInfoForClass:(Class)ancestorClass;
+
+/**
+ *  The class described by the receiver.
+ */
+@property (strong, nonatomic, readonly) Class ancestorClass;
+
+/**
+ *  The AKPropertyDescription objects from the class' +propertiesPassedToDescendants, sorted case-insensitively by name. Property indexes used by the receiver refer to this array.
+ */
+@property (copy, nonatomic, readonly) NSArray *properties;
+
+/**
+ *  The names of the properties array, in the same order.
+ */
+@property (copy, nonatomic, readonly) NSArray *propertyNames;
+
+/**
+ *  The number of inheritable properties.
+ */
+@property (assign, nonatomic, readonly) NSUInteger propertyCount;
+
+/**
+ *  Returns the index of the property with the given name, or NSNotFound if the class does not pass it to descendants.
+ */
+- (NSUInteger)indexOfPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the property description with the given name, or nil if the class does not pass it to descendants.
+ */
+- (AKPropertyDescription *)propertyNamed:(NSString *)propertyName;
+
+/**
+ *  Returns the getter of the property at the given index.
+ */
+- (SEL)getterAtIndex:(NSUInteger)index;
+
+/**
+ *  Returns the selector which retrieves the receiver's own value of the property at the given index, without consulting ancestors.
+ */
+- (SEL)localGetterAtIndex:(NSUInteger)index;
+
+/**
+ *  Returns YES if the class' getter for the property at the given index is not AncestorKit's implementation, meaning a subclass may transform the value it inherits.
+ */
+- (BOOL)propertyAtIndexTransformsInheritedValues:(NSUInteger)index;
+
+/**
+ *  The names of the properties for which propertyAtIndexTransformsInheritedValues: returns YES.
+ */
+@property (copy, nonatomic, readonly) NSSet *transformingPropertyNames;
+
+/**
+ *  Returns the class' merge policy for the property at the given index, from +mergePolicyForPropertyName:.
+ */
+- (AKAncestorMergePolicy)mergePolicyAtIndex:(NSUInteger)index;
+
+/**
+ *  The names of every property the class declares up to and excluding AKAncestor, including those which aren't inherited, sorted case-insensitively. Descriptions list properties in this order.
+ */
+@property (copy, nonatomic, readonly) NSArray *describedPropertyNames;
+
+/**
+ *  Returns the getter of the described property at the given index if it returns an object, or NULL if its value must be boxed with -valueForKey:.
+ */
+- (SEL)describedObjectGetterAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,241 @@
+//
+//  AKAncestorClassInfo.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorClassInfo.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import "AKPropertyDescription.h"
+#import "AKAncestorPlatform.h"
+#import <objc/runtime.h>
+
+SEL AKAncestorSwizzledPropertyGetter(AKPropertyDescription *property)
+{
+    NSCParameterAssert(property);
+    
+    NSString *selectorString = [NSString stringWithFormat:@"_ak_%@", NSStringFromSelector(property.propertyGetter)];
+    return NSSelectorFromString(selectorString);
+}
+
+SEL AKAncestorSwizzledPropertySetter(AKPropertyDescription *property)
+{
+    NSCParameterAssert(property);
+    
+    NSString *selectorString = [NSString stringWithFormat:@"_ak_%@", NSStringFromSelector(property.propertySetter)];
+    return NSSelectorFromString(selectorString);
+}
+
+static OSSpinLock AKAncestorInheritingImplementationsLock = OS_SPINLOCK_INIT;
+
+static NSMutableSet *AKAncestorInheritingImplementations()
+{
+    static NSMutableSet *implementations;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        implementations = [NSMutableSet set];
+    });
+    
+    return implementations;
+}
+
+void AKAncestorRegisterInheritingImplementation(IMP implementation)
+{
+    NSCParameterAssert(implementation);
+    
+    OSSpinLockLock(&AKAncestorInheritingImplementationsLock);
+    [AKAncestorInheritingImplementations() addObject:[NSValue valueWithPointer:(const void *)implementation]];
+    OSSpinLockUnlock(&AKAncestorInheritingImplementationsLock);
+}
+
+BOOL AKAncestorIsInheritingImplementation(IMP implementation)
+{
+    if (!implementation)
+    {
+        return NO;
+    }
+    
+    // Subclasses registered at runtime add to the table after AKAncestor loads, so reads take the lock too.
+    OSSpinLockLock(&AKAncestorInheritingImplementationsLock);
+    BOOL isInheritingImplementation = [AKAncestorInheritingImplementations() containsObject:[NSValue valueWithPointer:(const void *)implementation]];
+    OSSpinLockUnlock(&AKAncestorInheritingImplementationsLock);
+    
+    return isInheritingImplementation;
+}
+
+
+@interface AKAncestorClassInfo ()
+{
+    SEL *_getters;
+    SEL *_localGetters;
+    BOOL *_transformsInheritedValues;
+    AKAncestorMergePolicy *_mergePolicies;
+    SEL *_describedObjectGetters;
+}
+
+@property (copy, nonatomic, readonly) NSDictionary *indexesByName;
+
+@end
+
+@implementation AKAncestorClassInfo
+
+#pragma mark - Lifecycle
+
++ (instancetype)classInfoForClass:(Class)ancestorClass
+{
+    NSParameterAssert(ancestorClass);
+    
+    // Like +[AKAncestor _allInheritedProperties], racing threads may both build the info, but they will build identical objects so the loser is simply discarded.
+    AKAncestorClassInfo *classInfo = objc_getAssociatedObject(ancestorClass, _cmd);
+    if (classInfo)
+    {
+        return classInfo;
+    }
+    
+    classInfo = [[self alloc] initWithClass:ancestorClass];
+    objc_setAssociatedObject(ancestorClass, _cmd, classInfo, OBJC_ASSOCIATION_RETAIN);
+    return classInfo;
+}
+
+- (instancetype)initWithClass:(Class)ancestorClass
+{
+    NSParameterAssert([ancestorClass isSubclassOfClass:[AKAncestor class]]);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _ancestorClass = ancestorClass;
+    
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:NSStringFromSelector(@selector(propertyName)) ascending:YES selector:@selector(caseInsensitiveCompare:)];
+    _properties = [[[ancestorClass propertiesPassedToDescendants] allObjects] sortedArrayUsingDescriptors:@[sortDescriptor]];
+    _propertyNames = [_properties valueForKey:NSStringFromSelector(@selector(propertyName))];
+    _propertyCount = _properties.count;
+    
+    NSMutableDictionary *indexesByName = [NSMutableDictionary dictionaryWithCapacity:_propertyCount];
+    
+    _getters = calloc(MAX(_propertyCount, 1), sizeof(SEL));
+    _localGetters = calloc(MAX(_propertyCount, 1), sizeof(SEL));
+    _transformsInheritedValues = calloc(MAX(_propertyCount, 1), sizeof(BOOL));
+    _mergePolicies = calloc(MAX(_propertyCount, 1), sizeof(AKAncestorMergePolicy));
+    
+    NSMutableSet *transformingPropertyNames = [NSMutableSet set];
+    for (NSUInteger index = 0; index < _propertyCount; index++)
+    {
+        AKPropertyDescription *property = _properties[index];
+        indexesByName[property.propertyName] = @(index);
+        
+        _getters[index] = property.propertyGetter;
+        _localGetters[index] = AKAncestorSwizzledPropertyGetter(property);
+        _transformsInheritedValues[index] = !AKAncestorIsInheritingImplementation(class_getMethodImplementation(ancestorClass, property.propertyGetter));
+        _mergePolicies[index] = [ancestorClass mergePolicyForPropertyName:property.propertyName];
+        
+        if (_transformsInheritedValues[index])
+        {
+            [transformingPropertyNames addObject:property.propertyName];
+        }
+    }
+    
+    _indexesByName = [indexesByName copy];
+    _transformingPropertyNames = [transformingPropertyNames copy];
+    
+    // Subclasses may redeclare a superclass' property, so descriptions key properties by name to list each once.
+    NSMutableDictionary *describedPropertiesByName = [NSMutableDictionary dictionary];
+    for (AKPropertyDescription *property in [ancestorClass _allInheritedProperties])
+    {
+        describedPropertiesByName[property.propertyName] = property;
+    }
+    
+    _describedPropertyNames = [[describedPropertiesByName allKeys] sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)];
+    _describedObjectGetters = calloc(MAX(_describedPropertyNames.count, 1), sizeof(SEL));
+    
+    for (NSUInteger index = 0; index < _describedPropertyNames.count; index++)
+    {
+        AKPropertyDescription *property = describedPropertiesByName[_describedPropertyNames[index]];
+        if (property.propertyType == AKPropertyTypeObject)
+        {
+            _describedObjectGetters[index] = property.propertyGetter;
+        }
+    }
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithClass:nil];
+}
+
+- (void)dealloc
+{
+    free(_getters);
+    free(_localGetters);
+    free(_transformsInheritedValues);
+    free(_mergePolicies);
+    free(_describedObjectGetters);
+}
+
+
+#pragma mark - Properties
+
+- (NSUInteger)indexOfPropertyName:(NSString *)propertyName
+{
+    NSNumber *index = (propertyName) ? self.indexesByName[propertyName] : nil;
+    return (index) ? [index unsignedIntegerValue] : NSNotFound;
+}
+
+- (AKPropertyDescription *)propertyNamed:(NSString *)propertyName
+{
+    NSUInteger index = [self indexOfPropertyName:propertyName];
+    return (index != NSNotFound) ? self.properties[index] : nil;
+}
+
+- (SEL)getterAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < self.propertyCount);
+    return _getters[index];
+}
+
+- (SEL)localGetterAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < self.propertyCount);
+    return _localGetters[index];
+}
+
+- (BOOL)propertyAtIndexTransformsInheritedValues:(NSUInteger)index
+{
+    NSParameterAssert(index < self.propertyCount);
+    return _transformsInheritedValues[index];
+}
+
+- (AKAncestorMergePolicy)mergePolicyAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < self.propertyCount);
+    return _mergePolicies[index];
+}
+
+- (SEL)describedObjectGetterAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < self.describedPropertyNames.count);
+    return _describedObjectGetters[index];
+}
+
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+    return [self debugDescription];
+}
+
+- (NSString *)debugDescription
+{
+    return [NSString stringWithFormat:@"<%@:%p> class: %@, properties: %@", [self class], self, self.ancestorClass, self.propertyNames];
+}
+
+@end
@@ -0,0 +1,66 @@
+//
+//  AKAncestorDependencyRecorder.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKAncestor;
+@class AKAncestorDependencyRecorder;
+
+/**
+ *  Returns the recorder collecting dependencies on the current thread, or nil if no derived property is being computed.
+ */
+FOUNDATION_EXPORT AKAncestorDependencyRecorder *AKAncestorCurrentDependencyRecorder(void);
+
+/**
+ *  Makes the given recorder the current recorder of the thread and returns the previous one. Callers must restore the previous recorder when they're done. The recorder isn't retained, so the caller must keep it alive while it's current.
+ *
+ *  @param recorder The recorder to make current. This may be nil to stop recording.
+ *
+ *  @return The recorder which was current before.
+ */
+FOUNDATION_EXPORT AKAncestorDependencyRecorder *AKAncestorSetCurrentDependencyRecorder(AKAncestorDependencyRecorder *recorder);
+
+
+/**
+ *  Internal class which collects the inheritable property values read while a derived property is computed. Swizzled getters report each value they resolve to the recorder of the current thread, and derived properties later re-resolve the same values to check whether their cached result is still valid.
+ */
+@interface AKAncestorDependencyRecorder : NSObject
+
+/**
+ *  Records that a getter was called on an instance and resolved a value. Only the first read of each getter on each instance is kept.
+ *
+ *  @param value                The resolved value. This may be nil.
+ *  @param getter               The getter which was called.
+ *  @param instance             The instance the getter was called on. This must not be nil.
+ *  @param lineageMutationCount The -_lineageMutationCount of the instance, read before the value was resolved.
+ */
+- (void)recordValue:(id)value ofGetter:(SEL)getter onInstance:(AKAncestor *)instance lineageMutationCount:(int64_t)lineageMutationCount;
+
+/**
+ *  Records every dependency of another recorder, so that a derived property which reads another derived property depends on what that property read.
+ *
+ *  @param recorder The recorder whose dependencies should be added. This must not be nil.
+ */
+- (void)recordDependenciesOfRecorder:(AKAncestorDependencyRecorder *)recorder;
+
+/**
+ *  The sum of the lineage mutation counts captured for each distinct instance when it was first recorded. Since each count was read before any of the instance's values, the current sum differs from this one if anything the recorded values depend on changed since.
+ */
+@property (assign, nonatomic, readonly) int64_t lineageMutationCount;
+
+/**
+ *  Returns the sum of the current lineage mutation counts of the recorded instances, to compare with lineageMutationCount. Instances are only held weakly, so the instance caching a derived value can be one of its dependencies without a retain cycle. Deallocated instances count as 0.
+ */
+- (int64_t)currentLineageMutationCount;
+
+/**
+ *  Returns YES if every recorded getter still resolves an identical or equal value on its instance, or NO if one differs or its instance was deallocated. Reads made while checking aren't recorded.
+ */
+- (BOOL)recordedValuesAreCurrent;
+
+@end
@@ -0,0 +1,157 @@
+//
+//  AKAncestorDependencyRecorder.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorDependencyRecorder.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import <objc/message.h>
+
+// Thread local storage can't hold strong references under ARC, so the recorder is owned by whoever made it current.
+static __thread __unsafe_unretained AKAncestorDependencyRecorder *AKAncestorThreadDependencyRecorder;
+
+AKAncestorDependencyRecorder *AKAncestorCurrentDependencyRecorder(void)
+{
+    return AKAncestorThreadDependencyRecorder;
+}
+
+AKAncestorDependencyRecorder *AKAncestorSetCurrentDependencyRecorder(AKAncestorDependencyRecorder *recorder)
+{
+    AKAncestorDependencyRecorder *previousRecorder = AKAncestorThreadDependencyRecorder;
+    AKAncestorThreadDependencyRecorder = recorder;
+    return previousRecorder;
+}
+
+
+@interface AKAncestorDependencyRecorder ()
+
+// Instances are held weakly, since the instance caching a derived value is usually one of its dependencies and owns the recorder.
+@property (strong, nonatomic, readonly) NSPointerArray *recordedInstances;
+@property (strong, nonatomic, readonly) NSMutableArray *recordedGetters;
+@property (strong, nonatomic, readonly) NSMutableArray *recordedValues;
+@property (strong, nonatomic, readonly) NSPointerArray *distinctInstances;
+
+// Instances are keyed by identity, since instances with value semantics may be equal to each other.
+@property (strong, nonatomic, readonly) NSMapTable *recordedGettersByInstance;
+@property (strong, nonatomic, readonly) NSMapTable *lineageMutationCountsByInstance;
+
+@end
+
+@implementation AKAncestorDependencyRecorder
+
+#pragma mark - Lifecycle
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _recordedInstances = [NSPointerArray weakObjectsPointerArray];
+    _recordedGetters = [NSMutableArray array];
+    _recordedValues = [NSMutableArray array];
+    _distinctInstances = [NSPointerArray weakObjectsPointerArray];
+    
+    NSPointerFunctionsOptions instanceOptions = NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality;
+    _recordedGettersByInstance = [NSMapTable mapTableWithKeyOptions:instanceOptions valueOptions:NSPointerFunctionsStrongMemory];
+    _lineageMutationCountsByInstance = [NSMapTable mapTableWithKeyOptions:instanceOptions valueOptions:NSPointerFunctionsStrongMemory];
+    
+    return self;
+}
+
+
+#pragma mark - Recording
+
+- (void)recordValue:(id)value ofGetter:(SEL)getter onInstance:(AKAncestor *)instance lineageMutationCount:(int64_t)lineageMutationCount
+{
+    NSParameterAssert(instance);
+    
+    NSValue *getterValue = [NSValue valueWithPointer:(const void *)getter];
+    
+    NSMutableSet *getters = [self.recordedGettersByInstance objectForKey:instance];
+    if (!getters)
+    {
+        getters = [NSMutableSet set];
+        [self.recordedGettersByInstance setObject:getters forKey:instance];
+        [self.lineageMutationCountsByInstance setObject:@(lineageMutationCount) forKey:instance];
+        [self.distinctInstances addPointer:(__bridge void *)instance];
+        
+        _lineageMutationCount += lineageMutationCount;
+    }
+    
+    if ([getters containsObject:getterValue])
+    {
+        return;
+    }
+    
+    [getters addObject:getterValue];
+    [self.recordedInstances addPointer:(__bridge void *)instance];
+    [self.recordedGetters addObject:getterValue];
+    [self.recordedValues addObject:(value) ?: [NSNull null]];
+}
+
+- (void)recordDependenciesOfRecorder:(AKAncestorDependencyRecorder *)recorder
+{
+    NSParameterAssert(recorder);
+    
+    for (NSUInteger index = 0; index < recorder.recordedInstances.count; index++)
+    {
+        // A deallocated dependency can't change anymore, so there's nothing left to record about it.
+        AKAncestor *instance = (__bridge AKAncestor *)[recorder.recordedInstances pointerAtIndex:index];
+        if (!instance)
+        {
+            continue;
+        }
+        
+        id value = recorder.recordedValues[index];
+        int64_t lineageMutationCount = [[recorder.lineageMutationCountsByInstance objectForKey:instance] longLongValue];
+        
+        [self recordValue:(value != [NSNull null]) ? value : nil ofGetter:(SEL)[recorder.recordedGetters[index] pointerValue] onInstance:instance lineageMutationCount:lineageMutationCount];
+    }
+}
+
+- (int64_t)currentLineageMutationCount
+{
+    int64_t lineageMutationCount = 0;
+    for (NSUInteger index = 0; index < self.distinctInstances.count; index++)
+    {
+        AKAncestor *instance = (__bridge AKAncestor *)[self.distinctInstances pointerAtIndex:index];
+        lineageMutationCount += [instance _lineageMutationCount];
+    }
+    
+    return lineageMutationCount;
+}
+
+
+#pragma mark - Validating
+
+- (BOOL)recordedValuesAreCurrent
+{
+    AKAncestorDependencyRecorder *previousRecorder = AKAncestorSetCurrentDependencyRecorder(nil);
+    
+    BOOL isCurrent = YES;
+    for (NSUInteger index = 0; index < self.recordedInstances.count && isCurrent; index++)
+    {
+        AKAncestor *instance = (__bridge AKAncestor *)[self.recordedInstances pointerAtIndex:index];
+        if (!instance)
+        {
+            isCurrent = NO;
+            break;
+        }
+        
+        id recordedValue = self.recordedValues[index];
+        id value = ((id (*)(id, SEL))objc_msgSend)(instance, (SEL)[self.recordedGetters[index] pointerValue]) ?: [NSNull null];
+        
+        isCurrent = (value == recordedValue || [value isEqual:recordedValue]);
+    }
+    
+    AKAncestorSetCurrentDependencyRecorder(previousRecorder);
+    return isCurrent;
+}
+
+@end
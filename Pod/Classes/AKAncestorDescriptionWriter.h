@@ -0,0 +1,72 @@
+//
+//  AKAncestorDescriptionWriter.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKAncestor;
+
+/**
+ *  AKAncestorDescriptionWriter streams the description of an AKAncestor instance and its ancestor chain as UTF-8 into a caller-supplied buffer, an output stream, or a string. It produces the same layout as -[AKAncestor descriptionWithLocale:indent:], which uses it internally.
+ *
+ *  Text is written as it's produced rather than being assembled from nested strings, so describing a deep chain costs time proportional to its output. Each instance is described once per write: if an ancestor is reached again, for example through a property holding another member of the tree, it's written as a reference to the earlier description. The maximumDepth and maximumLength properties bound the output, which makes the writer suitable for logging from places like crash reporters where an unbounded description would stall.
+ *
+ *  Writes don't modify the receiver, so a configured writer may be shared between threads as long as its properties aren't changed concurrently.
+ */
+@interface AKAncestorDescriptionWriter : NSObject
+
+/**
+ *  The locale passed to -descriptionWithLocale: and -descriptionWithLocale:indent: of property values. Defaults to nil.
+ */
+@property (strong, nonatomic) id locale;
+
+/**
+ *  The indentation level of the described instance, matching the level argument of -descriptionWithLocale:indent:. Defaults to 0.
+ */
+@property (assign, nonatomic) NSUInteger indentLevel;
+
+/**
+ *  The maximum number of nested instances to describe, counting the described instance, its ancestors, and instances held by its properties. Deeper instances are written as their class and address followed by an ellipsis. Defaults to NSUIntegerMax.
+ */
+@property (assign, nonatomic) NSUInteger maximumDepth;
+
+/**
+ *  The maximum number of bytes to write, excluding the NUL terminator written to buffers. Descriptions which would exceed this are cut at a character boundary and end with an ellipsis. Defaults to NSUIntegerMax.
+ */
+@property (assign, nonatomic) NSUInteger maximumLength;
+
+/**
+ *  Writes the description of an instance into a buffer as NUL terminated UTF-8. The buffer's length limits the output in addition to maximumLength. Apart from property values which aren't strings or AKAncestor instances, whose own descriptions are requested, no memory is allocated for the text.
+ *
+ *  @param ancestor The instance to describe. This must not be nil.
+ *  @param buffer   The buffer to write into. This must not be NULL.
+ *  @param length   The length of the buffer in bytes, including space for the NUL terminator. This must be greater than 0.
+ *
+ *  @return The number of bytes written, excluding the NUL terminator.
+ */
+- (NSUInteger)writeDescriptionOfAncestor:(AKAncestor *)ancestor toBuffer:(char *)buffer length:(NSUInteger)length;
+
+/**
+ *  Writes the description of an instance to an open output stream as UTF-8. Text is staged in a small fixed buffer and written to the stream whenever it fills.
+ *
+ *  @param ancestor The instance to describe. This must not be nil.
+ *  @param stream   An open output stream. This must not be nil.
+ *
+ *  @return YES if the whole description was written, or NO if the stream failed to accept it.
+ */
+- (BOOL)writeDescriptionOfAncestor:(AKAncestor *)ancestor toStream:(NSOutputStream *)stream;
+
+/**
+ *  Returns the description of an instance as a string.
+ *
+ *  @param ancestor The instance to describe. This must not be nil.
+ *
+ *  @return The description of the instance.
+ */
+- (NSString *)descriptionOfAncestor:(AKAncestor *)ancestor;
+
+@end
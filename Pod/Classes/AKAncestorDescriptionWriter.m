@@ -0,0 +1,389 @@
+//
+//  AKAncestorDescriptionWriter.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorDescriptionWriter.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import "AKAncestorClassInfo.h"
+#import <objc/message.h>
+#import <objc/runtime.h>
+
+static const char AKAncestorDescriptionEllipsis[] = "...";
+
+// Text is staged in chunks of this size before being handed to a stream or data object.
+static const NSUInteger AKAncestorDescriptionChunkLength = 1024;
+
+/**
+ *  Destination of a single write. When writing to a caller's buffer the text goes straight into it, otherwise it's staged in a fixed chunk which is flushed to the stream or data object as it fills.
+ */
+typedef struct
+{
+    uint8_t *bytes;
+    NSUInteger capacity;
+    NSUInteger position;
+    
+    __unsafe_unretained NSOutputStream *stream;
+    __unsafe_unretained NSMutableData *data;
+    
+    NSUInteger written;
+    NSUInteger limit;
+    BOOL reservesEllipsis;
+    BOOL truncated;
+    BOOL failed;
+} AKAncestorDescriptionSink;
+
+static void AKAncestorDescriptionSinkInitialize(AKAncestorDescriptionSink *sink, uint8_t *bytes, NSUInteger capacity, NSUInteger maximumLength)
+{
+    memset(sink, 0, sizeof(AKAncestorDescriptionSink));
+    sink->bytes = bytes;
+    sink->capacity = capacity;
+    
+    // Space for the ellipsis is reserved up front, since text flushed to a stream can't be taken back once the limit is hit. Output within a few bytes of the limit is therefore also cut.
+    NSUInteger ellipsisLength = sizeof(AKAncestorDescriptionEllipsis) - 1;
+    sink->reservesEllipsis = (maximumLength != NSUIntegerMax && maximumLength >= ellipsisLength);
+    sink->limit = (sink->reservesEllipsis) ? maximumLength - ellipsisLength : maximumLength;
+}
+
+static void AKAncestorDescriptionSinkFlush(AKAncestorDescriptionSink *sink)
+{
+    if (sink->stream)
+    {
+        NSUInteger offset = 0;
+        while (offset < sink->position && !sink->failed)
+        {
+            NSInteger result = [sink->stream write:(sink->bytes + offset) maxLength:(sink->position - offset)];
+            if (result <= 0)
+            {
+                sink->failed = YES;
+            }
+            else
+            {
+                offset += (NSUInteger)result;
+            }
+        }
+        
+        sink->position = 0;
+    }
+    else if (sink->data)
+    {
+        [sink->data appendBytes:sink->bytes length:sink->position];
+        sink->position = 0;
+    }
+}
+
+static void AKAncestorDescriptionSinkAppend(AKAncestorDescriptionSink *sink, const char *bytes, NSUInteger length)
+{
+    while (length > 0 && !sink->failed)
+    {
+        if (sink->position == sink->capacity)
+        {
+            AKAncestorDescriptionSinkFlush(sink);
+            continue;
+        }
+        
+        NSUInteger count = MIN(length, sink->capacity - sink->position);
+        memcpy(sink->bytes + sink->position, bytes, count);
+        
+        sink->position += count;
+        sink->written += count;
+        bytes += count;
+        length -= count;
+    }
+}
+
+static void AKAncestorDescriptionSinkWrite(AKAncestorDescriptionSink *sink, const char *bytes, NSUInteger length)
+{
+    if (sink->truncated || sink->failed)
+    {
+        return;
+    }
+    
+    NSUInteger remaining = sink->limit - sink->written;
+    if (length <= remaining)
+    {
+        AKAncestorDescriptionSinkAppend(sink, bytes, length);
+        return;
+    }
+    
+    // Back off to the start of the character straddling the limit so the output stays valid UTF-8.
+    NSUInteger prefixLength = remaining;
+    while (prefixLength > 0 && (bytes[prefixLength] & 0xC0) == 0x80)
+    {
+        prefixLength--;
+    }
+    
+    AKAncestorDescriptionSinkAppend(sink, bytes, prefixLength);
+    if (sink->reservesEllipsis)
+    {
+        AKAncestorDescriptionSinkAppend(sink, AKAncestorDescriptionEllipsis, sizeof(AKAncestorDescriptionEllipsis) - 1);
+    }
+    
+    sink->truncated = YES;
+}
+
+static void AKAncestorDescriptionSinkWriteCString(AKAncestorDescriptionSink *sink, const char *string)
+{
+    AKAncestorDescriptionSinkWrite(sink, string, strlen(string));
+}
+
+static void AKAncestorDescriptionSinkWriteString(AKAncestorDescriptionSink *sink, NSString *string)
+{
+    uint8_t chunk[256];
+    NSRange range = NSMakeRange(0, string.length);
+    
+    // Converting in chunks avoids the autoreleased copy -UTF8String would make, and stops converting as soon as the output is cut.
+    while (range.length > 0 && !sink->truncated && !sink->failed)
+    {
+        NSUInteger usedLength = 0;
+        NSRange remainingRange;
+        [string getBytes:chunk maxLength:sizeof(chunk) usedLength:&usedLength encoding:NSUTF8StringEncoding options:NSStringEncodingConversionAllowLossy range:range remainingRange:&remainingRange];
+        
+        if (usedLength == 0)
+        {
+            break;
+        }
+        
+        AKAncestorDescriptionSinkWrite(sink, (const char *)chunk, usedLength);
+        range = remainingRange;
+    }
+}
+
+static void AKAncestorDescriptionSinkWriteNewline(AKAncestorDescriptionSink *sink, NSUInteger level)
+{
+    static const char tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    
+    AKAncestorDescriptionSinkWrite(sink, "\n", 1);
+    while (level > 0 && !sink->truncated && !sink->failed)
+    {
+        NSUInteger count = MIN(level, sizeof(tabs) - 1);
+        AKAncestorDescriptionSinkWrite(sink, tabs, count);
+        level -= count;
+    }
+}
+
+static void AKAncestorDescriptionSinkWriteReference(AKAncestorDescriptionSink *sink, id object)
+{
+    char reference[256];
+    snprintf(reference, sizeof(reference), "<%s:%p>", class_getName([object class]), (__bridge void *)object);
+    AKAncestorDescriptionSinkWriteCString(sink, reference);
+}
+
+
+@implementation AKAncestorDescriptionWriter
+
+#pragma mark - Lifecycle
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _maximumDepth = NSUIntegerMax;
+    _maximumLength = NSUIntegerMax;
+    
+    return self;
+}
+
+
+#pragma mark - Writing
+
+- (NSUInteger)writeDescriptionOfAncestor:(AKAncestor *)ancestor toBuffer:(char *)buffer length:(NSUInteger)length
+{
+    NSParameterAssert(ancestor);
+    NSParameterAssert(buffer);
+    NSParameterAssert(length > 0);
+    
+    // The buffer itself bounds the output, leaving room for the terminator.
+    AKAncestorDescriptionSink sink;
+    AKAncestorDescriptionSinkInitialize(&sink, (uint8_t *)buffer, length - 1, MIN(self.maximumLength, length - 1));
+    
+    [self _writeAncestor:ancestor toSink:&sink];
+    
+    buffer[sink.position] = '\0';
+    return sink.position;
+}
+
+- (BOOL)writeDescriptionOfAncestor:(AKAncestor *)ancestor toStream:(NSOutputStream *)stream
+{
+    NSParameterAssert(ancestor);
+    NSParameterAssert(stream);
+    
+    uint8_t chunk[AKAncestorDescriptionChunkLength];
+    
+    AKAncestorDescriptionSink sink;
+    AKAncestorDescriptionSinkInitialize(&sink, chunk, sizeof(chunk), self.maximumLength);
+    sink.stream = stream;
+    
+    [self _writeAncestor:ancestor toSink:&sink];
+    AKAncestorDescriptionSinkFlush(&sink);
+    
+    return !sink.failed;
+}
+
+- (NSString *)descriptionOfAncestor:(AKAncestor *)ancestor
+{
+    NSParameterAssert(ancestor);
+    
+    uint8_t chunk[AKAncestorDescriptionChunkLength];
+    NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(chunk)];
+    
+    AKAncestorDescriptionSink sink;
+    AKAncestorDescriptionSinkInitialize(&sink, chunk, sizeof(chunk), self.maximumLength);
+    sink.data = data;
+    
+    [self _writeAncestor:ancestor toSink:&sink];
+    AKAncestorDescriptionSinkFlush(&sink);
+    
+    return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+
+#pragma mark - Private
+
+- (void)_writeAncestor:(AKAncestor *)ancestor toSink:(AKAncestorDescriptionSink *)sink
+{
+    NSHashTable *describedAncestors = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    [self _writeAncestor:ancestor level:self.indentLevel depth:0 describedAncestors:describedAncestors toSink:sink];
+}
+
+- (void)_writeAncestor:(AKAncestor *)ancestor level:(NSUInteger)level depth:(NSUInteger)depth describedAncestors:(NSHashTable *)describedAncestors toSink:(AKAncestorDescriptionSink *)sink
+{
+    // The ancestor chain is walked iteratively, so a long chain doesn't recurse once per generation.
+    AKAncestor *currentAncestor = ancestor;
+    while (currentAncestor && !sink->truncated && !sink->failed)
+    {
+        AKAncestorDescriptionSinkWriteReference(sink, currentAncestor);
+        
+        if ([describedAncestors containsObject:currentAncestor])
+        {
+            AKAncestorDescriptionSinkWriteCString(sink, " (described above)");
+            return;
+        }
+        
+        if (depth >= self.maximumDepth)
+        {
+            AKAncestorDescriptionSinkWriteCString(sink, " ");
+            AKAncestorDescriptionSinkWriteCString(sink, AKAncestorDescriptionEllipsis);
+            return;
+        }
+        
+        [describedAncestors addObject:currentAncestor];
+        [self _writePropertiesOfAncestor:currentAncestor level:level depth:depth describedAncestors:describedAncestors toSink:sink];
+        
+        // Fallback ancestors are rare and shallow compared to the main chain, so they're simply described recursively.
+        for (AKAncestor *fallbackAncestor in [currentAncestor fallbackAncestors])
+        {
+            AKAncestorDescriptionSinkWriteNewline(sink, level + 1);
+            AKAncestorDescriptionSinkWriteCString(sink, "Fallback ancestor ");
+            [self _writeAncestor:fallbackAncestor level:(level + 1) depth:(depth + 1) describedAncestors:describedAncestors toSink:sink];
+        }
+        
+        currentAncestor = [currentAncestor ancestor];
+        if (currentAncestor)
+        {
+            AKAncestorDescriptionSinkWriteNewline(sink, level + 1);
+            AKAncestorDescriptionSinkWriteCString(sink, "Ancestor ");
+            
+            level++;
+            depth++;
+        }
+    }
+}
+
+- (void)_writePropertiesOfAncestor:(AKAncestor *)ancestor level:(NSUInteger)level depth:(NSUInteger)depth describedAncestors:(NSHashTable *)describedAncestors toSink:(AKAncestorDescriptionSink *)sink
+{
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[ancestor class]];
+    NSSet *ignoredPropertyNames = [ancestor _ignoredPropertyNames];
+    
+    BOOL hasWrittenHeader = NO;
+    NSArray *propertyNames = classInfo.describedPropertyNames;
+    
+    for (NSUInteger index = 0; index < propertyNames.count && !sink->truncated && !sink->failed; index++)
+    {
+        NSString *propertyName = propertyNames[index];
+        
+        SEL getter = [classInfo describedObjectGetterAtIndex:index];
+        id value = (getter) ? ((id (*)(id, SEL))objc_msgSend)(ancestor, getter) : [ancestor valueForKey:propertyName];
+        BOOL isIgnoredProperty = [ignoredPropertyNames containsObject:propertyName];
+        
+        if (!value && !isIgnoredProperty)
+        {
+            continue;
+        }
+        
+        if (!hasWrittenHeader)
+        {
+            AKAncestorDescriptionSinkWriteNewline(sink, level + 1);
+            AKAncestorDescriptionSinkWriteCString(sink, "Properties");
+            hasWrittenHeader = YES;
+        }
+        
+        AKAncestorDescriptionSinkWriteNewline(sink, level + 2);
+        AKAncestorDescriptionSinkWriteString(sink, propertyName);
+        AKAncestorDescriptionSinkWriteCString(sink, ": ");
+        
+        if (value)
+        {
+            [self _writeValue:value level:level depth:depth describedAncestors:describedAncestors toSink:sink];
+        }
+        else
+        {
+            AKAncestorDescriptionSinkWriteCString(sink, "nil");
+        }
+        
+        if (isIgnoredProperty)
+        {
+            AKAncestorDescriptionSinkWriteCString(sink, " (ignoring inheritance)");
+        }
+        
+        AKAncestorDescriptionSinkWriteCString(sink, ",");
+    }
+}
+
+- (void)_writeValue:(id)value level:(NSUInteger)level depth:(NSUInteger)depth describedAncestors:(NSHashTable *)describedAncestors toSink:(AKAncestorDescriptionSink *)sink
+{
+    if ([value isKindOfClass:[NSString class]])
+    {
+        AKAncestorDescriptionSinkWriteString(sink, value);
+        return;
+    }
+    
+    // Instances held by properties join the same write, so members of the tree are only ever described once.
+    if ([value isKindOfClass:[AKAncestor class]])
+    {
+        [self _writeAncestor:value level:(level + 1) depth:(depth + 1) describedAncestors:describedAncestors toSink:sink];
+        return;
+    }
+    
+    NSString *valueDescription;
+    if ([value respondsToSelector:@selector(descriptionWithLocale:indent:)])
+    {
+        valueDescription = [value descriptionWithLocale:self.locale indent:(level + 1)];
+    }
+    else if ([value respondsToSelector:@selector(descriptionWithLocale:)])
+    {
+        valueDescription = [value descriptionWithLocale:self.locale];
+    }
+    else
+    {
+        valueDescription = [value description];
+    }
+    
+    if (valueDescription)
+    {
+        AKAncestorDescriptionSinkWriteString(sink, valueDescription);
+    }
+    else
+    {
+        AKAncestorDescriptionSinkWriteReference(sink, value);
+    }
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  AKAncestorImporter.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKPropertyDescription;
+
+/**
+ *  Error domain for errors produced while importing ancestor trees.
+ */
+FOUNDATION_EXPORT NSString *const AKAncestorImporterErrorDomain;
+
+/**
+ *  Key in the userInfo of importer errors whose value is the name of the node which failed to import.
+ */
+FOUNDATION_EXPORT NSString *const AKAncestorImporterNodeNameErrorKey;
+
+/**
+ *  Keys recognized in node descriptions. Any other key in a node description is treated as an error.
+ */
+FOUNDATION_EXPORT NSString *const AKAncestorImporterParentKey;
+FOUNDATION_EXPORT NSString *const AKAncestorImporterClassKey;
+FOUNDATION_EXPORT NSString *const AKAncestorImporterValuesKey;
+FOUNDATION_EXPORT NSString *const AKAncestorImporterIgnoredPropertiesKey;
+
+/**
+ *  Error codes in the AKAncestorImporterErrorDomain.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorImporterError){
+    /**
+     *  The description, or one of its nodes, isn't structured as expected.
+     */
+    AKAncestorImporterErrorInvalidDescription = 1,
+    /**
+     *  A node names a class which doesn't exist or isn't a subclass of AKAncestor.
+     */
+    AKAncestorImporterErrorUnknownClass,
+    /**
+     *  A node names a parent which isn't in the description.
+     */
+    AKAncestorImporterErrorUnknownParent,
+    /**
+     *  A node is its own ancestor.
+     */
+    AKAncestorImporterErrorCycle,
+    /**
+     *  A node provides a value or ignores a property which isn't in its class' +propertiesPassedToDescendants.
+     */
+    AKAncestorImporterErrorUnknownProperty,
+    /**
+     *  A node provides a value which isn't an instance of the property's class.
+     */
+    AKAncestorImporterErrorInvalidValue
+};
+
+/**
+ *  AKAncestorImporter builds trees of AKAncestor instances from a dictionary or JSON description. The description maps node names to node descriptions, each of which may contain:
+ *
+ *  - AKAncestorImporterParentKey: the name of the node to inherit from.
+ *  - AKAncestorImporterClassKey: the name of the node's class. Nodes without a class use their parent's class, and roots use the importer's default class.
+ *  - AKAncestorImporterValuesKey: a dictionary mapping property names to the node's own values.
+ *  - AKAncestorImporterIgnoredPropertiesKey: an array of property names which should stop inheriting values.
+ *
+ *  The whole description is validated against each class' +propertiesPassedToDescendants before any instance is created. Nodes are then ordered by their depth in the tree and each depth is built concurrently with GCD, since nodes at the same depth only depend on nodes which already exist. Key-value observations on ancestors are wired up serially once every node has been created, so construction never contends on key-value observing's internal locks.
+ */
+@interface AKAncestorImporter : NSObject
+
+/**
+ *  Designated initializer.
+ *
+ *  @param defaultClass The class of root nodes which don't name a class. This must be AKAncestor or one of its subclasses.
+ *
+ *  @return An initialized instance of the receiver.
+ */
+- (instancetype)initWithDefaultClass:(Class)defaultClass NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The class of root nodes which don't name a class.
+ */
+@property (strong, nonatomic, readonly) Class defaultClass;
+
+/**
+ *  YES if imported instances should inherit key-value notifications from their ancestors. Defaults to YES.
+ */
+@property (assign, nonatomic) BOOL inheritsKeyValueNotifications;
+
+/**
+ *  An optional block which converts values from the description before they're validated and assigned, for example to turn strings into dates. The block is called concurrently from multiple threads and should return nil to reject a value.
+ */
+@property (copy, nonatomic) id (^valueTransformer)(AKPropertyDescription *property, id value);
+
+/**
+ *  Builds the instances described by the given dictionary.
+ *
+ *  @param description A dictionary mapping node names to node descriptions. This must not be nil.
+ *  @param error       If the description couldn't be imported, an error describing why. The AKAncestorImporterNodeNameErrorKey of its userInfo names the offending node.
+ *
+ *  @return A dictionary mapping node names to the imported instances, or nil if the description is invalid.
+ */
+- (NSDictionary *)ancestorsFromDictionary:(NSDictionary *)description error:(NSError **)error;
+
+/**
+ *  Parses the given JSON data and builds the instances it describes.
+ *
+ *  @param data  JSON data whose top level object is a dictionary of node descriptions. This must not be nil.
+ *  @param error If the data couldn't be parsed or imported, an error describing why.
+ *
+ *  @return A dictionary mapping node names to the imported instances, or nil if the data is invalid.
+ */
+- (NSDictionary *)ancestorsFromJSONData:(NSData *)data error:(NSError **)error;
+
+@end
@@ -0,0 +1,429 @@
+//
+//  AKAncestorImporter.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorImporter.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import "AKAncestorClassInfo.h"
+#import "AKPropertyDescription.h"
+
+NSString *const AKAncestorImporterErrorDomain = @"AKAncestorImporterErrorDomain";
+NSString *const AKAncestorImporterNodeNameErrorKey = @"AKAncestorImporterNodeNameErrorKey";
+
+NSString *const AKAncestorImporterParentKey = @"parent";
+NSString *const AKAncestorImporterClassKey = @"class";
+NSString *const AKAncestorImporterValuesKey = @"values";
+NSString *const AKAncestorImporterIgnoredPropertiesKey = @"ignored";
+
+// Nodes are handed to GCD in batches so the cost of scheduling is spread over enough work to matter.
+static const NSUInteger AKAncestorImporterBatchSize = 256;
+
+static NSError *AKAncestorImporterError(AKAncestorImporterError code, NSString *nodeName, NSString *description)
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    if (nodeName)
+    {
+        userInfo[AKAncestorImporterNodeNameErrorKey] = nodeName;
+    }
+    
+    return [NSError errorWithDomain:AKAncestorImporterErrorDomain code:code userInfo:userInfo];
+}
+
+
+#pragma mark - Nodes
+
+@interface AKAncestorImporterNode : NSObject
+
+@property (copy, nonatomic) NSString *name;
+@property (strong, nonatomic) Class ancestorClass;
+@property (copy, nonatomic) NSDictionary *values;
+@property (copy, nonatomic) NSArray *ignoredPropertyNames;
+
+@property (assign, nonatomic) NSInteger parentIndex;
+@property (assign, nonatomic) NSUInteger depth;
+
+@end
+
+@implementation AKAncestorImporterNode
+@end
+
+
+@implementation AKAncestorImporter
+
+#pragma mark - Lifecycle
+
+- (instancetype)initWithDefaultClass:(Class)defaultClass
+{
+    NSParameterAssert([defaultClass isSubclassOfClass:[AKAncestor class]]);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _defaultClass = defaultClass;
+    _inheritsKeyValueNotifications = YES;
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithDefaultClass:[AKAncestor class]];
+}
+
+
+#pragma mark - Importing
+
+- (NSDictionary *)ancestorsFromJSONData:(NSData *)data error:(NSError **)error
+{
+    NSParameterAssert(data);
+    
+    id description = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+    if (!description)
+    {
+        return nil;
+    }
+    
+    if (![description isKindOfClass:[NSDictionary class]])
+    {
+        if (error)
+        {
+            *error = AKAncestorImporterError(AKAncestorImporterErrorInvalidDescription, nil, @"The top level JSON object must be a dictionary of node descriptions.");
+        }
+        return nil;
+    }
+    
+    return [self ancestorsFromDictionary:description error:error];
+}
+
+- (NSDictionary *)ancestorsFromDictionary:(NSDictionary *)description error:(NSError **)error
+{
+    NSParameterAssert(description);
+    
+    NSArray *names = [description allKeys];
+    NSUInteger count = names.count;
+    
+    NSMutableDictionary *indexesByName = [NSMutableDictionary dictionaryWithCapacity:count];
+    [names enumerateObjectsUsingBlock:^(id name, NSUInteger index, BOOL *stop) {
+        indexesByName[name] = @(index);
+    }];
+    
+    // Each slot is only written by the iteration which owns it, which makes these safe to fill concurrently.
+    __strong AKAncestorImporterNode **nodes = (__strong AKAncestorImporterNode **)calloc(MAX(count, 1), sizeof(AKAncestorImporterNode *));
+    __strong NSError **nodeErrors = (__strong NSError **)calloc(MAX(count, 1), sizeof(NSError *));
+    __strong AKAncestor **ancestors = (__strong AKAncestor **)calloc(MAX(count, 1), sizeof(AKAncestor *));
+    NSUInteger *order = calloc(MAX(count, 1), sizeof(NSUInteger));
+    
+    NSError *importError = nil;
+    NSMutableDictionary *importedAncestors = nil;
+    
+    // Parsing and validating nodes only reads the description, so every node can be checked at once.
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_apply([self _batchCountForCount:count], queue, ^(size_t batch) {
+        @autoreleasepool {
+            NSRange range = [self _rangeOfBatch:batch count:count];
+            for (NSUInteger index = range.location; index < NSMaxRange(range); index++)
+            {
+                NSError *nodeError = nil;
+                nodes[index] = [self _nodeNamed:names[index] description:description[names[index]] indexesByName:indexesByName error:&nodeError];
+                nodeErrors[index] = nodeError;
+            }
+        }
+    });
+    
+    for (NSUInteger index = 0; index < count && !importError; index++)
+    {
+        importError = nodeErrors[index];
+    }
+    
+    if (!importError)
+    {
+        importError = [self _resolveClassesAndDepthsOfNodes:nodes count:count];
+    }
+    
+    if (!importError)
+    {
+        // Classes can now be validated, since nodes without a class inherited one from their parent.
+        dispatch_apply([self _batchCountForCount:count], queue, ^(size_t batch) {
+            @autoreleasepool {
+                NSRange range = [self _rangeOfBatch:batch count:count];
+                for (NSUInteger index = range.location; index < NSMaxRange(range); index++)
+                {
+                    nodeErrors[index] = [self _validateValuesOfNode:nodes[index]];
+                }
+            }
+        });
+        
+        for (NSUInteger index = 0; index < count && !importError; index++)
+        {
+            importError = nodeErrors[index];
+        }
+    }
+    
+    if (!importError)
+    {
+        NSUInteger maximumDepth = 0;
+        for (NSUInteger index = 0; index < count; index++)
+        {
+            maximumDepth = MAX(maximumDepth, nodes[index].depth);
+        }
+        
+        // A counting sort by depth places every node after its parent, and groups nodes which can be built at the same time.
+        NSUInteger *levelStarts = calloc(maximumDepth + 2, sizeof(NSUInteger));
+        for (NSUInteger index = 0; index < count; index++)
+        {
+            levelStarts[nodes[index].depth + 1]++;
+        }
+        for (NSUInteger depth = 1; depth <= maximumDepth + 1; depth++)
+        {
+            levelStarts[depth] += levelStarts[depth - 1];
+        }
+        
+        NSUInteger *levelPositions = calloc(maximumDepth + 1, sizeof(NSUInteger));
+        memcpy(levelPositions, levelStarts, (maximumDepth + 1) * sizeof(NSUInteger));
+        for (NSUInteger index = 0; index < count; index++)
+        {
+            order[levelPositions[nodes[index].depth]++] = index;
+        }
+        free(levelPositions);
+        
+        for (NSUInteger depth = 0; depth <= maximumDepth; depth++)
+        {
+            NSUInteger levelStart = levelStarts[depth];
+            NSUInteger levelCount = levelStarts[depth + 1] - levelStart;
+            
+            dispatch_apply([self _batchCountForCount:levelCount], queue, ^(size_t batch) {
+                @autoreleasepool {
+                    NSRange range = [self _rangeOfBatch:batch count:levelCount];
+                    for (NSUInteger position = levelStart + range.location; position < levelStart + NSMaxRange(range); position++)
+                    {
+                        NSUInteger index = order[position];
+                        AKAncestor *parent = (nodes[index].parentIndex >= 0) ? ancestors[nodes[index].parentIndex] : nil;
+                        ancestors[index] = [self _instantiateNode:nodes[index] ancestor:parent];
+                    }
+                }
+            });
+        }
+        
+        free(levelStarts);
+        
+        // Key-value observing serializes registration internally, so observations are added in one pass after construction rather than from every worker.
+        if (self.inheritsKeyValueNotifications)
+        {
+            for (NSUInteger index = 0; index < count; index++)
+            {
+                [ancestors[index] _beginInheritingKeyValueNotifications];
+            }
+        }
+        
+        importedAncestors = [NSMutableDictionary dictionaryWithCapacity:count];
+        for (NSUInteger index = 0; index < count; index++)
+        {
+            importedAncestors[names[index]] = ancestors[index];
+        }
+    }
+    
+    // ARC doesn't manage memory from calloc, so strong slots have to be cleared by hand before freeing them.
+    for (NSUInteger index = 0; index < count; index++)
+    {
+        nodes[index] = nil;
+        nodeErrors[index] = nil;
+        ancestors[index] = nil;
+    }
+    free(nodes);
+    free(nodeErrors);
+    free(ancestors);
+    free(order);
+    
+    if (importError && error)
+    {
+        *error = importError;
+    }
+    
+    return [importedAncestors copy];
+}
+
+
+#pragma mark - Private
+
+- (size_t)_batchCountForCount:(NSUInteger)count
+{
+    return (count + AKAncestorImporterBatchSize - 1) / AKAncestorImporterBatchSize;
+}
+
+- (NSRange)_rangeOfBatch:(size_t)batch count:(NSUInteger)count
+{
+    NSUInteger location = batch * AKAncestorImporterBatchSize;
+    return NSMakeRange(location, MIN(AKAncestorImporterBatchSize, count - location));
+}
+
+- (AKAncestorImporterNode *)_nodeNamed:(id)name description:(id)nodeDescription indexesByName:(NSDictionary *)indexesByName error:(NSError **)error
+{
+    if (![name isKindOfClass:[NSString class]] || ![nodeDescription isKindOfClass:[NSDictionary class]])
+    {
+        *error = AKAncestorImporterError(AKAncestorImporterErrorInvalidDescription, [name description], @"Nodes must be dictionaries stored under string names.");
+        return nil;
+    }
+    
+    NSSet *recognizedKeys = [NSSet setWithObjects:AKAncestorImporterParentKey, AKAncestorImporterClassKey, AKAncestorImporterValuesKey, AKAncestorImporterIgnoredPropertiesKey, nil];
+    for (id key in nodeDescription)
+    {
+        if (![recognizedKeys containsObject:key])
+        {
+            *error = AKAncestorImporterError(AKAncestorImporterErrorInvalidDescription, name, [NSString stringWithFormat:@"Node \"%@\" has unrecognized key \"%@\".", name, key]);
+            return nil;
+        }
+    }
+    
+    AKAncestorImporterNode *node = [AKAncestorImporterNode new];
+    node.name = name;
+    node.parentIndex = -1;
+    
+    id parentName = nodeDescription[AKAncestorImporterParentKey];
+    if (parentName)
+    {
+        NSNumber *parentIndex = ([parentName isKindOfClass:[NSString class]]) ? indexesByName[parentName] : nil;
+        if (!parentIndex)
+        {
+            *error = AKAncestorImporterError(AKAncestorImporterErrorUnknownParent, name, [NSString stringWithFormat:@"Node \"%@\" inherits from unknown node \"%@\".", name, parentName]);
+            return nil;
+        }
+        
+        node.parentIndex = [parentIndex integerValue];
+    }
+    
+    id className = nodeDescription[AKAncestorImporterClassKey];
+    if (className)
+    {
+        Class ancestorClass = ([className isKindOfClass:[NSString class]]) ? NSClassFromString(className) : Nil;
+        if (![ancestorClass isSubclassOfClass:[AKAncestor class]])
+        {
+            *error = AKAncestorImporterError(AKAncestorImporterErrorUnknownClass, name, [NSString stringWithFormat:@"Node \"%@\" has class \"%@\" which is not a subclass of AKAncestor.", name, className]);
+            return nil;
+        }
+        
+        node.ancestorClass = ancestorClass;
+    }
+    
+    id values = nodeDescription[AKAncestorImporterValuesKey];
+    id ignoredPropertyNames = nodeDescription[AKAncestorImporterIgnoredPropertiesKey];
+    if ((values && ![values isKindOfClass:[NSDictionary class]]) || (ignoredPropertyNames && ![ignoredPropertyNames isKindOfClass:[NSArray class]]))
+    {
+        *error = AKAncestorImporterError(AKAncestorImporterErrorInvalidDescription, name, [NSString stringWithFormat:@"Node \"%@\" must describe values with a dictionary and ignored properties with an array.", name]);
+        return nil;
+    }
+    
+    node.values = values;
+    node.ignoredPropertyNames = ignoredPropertyNames;
+    
+    return node;
+}
+
+- (NSError *)_resolveClassesAndDepthsOfNodes:(__strong AKAncestorImporterNode **)nodes count:(NSUInteger)count
+{
+    // 0 marks unvisited nodes, 1 marks nodes whose chain is being walked, and 2 marks resolved nodes.
+    uint8_t *states = calloc(MAX(count, 1), sizeof(uint8_t));
+    NSMutableArray *chain = [NSMutableArray array];
+    NSError *error = nil;
+    
+    for (NSUInteger index = 0; index < count && !error; index++)
+    {
+        [chain removeAllObjects];
+        
+        NSInteger current = (NSInteger)index;
+        while (current >= 0 && states[current] == 0)
+        {
+            states[current] = 1;
+            [chain addObject:@(current)];
+            current = nodes[current].parentIndex;
+        }
+        
+        if (current >= 0 && states[current] == 1)
+        {
+            error = AKAncestorImporterError(AKAncestorImporterErrorCycle, nodes[current].name, [NSString stringWithFormat:@"Node \"%@\" is its own ancestor.", nodes[current].name]);
+            break;
+        }
+        
+        // Resolve from the top of the chain down, so every node can copy its parent's class and depth.
+        for (NSNumber *chainIndex in [chain reverseObjectEnumerator])
+        {
+            AKAncestorImporterNode *node = nodes[[chainIndex unsignedIntegerValue]];
+            AKAncestorImporterNode *parent = (node.parentIndex >= 0) ? nodes[node.parentIndex] : nil;
+            
+            node.depth = (parent) ? parent.depth + 1 : 0;
+            if (!node.ancestorClass)
+            {
+                node.ancestorClass = (parent) ? parent.ancestorClass : self.defaultClass;
+            }
+            
+            states[[chainIndex unsignedIntegerValue]] = 2;
+        }
+    }
+    
+    free(states);
+    return error;
+}
+
+- (NSError *)_validateValuesOfNode:(AKAncestorImporterNode *)node
+{
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:node.ancestorClass];
+    
+    NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:node.values.count];
+    for (id propertyName in node.values)
+    {
+        AKPropertyDescription *property = [classInfo propertyNamed:propertyName];
+        if (!property)
+        {
+            return AKAncestorImporterError(AKAncestorImporterErrorUnknownProperty, node.name, [NSString stringWithFormat:@"Node \"%@\" sets \"%@\" which %@ does not pass to descendants.", node.name, propertyName, node.ancestorClass]);
+        }
+        
+        id value = node.values[propertyName];
+        if (self.valueTransformer)
+        {
+            value = self.valueTransformer(property, value);
+        }
+        
+        if (!value || (property.propertyClass && ![value isKindOfClass:property.propertyClass]))
+        {
+            return AKAncestorImporterError(AKAncestorImporterErrorInvalidValue, node.name, [NSString stringWithFormat:@"Node \"%@\" sets \"%@\" to %@, which is not a %@.", node.name, propertyName, node.values[propertyName], property.propertyClass]);
+        }
+        
+        values[propertyName] = value;
+    }
+    node.values = values;
+    
+    for (id propertyName in node.ignoredPropertyNames)
+    {
+        if (![classInfo propertyNamed:propertyName])
+        {
+            return AKAncestorImporterError(AKAncestorImporterErrorUnknownProperty, node.name, [NSString stringWithFormat:@"Node \"%@\" ignores \"%@\" which %@ does not pass to descendants.", node.name, propertyName, node.ancestorClass]);
+        }
+    }
+    
+    return nil;
+}
+
+- (AKAncestor *)_instantiateNode:(AKAncestorImporterNode *)node ancestor:(AKAncestor *)ancestor
+{
+    // Observations are added after every node exists, see -ancestorsFromDictionary:error:.
+    AKAncestor *instance = [[node.ancestorClass alloc] initWithAncestor:ancestor inheritKeyValueNotifications:NO];
+    
+    [node.values enumerateKeysAndObjectsUsingBlock:^(NSString *propertyName, id value, BOOL *stop) {
+        [instance setValue:value forKey:propertyName];
+    }];
+    
+    for (NSString *propertyName in node.ignoredPropertyNames)
+    {
+        [instance stopInheritingValuesForPropertyName:propertyName];
+    }
+    
+    return instance;
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  AKAncestorPlatform.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <pthread.h>
+
+// AncestorKit is written against Apple's spin locks, atomics and clocks. Elsewhere, like when building the benchmarks with GNUstep and libobjc2 on Linux, the few of them it uses are provided here on top of compiler builtins and POSIX, so the rest of the sources don't need to care.
+
+#if defined(__APPLE__)
+
+#import <libkern/OSAtomic.h>
+#import <mach/mach_time.h>
+
+/**
+ *  Returns a number identifying the current thread for as long as it runs.
+ */
+static inline uint64_t AKAncestorCurrentThreadID(void)
+{
+    uint64_t threadID = 0;
+    pthread_threadid_np(NULL, &threadID);
+    return threadID;
+}
+
+#else
+
+#import <sched.h>
+#import <sys/syscall.h>
+#import <time.h>
+#import <unistd.h>
+
+typedef volatile int32_t OSSpinLock;
+
+#define OS_SPINLOCK_INIT 0
+
+static inline void OSSpinLockLock(volatile OSSpinLock *lock)
+{
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+    {
+        // Waiting on loads instead of retrying the exchange keeps the cache line shared until the holder lets go.
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED))
+        {
+            sched_yield();
+        }
+    }
+}
+
+static inline void OSSpinLockUnlock(volatile OSSpinLock *lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline void OSMemoryBarrier(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline int64_t OSAtomicIncrement64Barrier(volatile int64_t *value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t OSAtomicIncrement32Barrier(volatile int32_t *value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t OSAtomicDecrement32Barrier(volatile int32_t *value)
+{
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline bool OSAtomicCompareAndSwapPtrBarrier(void *oldValue, void *newValue, void * volatile *value)
+{
+    return __atomic_compare_exchange_n(value, &oldValue, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+typedef struct
+{
+    uint32_t numer;
+    uint32_t denom;
+} mach_timebase_info_data_t;
+
+/**
+ *  Timestamps are in nanoseconds from the monotonic clock, so the timebase is always 1/1.
+ */
+static inline int mach_timebase_info(mach_timebase_info_data_t *info)
+{
+    info->numer = 1;
+    info->denom = 1;
+    return 0;
+}
+
+static inline uint64_t mach_absolute_time(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+static inline uint64_t AKAncestorCurrentThreadID(void)
+{
+    return (uint64_t)syscall(SYS_gettid);
+}
+
+#endif
@@ -0,0 +1,105 @@
+//
+//  AKAncestorResolutionHistogram.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  The deepest depth a histogram tells apart. Values resolved this many ancestors away or further are counted together at this depth.
+ */
+FOUNDATION_EXPORT const NSUInteger AKAncestorResolutionDepthLimit;
+
+
+/**
+ *  AKAncestorResolutionHistogram counts how far getters of an inheritable property walk before finding a value, so you can find out whether reads mostly resolve on the receiver or its ancestor, and how long the tail of deep walks is. That tells you where flattening or freezing a tree would pay off. A depth of 0 means the receiver had a value of its own, 1 its ancestor, and so on, while reads which found no value anywhere, including ones stopped by an ignored property, are counted as misses.
+ *
+ *  Histograms are disabled by default, and while they're disabled each getter only checks a flag. Once enabled, only one in every sampleInterval reads on each thread is recorded, so histograms can be left on in production. Each thread records into its own table, which the class methods add up into immutable snapshots. Only the outermost read is recorded, not those of the ancestors it consults.
+ */
+@interface AKAncestorResolutionHistogram : NSObject
+
+/**
+ *  Returns YES if resolution depths are being recorded. Defaults to NO.
+ */
++ (BOOL)isEnabled;
+
+/**
+ *  Starts or stops recording resolution depths. Recorded depths are kept when recording stops, so they can still be read.
+ *
+ *  @param enabled YES to record depths, or NO to stop.
+ */
++ (void)setEnabled:(BOOL)enabled;
+
+/**
+ *  Returns how many reads on each thread make up one sample. Defaults to 16.
+ */
++ (NSUInteger)sampleInterval;
+
+/**
+ *  Sets how many reads on each thread make up one sample, so only one of them is recorded.
+ *
+ *  @param sampleInterval The number of reads per sample, which must be greater than 0. Pass 1 to record every read.
+ */
++ (void)setSampleInterval:(NSUInteger)sampleInterval;
+
+/**
+ *  Discards the recorded depths of every thread.
+ */
++ (void)resetHistograms;
+
+/**
+ *  Returns a snapshot of the depths recorded for reads of every property of a class.
+ *
+ *  @param ancestorClass The class whose instances were read. Subclasses are recorded separately. This must not be nil.
+ *
+ *  @return A dictionary with property names as keys and AKAncestorResolutionHistogram instances as values, with only the properties which were sampled.
+ */
++ (NSDictionary *)histogramsForClass:(Class)ancestorClass;
+
+/**
+ *  Returns a snapshot of the depths recorded for reads of a property of a class.
+ *
+ *  @param ancestorClass The class whose instances were read. This must not be nil.
+ *  @param propertyName  The name of the property. This must not be nil.
+ *
+ *  @return A histogram, which is empty if the property wasn't sampled.
+ */
++ (instancetype)histogramForClass:(Class)ancestorClass propertyName:(NSString *)propertyName;
+
+/**
+ *  The number of sampled reads, including misses.
+ */
+@property (assign, nonatomic, readonly) uint64_t sampleCount;
+
+/**
+ *  The number of sampled reads which found no value.
+ */
+@property (assign, nonatomic, readonly) uint64_t missCount;
+
+/**
+ *  The deepest depth a value was found at, or NSNotFound if no sampled read found a value.
+ */
+@property (assign, nonatomic, readonly) NSUInteger maximumDepth;
+
+/**
+ *  Returns the number of sampled reads which found their value at a depth.
+ *
+ *  @param depth The depth, where depths of AKAncestorResolutionDepthLimit and deeper are counted together.
+ *
+ *  @return The number of sampled reads.
+ */
+- (uint64_t)countAtDepth:(NSUInteger)depth;
+
+/**
+ *  Returns the shallowest depth which the given fraction of sampled reads found their value at or before. Misses count as deeper than any depth, so this returns NSNotFound if the fraction can't be reached without them.
+ *
+ *  @param percentile A fraction between 0 and 1, like 0.99.
+ *
+ *  @return The depth, or NSNotFound.
+ */
+- (NSUInteger)depthAtPercentile:(double)percentile;
+
+@end
@@ -0,0 +1,311 @@
+//
+//  AKAncestorResolutionHistogram.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorResolutionHistogram.h"
+#import "AKAncestorResolutionHistogram_Private.h"
+#import "AKAncestorPlatform.h"
+
+enum
+{
+    AKAncestorResolutionBucketCount = 33
+};
+
+const NSUInteger AKAncestorResolutionDepthLimit = AKAncestorResolutionBucketCount - 1;
+
+volatile BOOL AKAncestorResolutionHistogramEnabled = NO;
+
+static volatile NSUInteger AKAncestorResolutionSampleInterval = 16;
+
+
+/**
+ *  The depths recorded for one class and property.
+ */
+@interface AKAncestorResolutionCounter : NSObject
+{
+    @public
+    uint64_t _counts[AKAncestorResolutionBucketCount];
+    uint64_t _missCount;
+}
+
+@end
+
+@implementation AKAncestorResolutionCounter
+
+@end
+
+
+/**
+ *  The counters of one thread, keyed by class and then by property name. Only the owning thread adds counters or counts, so the lock is only contended while the table is being added up or reset.
+ */
+@interface AKAncestorThreadResolutionHistograms : NSObject
+{
+    @public
+    OSSpinLock _spinLock;
+}
+
+@property (strong, nonatomic, readonly) NSMapTable *countersByClass;
+
+@end
+
+@implementation AKAncestorThreadResolutionHistograms
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _spinLock = OS_SPINLOCK_INIT;
+    _countersByClass = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    
+    return self;
+}
+
+@end
+
+
+// Like statistics, tables are registered once per thread and kept for the life of the process.
+static __thread __unsafe_unretained AKAncestorThreadResolutionHistograms *AKAncestorCurrentThreadResolutionHistograms;
+static __thread NSUInteger AKAncestorResolutionReadsSinceSample;
+static OSSpinLock AKAncestorThreadResolutionHistogramsLock = OS_SPINLOCK_INIT;
+
+static NSMutableArray *AKAncestorAllThreadResolutionHistograms()
+{
+    static NSMutableArray *threadHistograms;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        threadHistograms = [NSMutableArray array];
+    });
+    
+    return threadHistograms;
+}
+
+static NSArray *AKAncestorThreadResolutionHistogramsSnapshot()
+{
+    OSSpinLockLock(&AKAncestorThreadResolutionHistogramsLock);
+    NSArray *threadHistograms = [AKAncestorAllThreadResolutionHistograms() copy];
+    OSSpinLockUnlock(&AKAncestorThreadResolutionHistogramsLock);
+    
+    return threadHistograms;
+}
+
+void AKAncestorResolutionHistogramSample(id instance, NSString *propertyName, NSInteger depth)
+{
+    NSCParameterAssert(instance);
+    NSCParameterAssert(propertyName);
+    
+    // Counting down on the thread alone keeps unsampled reads to an increment and a comparison.
+    if (++AKAncestorResolutionReadsSinceSample < AKAncestorResolutionSampleInterval)
+    {
+        return;
+    }
+    
+    AKAncestorResolutionReadsSinceSample = 0;
+    
+    AKAncestorThreadResolutionHistograms *threadHistograms = AKAncestorCurrentThreadResolutionHistograms;
+    if (!threadHistograms)
+    {
+        threadHistograms = [AKAncestorThreadResolutionHistograms new];
+        
+        OSSpinLockLock(&AKAncestorThreadResolutionHistogramsLock);
+        [AKAncestorAllThreadResolutionHistograms() addObject:threadHistograms];
+        OSSpinLockUnlock(&AKAncestorThreadResolutionHistogramsLock);
+        
+        AKAncestorCurrentThreadResolutionHistograms = threadHistograms;
+    }
+    
+    Class ancestorClass = [instance class];
+    
+    OSSpinLockLock(&threadHistograms->_spinLock);
+    
+    NSMutableDictionary *countersByProperty = [threadHistograms.countersByClass objectForKey:ancestorClass];
+    if (!countersByProperty)
+    {
+        countersByProperty = [NSMutableDictionary dictionary];
+        [threadHistograms.countersByClass setObject:countersByProperty forKey:ancestorClass];
+    }
+    
+    AKAncestorResolutionCounter *counter = countersByProperty[propertyName];
+    if (!counter)
+    {
+        counter = [AKAncestorResolutionCounter new];
+        countersByProperty[propertyName] = counter;
+    }
+    
+    if (depth == AKAncestorResolutionDepthMiss)
+    {
+        counter->_missCount++;
+    }
+    else
+    {
+        counter->_counts[MIN((NSUInteger)depth, AKAncestorResolutionDepthLimit)]++;
+    }
+    
+    OSSpinLockUnlock(&threadHistograms->_spinLock);
+}
+
+
+@interface AKAncestorResolutionHistogram ()
+{
+    uint64_t _counts[AKAncestorResolutionBucketCount];
+}
+
+@end
+
+@implementation AKAncestorResolutionHistogram
+
+#pragma mark - Recording
+
++ (BOOL)isEnabled
+{
+    return AKAncestorResolutionHistogramEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+    AKAncestorResolutionHistogramEnabled = enabled;
+    OSMemoryBarrier();
+}
+
++ (NSUInteger)sampleInterval
+{
+    return AKAncestorResolutionSampleInterval;
+}
+
++ (void)setSampleInterval:(NSUInteger)sampleInterval
+{
+    NSParameterAssert(sampleInterval > 0);
+    
+    AKAncestorResolutionSampleInterval = MAX(sampleInterval, (NSUInteger)1);
+    OSMemoryBarrier();
+}
+
++ (void)resetHistograms
+{
+    for (AKAncestorThreadResolutionHistograms *threadHistograms in AKAncestorThreadResolutionHistogramsSnapshot())
+    {
+        OSSpinLockLock(&threadHistograms->_spinLock);
+        [threadHistograms.countersByClass removeAllObjects];
+        OSSpinLockUnlock(&threadHistograms->_spinLock);
+    }
+}
+
+
+#pragma mark - Snapshots
+
++ (NSDictionary *)histogramsForClass:(Class)ancestorClass
+{
+    NSParameterAssert(ancestorClass);
+    
+    NSMutableDictionary *histograms = [NSMutableDictionary dictionary];
+    
+    for (AKAncestorThreadResolutionHistograms *threadHistograms in AKAncestorThreadResolutionHistogramsSnapshot())
+    {
+        OSSpinLockLock(&threadHistograms->_spinLock);
+        
+        NSDictionary *countersByProperty = [threadHistograms.countersByClass objectForKey:ancestorClass];
+        [countersByProperty enumerateKeysAndObjectsUsingBlock:^(NSString *propertyName, AKAncestorResolutionCounter *counter, BOOL *stop) {
+            AKAncestorResolutionHistogram *histogram = histograms[propertyName];
+            if (!histogram)
+            {
+                histogram = [[self alloc] init];
+                histograms[propertyName] = histogram;
+            }
+            
+            [histogram _addCounter:counter];
+        }];
+        
+        OSSpinLockUnlock(&threadHistograms->_spinLock);
+    }
+    
+    return [histograms copy];
+}
+
++ (instancetype)histogramForClass:(Class)ancestorClass propertyName:(NSString *)propertyName
+{
+    NSParameterAssert(propertyName);
+    
+    return [self histogramsForClass:ancestorClass][propertyName] ?: [[self alloc] init];
+}
+
+- (void)_addCounter:(AKAncestorResolutionCounter *)counter
+{
+    for (NSUInteger depth = 0; depth < AKAncestorResolutionBucketCount; depth++)
+    {
+        _counts[depth] += counter->_counts[depth];
+        _sampleCount += counter->_counts[depth];
+    }
+    
+    _missCount += counter->_missCount;
+    _sampleCount += counter->_missCount;
+}
+
+
+#pragma mark - Depths
+
+- (NSUInteger)maximumDepth
+{
+    for (NSUInteger depth = AKAncestorResolutionBucketCount; depth > 0; depth--)
+    {
+        if (_counts[depth - 1] > 0)
+        {
+            return depth - 1;
+        }
+    }
+    
+    return NSNotFound;
+}
+
+- (uint64_t)countAtDepth:(NSUInteger)depth
+{
+    return _counts[MIN(depth, AKAncestorResolutionDepthLimit)];
+}
+
+- (NSUInteger)depthAtPercentile:(double)percentile
+{
+    NSParameterAssert(percentile >= 0.0 && percentile <= 1.0);
+    
+    if (_sampleCount == 0)
+    {
+        return NSNotFound;
+    }
+    
+    uint64_t runningCount = 0;
+    for (NSUInteger depth = 0; depth < AKAncestorResolutionBucketCount; depth++)
+    {
+        runningCount += _counts[depth];
+        if ((double)runningCount >= percentile * (double)_sampleCount)
+        {
+            return depth;
+        }
+    }
+    
+    return NSNotFound;
+}
+
+
+#pragma mark - NSObject
+
+- (NSString *)description
+{
+    NSMutableArray *buckets = [NSMutableArray array];
+    for (NSUInteger depth = 0; depth < AKAncestorResolutionBucketCount; depth++)
+    {
+        if (_counts[depth] > 0)
+        {
+            [buckets addObject:[NSString stringWithFormat:@"%lu%@: %llu", (unsigned long)depth, (depth == AKAncestorResolutionDepthLimit) ? @"+" : @"", _counts[depth]]];
+        }
+    }
+    
+    [buckets addObject:[NSString stringWithFormat:@"miss: %llu", _missCount]];
+    
+    return [NSString stringWithFormat:@"<%@:%p> {%@}", [self class], self, [buckets componentsJoinedByString:@", "]];
+}
+
+@end
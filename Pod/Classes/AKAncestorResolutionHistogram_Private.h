@@ -0,0 +1,36 @@
+//
+//  AKAncestorResolutionHistogram_Private.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorResolutionHistogram.h"
+
+/**
+ *  The depth of a read which found no value.
+ */
+static const NSInteger AKAncestorResolutionDepthMiss = -1;
+
+/**
+ *  YES while AKAncestorResolutionHistogram is recording. Getters read this without synchronization, so reads racing with enabling or disabling may or may not be recorded.
+ */
+FOUNDATION_EXPORT volatile BOOL AKAncestorResolutionHistogramEnabled;
+
+/**
+ *  Counts an outermost read towards the current thread's sample, and records its depth if it completes one.
+ *
+ *  @param instance     The instance which was read.
+ *  @param propertyName The property which was read.
+ *  @param depth        The depth the value was found at, or AKAncestorResolutionDepthMiss.
+ */
+FOUNDATION_EXPORT void AKAncestorResolutionHistogramSample(id instance, NSString *propertyName, NSInteger depth);
+
+/**
+ *  Returns YES if getters should measure their resolution depth. This is inlined, so disabled histograms cost a load and a branch.
+ */
+static inline BOOL AKAncestorResolutionHistogramIsEnabled(void)
+{
+    return __builtin_expect(AKAncestorResolutionHistogramEnabled, NO);
+}
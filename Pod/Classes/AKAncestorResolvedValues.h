@@ -0,0 +1,73 @@
+//
+//  AKAncestorResolvedValues.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  AKAncestorResolvedValues resolves properties of many AKAncestor instances at once, such as every row of a large list before it's displayed, and keeps the results in one flat buffer per property.
+ *
+ *  The instances and all of their ancestors are resolved level by level, starting with the roots, and each level is spread across the active cores, or at most maximumThreadCount threads, with dispatch_apply. An instance which has its own value or ignores a property doesn't need its ancestors, and one which inherits reuses the value already resolved for its ancestor, so ancestors shared by many instances are resolved once instead of once per instance. Instances with fallback ancestors or value providers, and properties which merge or are transformed by a subclass, are resolved by calling their getters instead, so the results always match the getters.
+ *
+ *  Values are resolved while initializing, and instances changed on other threads meanwhile may be resolved from before or after the change. Statistics, traces and resolution depths aren't recorded for values which aren't resolved by getters.
+ */
+@interface AKAncestorResolvedValues : NSObject
+
+/**
+ *  Resolves the given properties of every instance across all active cores.
+ *
+ *  @param ancestors     The AKAncestor instances to resolve. The same instance may appear more than once. This must not be nil.
+ *  @param propertyNames The names of the properties to resolve, or nil for every property passed to descendants by the classes of the instances. A property must be passed to descendants by at least one of the classes, or an AKAncestorUnknownPropertyException is raised. Instances whose class doesn't pass it on resolve it with their getter if they have one, or to nil.
+ *
+ *  @return The resolved values.
+ */
+- (instancetype)initWithAncestors:(NSArray *)ancestors propertyNames:(NSArray *)propertyNames;
+
+/**
+ *  Designated initializer. Resolves the given properties of every instance on at most the given number of threads at once, such as to leave cores free for other work.
+ *
+ *  @param ancestors          The AKAncestor instances to resolve. The same instance may appear more than once. This must not be nil.
+ *  @param propertyNames      The names of the properties to resolve, or nil for every property passed to descendants by the classes of the instances. The same rules apply as for -initWithAncestors:propertyNames:.
+ *  @param maximumThreadCount The most threads to resolve on at once, or 0 for the number of active cores. With 1, everything is resolved on the calling thread.
+ *
+ *  @return The resolved values.
+ */
+- (instancetype)initWithAncestors:(NSArray *)ancestors propertyNames:(NSArray *)propertyNames maximumThreadCount:(NSUInteger)maximumThreadCount NS_DESIGNATED_INITIALIZER;
+
+@property (copy, nonatomic, readonly) NSArray *ancestors;
+
+/**
+ *  The names of the resolved properties, sorted case-insensitively if they weren't given.
+ */
+@property (copy, nonatomic, readonly) NSArray *propertyNames;
+
+/**
+ *  The number of instances, which is the count of ancestors.
+ */
+@property (assign, nonatomic, readonly) NSUInteger count;
+
+/**
+ *  The most threads values were resolved on at once.
+ */
+@property (assign, nonatomic, readonly) NSUInteger maximumThreadCount;
+
+/**
+ *  Returns the resolved value of a property for the instance at the given index of ancestors.
+ *
+ *  @param propertyName One of propertyNames, or an AKAncestorUnknownPropertyException is raised.
+ *  @param index        The index of the instance. This must be less than count.
+ */
+- (id)valueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+
+/**
+ *  Returns the buffer holding the resolved values of a property, with one value for each instance in the order of ancestors. The buffer and its values are owned by the receiver and remain valid for as long as it does.
+ *
+ *  @param propertyName One of propertyNames, or an AKAncestorUnknownPropertyException is raised.
+ */
+- (__unsafe_unretained id const *)valuesForPropertyName:(NSString *)propertyName NS_RETURNS_INNER_POINTER;
+
+@end
@@ -0,0 +1,427 @@
+//
+//  AKAncestorResolvedValues.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorResolvedValues.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import "AKAncestorClassInfo.h"
+#import <objc/message.h>
+
+static const NSUInteger AKAncestorResolvedValuesBatchSize = 256;
+
+typedef NS_ENUM(uint8_t, AKResolvedColumnMode) {
+    // The class neither passes the property on nor has a getter for it.
+    AKResolvedColumnModeNil = 0,
+    // The value comes from the getter, since it may merge, transform or not be inherited at all.
+    AKResolvedColumnModeGetter,
+    // The value is the instance's own, or nothing if the property is ignored, or else its ancestor's.
+    AKResolvedColumnModeInherited
+};
+
+typedef struct AKResolvedColumn {
+    SEL getter;
+    SEL localGetter;
+    AKResolvedColumnMode mode;
+} AKResolvedColumn;
+
+
+@interface AKAncestorResolvedValues ()
+{
+    // One value for each property of each instance, property by property, pointing into the values of the nodes below.
+    __unsafe_unretained id *_values;
+    
+    // One retained value for each property of each node, property by property. Nodes are the instances along with all of their ancestors.
+    __strong id *_nodeValues;
+    NSUInteger _nodeCount;
+}
+
+@property (copy, nonatomic, readonly) NSDictionary *columnsByName;
+
+@end
+
+@implementation AKAncestorResolvedValues
+
+- (instancetype)init
+{
+    return [self initWithAncestors:@[] propertyNames:nil];
+}
+
+- (instancetype)initWithAncestors:(NSArray *)ancestors propertyNames:(NSArray *)propertyNames
+{
+    return [self initWithAncestors:ancestors propertyNames:propertyNames maximumThreadCount:0];
+}
+
+- (instancetype)initWithAncestors:(NSArray *)ancestors propertyNames:(NSArray *)propertyNames maximumThreadCount:(NSUInteger)maximumThreadCount
+{
+    NSParameterAssert(ancestors);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _ancestors = [ancestors copy];
+    _count = _ancestors.count;
+    _maximumThreadCount = (maximumThreadCount > 0) ? maximumThreadCount : MAX([[NSProcessInfo processInfo] activeProcessorCount], (NSUInteger)1);
+    
+    // Everything which can raise is checked before anything is allocated.
+    NSMutableArray *classInfos = [NSMutableArray array];
+    NSHashTable *classes = [NSHashTable hashTableWithOptions:NSPointerFunctionsOpaqueMemory|NSPointerFunctionsOpaquePersonality];
+    for (id ancestor in _ancestors)
+    {
+        if (![ancestor isKindOfClass:[AKAncestor class]])
+        {
+            [NSException raise:NSInvalidArgumentException format:@"Ancestors must be AKAncestor instances, but got %@.", [ancestor class]];
+        }
+        
+        if (![classes containsObject:[ancestor class]])
+        {
+            [classes addObject:[ancestor class]];
+            [classInfos addObject:[AKAncestorClassInfo classInfoForClass:[ancestor class]]];
+        }
+    }
+    
+    _propertyNames = [self _propertyNamesFromRequestedPropertyNames:propertyNames classInfos:classInfos];
+    
+    NSMutableDictionary *columnsByName = [NSMutableDictionary dictionaryWithCapacity:_propertyNames.count];
+    [_propertyNames enumerateObjectsUsingBlock:^(NSString *propertyName, NSUInteger column, BOOL *stop) {
+        columnsByName[propertyName] = @(column);
+    }];
+    _columnsByName = [columnsByName copy];
+    
+    [self _resolve];
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    // ARC doesn't manage memory from calloc, so strong slots have to be cleared by hand before freeing them.
+    NSUInteger valueCount = _nodeCount * _propertyNames.count;
+    for (NSUInteger index = 0; index < valueCount; index++)
+    {
+        _nodeValues[index] = nil;
+    }
+    
+    free(_nodeValues);
+    free(_values);
+}
+
+
+#pragma mark - Values
+
+- (NSUInteger)_columnForPropertyName:(NSString *)propertyName
+{
+    NSNumber *column = self.columnsByName[propertyName];
+    if (!column)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" was resolved.", propertyName];
+    }
+    
+    return [column unsignedIntegerValue];
+}
+
+- (id)valueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    if (index >= self.count)
+    {
+        [NSException raise:NSRangeException format:@"Index %lu is beyond the %lu resolved instances.", (unsigned long)index, (unsigned long)self.count];
+    }
+    
+    return _values[column * self.count + index];
+}
+
+- (__unsafe_unretained id const *)valuesForPropertyName:(NSString *)propertyName
+{
+    return &_values[[self _columnForPropertyName:propertyName] * self.count];
+}
+
+
+#pragma mark - Resolving
+
+- (NSUInteger)_batchCountForCount:(NSUInteger)count
+{
+    return (count + AKAncestorResolvedValuesBatchSize - 1) / AKAncestorResolvedValuesBatchSize;
+}
+
+- (NSRange)_rangeOfBatch:(size_t)batch count:(NSUInteger)count
+{
+    NSUInteger location = batch * AKAncestorResolvedValuesBatchSize;
+    return NSMakeRange(location, MIN(AKAncestorResolvedValuesBatchSize, count - location));
+}
+
+- (void)_applyBatchesForCount:(NSUInteger)count onQueue:(dispatch_queue_t)queue block:(void (^)(NSRange range))block
+{
+    NSUInteger batchCount = [self _batchCountForCount:count];
+    NSUInteger workerCount = MIN(batchCount, self.maximumThreadCount);
+    
+    // Each worker takes every workerCount-th batch, so no more than maximumThreadCount batches are resolved at once however wide the queue is.
+    dispatch_apply(workerCount, queue, ^(size_t worker) {
+        for (NSUInteger batch = worker; batch < batchCount; batch += workerCount)
+        {
+            @autoreleasepool {
+                block([self _rangeOfBatch:batch count:count]);
+            }
+        }
+    });
+}
+
+- (void)_resolve
+{
+    NSUInteger count = self.count;
+    NSArray *propertyNames = self.propertyNames;
+    NSUInteger columnCount = propertyNames.count;
+    
+    // Collecting the nodes is serial, but only visits each shared ancestor once: a chain is climbed until it reaches a node which was already collected.
+    NSMapTable *indexesByNode = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    NSMutableArray *nodes = [NSMutableArray arrayWithCapacity:count];
+    NSMutableArray *chain = [NSMutableArray array];
+    
+    NSUInteger nodeCapacity = MAX(count, 1);
+    NSUInteger *parentIndexes = calloc(nodeCapacity, sizeof(NSUInteger));
+    NSUInteger *depths = calloc(nodeCapacity, sizeof(NSUInteger));
+    NSUInteger *rowNodeIndexes = calloc(MAX(count, 1), sizeof(NSUInteger));
+    NSUInteger maximumDepth = 0;
+    
+    for (NSUInteger row = 0; row < count; row++)
+    {
+        AKAncestor *ancestor = self.ancestors[row];
+        AKAncestor *node = ancestor;
+        NSNumber *collectedIndex = nil;
+        while (node && !(collectedIndex = [indexesByNode objectForKey:node]))
+        {
+            [chain addObject:node];
+            node = node.ancestor;
+        }
+        
+        NSUInteger parentIndex = (collectedIndex) ? [collectedIndex unsignedIntegerValue] : NSNotFound;
+        for (AKAncestor *chainNode in [chain reverseObjectEnumerator])
+        {
+            NSUInteger nodeIndex = nodes.count;
+            if (nodeIndex == nodeCapacity)
+            {
+                nodeCapacity *= 2;
+                parentIndexes = realloc(parentIndexes, nodeCapacity * sizeof(NSUInteger));
+                depths = realloc(depths, nodeCapacity * sizeof(NSUInteger));
+            }
+            
+            parentIndexes[nodeIndex] = parentIndex;
+            depths[nodeIndex] = (parentIndex != NSNotFound) ? depths[parentIndex] + 1 : 0;
+            maximumDepth = MAX(maximumDepth, depths[nodeIndex]);
+            
+            [nodes addObject:chainNode];
+            [indexesByNode setObject:@(nodeIndex) forKey:chainNode];
+            parentIndex = nodeIndex;
+        }
+        
+        [chain removeAllObjects];
+        rowNodeIndexes[row] = [[indexesByNode objectForKey:ancestor] unsignedIntegerValue];
+    }
+    
+    NSUInteger nodeCount = nodes.count;
+    
+    // Instances of the same class share their class info, so columns are worked out once per class.
+    NSMapTable *slotsByClass = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory|NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory];
+    NSMutableArray *classInfos = [NSMutableArray array];
+    NSUInteger *classSlots = calloc(MAX(nodeCount, 1), sizeof(NSUInteger));
+    for (NSUInteger nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+    {
+        Class nodeClass = [nodes[nodeIndex] class];
+        NSNumber *slot = [slotsByClass objectForKey:nodeClass];
+        if (!slot)
+        {
+            slot = @(classInfos.count);
+            [classInfos addObject:[AKAncestorClassInfo classInfoForClass:nodeClass]];
+            [slotsByClass setObject:slot forKey:nodeClass];
+        }
+        
+        classSlots[nodeIndex] = [slot unsignedIntegerValue];
+    }
+    
+    _nodeCount = nodeCount;
+    _nodeValues = (__strong id *)calloc(MAX(nodeCount * columnCount, 1), sizeof(id));
+    _values = (__unsafe_unretained id *)calloc(MAX(count * columnCount, 1), sizeof(id));
+    
+    AKResolvedColumn *classColumns = [self _copyColumnsForPropertyNames:propertyNames classInfos:classInfos];
+    
+    // A counting sort by depth places every node after its ancestor, and groups nodes which can be resolved at the same time.
+    NSUInteger *levelStarts = calloc(maximumDepth + 2, sizeof(NSUInteger));
+    for (NSUInteger nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+    {
+        levelStarts[depths[nodeIndex] + 1]++;
+    }
+    for (NSUInteger depth = 1; depth <= maximumDepth + 1; depth++)
+    {
+        levelStarts[depth] += levelStarts[depth - 1];
+    }
+    
+    NSUInteger *order = calloc(MAX(nodeCount, 1), sizeof(NSUInteger));
+    NSUInteger *levelPositions = calloc(maximumDepth + 1, sizeof(NSUInteger));
+    memcpy(levelPositions, levelStarts, (maximumDepth + 1) * sizeof(NSUInteger));
+    for (NSUInteger nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++)
+    {
+        order[levelPositions[depths[nodeIndex]]++] = nodeIndex;
+    }
+    free(levelPositions);
+    
+    // Each slot is only written by the iteration which owns it, and ancestors' slots were filled by an earlier level, which makes these safe to fill concurrently.
+    __strong id *nodeValues = _nodeValues;
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    for (NSUInteger depth = 0; depth <= maximumDepth && nodeCount > 0; depth++)
+    {
+        NSUInteger levelStart = levelStarts[depth];
+        NSUInteger levelCount = levelStarts[depth + 1] - levelStart;
+        
+        [self _applyBatchesForCount:levelCount onQueue:queue block:^(NSRange range) {
+            for (NSUInteger position = levelStart + range.location; position < levelStart + NSMaxRange(range); position++)
+            {
+                NSUInteger nodeIndex = order[position];
+                [self _resolveNode:nodes[nodeIndex] atIndex:nodeIndex parentIndex:parentIndexes[nodeIndex] columns:&classColumns[classSlots[nodeIndex] * columnCount] propertyNames:propertyNames values:nodeValues nodeCount:nodeCount];
+            }
+        }];
+    }
+    
+    // The instances' values point into their nodes' values, so each property's values are contiguous in the order of ancestors.
+    __unsafe_unretained id *values = _values;
+    [self _applyBatchesForCount:count onQueue:queue block:^(NSRange range) {
+        for (NSUInteger column = 0; column < columnCount; column++)
+        {
+            for (NSUInteger row = range.location; row < NSMaxRange(range); row++)
+            {
+                values[column * count + row] = nodeValues[column * nodeCount + rowNodeIndexes[row]];
+            }
+        }
+    }];
+    
+    free(order);
+    free(levelStarts);
+    free(classColumns);
+    free(classSlots);
+    free(rowNodeIndexes);
+    free(depths);
+    free(parentIndexes);
+}
+
+- (NSArray *)_propertyNamesFromRequestedPropertyNames:(NSArray *)requestedPropertyNames classInfos:(NSArray *)classInfos
+{
+    if (!requestedPropertyNames)
+    {
+        NSMutableSet *propertyNames = [NSMutableSet set];
+        for (AKAncestorClassInfo *classInfo in classInfos)
+        {
+            [propertyNames addObjectsFromArray:classInfo.propertyNames];
+        }
+        
+        return [[propertyNames allObjects] sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)];
+    }
+    
+    // Without any instances there are no classes to check the names against.
+    for (NSString *propertyName in requestedPropertyNames)
+    {
+        BOOL isInherited = (classInfos.count == 0);
+        for (AKAncestorClassInfo *classInfo in classInfos)
+        {
+            isInherited = isInherited || ([classInfo indexOfPropertyName:propertyName] != NSNotFound);
+        }
+        
+        if (!isInherited)
+        {
+            [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by the classes of the instances.", propertyName];
+        }
+    }
+    
+    return [requestedPropertyNames copy];
+}
+
+- (AKResolvedColumn *)_copyColumnsForPropertyNames:(NSArray *)propertyNames classInfos:(NSArray *)classInfos
+{
+    NSUInteger columnCount = propertyNames.count;
+    AKResolvedColumn *classColumns = calloc(MAX(classInfos.count * columnCount, 1), sizeof(AKResolvedColumn));
+    
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        NSString *propertyName = propertyNames[column];
+        
+        // Classes which don't pass the property on may still have a getter for it, which is found through any class that does.
+        SEL getter = NULL;
+        for (AKAncestorClassInfo *classInfo in classInfos)
+        {
+            NSUInteger propertyIndex = [classInfo indexOfPropertyName:propertyName];
+            if (propertyIndex != NSNotFound)
+            {
+                getter = [classInfo getterAtIndex:propertyIndex];
+                break;
+            }
+        }
+        
+        [classInfos enumerateObjectsUsingBlock:^(AKAncestorClassInfo *classInfo, NSUInteger slot, BOOL *stop) {
+            AKResolvedColumn *resolvedColumn = &classColumns[slot * columnCount + column];
+            NSUInteger propertyIndex = [classInfo indexOfPropertyName:propertyName];
+            
+            if (propertyIndex == NSNotFound)
+            {
+                resolvedColumn->getter = getter;
+                resolvedColumn->mode = (getter && [classInfo.ancestorClass instancesRespondToSelector:getter]) ? AKResolvedColumnModeGetter : AKResolvedColumnModeNil;
+                return;
+            }
+            
+            resolvedColumn->getter = [classInfo getterAtIndex:propertyIndex];
+            resolvedColumn->localGetter = [classInfo localGetterAtIndex:propertyIndex];
+            
+            BOOL resolvesWithGetter = [classInfo propertyAtIndexTransformsInheritedValues:propertyIndex] || [classInfo mergePolicyAtIndex:propertyIndex] != AKAncestorMergePolicyReplace;
+            resolvedColumn->mode = (resolvesWithGetter) ? AKResolvedColumnModeGetter : AKResolvedColumnModeInherited;
+        }];
+    }
+    
+    return classColumns;
+}
+
+- (void)_resolveNode:(AKAncestor *)node atIndex:(NSUInteger)nodeIndex parentIndex:(NSUInteger)parentIndex columns:(const AKResolvedColumn *)columns propertyNames:(NSArray *)propertyNames values:(__strong id *)values nodeCount:(NSUInteger)nodeCount
+{
+    BOOL resolvesFromAncestor = [node _resolvesValuesFromFirstAncestorOnly];
+    NSSet *ignoredPropertyNames = nil;
+    BOOL hasLoadedIgnoredPropertyNames = NO;
+    
+    NSUInteger columnCount = propertyNames.count;
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        const AKResolvedColumn *resolvedColumn = &columns[column];
+        if (resolvedColumn->mode == AKResolvedColumnModeNil)
+        {
+            continue;
+        }
+        
+        if (resolvedColumn->mode == AKResolvedColumnModeGetter || !resolvesFromAncestor)
+        {
+            values[column * nodeCount + nodeIndex] = ((id (*)(id, SEL))objc_msgSend)(node, resolvedColumn->getter);
+            continue;
+        }
+        
+        id localValue = ((id (*)(id, SEL))objc_msgSend)(node, resolvedColumn->localGetter);
+        if (localValue)
+        {
+            values[column * nodeCount + nodeIndex] = localValue;
+            continue;
+        }
+        
+        // Most instances don't ignore anything, so the copy is only taken once per instance when it's first needed.
+        if (!hasLoadedIgnoredPropertyNames)
+        {
+            ignoredPropertyNames = [node _ignoredPropertyNames];
+            hasLoadedIgnoredPropertyNames = YES;
+        }
+        
+        if (parentIndex != NSNotFound && ![ignoredPropertyNames containsObject:propertyNames[column]])
+        {
+            values[column * nodeCount + nodeIndex] = values[column * nodeCount + parentIndex];
+        }
+    }
+}
+
+@end
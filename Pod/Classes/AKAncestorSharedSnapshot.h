@@ -0,0 +1,119 @@
+//
+//  AKAncestorSharedSnapshot.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKAncestorSnapshot;
+
+/**
+ *  AKAncestorSharedSnapshotPublisher publishes AKAncestorSnapshot layouts into a named POSIX shared memory segment, so processes on the same machine can share one copy of a configuration instead of each building its own.
+ *
+ *  The segment holds two slots of the given capacity and a sequence number. Each publication is written into the slot not holding the latest one, bracketed by incrementing the sequence, so readers keep reading the latest publication while the next one is written. Only one publisher should write to a segment at a time. Publishing from several threads of the same publisher is safe.
+ */
+@interface AKAncestorSharedSnapshotPublisher : NSObject
+
+/**
+ *  Designated initializer. Creates the shared memory segment with the given name, or opens it if it already exists, such as when a publisher is restarted.
+ *
+ *  @param name     The name of the segment. Names are limited to 30 characters on some platforms. This must not be nil.
+ *  @param capacity The largest snapshot, in bytes, which can be published. An existing segment must have been created with the same capacity.
+ *  @param error    If the segment couldn't be created or opened, an error describing why.
+ *
+ *  @return An initialized publisher, or nil if the segment couldn't be created or opened.
+ */
+- (instancetype)initWithName:(NSString *)name capacity:(NSUInteger)capacity error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+@property (copy, nonatomic, readonly) NSString *name;
+
+@property (assign, nonatomic, readonly) NSUInteger capacity;
+
+/**
+ *  The number of snapshots published to the segment, including those published by earlier publishers of the same segment.
+ */
+@property (assign, readonly) uint64_t generation;
+
+/**
+ *  Writes a snapshot of the given instances and all of their ancestors, and publishes it as the next generation once it's completely written.
+ *
+ *  @param ancestorsByName A dictionary mapping names to AKAncestor instances, as passed to +[AKAncestorSnapshot snapshotDataWithAncestorsByName:error:]. This must not be nil.
+ *  @param error           If the snapshot couldn't be written or is larger than the capacity, an error describing why.
+ *
+ *  @return YES if the snapshot was published.
+ */
+- (BOOL)publishAncestorsByName:(NSDictionary *)ancestorsByName error:(NSError **)error;
+
+/**
+ *  Removes the name of a shared memory segment. Processes which already mapped it keep their mapping, and the memory is freed once the last of them unmaps it.
+ *
+ *  @param name  The name of the segment. This must not be nil.
+ *  @param error If the name couldn't be removed, an error describing why.
+ *
+ *  @return YES if the name was removed.
+ */
++ (BOOL)removeSegmentNamed:(NSString *)name error:(NSError **)error;
+
+@end
+
+
+/**
+ *  AKAncestorSharedSnapshot maps a segment written by an AKAncestorSharedSnapshotPublisher read only and resolves values straight from its records, without copying the snapshot or creating instances.
+ *
+ *  Reads never take locks. Each read notes the sequence number, resolves from the slot of the latest publication, and is retried if the publisher started rewriting that slot meanwhile, so every call returns values from a single generation. The classes stored in the snapshot must be linked into the reading process.
+ */
+@interface AKAncestorSharedSnapshot : NSObject
+
+/**
+ *  Designated initializer. Maps the shared memory segment with the given name.
+ *
+ *  @param name  The name the publisher was created with. This must not be nil.
+ *  @param error If the segment doesn't exist or wasn't created by a compatible publisher, an error describing why.
+ *
+ *  @return An initialized reader, or nil if the segment couldn't be mapped.
+ */
+- (instancetype)initWithName:(NSString *)name error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+@property (copy, nonatomic, readonly) NSString *name;
+
+/**
+ *  The generation of the latest publication, or 0 if nothing has been published yet.
+ */
+@property (assign, readonly) uint64_t generation;
+
+/**
+ *  The names stored in the latest publication.
+ */
+- (NSArray *)names;
+
+/**
+ *  Returns the value of a property for the instance stored under the given name in the latest publication, resolved as by -[AKAncestorSnapshot valueForPropertyName:ofAncestorAtIndex:].
+ *
+ *  @param propertyName The name of a property inherited by the instance's class, or an AKAncestorUnknownPropertyException is raised.
+ *  @param name         The name of the instance.
+ *
+ *  @return The resolved value, or nil if no instance was stored under the name or it doesn't resolve a value.
+ */
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestorNamed:(NSString *)name;
+
+/**
+ *  Returns the values of several properties for the instance stored under the given name, all resolved from the same publication.
+ *
+ *  @param propertyNames The names of properties inherited by the instance's class, or an AKAncestorUnknownPropertyException is raised.
+ *  @param name          The name of the instance.
+ *
+ *  @return A dictionary mapping the property names to their resolved values. Properties which don't resolve a value are left out.
+ */
+- (NSDictionary *)valuesForPropertyNames:(NSArray *)propertyNames ofAncestorNamed:(NSString *)name;
+
+/**
+ *  Copies the latest publication into a private snapshot, for callers which need AKAncestor instances rather than values.
+ *
+ *  @return A snapshot of the latest publication, or nil if nothing has been published yet.
+ */
+- (AKAncestorSnapshot *)currentSnapshot;
+
+@end
@@ -0,0 +1,504 @@
+//
+//  AKAncestorSharedSnapshot.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorSharedSnapshot.h"
+#import "AKAncestorSnapshot.h"
+#import "AKAncestorPlatform.h"
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+#pragma mark - Layout
+
+// The header is followed by two slots of capacity bytes each. Generation g lives in slot g % 2, and the sequence is 2g while it's the latest publication and 2g + 1 while generation g + 1 is being written into the other slot. A reader which saw a sequence of 2g or 2g + 1 can keep reading slot g % 2 until the sequence reaches 2g + 3, when generation g + 2 starts overwriting it.
+
+static const uint32_t AKSharedSnapshotMagic = 0x53534B41; // "AKSS"
+static const uint16_t AKSharedSnapshotVersion = 1;
+static const uint16_t AKSharedSnapshotByteOrderMark = 0x0102;
+static const uint64_t AKSharedSnapshotSlotsOffset = 64;
+
+typedef struct AKSharedSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t byteOrder;
+    uint64_t capacity;
+    volatile int64_t sequence;
+    uint64_t lengths[2];
+} AKSharedSnapshotHeader;
+
+static uint64_t AKSharedSnapshotSegmentLength(uint64_t capacity)
+{
+    return AKSharedSnapshotSlotsOffset + 2 * capacity;
+}
+
+static NSString *AKSharedSnapshotSegmentName(NSString *name)
+{
+    return ([name hasPrefix:@"/"]) ? name : [@"/" stringByAppendingString:name];
+}
+
+static NSError *AKSharedSnapshotError(AKAncestorSnapshotError code, NSString *description)
+{
+    return [NSError errorWithDomain:AKAncestorSnapshotErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+static NSError *AKSharedSnapshotPOSIXError(NSString *description)
+{
+    NSError *underlyingError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+    return [NSError errorWithDomain:AKAncestorSnapshotErrorDomain code:AKAncestorSnapshotErrorSharedMemory userInfo:@{NSLocalizedDescriptionKey: description, NSUnderlyingErrorKey: underlyingError}];
+}
+
+static BOOL AKSharedSnapshotHeaderIsCompatible(const AKSharedSnapshotHeader *header, NSError **error)
+{
+    if (header->magic != AKSharedSnapshotMagic)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorCorruptData, @"The shared memory segment wasn't created by an AncestorKit publisher.");
+        }
+        return NO;
+    }
+    
+    if (header->version != AKSharedSnapshotVersion || header->byteOrder != AKSharedSnapshotByteOrderMark)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorUnsupportedVersion, [NSString stringWithFormat:@"Shared snapshot version %u is not supported.", header->version]);
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+
+#pragma mark - Publisher
+
+@interface AKAncestorSharedSnapshotPublisher ()
+{
+    AKSharedSnapshotHeader *_header;
+    uint8_t *_slots;
+    size_t _mappedLength;
+}
+
+@end
+
+@implementation AKAncestorSharedSnapshotPublisher
+
+- (instancetype)initWithName:(NSString *)name capacity:(NSUInteger)capacity error:(NSError **)error
+{
+    NSParameterAssert(name);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _name = [name copy];
+    
+    // Slots start 8 byte aligned, like the sections of a snapshot, so snapshots can be read in place.
+    _capacity = (capacity + 7) & ~(NSUInteger)7;
+    _mappedLength = (size_t)AKSharedSnapshotSegmentLength(_capacity);
+    
+    int descriptor = shm_open([AKSharedSnapshotSegmentName(_name) UTF8String], O_RDWR | O_CREAT, 0644);
+    if (descriptor < 0)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotPOSIXError([NSString stringWithFormat:@"The shared memory segment \"%@\" couldn't be opened.", _name]);
+        }
+        return nil;
+    }
+    
+    struct stat status;
+    BOOL isSized = (fstat(descriptor, &status) == 0);
+    if (isSized && status.st_size == 0)
+    {
+        isSized = (ftruncate(descriptor, (off_t)_mappedLength) == 0);
+    }
+    else if (isSized && (uint64_t)status.st_size != _mappedLength)
+    {
+        close(descriptor);
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorCapacityExceeded, [NSString stringWithFormat:@"The shared memory segment \"%@\" already exists with a different capacity.", _name]);
+        }
+        return nil;
+    }
+    
+    void *bytes = (isSized) ? mmap(NULL, _mappedLength, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    if (bytes == MAP_FAILED)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotPOSIXError([NSString stringWithFormat:@"The shared memory segment \"%@\" couldn't be mapped.", _name]);
+        }
+        close(descriptor);
+        return nil;
+    }
+    
+    // The mapping keeps the segment alive, so the descriptor isn't needed anymore.
+    close(descriptor);
+    
+    _header = (AKSharedSnapshotHeader *)bytes;
+    _slots = (uint8_t *)bytes + AKSharedSnapshotSlotsOffset;
+    
+    if (_header->magic == 0)
+    {
+        // New segments are zero filled. The magic number is written last, so readers never accept a half initialized header.
+        _header->version = AKSharedSnapshotVersion;
+        _header->byteOrder = AKSharedSnapshotByteOrderMark;
+        _header->capacity = _capacity;
+        OSMemoryBarrier();
+        _header->magic = AKSharedSnapshotMagic;
+    }
+    else if (!AKSharedSnapshotHeaderIsCompatible(_header, error))
+    {
+        return nil;
+    }
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithName:nil capacity:0 error:NULL];
+}
+
+- (void)dealloc
+{
+    if (_header)
+    {
+        munmap(_header, _mappedLength);
+    }
+}
+
+- (uint64_t)generation
+{
+    return (uint64_t)_header->sequence / 2;
+}
+
+- (BOOL)publishAncestorsByName:(NSDictionary *)ancestorsByName error:(NSError **)error
+{
+    NSData *data = [AKAncestorSnapshot snapshotDataWithAncestorsByName:ancestorsByName error:error];
+    if (!data)
+    {
+        return NO;
+    }
+    
+    if (data.length > self.capacity)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorCapacityExceeded, [NSString stringWithFormat:@"The snapshot needs %lu bytes, but \"%@\" only holds %lu.", (unsigned long)data.length, self.name, (unsigned long)self.capacity]);
+        }
+        return NO;
+    }
+    
+    @synchronized(self)
+    {
+        // An odd sequence means an earlier publisher stopped partway through writing the next generation, which is simply written again.
+        int64_t sequence = _header->sequence;
+        uint64_t generation = (uint64_t)sequence / 2 + 1;
+        NSUInteger slot = generation % 2;
+        
+        if (sequence % 2 == 0)
+        {
+            OSAtomicIncrement64Barrier(&_header->sequence);
+        }
+        
+        memcpy(_slots + slot * self.capacity, data.bytes, data.length);
+        _header->lengths[slot] = data.length;
+        
+        OSAtomicIncrement64Barrier(&_header->sequence);
+    }
+    
+    return YES;
+}
+
++ (BOOL)removeSegmentNamed:(NSString *)name error:(NSError **)error
+{
+    NSParameterAssert(name);
+    
+    if (shm_unlink([AKSharedSnapshotSegmentName(name) UTF8String]) != 0)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotPOSIXError([NSString stringWithFormat:@"The shared memory segment \"%@\" couldn't be removed.", name]);
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+@end
+
+
+#pragma mark - Reader
+
+@interface AKAncestorSharedSnapshot ()
+{
+    const AKSharedSnapshotHeader *_header;
+    const uint8_t *_slots;
+    size_t _mappedLength;
+    uint64_t _capacity;
+    
+    OSSpinLock _spinLock;
+    AKAncestorSnapshot *_slotSnapshot;
+    uint64_t _slotSnapshotGeneration;
+}
+
+@end
+
+@implementation AKAncestorSharedSnapshot
+
+- (instancetype)initWithName:(NSString *)name error:(NSError **)error
+{
+    NSParameterAssert(name);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _name = [name copy];
+    _spinLock = OS_SPINLOCK_INIT;
+    
+    int descriptor = shm_open([AKSharedSnapshotSegmentName(_name) UTF8String], O_RDONLY, 0);
+    if (descriptor < 0)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotPOSIXError([NSString stringWithFormat:@"The shared memory segment \"%@\" couldn't be opened.", _name]);
+        }
+        return nil;
+    }
+    
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || (uint64_t)status.st_size < AKSharedSnapshotSlotsOffset)
+    {
+        close(descriptor);
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorCorruptData, [NSString stringWithFormat:@"The shared memory segment \"%@\" hasn't been set up by a publisher.", _name]);
+        }
+        return nil;
+    }
+    
+    _mappedLength = (size_t)status.st_size;
+    void *bytes = mmap(NULL, _mappedLength, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    
+    if (bytes == MAP_FAILED)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotPOSIXError([NSString stringWithFormat:@"The shared memory segment \"%@\" couldn't be mapped.", _name]);
+        }
+        return nil;
+    }
+    
+    _header = (const AKSharedSnapshotHeader *)bytes;
+    _slots = (const uint8_t *)bytes + AKSharedSnapshotSlotsOffset;
+    
+    if (!AKSharedSnapshotHeaderIsCompatible(_header, error))
+    {
+        return nil;
+    }
+    
+    OSMemoryBarrier();
+    _capacity = _header->capacity;
+    if (AKSharedSnapshotSegmentLength(_capacity) > _mappedLength)
+    {
+        if (error)
+        {
+            *error = AKSharedSnapshotError(AKAncestorSnapshotErrorCorruptData, [NSString stringWithFormat:@"The shared memory segment \"%@\" is shorter than its capacity.", _name]);
+        }
+        return nil;
+    }
+    
+    return self;
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithName:nil error:NULL];
+}
+
+- (void)dealloc
+{
+    // Snapshots of a slot only point into the mapping, so they're released before it's unmapped.
+    _slotSnapshot = nil;
+    
+    if (_header)
+    {
+        munmap((void *)_header, _mappedLength);
+    }
+}
+
+- (uint64_t)generation
+{
+    return (uint64_t)_header->sequence / 2;
+}
+
+
+#pragma mark - Reading
+
+- (NSArray *)names
+{
+    return [self _readUsingBlock:^id(AKAncestorSnapshot *snapshot) {
+        return snapshot.names;
+    }] ?: @[];
+}
+
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestorNamed:(NSString *)name
+{
+    NSParameterAssert(propertyName);
+    
+    return [self valuesForPropertyNames:@[propertyName] ofAncestorNamed:name][propertyName];
+}
+
+- (NSDictionary *)valuesForPropertyNames:(NSArray *)propertyNames ofAncestorNamed:(NSString *)name
+{
+    NSParameterAssert(propertyNames);
+    
+    return [self _readUsingBlock:^id(AKAncestorSnapshot *snapshot) {
+        NSUInteger index = [snapshot indexOfAncestorNamed:name];
+        if (index == NSNotFound)
+        {
+            return nil;
+        }
+        
+        NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:propertyNames.count];
+        for (NSString *propertyName in propertyNames)
+        {
+            values[propertyName] = [snapshot valueForPropertyName:propertyName ofAncestorAtIndex:index];
+        }
+        
+        return values;
+    }] ?: @{};
+}
+
+- (AKAncestorSnapshot *)currentSnapshot
+{
+    NSData *data = nil;
+    while (YES)
+    {
+        int64_t sequence = _header->sequence;
+        OSMemoryBarrier();
+        
+        uint64_t generation = (uint64_t)sequence / 2;
+        if (generation == 0)
+        {
+            return nil;
+        }
+        
+        uint64_t length = MIN(_header->lengths[generation % 2], _capacity);
+        data = [NSData dataWithBytes:(_slots + (generation % 2) * _capacity) length:(NSUInteger)length];
+        
+        OSMemoryBarrier();
+        if (_header->sequence < (int64_t)(2 * generation + 3))
+        {
+            break;
+        }
+    }
+    
+    NSError *error = nil;
+    AKAncestorSnapshot *snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:&error];
+    if (!snapshot)
+    {
+        [NSException raise:NSInternalInconsistencyException format:@"The latest publication to \"%@\" can't be read: %@", self.name, [error localizedDescription]];
+    }
+    
+    return snapshot;
+}
+
+
+#pragma mark - Private
+
+- (id)_readUsingBlock:(id (^)(AKAncestorSnapshot *snapshot))block
+{
+    while (YES)
+    {
+        int64_t sequence = _header->sequence;
+        OSMemoryBarrier();
+        
+        uint64_t generation = (uint64_t)sequence / 2;
+        if (generation == 0)
+        {
+            return nil;
+        }
+        
+        NSError *error = nil;
+        AKAncestorSnapshot *snapshot = [self _snapshotOfGeneration:generation error:&error];
+        
+        // Reads racing with the publisher may see any bytes at all, which can make them raise. That only matters if the slot turns out not to have changed.
+        id result = nil;
+        NSException *exception = nil;
+        @try
+        {
+            result = (snapshot) ? block(snapshot) : nil;
+        }
+        @catch (NSException *caughtException)
+        {
+            exception = caughtException;
+        }
+        
+        OSMemoryBarrier();
+        if (_header->sequence >= (int64_t)(2 * generation + 3))
+        {
+            continue;
+        }
+        
+        if (!snapshot)
+        {
+            [NSException raise:NSInternalInconsistencyException format:@"The latest publication to \"%@\" can't be read: %@", self.name, [error localizedDescription]];
+        }
+        
+        if (exception)
+        {
+            @throw exception;
+        }
+        
+        return result;
+    }
+}
+
+- (AKAncestorSnapshot *)_snapshotOfGeneration:(uint64_t)generation error:(NSError **)error
+{
+    OSSpinLockLock(&_spinLock);
+    AKAncestorSnapshot *snapshot = (_slotSnapshotGeneration == generation) ? _slotSnapshot : nil;
+    OSSpinLockUnlock(&_spinLock);
+    
+    if (snapshot)
+    {
+        return snapshot;
+    }
+    
+    // Validating the layout and reading the names once per generation keeps it out of every read. A snapshot made while its slot was being rewritten is never used again, since by then the sequence has moved past its generation for good.
+    NSUInteger slot = generation % 2;
+    uint64_t length = MIN(_header->lengths[slot], _capacity);
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)(_slots + slot * _capacity) length:(NSUInteger)length freeWhenDone:NO];
+    
+    snapshot = [[AKAncestorSnapshot alloc] initWithData:data error:error];
+    if (snapshot)
+    {
+        OSSpinLockLock(&_spinLock);
+        __attribute__((objc_precise_lifetime)) AKAncestorSnapshot *previousSnapshot = _slotSnapshot;
+        _slotSnapshot = snapshot;
+        _slotSnapshotGeneration = generation;
+        OSSpinLockUnlock(&_spinLock);
+    }
+    
+    return snapshot;
+}
+
+@end
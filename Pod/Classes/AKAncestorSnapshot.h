@@ -0,0 +1,148 @@
+//
+//  AKAncestorSnapshot.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKAncestor;
+
+/**
+ *  Error domain for errors produced while writing or reading snapshots.
+ */
+FOUNDATION_EXPORT NSString *const AKAncestorSnapshotErrorDomain;
+
+/**
+ *  Error codes in the AKAncestorSnapshotErrorDomain.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorSnapshotError){
+    /**
+     *  The snapshot data is truncated or its sections reference data outside of it.
+     */
+    AKAncestorSnapshotErrorCorruptData = 1,
+    /**
+     *  The snapshot was written by an incompatible version of AncestorKit or on a machine with a different byte order.
+     */
+    AKAncestorSnapshotErrorUnsupportedVersion,
+    /**
+     *  The snapshot references a class which isn't linked into the process or isn't a subclass of AKAncestor.
+     */
+    AKAncestorSnapshotErrorUnknownClass,
+    /**
+     *  A property value can't be stored because it isn't a string, number, data, or an object conforming to NSSecureCoding whose class +[AKAncestor allowedClassesForDecodingPropertyName:] allows.
+     */
+    AKAncestorSnapshotErrorUnsupportedValue,
+    /**
+     *  A shared memory segment couldn't be created, opened or mapped. The POSIX error is in the NSUnderlyingErrorKey of the userInfo.
+     */
+    AKAncestorSnapshotErrorSharedMemory,
+    /**
+     *  The snapshot is larger than the capacity of the shared memory segment it was published to.
+     */
+    AKAncestorSnapshotErrorCapacityExceeded,
+    /**
+     *  An instance's class has more inheritable properties than a snapshot record can store, which is 32767.
+     */
+    AKAncestorSnapshotErrorTooManyProperties
+};
+
+/**
+ *  AKAncestorSnapshot stores whole trees of AKAncestor instances in a flat binary layout which can be memory mapped and read without parsing. Classes, property names and string values are interned in a string table, and each instance is stored as a fixed size record holding its class, its ancestor's index and a range of its own property values.
+ *
+ *  Loading a snapshot only validates the layout. Instances are created on first access, along with any of their ancestors which haven't been created yet, so configurations which are only partially used at launch only pay for what they touch. Materialized instances are retained by the snapshot and the same instance is returned for every access.
+ *
+ *  Values are limited to strings, numbers, data and objects conforming to NSSecureCoding. The last are stored as keyed archives and decoded when their instance is materialized. Snapshots use the byte order of the machine that wrote them, and are rejected on machines with a different byte order.
+ */
+@interface AKAncestorSnapshot : NSObject
+
+#pragma mark - Writing snapshots
+
+/**
+ *  Writes a snapshot containing the given instances and all of their ancestors. Ancestors shared between instances are only written once.
+ *
+ *  @param ancestorsByName A dictionary mapping names to AKAncestor instances which should be retrievable with -ancestorNamed:. This must not be nil.
+ *  @param error           If the snapshot couldn't be written, an error describing why.
+ *
+ *  @return The snapshot data, or nil if a value couldn't be stored.
+ */
++ (NSData *)snapshotDataWithAncestorsByName:(NSDictionary *)ancestorsByName error:(NSError **)error;
+
+
+#pragma mark - Reading snapshots
+
+/**
+ *  Designated initializer. Validates the layout of the snapshot data without creating any instances. The data is retained, so memory mapped data stays mapped for the lifetime of the receiver.
+ *
+ *  @param data  Data created by +snapshotDataWithAncestorsByName:error:. This must not be nil.
+ *  @param error If the data isn't a valid snapshot, an error describing why.
+ *
+ *  @return An initialized instance of the receiver, or nil if the data isn't a valid snapshot.
+ */
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Memory maps the file at the given URL if possible and initializes the receiver with it.
+ *
+ *  @param url   The file URL of a snapshot. This must not be nil.
+ *  @param error If the file couldn't be read or isn't a valid snapshot, an error describing why.
+ *
+ *  @return An initialized instance of the receiver, or nil if the file couldn't be loaded.
+ */
+- (instancetype)initWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+/**
+ *  The names passed when the snapshot was written.
+ */
+@property (copy, nonatomic, readonly) NSArray *names;
+
+/**
+ *  The number of instances stored in the snapshot, including ancestors which were not named.
+ */
+@property (assign, nonatomic, readonly) NSUInteger count;
+
+/**
+ *  Returns the instance stored under the given name, creating it and any of its ancestors if necessary. This method is thread safe.
+ *
+ *  @param name The name of the instance.
+ *
+ *  @return The instance stored under the name, or nil if no instance was stored under it.
+ */
+- (id)ancestorNamed:(NSString *)name;
+
+/**
+ *  Returns the instance at the given index, creating it and any of its ancestors if necessary. Ancestors are always stored at lower indexes than their descendants. This method is thread safe.
+ *
+ *  @param index The index of the instance. This must be less than count.
+ *
+ *  @return The instance at the index.
+ */
+- (id)ancestorAtIndex:(NSUInteger)index;
+
+
+#pragma mark - Resolving values
+
+/**
+ *  Returns the index of the instance stored under the given name.
+ *
+ *  @param name The name of the instance.
+ *
+ *  @return The index of the instance, or NSNotFound if no instance was stored under the name.
+ */
+- (NSUInteger)indexOfAncestorNamed:(NSString *)name;
+
+/**
+ *  Returns the value of a property for the instance at the given index, resolved straight from the snapshot's records without creating any instances. The instance's own value is returned if it has one, nothing if it ignores the property, or else the value resolved for its ancestor. Values are created for each call, and archived values are decoded each time. This method is thread safe.
+ *
+ *  As when the snapshot was written, merge policies, derived properties and subclasses transforming inherited values don't apply.
+ *
+ *  @param propertyName The name of a property inherited by the instance's class, or an AKAncestorUnknownPropertyException is raised.
+ *  @param index        The index of the instance. This must be less than count.
+ *
+ *  @return The resolved value, or nil if neither the instance nor its ancestors have one.
+ */
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestorAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,957 @@
+//
+//  AKAncestorSnapshot.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorSnapshot.h"
+#import "AKAncestor.h"
+#import "AKAncestorClassInfo.h"
+#import "AKPropertyDescription.h"
+#import <objc/message.h>
+
+NSString *const AKAncestorSnapshotErrorDomain = @"AKAncestorSnapshotErrorDomain";
+
+#pragma mark - Layout
+
+// Every section is an array of fixed size records starting at an 8 byte aligned offset from the start of the snapshot, so a mapped file can be read in place.
+
+static const uint32_t AKSnapshotMagic = 0x4E534B41; // "AKSN"
+static const uint16_t AKSnapshotVersion = 1;
+static const uint16_t AKSnapshotByteOrderMark = 0x0102;
+static const uint32_t AKSnapshotNoIndex = UINT32_MAX;
+
+typedef NS_ENUM(uint8_t, AKSnapshotValueType) {
+    AKSnapshotValueTypeString = 1,
+    AKSnapshotValueTypeNumber,
+    AKSnapshotValueTypeData,
+    AKSnapshotValueTypeArchive,
+    AKSnapshotValueTypeIgnored
+};
+
+typedef NS_OPTIONS(uint16_t, AKSnapshotNodeFlags) {
+    AKSnapshotNodeFlagIgnoresKeyValueNotifications = 1 << 0
+};
+
+typedef struct AKSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t byteOrder;
+    uint32_t chunkCount;
+    uint32_t classCount;
+    uint32_t classPropertyCount;
+    uint32_t nodeCount;
+    uint32_t valueCount;
+    uint32_t entryCount;
+    uint64_t chunksOffset;
+    uint64_t classesOffset;
+    uint64_t classPropertiesOffset;
+    uint64_t nodesOffset;
+    uint64_t valuesOffset;
+    uint64_t entriesOffset;
+    uint64_t blobOffset;
+    uint64_t blobLength;
+} AKSnapshotHeader;
+
+// A byte range in the blob section. Strings are stored as UTF-8 chunks and interned, so each distinct string appears once.
+typedef struct AKSnapshotChunk {
+    uint64_t offset;
+    uint64_t length;
+} AKSnapshotChunk;
+
+typedef struct AKSnapshotClass {
+    uint32_t nameChunk;
+    uint32_t firstProperty;
+    uint32_t propertyCount;
+    uint32_t reserved;
+} AKSnapshotClass;
+
+// Ancestors are always written before their descendants, so ancestorIndex is less than the node's own index, which rules out cycles.
+typedef struct AKSnapshotNode {
+    uint32_t classIndex;
+    uint32_t ancestorIndex;
+    uint32_t firstValue;
+    uint16_t valueCount;
+    uint16_t flags;
+} AKSnapshotNode;
+
+typedef struct AKSnapshotValue {
+    uint32_t propertyIndex;
+    uint8_t type;
+    uint8_t numberType;
+    uint16_t reserved;
+    uint64_t payload;
+} AKSnapshotValue;
+
+typedef struct AKSnapshotEntry {
+    uint32_t nameChunk;
+    uint32_t nodeIndex;
+} AKSnapshotEntry;
+
+static NSError *AKSnapshotError(AKAncestorSnapshotError code, NSString *description)
+{
+    return [NSError errorWithDomain:AKAncestorSnapshotErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+static BOOL AKSnapshotSectionIsValid(uint64_t offset, uint64_t count, size_t recordSize, uint64_t length)
+{
+    if (offset % 8 != 0 || offset > length)
+    {
+        return NO;
+    }
+    
+    return count <= (length - offset) / recordSize;
+}
+
+
+#pragma mark - Writer
+
+@interface AKAncestorSnapshotWriter : NSObject
+
+@property (strong, nonatomic, readonly) NSMutableData *chunks;
+@property (strong, nonatomic, readonly) NSMutableData *classes;
+@property (strong, nonatomic, readonly) NSMutableData *classProperties;
+@property (strong, nonatomic, readonly) NSMutableData *nodes;
+@property (strong, nonatomic, readonly) NSMutableData *values;
+@property (strong, nonatomic, readonly) NSMutableData *entries;
+@property (strong, nonatomic, readonly) NSMutableData *blob;
+
+@property (strong, nonatomic, readonly) NSMutableDictionary *stringIndexes;
+@property (strong, nonatomic, readonly) NSMutableDictionary *classIndexes;
+@property (strong, nonatomic, readonly) NSMapTable *nodeIndexes;
+
+@end
+
+@implementation AKAncestorSnapshotWriter
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _chunks = [NSMutableData data];
+    _classes = [NSMutableData data];
+    _classProperties = [NSMutableData data];
+    _nodes = [NSMutableData data];
+    _values = [NSMutableData data];
+    _entries = [NSMutableData data];
+    _blob = [NSMutableData data];
+    
+    _stringIndexes = [NSMutableDictionary dictionary];
+    _classIndexes = [NSMutableDictionary dictionary];
+    _nodeIndexes = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    
+    return self;
+}
+
+- (uint32_t)addChunkWithBytes:(const void *)bytes length:(NSUInteger)length
+{
+    AKSnapshotChunk chunk = { .offset = self.blob.length, .length = length };
+    [self.blob appendBytes:bytes length:length];
+    [self.chunks appendBytes:&chunk length:sizeof(chunk)];
+    
+    return (uint32_t)(self.chunks.length / sizeof(chunk)) - 1;
+}
+
+- (uint32_t)indexOfString:(NSString *)string
+{
+    NSNumber *index = self.stringIndexes[string];
+    if (index)
+    {
+        return [index unsignedIntValue];
+    }
+    
+    NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding];
+    uint32_t chunkIndex = [self addChunkWithBytes:data.bytes length:data.length];
+    self.stringIndexes[[string copy]] = @(chunkIndex);
+    
+    return chunkIndex;
+}
+
+- (uint32_t)indexOfClass:(Class)ancestorClass
+{
+    NSString *className = NSStringFromClass(ancestorClass);
+    NSNumber *index = self.classIndexes[className];
+    if (index)
+    {
+        return [index unsignedIntValue];
+    }
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:ancestorClass];
+    
+    AKSnapshotClass record = {
+        .nameChunk = [self indexOfString:className],
+        .firstProperty = (uint32_t)(self.classProperties.length / sizeof(uint32_t)),
+        .propertyCount = (uint32_t)classInfo.propertyCount
+    };
+    
+    for (NSString *propertyName in classInfo.propertyNames)
+    {
+        uint32_t nameChunk = [self indexOfString:propertyName];
+        [self.classProperties appendBytes:&nameChunk length:sizeof(nameChunk)];
+    }
+    
+    uint32_t classIndex = (uint32_t)(self.classes.length / sizeof(record));
+    [self.classes appendBytes:&record length:sizeof(record)];
+    self.classIndexes[className] = @(classIndex);
+    
+    return classIndex;
+}
+
+- (BOOL)getValue:(AKSnapshotValue *)record forObject:(id)object error:(NSError **)error
+{
+    if ([object isKindOfClass:[NSString class]])
+    {
+        record->type = AKSnapshotValueTypeString;
+        record->payload = [self indexOfString:object];
+    }
+    else if ([object isKindOfClass:[NSNumber class]])
+    {
+        const char *objCType = [object objCType];
+        record->type = AKSnapshotValueTypeNumber;
+        record->numberType = (uint8_t)objCType[0];
+        
+        if (objCType[0] == 'f' || objCType[0] == 'd')
+        {
+            double doubleValue = [object doubleValue];
+            memcpy(&record->payload, &doubleValue, sizeof(doubleValue));
+        }
+        else if (strchr("CSILQB", objCType[0]) != NULL)
+        {
+            record->payload = [object unsignedLongLongValue];
+        }
+        else
+        {
+            record->payload = (uint64_t)[object longLongValue];
+        }
+    }
+    else if ([object isKindOfClass:[NSData class]])
+    {
+        record->type = AKSnapshotValueTypeData;
+        record->payload = [self addChunkWithBytes:[object bytes] length:[object length]];
+    }
+    else if ([object conformsToProtocol:@protocol(NSSecureCoding)] && [[object class] supportsSecureCoding])
+    {
+        NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:object];
+        record->type = AKSnapshotValueTypeArchive;
+        record->payload = [self addChunkWithBytes:archive.bytes length:archive.length];
+    }
+    else
+    {
+        if (error)
+        {
+            *error = AKSnapshotError(AKAncestorSnapshotErrorUnsupportedValue, [NSString stringWithFormat:@"Value %@ can't be stored in a snapshot because it doesn't support secure coding.", object]);
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (BOOL)addNode:(AKAncestor *)ancestor error:(NSError **)error
+{
+    AKAncestor *parent = ancestor.ancestor;
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:[ancestor class]];
+    
+    AKSnapshotNode node = {
+        .classIndex = [self indexOfClass:[ancestor class]],
+        .ancestorIndex = (parent) ? [[self.nodeIndexes objectForKey:parent] unsignedIntValue] : AKSnapshotNoIndex,
+        .firstValue = (uint32_t)(self.values.length / sizeof(AKSnapshotValue)),
+        .flags = (ancestor.inheritsKeyValueNotifications) ? 0 : AKSnapshotNodeFlagIgnoresKeyValueNotifications
+    };
+    
+    // Each property can store both an ignored marker and a value, and the record only counts up to UINT16_MAX of them.
+    if (2 * classInfo.propertyCount > UINT16_MAX)
+    {
+        if (error)
+        {
+            *error = AKSnapshotError(AKAncestorSnapshotErrorTooManyProperties, [NSString stringWithFormat:@"%@ has %lu inheritable properties, more than a snapshot can store.", [ancestor class], (unsigned long)classInfo.propertyCount]);
+        }
+        return NO;
+    }
+    
+    NSSet *ignoredPropertyNames = [ancestor.propertiesIgnoringInheritedValues valueForKey:NSStringFromSelector(@selector(propertyName))];
+    
+    for (NSUInteger index = 0; index < classInfo.propertyCount; index++)
+    {
+        if ([ignoredPropertyNames containsObject:classInfo.propertyNames[index]])
+        {
+            AKSnapshotValue record = { .propertyIndex = (uint32_t)index, .type = AKSnapshotValueTypeIgnored };
+            [self.values appendBytes:&record length:sizeof(record)];
+            node.valueCount++;
+        }
+        
+        // Only the instance's own values are stored, inherited values come from the ancestor's record.
+        id value = ((id (*)(id, SEL))objc_msgSend)(ancestor, [classInfo localGetterAtIndex:index]);
+        if (value)
+        {
+            AKSnapshotValue record = { .propertyIndex = (uint32_t)index };
+            if (![self getValue:&record forObject:value error:error])
+            {
+                return NO;
+            }
+            
+            // Archived values are decoded securely, which needs the classes the property allows.
+            if (record.type == AKSnapshotValueTypeArchive && [[ancestor class] allowedClassesForDecodingPropertyName:classInfo.propertyNames[index]].count == 0)
+            {
+                if (error)
+                {
+                    *error = AKSnapshotError(AKAncestorSnapshotErrorUnsupportedValue, [NSString stringWithFormat:@"Value %@ can't be stored in a snapshot because %@ allows no classes for decoding \"%@\".", value, [ancestor class], classInfo.propertyNames[index]]);
+                }
+                return NO;
+            }
+            
+            [self.values appendBytes:&record length:sizeof(record)];
+            node.valueCount++;
+        }
+    }
+    
+    [self.nodeIndexes setObject:@(self.nodes.length / sizeof(node)) forKey:ancestor];
+    [self.nodes appendBytes:&node length:sizeof(node)];
+    
+    return YES;
+}
+
+- (BOOL)addEntryWithName:(NSString *)name ancestor:(AKAncestor *)ancestor error:(NSError **)error
+{
+    NSParameterAssert([ancestor isKindOfClass:[AKAncestor class]]);
+    
+    // Ancestors are written before descendants, so collect the chain up to the first instance which was already written.
+    NSMutableArray *pendingAncestors = [NSMutableArray array];
+    for (AKAncestor *current = ancestor; current && ![self.nodeIndexes objectForKey:current]; current = current.ancestor)
+    {
+        [pendingAncestors addObject:current];
+    }
+    
+    for (AKAncestor *pendingAncestor in [pendingAncestors reverseObjectEnumerator])
+    {
+        if (![self addNode:pendingAncestor error:error])
+        {
+            return NO;
+        }
+    }
+    
+    AKSnapshotEntry entry = {
+        .nameChunk = [self indexOfString:name],
+        .nodeIndex = [[self.nodeIndexes objectForKey:ancestor] unsignedIntValue]
+    };
+    [self.entries appendBytes:&entry length:sizeof(entry)];
+    
+    return YES;
+}
+
+- (NSData *)snapshotData
+{
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(AKSnapshotHeader)];
+    
+    uint64_t (^appendSection)(NSData *) = ^uint64_t (NSData *section) {
+        NSUInteger padding = (8 - (data.length % 8)) % 8;
+        [data increaseLengthBy:padding];
+        
+        uint64_t offset = data.length;
+        [data appendData:section];
+        return offset;
+    };
+    
+    AKSnapshotHeader header = {
+        .magic = AKSnapshotMagic,
+        .version = AKSnapshotVersion,
+        .byteOrder = AKSnapshotByteOrderMark,
+        .chunkCount = (uint32_t)(self.chunks.length / sizeof(AKSnapshotChunk)),
+        .classCount = (uint32_t)(self.classes.length / sizeof(AKSnapshotClass)),
+        .classPropertyCount = (uint32_t)(self.classProperties.length / sizeof(uint32_t)),
+        .nodeCount = (uint32_t)(self.nodes.length / sizeof(AKSnapshotNode)),
+        .valueCount = (uint32_t)(self.values.length / sizeof(AKSnapshotValue)),
+        .entryCount = (uint32_t)(self.entries.length / sizeof(AKSnapshotEntry))
+    };
+    
+    header.chunksOffset = appendSection(self.chunks);
+    header.classesOffset = appendSection(self.classes);
+    header.classPropertiesOffset = appendSection(self.classProperties);
+    header.nodesOffset = appendSection(self.nodes);
+    header.valuesOffset = appendSection(self.values);
+    header.entriesOffset = appendSection(self.entries);
+    header.blobOffset = appendSection(self.blob);
+    header.blobLength = self.blob.length;
+    
+    [data replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+    
+    return [data copy];
+}
+
+@end
+
+
+#pragma mark - Reader
+
+@interface AKAncestorSnapshot ()
+{
+    AKSnapshotHeader _validatedHeader;
+    const AKSnapshotHeader *_header;
+    const AKSnapshotChunk *_chunks;
+    const AKSnapshotClass *_classes;
+    const uint32_t *_classProperties;
+    const AKSnapshotNode *_nodes;
+    const AKSnapshotValue *_values;
+    const AKSnapshotEntry *_entries;
+    const uint8_t *_blob;
+}
+
+@property (strong, nonatomic, readonly) NSData *data;
+@property (copy, nonatomic, readonly) NSArray *ancestorClasses;
+@property (copy, nonatomic, readonly) NSArray *classPropertyNames;
+@property (copy, nonatomic, readonly) NSArray *classPropertyIndexes;
+@property (copy, nonatomic, readonly) NSDictionary *nodeIndexesByName;
+@property (strong, nonatomic, readonly) NSMutableArray *strings;
+@property (strong, nonatomic, readonly) NSMutableArray *materializedAncestors;
+
+@end
+
+@implementation AKAncestorSnapshot
+
+#pragma mark - Writing snapshots
+
++ (NSData *)snapshotDataWithAncestorsByName:(NSDictionary *)ancestorsByName error:(NSError **)error
+{
+    NSParameterAssert(ancestorsByName);
+    
+    AKAncestorSnapshotWriter *writer = [AKAncestorSnapshotWriter new];
+    
+    // Sorting the names keeps snapshots of the same tree byte for byte identical.
+    for (NSString *name in [[ancestorsByName allKeys] sortedArrayUsingSelector:@selector(compare:)])
+    {
+        if (![writer addEntryWithName:name ancestor:ancestorsByName[name] error:error])
+        {
+            return nil;
+        }
+    }
+    
+    return [writer snapshotData];
+}
+
+
+#pragma mark - Lifecycle
+
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error
+{
+    NSParameterAssert(data);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _data = data;
+    
+    NSError *validationError = [self _validateLayout];
+    if (validationError)
+    {
+        if (error)
+        {
+            *error = validationError;
+        }
+        return nil;
+    }
+    
+    // Strings and instances are created lazily, these placeholders mark the ones which haven't been created yet.
+    NSUInteger chunkCount = _header->chunkCount;
+    _strings = [NSMutableArray arrayWithCapacity:chunkCount];
+    for (NSUInteger index = 0; index < chunkCount; index++)
+    {
+        [_strings addObject:[NSNull null]];
+    }
+    
+    NSUInteger nodeCount = _header->nodeCount;
+    _materializedAncestors = [NSMutableArray arrayWithCapacity:nodeCount];
+    for (NSUInteger index = 0; index < nodeCount; index++)
+    {
+        [_materializedAncestors addObject:[NSNull null]];
+    }
+    
+    NSError *classError = [self _resolveClasses];
+    if (classError)
+    {
+        if (error)
+        {
+            *error = classError;
+        }
+        return nil;
+    }
+    
+    NSMutableDictionary *nodeIndexesByName = [NSMutableDictionary dictionaryWithCapacity:_header->entryCount];
+    for (uint32_t index = 0; index < _header->entryCount; index++)
+    {
+        nodeIndexesByName[[self _stringAtIndex:_entries[index].nameChunk]] = @(_entries[index].nodeIndex);
+    }
+    _nodeIndexesByName = [nodeIndexesByName copy];
+    
+    return self;
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL *)url error:(NSError **)error
+{
+    NSParameterAssert(url);
+    
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+    if (!data)
+    {
+        return nil;
+    }
+    
+    return [self initWithData:data error:error];
+}
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithData:nil error:NULL];
+}
+
+
+#pragma mark - Reading snapshots
+
+- (NSArray *)names
+{
+    return [[self.nodeIndexesByName allKeys] sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (NSUInteger)count
+{
+    return _header->nodeCount;
+}
+
+- (id)ancestorNamed:(NSString *)name
+{
+    NSNumber *index = (name) ? self.nodeIndexesByName[name] : nil;
+    return (index) ? [self ancestorAtIndex:[index unsignedIntegerValue]] : nil;
+}
+
+- (id)ancestorAtIndex:(NSUInteger)index
+{
+    if (index >= self.count)
+    {
+        [NSException raise:NSRangeException format:@"Index %lu is beyond the %lu instances in %@.", (unsigned long)index, (unsigned long)self.count, self];
+        return nil;
+    }
+    
+    @synchronized (self)
+    {
+        id ancestor = self.materializedAncestors[index];
+        if (ancestor != [NSNull null])
+        {
+            return ancestor;
+        }
+        
+        // Walk up to the nearest instance which already exists, then create the rest top down. This avoids recursing through deep chains.
+        NSMutableArray *pendingIndexes = [NSMutableArray array];
+        ancestor = nil;
+        
+        uint32_t currentIndex = (uint32_t)index;
+        while (currentIndex != AKSnapshotNoIndex)
+        {
+            id existingAncestor = self.materializedAncestors[currentIndex];
+            if (existingAncestor != [NSNull null])
+            {
+                ancestor = existingAncestor;
+                break;
+            }
+            
+            [pendingIndexes addObject:@(currentIndex)];
+            currentIndex = _nodes[currentIndex].ancestorIndex;
+        }
+        
+        for (NSNumber *pendingIndex in [pendingIndexes reverseObjectEnumerator])
+        {
+            ancestor = [self _instantiateNodeAtIndex:[pendingIndex unsignedIntValue] ancestor:ancestor];
+            self.materializedAncestors[[pendingIndex unsignedIntegerValue]] = ancestor;
+        }
+        
+        return ancestor;
+    }
+}
+
+
+#pragma mark - Resolving values
+
+- (NSUInteger)indexOfAncestorNamed:(NSString *)name
+{
+    NSNumber *index = (name) ? self.nodeIndexesByName[name] : nil;
+    return (index) ? [index unsignedIntegerValue] : NSNotFound;
+}
+
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestorAtIndex:(NSUInteger)index
+{
+    if (index >= self.count)
+    {
+        [NSException raise:NSRangeException format:@"Index %lu is beyond the %lu instances in %@.", (unsigned long)index, (unsigned long)self.count, self];
+        return nil;
+    }
+    
+    uint32_t nodeIndex = (uint32_t)index;
+    AKSnapshotNode node = _nodes[nodeIndex];
+    NSUInteger propertyIndex = [self _indexOfPropertyName:propertyName classIndex:node.classIndex];
+    if (propertyIndex == NSNotFound)
+    {
+        Class ancestorClass = (node.classIndex < self.ancestorClasses.count) ? self.ancestorClasses[node.classIndex] : Nil;
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, ancestorClass];
+        return nil;
+    }
+    
+    // Records are copied and checked as they're read, so a shared snapshot rewritten meanwhile only yields wrong values, which its reader discards.
+    while (propertyIndex != NSNotFound && node.firstValue <= _header->valueCount && node.valueCount <= _header->valueCount - node.firstValue)
+    {
+        BOOL isIgnored = NO;
+        for (uint32_t valueIndex = node.firstValue; valueIndex < node.firstValue + node.valueCount; valueIndex++)
+        {
+            AKSnapshotValue value = _values[valueIndex];
+            if (value.propertyIndex != propertyIndex)
+            {
+                continue;
+            }
+            
+            if (value.type == AKSnapshotValueTypeIgnored)
+            {
+                isIgnored = YES;
+                continue;
+            }
+            
+            return [self _objectForValue:&value propertyName:propertyName ancestorClass:self.ancestorClasses[node.classIndex] cachesStrings:NO];
+        }
+        
+        // Ancestors are always stored before their descendants, which also guarantees the walk ends.
+        if (isIgnored || node.ancestorIndex >= nodeIndex)
+        {
+            return nil;
+        }
+        
+        nodeIndex = node.ancestorIndex;
+        node = _nodes[nodeIndex];
+        propertyIndex = [self _indexOfPropertyName:propertyName classIndex:node.classIndex];
+    }
+    
+    return nil;
+}
+
+
+#pragma mark - Private
+
+- (NSUInteger)_indexOfPropertyName:(NSString *)propertyName classIndex:(uint32_t)classIndex
+{
+    NSNumber *propertyIndex = (classIndex < self.classPropertyIndexes.count && propertyName) ? self.classPropertyIndexes[classIndex][propertyName] : nil;
+    return (propertyIndex) ? [propertyIndex unsignedIntegerValue] : NSNotFound;
+}
+
+- (NSError *)_validateLayout
+{
+    uint64_t length = self.data.length;
+    if (length < sizeof(AKSnapshotHeader))
+    {
+        return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"The snapshot is too short to contain a header.");
+    }
+    
+    // A shared snapshot's memory can be rewritten by its publisher while it's being read. The header is copied so every count and offset checked here stays the one used afterwards, and records read later are checked again as they're read, so reads stay within the data even then.
+    const uint8_t *bytes = self.data.bytes;
+    memcpy(&_validatedHeader, bytes, sizeof(_validatedHeader));
+    _header = &_validatedHeader;
+    
+    if (_header->magic != AKSnapshotMagic)
+    {
+        return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"The data is not an AncestorKit snapshot.");
+    }
+    
+    if (_header->version != AKSnapshotVersion || _header->byteOrder != AKSnapshotByteOrderMark)
+    {
+        return AKSnapshotError(AKAncestorSnapshotErrorUnsupportedVersion, [NSString stringWithFormat:@"Snapshot version %u is not supported.", _header->version]);
+    }
+    
+    if (!AKSnapshotSectionIsValid(_header->chunksOffset, _header->chunkCount, sizeof(AKSnapshotChunk), length) ||
+        !AKSnapshotSectionIsValid(_header->classesOffset, _header->classCount, sizeof(AKSnapshotClass), length) ||
+        !AKSnapshotSectionIsValid(_header->classPropertiesOffset, _header->classPropertyCount, sizeof(uint32_t), length) ||
+        !AKSnapshotSectionIsValid(_header->nodesOffset, _header->nodeCount, sizeof(AKSnapshotNode), length) ||
+        !AKSnapshotSectionIsValid(_header->valuesOffset, _header->valueCount, sizeof(AKSnapshotValue), length) ||
+        !AKSnapshotSectionIsValid(_header->entriesOffset, _header->entryCount, sizeof(AKSnapshotEntry), length) ||
+        !AKSnapshotSectionIsValid(_header->blobOffset, _header->blobLength, sizeof(uint8_t), length))
+    {
+        return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot section extends beyond the end of the data.");
+    }
+    
+    _chunks = (const AKSnapshotChunk *)(bytes + _header->chunksOffset);
+    _classes = (const AKSnapshotClass *)(bytes + _header->classesOffset);
+    _classProperties = (const uint32_t *)(bytes + _header->classPropertiesOffset);
+    _nodes = (const AKSnapshotNode *)(bytes + _header->nodesOffset);
+    _values = (const AKSnapshotValue *)(bytes + _header->valuesOffset);
+    _entries = (const AKSnapshotEntry *)(bytes + _header->entriesOffset);
+    _blob = bytes + _header->blobOffset;
+    
+    // Checking every record up front is a pass over plain integers, which keeps lazy materialization free of bounds checks.
+    for (uint32_t index = 0; index < _header->chunkCount; index++)
+    {
+        if (_chunks[index].offset > _header->blobLength || _chunks[index].length > _header->blobLength - _chunks[index].offset)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot chunk extends beyond the blob section.");
+        }
+    }
+    
+    for (uint32_t index = 0; index < _header->classCount; index++)
+    {
+        const AKSnapshotClass *record = &_classes[index];
+        if (record->nameChunk >= _header->chunkCount || record->firstProperty > _header->classPropertyCount || record->propertyCount > _header->classPropertyCount - record->firstProperty)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot class references missing data.");
+        }
+    }
+    
+    for (uint32_t index = 0; index < _header->classPropertyCount; index++)
+    {
+        if (_classProperties[index] >= _header->chunkCount)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot property name references missing data.");
+        }
+    }
+    
+    for (uint32_t index = 0; index < _header->nodeCount; index++)
+    {
+        const AKSnapshotNode *node = &_nodes[index];
+        BOOL hasValidAncestor = (node->ancestorIndex == AKSnapshotNoIndex || node->ancestorIndex < index);
+        if (node->classIndex >= _header->classCount || !hasValidAncestor || node->firstValue > _header->valueCount || node->valueCount > _header->valueCount - node->firstValue)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot instance references missing data.");
+        }
+        
+        const AKSnapshotClass *record = &_classes[node->classIndex];
+        for (uint32_t valueIndex = node->firstValue; valueIndex < node->firstValue + node->valueCount; valueIndex++)
+        {
+            const AKSnapshotValue *value = &_values[valueIndex];
+            BOOL referencesChunk = (value->type == AKSnapshotValueTypeString || value->type == AKSnapshotValueTypeData || value->type == AKSnapshotValueTypeArchive);
+            if (value->propertyIndex >= record->propertyCount || (referencesChunk && value->payload >= _header->chunkCount))
+            {
+                return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot value references missing data.");
+            }
+        }
+    }
+    
+    for (uint32_t index = 0; index < _header->entryCount; index++)
+    {
+        if (_entries[index].nameChunk >= _header->chunkCount || _entries[index].nodeIndex >= _header->nodeCount)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot name references missing data.");
+        }
+    }
+    
+    return nil;
+}
+
+- (NSError *)_resolveClasses
+{
+    NSMutableArray *ancestorClasses = [NSMutableArray arrayWithCapacity:_header->classCount];
+    NSMutableArray *classPropertyNames = [NSMutableArray arrayWithCapacity:_header->classCount];
+    NSMutableArray *classPropertyIndexes = [NSMutableArray arrayWithCapacity:_header->classCount];
+    
+    for (uint32_t index = 0; index < _header->classCount; index++)
+    {
+        AKSnapshotClass record = _classes[index];
+        if (record.firstProperty > _header->classPropertyCount || record.propertyCount > _header->classPropertyCount - record.firstProperty)
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorCorruptData, @"A snapshot class references missing data.");
+        }
+        
+        NSString *className = [self _stringAtIndex:record.nameChunk];
+        Class ancestorClass = NSClassFromString(className);
+        if (![ancestorClass isSubclassOfClass:[AKAncestor class]])
+        {
+            return AKSnapshotError(AKAncestorSnapshotErrorUnknownClass, [NSString stringWithFormat:@"The snapshot class \"%@\" is not a subclass of AKAncestor in this process.", className]);
+        }
+        
+        NSMutableArray *propertyNames = [NSMutableArray arrayWithCapacity:record.propertyCount];
+        NSMutableDictionary *propertyIndexes = [NSMutableDictionary dictionaryWithCapacity:record.propertyCount];
+        for (uint32_t propertyIndex = 0; propertyIndex < record.propertyCount; propertyIndex++)
+        {
+            NSString *propertyName = [self _stringAtIndex:_classProperties[record.firstProperty + propertyIndex]];
+            [propertyNames addObject:propertyName];
+            propertyIndexes[propertyName] = @(propertyIndex);
+        }
+        
+        [ancestorClasses addObject:ancestorClass];
+        [classPropertyNames addObject:propertyNames];
+        [classPropertyIndexes addObject:propertyIndexes];
+    }
+    
+    _ancestorClasses = [ancestorClasses copy];
+    _classPropertyNames = [classPropertyNames copy];
+    _classPropertyIndexes = [classPropertyIndexes copy];
+    
+    return nil;
+}
+
+- (BOOL)_getChunk:(AKSnapshotChunk *)chunk atIndex:(uint64_t)index
+{
+    if (index >= _header->chunkCount)
+    {
+        return NO;
+    }
+    
+    *chunk = _chunks[index];
+    return (chunk->offset <= _header->blobLength && chunk->length <= _header->blobLength - chunk->offset);
+}
+
+- (NSString *)_newStringAtIndex:(uint64_t)index
+{
+    AKSnapshotChunk chunk;
+    if (![self _getChunk:&chunk atIndex:index])
+    {
+        return @"";
+    }
+    
+    return [[NSString alloc] initWithBytes:(_blob + chunk.offset) length:(NSUInteger)chunk.length encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+- (NSString *)_stringAtIndex:(uint32_t)index
+{
+    if (index >= _header->chunkCount)
+    {
+        return @"";
+    }
+    
+    id string = self.strings[index];
+    if (string == [NSNull null])
+    {
+        string = [self _newStringAtIndex:index];
+        self.strings[index] = string;
+    }
+    
+    return string;
+}
+
+- (NSData *)_dataAtIndex:(uint64_t)index
+{
+    AKSnapshotChunk chunk;
+    if (![self _getChunk:&chunk atIndex:index])
+    {
+        return [NSData data];
+    }
+    
+    return [NSData dataWithBytes:(_blob + chunk.offset) length:(NSUInteger)chunk.length];
+}
+
+- (id)_objectForValue:(const AKSnapshotValue *)value propertyName:(NSString *)propertyName ancestorClass:(Class)ancestorClass cachesStrings:(BOOL)cachesStrings
+{
+    switch ((AKSnapshotValueType)value->type)
+    {
+        case AKSnapshotValueTypeString:
+            return (cachesStrings) ? [self _stringAtIndex:(uint32_t)value->payload] : [self _newStringAtIndex:value->payload];
+        case AKSnapshotValueTypeNumber:
+            return [[self class] _numberWithType:value->numberType payload:value->payload];
+        case AKSnapshotValueTypeData:
+            return [self _dataAtIndex:value->payload];
+        case AKSnapshotValueTypeArchive:
+        {
+            // Snapshots written by other processes aren't trusted, so values of properties without allowed classes are never decoded.
+            NSSet *allowedClasses = [ancestorClass allowedClassesForDecodingPropertyName:propertyName];
+            if (allowedClasses.count == 0)
+            {
+                return nil;
+            }
+            
+            NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:[self _dataAtIndex:value->payload]];
+            unarchiver.requiresSecureCoding = YES;
+            
+            id object = [unarchiver decodeObjectOfClasses:allowedClasses forKey:NSKeyedArchiveRootObjectKey];
+            [unarchiver finishDecoding];
+            return object;
+        }
+        case AKSnapshotValueTypeIgnored:
+            return nil;
+    }
+    
+    return nil;
+}
+
++ (NSNumber *)_numberWithType:(uint8_t)numberType payload:(uint64_t)payload
+{
+    switch (numberType)
+    {
+        case 'f':
+        case 'd':
+        {
+            double doubleValue;
+            memcpy(&doubleValue, &payload, sizeof(doubleValue));
+            return (numberType == 'f') ? [NSNumber numberWithFloat:(float)doubleValue] : [NSNumber numberWithDouble:doubleValue];
+        }
+        case 'B':
+            return [NSNumber numberWithBool:(payload != 0)];
+        case 'c':
+            return [NSNumber numberWithChar:(char)payload];
+        case 'C':
+            return [NSNumber numberWithUnsignedChar:(unsigned char)payload];
+        case 's':
+            return [NSNumber numberWithShort:(short)payload];
+        case 'S':
+            return [NSNumber numberWithUnsignedShort:(unsigned short)payload];
+        case 'i':
+            return [NSNumber numberWithInt:(int)payload];
+        case 'I':
+            return [NSNumber numberWithUnsignedInt:(unsigned int)payload];
+        case 'L':
+        case 'Q':
+            return [NSNumber numberWithUnsignedLongLong:payload];
+        default:
+            return [NSNumber numberWithLongLong:(long long)payload];
+    }
+}
+
+- (AKAncestor *)_instantiateNodeAtIndex:(uint32_t)index ancestor:(AKAncestor *)ancestor
+{
+    const AKSnapshotNode *node = &_nodes[index];
+    
+    Class ancestorClass = self.ancestorClasses[node->classIndex];
+    NSArray *propertyNames = self.classPropertyNames[node->classIndex];
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:ancestorClass];
+    
+    BOOL shouldInheritKeyValueNotifications = !(node->flags & AKSnapshotNodeFlagIgnoresKeyValueNotifications);
+    AKAncestor *instance = [[ancestorClass alloc] initWithAncestor:ancestor inheritKeyValueNotifications:shouldInheritKeyValueNotifications];
+    
+    for (uint32_t valueIndex = node->firstValue; valueIndex < node->firstValue + node->valueCount; valueIndex++)
+    {
+        const AKSnapshotValue *value = &_values[valueIndex];
+        NSString *propertyName = propertyNames[value->propertyIndex];
+        
+        // The class may have changed since the snapshot was written, so properties it no longer inherits are skipped.
+        if ([classInfo indexOfPropertyName:propertyName] == NSNotFound)
+        {
+            continue;
+        }
+        
+        if (value->type == AKSnapshotValueTypeIgnored)
+        {
+            [instance stopInheritingValuesForPropertyName:propertyName];
+            continue;
+        }
+        
+        id object = [self _objectForValue:value propertyName:propertyName ancestorClass:ancestorClass cachesStrings:YES];
+        if (object)
+        {
+            [instance setValue:object forKey:propertyName];
+        }
+    }
+    
+    return instance;
+}
+
+
+#pragma mark - NSObject
+
+- (NSString *)description
+{
+    return [self debugDescription];
+}
+
+- (NSString *)debugDescription
+{
+    return [NSString stringWithFormat:@"<%@:%p> count: %lu, names: %@", [self class], self, (unsigned long)self.count, self.names];
+}
+
+@end
@@ -0,0 +1,119 @@
+//
+//  AKAncestorStatistics.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  The events counted by AKAncestorStatistics.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorStatisticsEvent){
+    /**
+     *  A swizzled getter of an inheritable property was called.
+     */
+    AKAncestorStatisticsEventGetterCall = 0,
+    /**
+     *  A getter consulted an ancestor because the instance had no value of its own.
+     */
+    AKAncestorStatisticsEventAncestorHop,
+    /**
+     *  A cached provenance table, derived value, merged value, or effective value hash was reused.
+     */
+    AKAncestorStatisticsEventCacheHit,
+    /**
+     *  A cached provenance table, derived value, merged value, or effective value hash had to be calculated.
+     */
+    AKAncestorStatisticsEventCacheMiss,
+    /**
+     *  A key-value notification from an ancestor was forwarded to observers of a descendant.
+     */
+    AKAncestorStatisticsEventKeyValueForward,
+    /**
+     *  An instance was initialized with an ancestor.
+     */
+    AKAncestorStatisticsEventDescendantCreation
+};
+
+/**
+ *  The number of events in AKAncestorStatisticsEvent.
+ */
+FOUNDATION_EXPORT const NSUInteger AKAncestorStatisticsEventCount;
+
+
+/**
+ *  AKAncestorStatistics counts how often AncestorKit's hot paths run, per class and per property, so you can find out which properties are hot and how deep chains resolve in practice. Counting is disabled by default, and while it's disabled each instrumented path only checks a flag.
+ *
+ *  Once enabled, every thread counts into its own table, so counting doesn't contend between threads. +currentStatistics adds up the tables of every thread into an immutable snapshot, which can be queried or exported in the Prometheus text format to feed dashboards.
+ */
+@interface AKAncestorStatistics : NSObject
+
+/**
+ *  Returns YES if events are being counted. Defaults to NO.
+ */
++ (BOOL)isEnabled;
+
+/**
+ *  Starts or stops counting events. Counts are kept when counting stops, so they can still be read.
+ *
+ *  @param enabled YES to count events, or NO to stop.
+ */
++ (void)setEnabled:(BOOL)enabled;
+
+/**
+ *  Discards the counts of every thread.
+ */
++ (void)resetStatistics;
+
+/**
+ *  Returns a snapshot of the counts of every thread, added up. Threads may keep counting while the snapshot is taken, so concurrent events may or may not be included.
+ *
+ *  @return A new snapshot.
+ */
++ (instancetype)currentStatistics;
+
+/**
+ *  Returns the total number of times an event happened, across all classes and properties.
+ */
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event;
+
+/**
+ *  Returns the number of times an event happened for instances of a class, across all properties. Subclasses are counted separately.
+ *
+ *  @param event         The event to count.
+ *  @param ancestorClass The class whose instances the event happened on. This must not be nil.
+ *
+ *  @return The number of times the event happened.
+ */
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event forClass:(Class)ancestorClass;
+
+/**
+ *  Returns the number of times an event happened for a property of instances of a class.
+ *
+ *  @param event         The event to count.
+ *  @param ancestorClass The class whose instances the event happened on. This must not be nil.
+ *  @param propertyName  The name of the property, or nil for events which aren't tied to a property, like descendant creations and provenance tables.
+ *
+ *  @return The number of times the event happened.
+ */
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event forClass:(Class)ancestorClass propertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the counts in the Prometheus text exposition format. Each event is a counter named with an "ancestorkit_" prefix and labelled with the class and, where there is one, the property.
+ */
+- (NSString *)prometheusText;
+
+/**
+ *  Writes -prometheusText to a file atomically as UTF-8, so a scraper never reads a partial file.
+ *
+ *  @param fileURL The URL of the file to write. This must not be nil.
+ *  @param error   On failure, the error which occurred. This may be NULL.
+ *
+ *  @return YES if the file was written, or NO if an error occurred.
+ */
+- (BOOL)writePrometheusTextToURL:(NSURL *)fileURL error:(NSError **)error;
+
+@end
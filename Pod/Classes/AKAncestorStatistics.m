@@ -0,0 +1,342 @@
+//
+//  AKAncestorStatistics.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorStatistics.h"
+#import "AKAncestorStatistics_Private.h"
+#import "AKAncestorPlatform.h"
+
+enum
+{
+    AKAncestorStatisticsEventLimit = AKAncestorStatisticsEventDescendantCreation + 1
+};
+
+const NSUInteger AKAncestorStatisticsEventCount = AKAncestorStatisticsEventLimit;
+
+volatile BOOL AKAncestorStatisticsEnabled = NO;
+
+static const struct
+{
+    const char *name;
+    const char *help;
+} AKAncestorStatisticsMetrics[AKAncestorStatisticsEventLimit] = {
+    {"ancestorkit_getter_calls_total", "Calls to getters of inheritable properties."},
+    {"ancestorkit_ancestor_hops_total", "Getters which consulted an ancestor."},
+    {"ancestorkit_cache_hits_total", "Cached provenance tables, derived values, merged values and hashes which were reused."},
+    {"ancestorkit_cache_misses_total", "Cached provenance tables, derived values, merged values and hashes which were calculated."},
+    {"ancestorkit_kvo_forwards_total", "Key-value notifications forwarded from ancestors."},
+    {"ancestorkit_descendant_creations_total", "Instances initialized with an ancestor."},
+};
+
+
+/**
+ *  The counts of every event for one class and property.
+ */
+@interface AKAncestorStatisticsCounter : NSObject
+{
+    @public
+    uint64_t _counts[AKAncestorStatisticsEventLimit];
+}
+
+@end
+
+@implementation AKAncestorStatisticsCounter
+
+@end
+
+
+/**
+ *  The counters of one thread, keyed by class and then by property name, with NSNull standing in for events without a property. Only the owning thread adds counters or counts, so the lock is only contended while the table is being added up or reset.
+ */
+@interface AKAncestorThreadStatistics : NSObject
+{
+    @public
+    OSSpinLock _spinLock;
+}
+
+@property (strong, nonatomic, readonly) NSMapTable *countersByClass;
+
+@end
+
+@implementation AKAncestorThreadStatistics
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _spinLock = OS_SPINLOCK_INIT;
+    _countersByClass = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory|NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    
+    return self;
+}
+
+@end
+
+
+// Tables are registered once per thread and kept for the life of the process, so counts from threads which have exited aren't lost.
+static __thread __unsafe_unretained AKAncestorThreadStatistics *AKAncestorCurrentThreadStatistics;
+static OSSpinLock AKAncestorThreadStatisticsLock = OS_SPINLOCK_INIT;
+
+static NSMutableArray *AKAncestorAllThreadStatistics()
+{
+    static NSMutableArray *threadStatistics;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        threadStatistics = [NSMutableArray array];
+    });
+    
+    return threadStatistics;
+}
+
+static NSArray *AKAncestorThreadStatisticsSnapshot()
+{
+    OSSpinLockLock(&AKAncestorThreadStatisticsLock);
+    NSArray *threadStatistics = [AKAncestorAllThreadStatistics() copy];
+    OSSpinLockUnlock(&AKAncestorThreadStatisticsLock);
+    
+    return threadStatistics;
+}
+
+void AKAncestorStatisticsRecordEvent(AKAncestorStatisticsEvent event, Class ancestorClass, NSString *propertyName)
+{
+    NSCParameterAssert(event >= 0 && event < AKAncestorStatisticsEventLimit);
+    NSCParameterAssert(ancestorClass);
+    
+    AKAncestorThreadStatistics *threadStatistics = AKAncestorCurrentThreadStatistics;
+    if (!threadStatistics)
+    {
+        threadStatistics = [AKAncestorThreadStatistics new];
+        
+        OSSpinLockLock(&AKAncestorThreadStatisticsLock);
+        [AKAncestorAllThreadStatistics() addObject:threadStatistics];
+        OSSpinLockUnlock(&AKAncestorThreadStatisticsLock);
+        
+        AKAncestorCurrentThreadStatistics = threadStatistics;
+    }
+    
+    id propertyKey = propertyName ?: [NSNull null];
+    
+    OSSpinLockLock(&threadStatistics->_spinLock);
+    
+    NSMutableDictionary *countersByProperty = [threadStatistics.countersByClass objectForKey:ancestorClass];
+    if (!countersByProperty)
+    {
+        countersByProperty = [NSMutableDictionary dictionary];
+        [threadStatistics.countersByClass setObject:countersByProperty forKey:ancestorClass];
+    }
+    
+    AKAncestorStatisticsCounter *counter = countersByProperty[propertyKey];
+    if (!counter)
+    {
+        counter = [AKAncestorStatisticsCounter new];
+        countersByProperty[propertyKey] = counter;
+    }
+    
+    counter->_counts[event]++;
+    
+    OSSpinLockUnlock(&threadStatistics->_spinLock);
+}
+
+static NSString *AKAncestorStatisticsEscapedLabelValue(NSString *value)
+{
+    NSString *escapedValue = [value stringByReplacingOccurrencesOfString:@"\\" withString:@"\\\\"];
+    escapedValue = [escapedValue stringByReplacingOccurrencesOfString:@"\"" withString:@"\\\""];
+    return [escapedValue stringByReplacingOccurrencesOfString:@"\n" withString:@"\\n"];
+}
+
+
+@interface AKAncestorStatistics ()
+
+// Class names mapped to dictionaries of property names, or NSNull, mapped to counters.
+@property (copy, nonatomic, readonly) NSDictionary *countersByClassName;
+
+@end
+
+@implementation AKAncestorStatistics
+
+#pragma mark - Lifecycle
+
++ (BOOL)isEnabled
+{
+    return AKAncestorStatisticsEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+    AKAncestorStatisticsEnabled = enabled;
+    OSMemoryBarrier();
+}
+
++ (void)resetStatistics
+{
+    for (AKAncestorThreadStatistics *threadStatistics in AKAncestorThreadStatisticsSnapshot())
+    {
+        OSSpinLockLock(&threadStatistics->_spinLock);
+        [threadStatistics.countersByClass removeAllObjects];
+        OSSpinLockUnlock(&threadStatistics->_spinLock);
+    }
+}
+
++ (instancetype)currentStatistics
+{
+    NSMutableDictionary *countersByClassName = [NSMutableDictionary dictionary];
+    
+    for (AKAncestorThreadStatistics *threadStatistics in AKAncestorThreadStatisticsSnapshot())
+    {
+        OSSpinLockLock(&threadStatistics->_spinLock);
+        
+        for (Class ancestorClass in threadStatistics.countersByClass)
+        {
+            NSString *className = NSStringFromClass(ancestorClass);
+            NSMutableDictionary *totalsByProperty = countersByClassName[className];
+            if (!totalsByProperty)
+            {
+                totalsByProperty = [NSMutableDictionary dictionary];
+                countersByClassName[className] = totalsByProperty;
+            }
+            
+            NSDictionary *countersByProperty = [threadStatistics.countersByClass objectForKey:ancestorClass];
+            [countersByProperty enumerateKeysAndObjectsUsingBlock:^(id propertyKey, AKAncestorStatisticsCounter *counter, BOOL *stop) {
+                AKAncestorStatisticsCounter *total = totalsByProperty[propertyKey];
+                if (!total)
+                {
+                    total = [AKAncestorStatisticsCounter new];
+                    totalsByProperty[propertyKey] = total;
+                }
+                
+                for (NSUInteger event = 0; event < AKAncestorStatisticsEventLimit; event++)
+                {
+                    total->_counts[event] += counter->_counts[event];
+                }
+            }];
+        }
+        
+        OSSpinLockUnlock(&threadStatistics->_spinLock);
+    }
+    
+    return [[self alloc] initWithCountersByClassName:countersByClassName];
+}
+
+- (instancetype)initWithCountersByClassName:(NSDictionary *)countersByClassName
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _countersByClassName = [countersByClassName copy];
+    
+    return self;
+}
+
+
+#pragma mark - Counts
+
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event
+{
+    NSParameterAssert(event >= 0 && event < AKAncestorStatisticsEventLimit);
+    
+    uint64_t count = 0;
+    for (NSString *className in self.countersByClassName)
+    {
+        count += [self _countOfEvent:event forClassName:className];
+    }
+    
+    return count;
+}
+
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event forClass:(Class)ancestorClass
+{
+    NSParameterAssert(event >= 0 && event < AKAncestorStatisticsEventLimit);
+    NSParameterAssert(ancestorClass);
+    
+    return [self _countOfEvent:event forClassName:NSStringFromClass(ancestorClass)];
+}
+
+- (uint64_t)countOfEvent:(AKAncestorStatisticsEvent)event forClass:(Class)ancestorClass propertyName:(NSString *)propertyName
+{
+    NSParameterAssert(event >= 0 && event < AKAncestorStatisticsEventLimit);
+    NSParameterAssert(ancestorClass);
+    
+    AKAncestorStatisticsCounter *counter = self.countersByClassName[NSStringFromClass(ancestorClass)][propertyName ?: [NSNull null]];
+    return (counter) ? counter->_counts[event] : 0;
+}
+
+- (uint64_t)_countOfEvent:(AKAncestorStatisticsEvent)event forClassName:(NSString *)className
+{
+    uint64_t count = 0;
+    for (AKAncestorStatisticsCounter *counter in [self.countersByClassName[className] allValues])
+    {
+        count += counter->_counts[event];
+    }
+    
+    return count;
+}
+
+
+#pragma mark - Exporting
+
+- (NSString *)prometheusText
+{
+    NSArray *classNames = [[self.countersByClassName allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    NSMutableString *text = [NSMutableString string];
+    
+    for (NSUInteger event = 0; event < AKAncestorStatisticsEventLimit; event++)
+    {
+        const char *name = AKAncestorStatisticsMetrics[event].name;
+        [text appendFormat:@"# HELP %s %s\n# TYPE %s counter\n", name, AKAncestorStatisticsMetrics[event].help, name];
+        
+        for (NSString *className in classNames)
+        {
+            NSDictionary *countersByProperty = self.countersByClassName[className];
+            NSString *escapedClassName = AKAncestorStatisticsEscapedLabelValue(className);
+            
+            // NSNull sorts apart from the property names, so events without a property are listed first.
+            NSArray *propertyKeys = [[countersByProperty allKeys] sortedArrayUsingComparator:^NSComparisonResult(id key, id otherKey) {
+                if ([key isKindOfClass:[NSNull class]] || [otherKey isKindOfClass:[NSNull class]])
+                {
+                    return ([key isKindOfClass:[NSNull class]]) ? NSOrderedAscending : NSOrderedDescending;
+                }
+                
+                return [key compare:otherKey];
+            }];
+            
+            for (id propertyKey in propertyKeys)
+            {
+                AKAncestorStatisticsCounter *counter = countersByProperty[propertyKey];
+                uint64_t count = counter->_counts[event];
+                if (count == 0)
+                {
+                    continue;
+                }
+                
+                if ([propertyKey isKindOfClass:[NSNull class]])
+                {
+                    [text appendFormat:@"%s{class=\"%@\"} %llu\n", name, escapedClassName, count];
+                }
+                else
+                {
+                    [text appendFormat:@"%s{class=\"%@\",property=\"%@\"} %llu\n", name, escapedClassName, AKAncestorStatisticsEscapedLabelValue(propertyKey), count];
+                }
+            }
+        }
+    }
+    
+    return [text copy];
+}
+
+- (BOOL)writePrometheusTextToURL:(NSURL *)fileURL error:(NSError **)error
+{
+    NSParameterAssert(fileURL);
+    
+    return [[self prometheusText] writeToURL:fileURL atomically:YES encoding:NSUTF8StringEncoding error:error];
+}
+
+@end
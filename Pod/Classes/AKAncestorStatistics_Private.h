@@ -0,0 +1,34 @@
+//
+//  AKAncestorStatistics_Private.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorStatistics.h"
+
+/**
+ *  YES while AKAncestorStatistics is counting events. Instrumented paths read this without synchronization, so events racing with enabling or disabling may or may not be counted.
+ */
+FOUNDATION_EXPORT volatile BOOL AKAncestorStatisticsEnabled;
+
+/**
+ *  Adds to the count of an event in the current thread's table. Call AKAncestorStatisticsRecord instead, which skips this while counting is disabled.
+ *
+ *  @param event         The event which happened.
+ *  @param ancestorClass The class of the instance it happened on. This must not be Nil.
+ *  @param propertyName  The property it happened for, or nil.
+ */
+FOUNDATION_EXPORT void AKAncestorStatisticsRecordEvent(AKAncestorStatisticsEvent event, Class ancestorClass, NSString *propertyName);
+
+/**
+ *  Counts an event for an instance if AKAncestorStatistics is enabled. This is inlined and only asks for the instance's class once it knows counting is enabled, so disabled counting costs a load and a branch.
+ */
+static inline void AKAncestorStatisticsRecord(AKAncestorStatisticsEvent event, id instance, NSString *propertyName)
+{
+    if (__builtin_expect(AKAncestorStatisticsEnabled, NO))
+    {
+        AKAncestorStatisticsRecordEvent(event, [instance class], propertyName);
+    }
+}
@@ -0,0 +1,154 @@
+//
+//  AKAncestorTable.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  How a query over several properties combines them.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorTableMatch){
+    /**
+     *  An instance matches if it matches for any of the properties.
+     */
+    AKAncestorTableMatchAny = 0,
+    /**
+     *  An instance matches only if it matches for every property.
+     */
+    AKAncestorTableMatchAll
+};
+
+/**
+ *  AKAncestorTable stores many instances of one AKAncestor subclass column by column instead of as separate objects. Each inherited property has a column of local values, with a bitmap marking which instances override it and another marking which stopped inheriting it, and one more column holds each instance's ancestor index. Ancestors are always stored at lower indexes than their descendants, so every value of a property can be resolved in a single pass over its column, instead of walking a chain of objects per instance.
+ *
+ *  Instances can also be read through facades, which are instances of the table's class whose getters, setters and inheritance methods read from and write to the table. Facades retain their table, and a new facade is returned for each request, so they should be used for handing instances to code expecting AKAncestor rather than for bulk work.
+ *
+ *  Tables resolve values by replacing inherited values with local ones. Merge policies, derived properties, lazily provided values and key-value notifications of inherited changes aren't supported. All methods are thread safe.
+ */
+@interface AKAncestorTable : NSObject
+
+/**
+ *  Designated initializer.
+ *
+ *  @param ancestorClass The subclass of AKAncestor whose inherited properties become columns. This must not be nil.
+ *
+ *  @return An empty table.
+ */
+- (instancetype)initWithAncestorClass:(Class)ancestorClass NS_DESIGNATED_INITIALIZER;
+
+@property (assign, nonatomic, readonly) Class ancestorClass;
+
+/**
+ *  The names of the inherited properties, in the order of their columns.
+ */
+@property (copy, nonatomic, readonly) NSArray *propertyNames;
+
+/**
+ *  The number of instances in the table.
+ */
+@property (assign, nonatomic, readonly) NSUInteger count;
+
+
+#pragma mark - Instances
+
+/**
+ *  Adds an instance without any local values.
+ *
+ *  @param ancestorIndex The index of the new instance's ancestor, which must be less than count, or NSNotFound for an instance without one.
+ *
+ *  @return The index of the new instance, which is the previous count.
+ */
+- (NSUInteger)addInstanceWithAncestorIndex:(NSUInteger)ancestorIndex;
+
+/**
+ *  Returns the index of an instance's ancestor, or NSNotFound if it doesn't have one.
+ */
+- (NSUInteger)ancestorIndexAtIndex:(NSUInteger)index;
+
+/**
+ *  Returns a new facade for the instance at the given index. Its ancestor is a facade for the instance at its ancestor index.
+ *
+ *  @param index The index of the instance. This must be less than count.
+ */
+- (id)ancestorAtIndex:(NSUInteger)index;
+
+
+#pragma mark - Values
+
+/**
+ *  Returns the value the instance at the given index resolves for a property: its local value, or nil if it stopped inheriting the property, or else its ancestor's value.
+ *
+ *  @param propertyName The name of an inherited property. If the table has no column for it an AKAncestorUnknownPropertyException is raised.
+ *  @param index        The index of the instance. This must be less than count.
+ */
+- (id)valueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+
+/**
+ *  Returns the instance's own value for a property, ignoring its ancestors.
+ */
+- (id)localValueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+
+/**
+ *  Sets the instance's own value for a property. Values of properties declared copy are copied.
+ *
+ *  @param value        The new value, or nil to inherit the value again.
+ *  @param propertyName The name of an inherited property. If the table has no column for it an AKAncestorUnknownPropertyException is raised.
+ *  @param index        The index of the instance. This must be less than count.
+ */
+- (void)setValue:(id)value forPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+
+- (void)stopInheritingValuesForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+- (void)resumeInheritingValuesForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index;
+
+
+#pragma mark - Bulk resolution
+
+/**
+ *  Resolves a property for the first instances of the table in one pass over its column. Since ancestors come before their descendants, the first instances never depend on later ones.
+ *
+ *  @param values       A buffer of at least valueCount objects, which is filled with each instance's value in index order. The values aren't retained, so they're only valid until the table is next changed.
+ *  @param valueCount   The number of instances to resolve, which must be at most count.
+ *  @param propertyName The name of an inherited property. If the table has no column for it an AKAncestorUnknownPropertyException is raised.
+ */
+- (void)getValues:(__unsafe_unretained id *)values count:(NSUInteger)valueCount forPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the value of a property for every instance in index order, with NSNull in place of nil.
+ */
+- (NSArray *)valuesForPropertyName:(NSString *)propertyName;
+
+
+#pragma mark - Queries
+
+/**
+ *  Returns the indexes of the instances with their own values for the given properties. The bitmaps of the properties are combined a word at a time, so this is far cheaper than asking each instance.
+ *
+ *  @param propertyNames The names of inherited properties. If the table has no column for any of them an AKAncestorUnknownPropertyException is raised.
+ *  @param match         Whether an instance must override any or all of the properties.
+ */
+- (NSIndexSet *)indexesOverridingPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match;
+
+/**
+ *  Returns the number of instances with their own values for the given properties, without building an index set.
+ */
+- (NSUInteger)countOfIndexesOverridingPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match;
+
+/**
+ *  Returns the indexes of the instances which stopped inheriting the given properties.
+ */
+- (NSIndexSet *)indexesIgnoringPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match;
+
+/**
+ *  Returns the indexes of the descendants of an instance which resolve the given properties from it, because neither they nor any instance between them overrides or stops inheriting the properties. These are the instances whose values change when the instance's values do.
+ *
+ *  @param propertyNames The names of inherited properties. If the table has no column for any of them an AKAncestorUnknownPropertyException is raised.
+ *  @param index         The index of the instance. This must be less than count.
+ *  @param match         Whether a descendant must inherit any or all of the properties.
+ */
+- (NSIndexSet *)indexesInheritingPropertyNames:(NSArray *)propertyNames fromIndex:(NSUInteger)index match:(AKAncestorTableMatch)match;
+
+@end
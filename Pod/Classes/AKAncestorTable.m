@@ -0,0 +1,775 @@
+//
+//  AKAncestorTable.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorTable.h"
+#import "AKAncestor.h"
+#import "AKAncestorClassInfo.h"
+#import "AKPropertyDescription.h"
+#import "AKAncestorPlatform.h"
+#import <objc/runtime.h>
+
+static const NSUInteger AKAncestorTableInitialCapacity = 64;
+static const NSUInteger AKAncestorTableBitsPerWord = 64;
+
+static const char *const AKAncestorTableFacadeTableIvarName = "_ak_table";
+static const char *const AKAncestorTableFacadeIndexIvarName = "_ak_tableIndex";
+static void *AKAncestorTableFacadeTableKey = &AKAncestorTableFacadeTableKey;
+
+static inline BOOL AKAncestorTableTestBit(const uint64_t *bitmap, NSUInteger index)
+{
+    return (bitmap[index / AKAncestorTableBitsPerWord] >> (index % AKAncestorTableBitsPerWord)) & 1;
+}
+
+static inline void AKAncestorTableSetBit(uint64_t *bitmap, NSUInteger index, BOOL isSet)
+{
+    uint64_t mask = (uint64_t)1 << (index % AKAncestorTableBitsPerWord);
+    if (isSet)
+    {
+        bitmap[index / AKAncestorTableBitsPerWord] |= mask;
+    }
+    else
+    {
+        bitmap[index / AKAncestorTableBitsPerWord] &= ~mask;
+    }
+}
+
+static inline NSUInteger AKAncestorTableWordCount(NSUInteger count)
+{
+    return (count + AKAncestorTableBitsPerWord - 1) / AKAncestorTableBitsPerWord;
+}
+
+// Four words are combined at once with the compiler's vector extensions, which become SSE, AVX or NEON operations depending on the target. The reduced alignment lets bitmaps be loaded wherever they start.
+typedef uint64_t AKAncestorTableWordVector __attribute__((vector_size(32), aligned(8), may_alias));
+static const NSUInteger AKAncestorTableWordsPerVector = sizeof(AKAncestorTableWordVector) / sizeof(uint64_t);
+
+static void AKAncestorTableCombineBitmaps(uint64_t *result, const uint64_t *const *bitmaps, NSUInteger bitmapCount, NSUInteger wordCount, AKAncestorTableMatch match)
+{
+    BOOL matchesAll = (match == AKAncestorTableMatchAll);
+    memset(result, (matchesAll) ? 0xFF : 0, wordCount * sizeof(uint64_t));
+    
+    for (NSUInteger bitmapIndex = 0; bitmapIndex < bitmapCount; bitmapIndex++)
+    {
+        const uint64_t *bitmap = bitmaps[bitmapIndex];
+        
+        NSUInteger word = 0;
+        for (; word + AKAncestorTableWordsPerVector <= wordCount; word += AKAncestorTableWordsPerVector)
+        {
+            AKAncestorTableWordVector *resultVector = (AKAncestorTableWordVector *)(result + word);
+            AKAncestorTableWordVector bitmapVector = *(const AKAncestorTableWordVector *)(bitmap + word);
+            if (matchesAll)
+            {
+                *resultVector &= bitmapVector;
+            }
+            else
+            {
+                *resultVector |= bitmapVector;
+            }
+        }
+        
+        for (; word < wordCount; word++)
+        {
+            result[word] = (matchesAll) ? (result[word] & bitmap[word]) : (result[word] | bitmap[word]);
+        }
+    }
+}
+
+// Clears the bits past the last instance, which a match of all properties would otherwise leave set.
+static void AKAncestorTableMaskBitmap(uint64_t *bitmap, NSUInteger count)
+{
+    NSUInteger remainder = count % AKAncestorTableBitsPerWord;
+    if (remainder > 0)
+    {
+        bitmap[count / AKAncestorTableBitsPerWord] &= ((uint64_t)1 << remainder) - 1;
+    }
+}
+
+static NSUInteger AKAncestorTableCountBits(const uint64_t *bitmap, NSUInteger wordCount)
+{
+    NSUInteger count = 0;
+    for (NSUInteger word = 0; word < wordCount; word++)
+    {
+        count += (NSUInteger)__builtin_popcountll(bitmap[word]);
+    }
+    
+    return count;
+}
+
+static NSIndexSet *AKAncestorTableIndexSetFromBitmap(const uint64_t *bitmap, NSUInteger wordCount)
+{
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    NSRange run = NSMakeRange(NSNotFound, 0);
+    
+    // Runs of set bits are added as ranges, carried across words, so dense results don't cost an insertion per index.
+    for (NSUInteger word = 0; word < wordCount; word++)
+    {
+        uint64_t bits = bitmap[word];
+        NSUInteger bit = 0;
+        while (bit < AKAncestorTableBitsPerWord)
+        {
+            uint64_t remainingBits = bits >> bit;
+            if (remainingBits == 0)
+            {
+                break;
+            }
+            
+            NSUInteger skippedCount = (NSUInteger)__builtin_ctzll(remainingBits);
+            uint64_t runBits = ~(remainingBits >> skippedCount);
+            NSUInteger setCount = (runBits == 0) ? AKAncestorTableBitsPerWord - bit - skippedCount : MIN((NSUInteger)__builtin_ctzll(runBits), AKAncestorTableBitsPerWord - bit - skippedCount);
+            NSUInteger location = word * AKAncestorTableBitsPerWord + bit + skippedCount;
+            
+            if (run.location != NSNotFound && NSMaxRange(run) == location)
+            {
+                run.length += setCount;
+            }
+            else
+            {
+                if (run.location != NSNotFound)
+                {
+                    [indexes addIndexesInRange:run];
+                }
+                
+                run = NSMakeRange(location, setCount);
+            }
+            
+            bit += skippedCount + setCount;
+        }
+    }
+    
+    if (run.location != NSNotFound)
+    {
+        [indexes addIndexesInRange:run];
+    }
+    
+    return indexes;
+}
+
+
+@interface AKAncestorTable ()
+{
+    // Spin locks require using an Ivar or a static variable, so unfortunately we can't enjoy property goodness here.
+    OSSpinLock _spinLock;
+    
+    // Only ever increases, so indexes are validated against it without the spin lock.
+    volatile NSUInteger _count;
+    NSUInteger _capacity;
+    
+    NSUInteger *_ancestorIndexes;
+    
+    // One array of capacity values and two bitmaps of capacity bits for each column.
+    __strong id **_localValues;
+    uint64_t **_overrideBitmaps;
+    uint64_t **_ignoreBitmaps;
+    
+    BOOL *_copiesValues;
+}
+
+@property (strong, nonatomic, readonly) AKAncestorClassInfo *classInfo;
+@property (assign, nonatomic, readonly) Class facadeClass;
+
+- (id)_valueInColumn:(NSUInteger)column atIndex:(NSUInteger)index;
+- (id)_localValueInColumn:(NSUInteger)column atIndex:(NSUInteger)index;
+- (void)_setValue:(id)value inColumn:(NSUInteger)column atIndex:(NSUInteger)index;
+- (void)_setIgnoresValues:(BOOL)ignoresValues inColumn:(NSUInteger)column atIndex:(NSUInteger)index;
+
+@end
+
+@implementation AKAncestorTable
+
+- (instancetype)init
+{
+    return [self initWithAncestorClass:[AKAncestor class]];
+}
+
+- (instancetype)initWithAncestorClass:(Class)ancestorClass
+{
+    NSParameterAssert(ancestorClass);
+    
+    if (![ancestorClass isSubclassOfClass:[AKAncestor class]])
+    {
+        [NSException raise:NSInvalidArgumentException format:@"%@ is not a subclass of AKAncestor.", ancestorClass];
+    }
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _spinLock = OS_SPINLOCK_INIT;
+    _ancestorClass = ancestorClass;
+    _classInfo = [AKAncestorClassInfo classInfoForClass:ancestorClass];
+    _propertyNames = [_classInfo.propertyNames copy];
+    _facadeClass = [[self class] _facadeClassForAncestorClass:ancestorClass];
+    
+    NSUInteger columnCount = _classInfo.propertyCount;
+    NSUInteger wordCount = AKAncestorTableInitialCapacity / AKAncestorTableBitsPerWord;
+    
+    _capacity = AKAncestorTableInitialCapacity;
+    _ancestorIndexes = calloc(_capacity, sizeof(NSUInteger));
+    _localValues = (__strong id **)calloc(columnCount, sizeof(id *));
+    _overrideBitmaps = calloc(columnCount, sizeof(uint64_t *));
+    _ignoreBitmaps = calloc(columnCount, sizeof(uint64_t *));
+    _copiesValues = calloc(columnCount, sizeof(BOOL));
+    
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        _localValues[column] = (__strong id *)calloc(_capacity, sizeof(id));
+        _overrideBitmaps[column] = calloc(wordCount, sizeof(uint64_t));
+        _ignoreBitmaps[column] = calloc(wordCount, sizeof(uint64_t));
+        _copiesValues[column] = [_classInfo.properties[column] isCopy];
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    NSUInteger columnCount = _classInfo.propertyCount;
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        // The values are released before their storage goes away, since ARC doesn't manage them inside a malloced array.
+        for (NSUInteger index = 0; index < _count; index++)
+        {
+            _localValues[column][index] = nil;
+        }
+        
+        free(_localValues[column]);
+        free(_overrideBitmaps[column]);
+        free(_ignoreBitmaps[column]);
+    }
+    
+    free(_localValues);
+    free(_overrideBitmaps);
+    free(_ignoreBitmaps);
+    free(_copiesValues);
+    free(_ancestorIndexes);
+}
+
+- (NSUInteger)count
+{
+    return _count;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> %@ (%lu instances)", NSStringFromClass([self class]), self, NSStringFromClass(self.ancestorClass), (unsigned long)self.count];
+}
+
+
+#pragma mark - Validation
+
+- (void)_validateIndex:(NSUInteger)index
+{
+    if (index >= _count)
+    {
+        [NSException raise:NSRangeException format:@"Index %lu is beyond the %lu instances of %@.", (unsigned long)index, (unsigned long)_count, self];
+    }
+}
+
+- (NSUInteger)_columnForPropertyName:(NSString *)propertyName
+{
+    NSUInteger column = [self.classInfo indexOfPropertyName:propertyName];
+    if (column == NSNotFound)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, self.ancestorClass];
+    }
+    
+    return column;
+}
+
+
+#pragma mark - Instances
+
+- (void)_growIfNeeded
+{
+    if (_count < _capacity)
+    {
+        return;
+    }
+    
+    NSUInteger previousCapacity = _capacity;
+    NSUInteger previousWordCount = previousCapacity / AKAncestorTableBitsPerWord;
+    
+    _capacity = previousCapacity * 2;
+    NSUInteger wordCount = _capacity / AKAncestorTableBitsPerWord;
+    
+    _ancestorIndexes = realloc(_ancestorIndexes, _capacity * sizeof(NSUInteger));
+    
+    NSUInteger columnCount = self.classInfo.propertyCount;
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        // The values move along with their storage, so they're copied bitwise and the new slots are zeroed to nil before ARC sees them.
+        _localValues[column] = (__strong id *)realloc((void *)_localValues[column], _capacity * sizeof(id));
+        memset((void *)(_localValues[column] + previousCapacity), 0, (_capacity - previousCapacity) * sizeof(id));
+        
+        _overrideBitmaps[column] = realloc(_overrideBitmaps[column], wordCount * sizeof(uint64_t));
+        memset(_overrideBitmaps[column] + previousWordCount, 0, (wordCount - previousWordCount) * sizeof(uint64_t));
+        
+        _ignoreBitmaps[column] = realloc(_ignoreBitmaps[column], wordCount * sizeof(uint64_t));
+        memset(_ignoreBitmaps[column] + previousWordCount, 0, (wordCount - previousWordCount) * sizeof(uint64_t));
+    }
+}
+
+- (NSUInteger)addInstanceWithAncestorIndex:(NSUInteger)ancestorIndex
+{
+    if (ancestorIndex != NSNotFound)
+    {
+        [self _validateIndex:ancestorIndex];
+    }
+    
+    OSSpinLockLock(&_spinLock);
+    [self _growIfNeeded];
+    
+    NSUInteger index = _count;
+    _ancestorIndexes[index] = ancestorIndex;
+    _count = index + 1;
+    OSSpinLockUnlock(&_spinLock);
+    
+    return index;
+}
+
+- (NSUInteger)ancestorIndexAtIndex:(NSUInteger)index
+{
+    [self _validateIndex:index];
+    
+    // Ancestor indexes never change once added, but the column may be moved while growing.
+    OSSpinLockLock(&_spinLock);
+    NSUInteger ancestorIndex = _ancestorIndexes[index];
+    OSSpinLockUnlock(&_spinLock);
+    
+    return ancestorIndex;
+}
+
+- (id)ancestorAtIndex:(NSUInteger)index
+{
+    [self _validateIndex:index];
+    
+    AKAncestor *facade = [[self.facadeClass alloc] initWithAncestor:nil inheritKeyValueNotifications:NO];
+    
+    // The ivar is read by every facade getter, so it's a plain pointer, and the associated object is what keeps the table alive.
+    object_setIvar(facade, class_getInstanceVariable(self.facadeClass, AKAncestorTableFacadeTableIvarName), self);
+    objc_setAssociatedObject(facade, AKAncestorTableFacadeTableKey, self, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    
+    Ivar indexIvar = class_getInstanceVariable(self.facadeClass, AKAncestorTableFacadeIndexIvarName);
+    *(NSUInteger *)((uint8_t *)(__bridge void *)facade + ivar_getOffset(indexIvar)) = index;
+    
+    return facade;
+}
+
+
+#pragma mark - Values
+
+- (id)_valueInColumn:(NSUInteger)column atIndex:(NSUInteger)index
+{
+    id value = nil;
+    
+    OSSpinLockLock(&_spinLock);
+    const uint64_t *overrideBitmap = _overrideBitmaps[column];
+    const uint64_t *ignoreBitmap = _ignoreBitmaps[column];
+    
+    NSUInteger currentIndex = index;
+    while (currentIndex != NSNotFound)
+    {
+        if (AKAncestorTableTestBit(overrideBitmap, currentIndex))
+        {
+            value = _localValues[column][currentIndex];
+            break;
+        }
+        
+        if (AKAncestorTableTestBit(ignoreBitmap, currentIndex))
+        {
+            break;
+        }
+        
+        currentIndex = _ancestorIndexes[currentIndex];
+    }
+    OSSpinLockUnlock(&_spinLock);
+    
+    return value;
+}
+
+- (id)_localValueInColumn:(NSUInteger)column atIndex:(NSUInteger)index
+{
+    OSSpinLockLock(&_spinLock);
+    id value = _localValues[column][index];
+    OSSpinLockUnlock(&_spinLock);
+    
+    return value;
+}
+
+- (void)_setValue:(id)value inColumn:(NSUInteger)column atIndex:(NSUInteger)index
+{
+    // Copying may run arbitrary code, so it happens before taking the lock.
+    id newValue = (_copiesValues[column]) ? [value copy] : value;
+    
+    OSSpinLockLock(&_spinLock);
+    // The previous value is kept until after unlocking, so releasing it can't run a dealloc while the lock is held.
+    __attribute__((objc_precise_lifetime)) id previousValue = _localValues[column][index];
+    _localValues[column][index] = newValue;
+    AKAncestorTableSetBit(_overrideBitmaps[column], index, (newValue != nil));
+    OSSpinLockUnlock(&_spinLock);
+}
+
+- (void)_setIgnoresValues:(BOOL)ignoresValues inColumn:(NSUInteger)column atIndex:(NSUInteger)index
+{
+    OSSpinLockLock(&_spinLock);
+    AKAncestorTableSetBit(_ignoreBitmaps[column], index, ignoresValues);
+    OSSpinLockUnlock(&_spinLock);
+}
+
+- (id)valueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    [self _validateIndex:index];
+    
+    return [self _valueInColumn:column atIndex:index];
+}
+
+- (id)localValueForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    [self _validateIndex:index];
+    
+    return [self _localValueInColumn:column atIndex:index];
+}
+
+- (void)setValue:(id)value forPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    [self _validateIndex:index];
+    
+    [self _setValue:value inColumn:column atIndex:index];
+}
+
+- (void)stopInheritingValuesForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    [self _validateIndex:index];
+    
+    [self _setIgnoresValues:YES inColumn:column atIndex:index];
+}
+
+- (void)resumeInheritingValuesForPropertyName:(NSString *)propertyName atIndex:(NSUInteger)index
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    [self _validateIndex:index];
+    
+    [self _setIgnoresValues:NO inColumn:column atIndex:index];
+}
+
+
+#pragma mark - Bulk resolution
+
+// Must be called with the spin lock held. Each instance's ancestor has already been resolved by the time it's reached, so resolving is one pass instead of a walk per instance.
+- (void)_getValues:(__unsafe_unretained id *)values count:(NSUInteger)valueCount inColumn:(NSUInteger)column
+{
+    __strong id *localValues = _localValues[column];
+    const uint64_t *overrideBitmap = _overrideBitmaps[column];
+    const uint64_t *ignoreBitmap = _ignoreBitmaps[column];
+    const NSUInteger *ancestorIndexes = _ancestorIndexes;
+    
+    for (NSUInteger index = 0; index < valueCount; index++)
+    {
+        if (AKAncestorTableTestBit(overrideBitmap, index))
+        {
+            values[index] = localValues[index];
+        }
+        else if (AKAncestorTableTestBit(ignoreBitmap, index) || ancestorIndexes[index] == NSNotFound)
+        {
+            values[index] = nil;
+        }
+        else
+        {
+            values[index] = values[ancestorIndexes[index]];
+        }
+    }
+}
+
+- (void)getValues:(__unsafe_unretained id *)values count:(NSUInteger)valueCount forPropertyName:(NSString *)propertyName
+{
+    NSParameterAssert(values || valueCount == 0);
+    
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    if (valueCount > _count)
+    {
+        [NSException raise:NSRangeException format:@"Can't resolve %lu values from the %lu instances of %@.", (unsigned long)valueCount, (unsigned long)_count, self];
+    }
+    
+    OSSpinLockLock(&_spinLock);
+    [self _getValues:values count:valueCount inColumn:column];
+    OSSpinLockUnlock(&_spinLock);
+}
+
+- (NSArray *)valuesForPropertyName:(NSString *)propertyName
+{
+    NSUInteger column = [self _columnForPropertyName:propertyName];
+    
+    OSSpinLockLock(&_spinLock);
+    NSUInteger valueCount = _count;
+    __unsafe_unretained id *values = (__unsafe_unretained id *)malloc(MAX(valueCount, 1) * sizeof(id));
+    [self _getValues:values count:valueCount inColumn:column];
+    
+    for (NSUInteger index = 0; index < valueCount; index++)
+    {
+        values[index] = values[index] ?: [NSNull null];
+    }
+    
+    // The array retains the values before unlocking, since a concurrent write could otherwise release them.
+    NSArray *array = [NSArray arrayWithObjects:values count:valueCount];
+    OSSpinLockUnlock(&_spinLock);
+    
+    free(values);
+    return array;
+}
+
+
+#pragma mark - Queries
+
+- (NSUInteger *)_copyColumnsForPropertyNames:(NSArray *)propertyNames
+{
+    NSUInteger *columns = calloc(MAX(propertyNames.count, 1), sizeof(NSUInteger));
+    for (NSUInteger index = 0; index < propertyNames.count; index++)
+    {
+        columns[index] = [self _columnForPropertyName:propertyNames[index]];
+    }
+    
+    return columns;
+}
+
+// Fills result with the bitmaps of the given columns combined, covering the first valueCount instances.
+- (void)_combineBitmaps:(uint64_t **)columnBitmaps ofPropertyNames:(NSArray *)propertyNames count:(NSUInteger)valueCount match:(AKAncestorTableMatch)match result:(uint64_t *)result
+{
+    NSUInteger *columns = [self _copyColumnsForPropertyNames:propertyNames];
+    NSUInteger columnCount = propertyNames.count;
+    const uint64_t **bitmaps = calloc(MAX(columnCount, 1), sizeof(uint64_t *));
+    
+    // The bitmaps may move while the table grows, but the words covering valueCount instances don't change size.
+    OSSpinLockLock(&_spinLock);
+    for (NSUInteger index = 0; index < columnCount; index++)
+    {
+        bitmaps[index] = columnBitmaps[columns[index]];
+    }
+    
+    AKAncestorTableCombineBitmaps(result, bitmaps, columnCount, AKAncestorTableWordCount(valueCount), match);
+    OSSpinLockUnlock(&_spinLock);
+    
+    AKAncestorTableMaskBitmap(result, valueCount);
+    
+    free(bitmaps);
+    free(columns);
+}
+
+- (NSIndexSet *)indexesOverridingPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match
+{
+    NSUInteger valueCount = _count;
+    NSUInteger wordCount = AKAncestorTableWordCount(valueCount);
+    uint64_t *result = calloc(MAX(wordCount, 1), sizeof(uint64_t));
+    
+    [self _combineBitmaps:_overrideBitmaps ofPropertyNames:propertyNames count:valueCount match:match result:result];
+    NSIndexSet *indexes = AKAncestorTableIndexSetFromBitmap(result, wordCount);
+    
+    free(result);
+    return indexes;
+}
+
+- (NSUInteger)countOfIndexesOverridingPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match
+{
+    NSUInteger valueCount = _count;
+    NSUInteger wordCount = AKAncestorTableWordCount(valueCount);
+    uint64_t *result = calloc(MAX(wordCount, 1), sizeof(uint64_t));
+    
+    [self _combineBitmaps:_overrideBitmaps ofPropertyNames:propertyNames count:valueCount match:match result:result];
+    NSUInteger count = AKAncestorTableCountBits(result, wordCount);
+    
+    free(result);
+    return count;
+}
+
+- (NSIndexSet *)indexesIgnoringPropertyNames:(NSArray *)propertyNames match:(AKAncestorTableMatch)match
+{
+    NSUInteger valueCount = _count;
+    NSUInteger wordCount = AKAncestorTableWordCount(valueCount);
+    uint64_t *result = calloc(MAX(wordCount, 1), sizeof(uint64_t));
+    
+    [self _combineBitmaps:_ignoreBitmaps ofPropertyNames:propertyNames count:valueCount match:match result:result];
+    NSIndexSet *indexes = AKAncestorTableIndexSetFromBitmap(result, wordCount);
+    
+    free(result);
+    return indexes;
+}
+
+- (NSIndexSet *)indexesInheritingPropertyNames:(NSArray *)propertyNames fromIndex:(NSUInteger)index match:(AKAncestorTableMatch)match
+{
+    [self _validateIndex:index];
+    
+    NSUInteger *columns = [self _copyColumnsForPropertyNames:propertyNames];
+    NSUInteger columnCount = propertyNames.count;
+    NSUInteger valueCount = _count;
+    NSUInteger wordCount = AKAncestorTableWordCount(valueCount);
+    
+    // One bitmap of every descendant, followed by one per property of the descendants reached without being blocked.
+    uint64_t *descendants = calloc((columnCount + 1) * wordCount, sizeof(uint64_t));
+    uint64_t **reached = calloc(MAX(columnCount, 1), sizeof(uint64_t *));
+    for (NSUInteger column = 0; column < columnCount; column++)
+    {
+        reached[column] = descendants + (column + 1) * wordCount;
+    }
+    
+    OSSpinLockLock(&_spinLock);
+    // Ancestors come before their descendants, so a single pass from the instance onward sees every ancestor's bit before it's needed.
+    for (NSUInteger currentIndex = index + 1; currentIndex < valueCount; currentIndex++)
+    {
+        NSUInteger ancestorIndex = _ancestorIndexes[currentIndex];
+        if (ancestorIndex == NSNotFound || ancestorIndex < index)
+        {
+            continue;
+        }
+        
+        BOOL isChild = (ancestorIndex == index);
+        if (!isChild && !AKAncestorTableTestBit(descendants, ancestorIndex))
+        {
+            continue;
+        }
+        
+        AKAncestorTableSetBit(descendants, currentIndex, YES);
+        
+        for (NSUInteger column = 0; column < columnCount; column++)
+        {
+            NSUInteger propertyColumn = columns[column];
+            if ((isChild || AKAncestorTableTestBit(reached[column], ancestorIndex)) && !AKAncestorTableTestBit(_overrideBitmaps[propertyColumn], currentIndex) && !AKAncestorTableTestBit(_ignoreBitmaps[propertyColumn], currentIndex))
+            {
+                AKAncestorTableSetBit(reached[column], currentIndex, YES);
+            }
+        }
+    }
+    OSSpinLockUnlock(&_spinLock);
+    
+    uint64_t *result = calloc(MAX(wordCount, 1), sizeof(uint64_t));
+    AKAncestorTableCombineBitmaps(result, (const uint64_t *const *)reached, columnCount, wordCount, match);
+    
+    // Matching all of no properties would match every instance, not just descendants.
+    for (NSUInteger word = 0; word < wordCount; word++)
+    {
+        result[word] &= descendants[word];
+    }
+    
+    NSIndexSet *indexes = AKAncestorTableIndexSetFromBitmap(result, wordCount);
+    
+    free(result);
+    free(reached);
+    free(descendants);
+    free(columns);
+    return indexes;
+}
+
+
+#pragma mark - Facades
+
+static NSUInteger AKAncestorTableFacadeIndex(id facade, ptrdiff_t indexOffset)
+{
+    return *(NSUInteger *)((uint8_t *)(__bridge void *)facade + indexOffset);
+}
+
++ (Class)_facadeClassForAncestorClass:(Class)ancestorClass
+{
+    static NSMutableDictionary *facadeClasses;
+    
+    @synchronized(self)
+    {
+        if (!facadeClasses)
+        {
+            facadeClasses = [NSMutableDictionary dictionary];
+        }
+        
+        NSString *ancestorClassName = NSStringFromClass(ancestorClass);
+        Class facadeClass = facadeClasses[ancestorClassName];
+        if (facadeClass)
+        {
+            return facadeClass;
+        }
+        
+        NSString *facadeClassName = [NSString stringWithFormat:@"AKAncestorTableFacade_%@", ancestorClassName];
+        facadeClass = objc_allocateClassPair(ancestorClass, facadeClassName.UTF8String, 0);
+        
+        // Ivars can only be added before the class is registered, while methods capture their offsets afterwards.
+        class_addIvar(facadeClass, AKAncestorTableFacadeTableIvarName, sizeof(id), (uint8_t)log2(sizeof(id)), @encode(id));
+        class_addIvar(facadeClass, AKAncestorTableFacadeIndexIvarName, sizeof(NSUInteger), (uint8_t)log2(sizeof(NSUInteger)), @encode(NSUInteger));
+        objc_registerClassPair(facadeClass);
+        
+        [self _addFacadeMethodsToClass:facadeClass ancestorClass:ancestorClass];
+        
+        facadeClasses[ancestorClassName] = facadeClass;
+        return facadeClass;
+    }
+}
+
++ (void)_addFacadeMethodsToClass:(Class)facadeClass ancestorClass:(Class)ancestorClass
+{
+    Ivar tableIvar = class_getInstanceVariable(facadeClass, AKAncestorTableFacadeTableIvarName);
+    ptrdiff_t indexOffset = ivar_getOffset(class_getInstanceVariable(facadeClass, AKAncestorTableFacadeIndexIvarName));
+    
+    AKAncestorClassInfo *classInfo = [AKAncestorClassInfo classInfoForClass:ancestorClass];
+    for (NSUInteger column = 0; column < classInfo.propertyCount; column++)
+    {
+        AKPropertyDescription *property = classInfo.properties[column];
+        
+        IMP getter = imp_implementationWithBlock(^id (id self) {
+            AKAncestorTable *table = object_getIvar(self, tableIvar);
+            return [table _valueInColumn:column atIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+        });
+        class_addMethod(facadeClass, property.propertyGetter, getter, "@@:");
+        
+        // Code which wants the receiver's own value, like descriptions and comparisons, reads it through the swizzled getter.
+        IMP localGetter = imp_implementationWithBlock(^id (id self) {
+            AKAncestorTable *table = object_getIvar(self, tableIvar);
+            return [table _localValueInColumn:column atIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+        });
+        class_addMethod(facadeClass, [classInfo localGetterAtIndex:column], localGetter, "@@:");
+        
+        if (!property.isReadonly)
+        {
+            IMP setter = imp_implementationWithBlock(^(id self, id value) {
+                AKAncestorTable *table = object_getIvar(self, tableIvar);
+                [table _setValue:value inColumn:column atIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+            });
+            class_addMethod(facadeClass, property.propertySetter, setter, "v@:@");
+        }
+    }
+    
+    IMP ancestor = imp_implementationWithBlock(^id (id self) {
+        AKAncestorTable *table = object_getIvar(self, tableIvar);
+        NSUInteger ancestorIndex = [table ancestorIndexAtIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+        return (ancestorIndex != NSNotFound) ? [table ancestorAtIndex:ancestorIndex] : nil;
+    });
+    class_addMethod(facadeClass, @selector(ancestor), ancestor, "@@:");
+    
+    IMP ancestors = imp_implementationWithBlock(^NSArray *(id self) {
+        AKAncestor *ancestor = [self ancestor];
+        return (ancestor) ? @[ancestor] : @[];
+    });
+    class_addMethod(facadeClass, @selector(ancestors), ancestors, "@@:");
+    
+    IMP stopInheriting = imp_implementationWithBlock(^(id self, NSString *propertyName) {
+        AKAncestorTable *table = object_getIvar(self, tableIvar);
+        [table stopInheritingValuesForPropertyName:propertyName atIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+    });
+    class_addMethod(facadeClass, @selector(stopInheritingValuesForPropertyName:), stopInheriting, "v@:@");
+    
+    IMP resumeInheriting = imp_implementationWithBlock(^(id self, NSString *propertyName) {
+        AKAncestorTable *table = object_getIvar(self, tableIvar);
+        [table resumeInheritingValuesForPropertyName:propertyName atIndex:AKAncestorTableFacadeIndex(self, indexOffset)];
+    });
+    class_addMethod(facadeClass, @selector(resumeInheritingValuesForPropertyName:), resumeInheriting, "v@:@");
+    
+    // Facades pass for the table's class, so class info, descendants and archives treat them as ordinary instances.
+    IMP class = imp_implementationWithBlock(^Class (id self) {
+        return ancestorClass;
+    });
+    class_addMethod(facadeClass, @selector(class), class, "#@:");
+}
+
+@end
@@ -0,0 +1,91 @@
+//
+//  AKAncestorTrace.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  The events recorded by AKAncestorTrace.
+ */
+typedef NS_ENUM(NSInteger, AKAncestorTraceEvent){
+    /**
+     *  A getter of an inheritable property resolved its value, from when it was called until it returned. Resolutions which consulted an ancestor contain the ancestor's resolution.
+     */
+    AKAncestorTraceEventResolution = 0,
+    /**
+     *  A setter of an inheritable property stored a new value. Key-value notifications sent for the change are recorded separately, once the setter returns.
+     */
+    AKAncestorTraceEventWrite,
+    /**
+     *  A key-value notification from an ancestor was forwarded to observers of a descendant, from when the descendant was told until its observers, and those of its own descendants, were notified.
+     */
+    AKAncestorTraceEventKeyValueForward,
+    /**
+     *  An instance was initialized with an ancestor.
+     */
+    AKAncestorTraceEventDescendantCreation,
+    /**
+     *  An instance initialized with an ancestor was deallocated.
+     */
+    AKAncestorTraceEventDescendantDeallocation
+};
+
+
+/**
+ *  AKAncestorTrace records timestamped events, like resolutions, writes, and forwarded key-value notifications, so the sequence of events behind a latency spike can be seen rather than only their totals. Tracing is disabled by default, and while it's disabled each instrumented path only checks a flag.
+ *
+ *  Once enabled, every thread records into its own fixed size ring buffer without taking locks, so the oldest events of a thread are overwritten once its buffer fills up. The recorded events can be dumped at any time in the Chrome trace event format, to be opened in chrome://tracing or Perfetto.
+ */
+@interface AKAncestorTrace : NSObject
+
+/**
+ *  Returns YES if events are being recorded. Defaults to NO.
+ */
++ (BOOL)isEnabled;
+
+/**
+ *  Starts or stops recording events. Recorded events are kept when recording stops, so they can still be dumped.
+ *
+ *  @param enabled YES to record events, or NO to stop.
+ */
++ (void)setEnabled:(BOOL)enabled;
+
+/**
+ *  Returns the number of events each thread's ring buffer holds. Defaults to 8192.
+ */
++ (NSUInteger)bufferCapacity;
+
+/**
+ *  Sets the number of events each thread's ring buffer holds. Threads switch to a buffer of the new capacity the next time they record an event, and the events in their previous buffer are kept until the trace is cleared.
+ *
+ *  @param bufferCapacity The number of events to hold, which must be greater than 0.
+ */
++ (void)setBufferCapacity:(NSUInteger)bufferCapacity;
+
+/**
+ *  Discards the events recorded so far by every thread.
+ */
++ (void)clear;
+
+/**
+ *  Returns the recorded events of every thread as a Chrome trace JSON object. Resolutions, writes, and forwarded notifications are complete events with a duration, while descendant creations and deallocations are instant events. Each event is labelled with the class and address of its instance. Threads may keep recording while the events are read, so concurrent events may or may not be included.
+ *
+ *  @return UTF-8 encoded JSON data.
+ */
++ (NSData *)chromeTraceData;
+
+/**
+ *  Writes -chromeTraceData to a file atomically.
+ *
+ *  @param fileURL The URL of the file to write. This must not be nil.
+ *  @param error   On failure, the error which occurred. This may be NULL.
+ *
+ *  @return YES if the file was written, or NO if an error occurred.
+ */
++ (BOOL)writeChromeTraceToURL:(NSURL *)fileURL error:(NSError **)error;
+
+@end
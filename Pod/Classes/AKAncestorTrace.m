@@ -0,0 +1,302 @@
+//
+//  AKAncestorTrace.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorTrace.h"
+#import "AKAncestorTrace_Private.h"
+#import "AKAncestorPlatform.h"
+#import <objc/runtime.h>
+#import <unistd.h>
+
+volatile BOOL AKAncestorTraceEnabled = NO;
+
+static volatile NSUInteger AKAncestorTraceBufferCapacity = 8192;
+
+/**
+ *  One recorded event. The sequence is 0 while the entry is being written and the event's index plus one afterwards, so a reader copying the entry can tell whether the owning thread wrote over it in the meantime.
+ */
+typedef struct
+{
+    volatile uint64_t sequence;
+    uint64_t startTimestamp;
+    uint64_t endTimestamp;
+    __unsafe_unretained Class instanceClass;
+    const void *instance;
+    const char *propertyName;
+    AKAncestorTraceEvent event;
+} AKAncestorTraceEntry;
+
+
+/**
+ *  The ring buffer of one thread. Only the owning thread writes entries and advances the next index, while readers only copy entries and move the cleared index, so neither side takes a lock.
+ */
+@interface AKAncestorTraceBuffer : NSObject
+{
+    @public
+    AKAncestorTraceEntry *_entries;
+    NSUInteger _capacity;
+    volatile uint64_t _nextIndex;
+    volatile uint64_t _clearedIndex;
+    
+    // Set by the owning thread once it has moved on to a buffer of another capacity, after which the buffer is never written again.
+    volatile BOOL _retired;
+}
+
+@property (assign, nonatomic, readonly) uint64_t threadID;
+@property (copy, nonatomic, readonly) NSString *threadName;
+
+@end
+
+@implementation AKAncestorTraceBuffer
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _capacity = capacity;
+    _entries = calloc(capacity, sizeof(AKAncestorTraceEntry));
+    
+    _threadID = AKAncestorCurrentThreadID();
+    
+    char threadName[64] = {0};
+    pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+    if (threadName[0] != '\0')
+    {
+        _threadName = [NSString stringWithUTF8String:threadName];
+    }
+    else
+    {
+        _threadName = ([NSThread isMainThread]) ? @"Main thread" : [NSString stringWithFormat:@"Thread %llu", _threadID];
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_entries);
+}
+
+@end
+
+
+// Buffers are registered once per thread and kept for the life of the process, so events from threads which have exited aren't lost. Only retired buffers are let go, when the trace is cleared.
+static __thread __unsafe_unretained AKAncestorTraceBuffer *AKAncestorCurrentTraceBuffer;
+static OSSpinLock AKAncestorTraceBuffersLock = OS_SPINLOCK_INIT;
+
+static NSMutableArray *AKAncestorAllTraceBuffers()
+{
+    static NSMutableArray *buffers;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        buffers = [NSMutableArray array];
+    });
+    
+    return buffers;
+}
+
+static NSArray *AKAncestorTraceBuffersSnapshot()
+{
+    OSSpinLockLock(&AKAncestorTraceBuffersLock);
+    NSArray *buffers = [AKAncestorAllTraceBuffers() copy];
+    OSSpinLockUnlock(&AKAncestorTraceBuffersLock);
+    
+    return buffers;
+}
+
+const char *AKAncestorTraceInternedName(NSString *name)
+{
+    NSCParameterAssert(name);
+    
+    // Selector names are registered for good, which makes them a convenient interning table.
+    return sel_getName(sel_registerName([name UTF8String]));
+}
+
+void AKAncestorTraceRecordEvent(AKAncestorTraceEvent event, id instance, const char *propertyName, uint64_t startTimestamp, uint64_t endTimestamp)
+{
+    AKAncestorTraceBuffer *buffer = AKAncestorCurrentTraceBuffer;
+    NSUInteger capacity = AKAncestorTraceBufferCapacity;
+    if (!buffer || buffer->_capacity != capacity)
+    {
+        AKAncestorTraceBuffer *newBuffer = [[AKAncestorTraceBuffer alloc] initWithCapacity:capacity];
+        
+        OSSpinLockLock(&AKAncestorTraceBuffersLock);
+        [AKAncestorAllTraceBuffers() addObject:newBuffer];
+        OSSpinLockUnlock(&AKAncestorTraceBuffersLock);
+        
+        AKAncestorCurrentTraceBuffer = newBuffer;
+        if (buffer)
+        {
+            buffer->_retired = YES;
+        }
+        
+        buffer = newBuffer;
+    }
+    
+    uint64_t index = buffer->_nextIndex;
+    AKAncestorTraceEntry *entry = &buffer->_entries[index % buffer->_capacity];
+    
+    entry->sequence = 0;
+    OSMemoryBarrier();
+    
+    entry->startTimestamp = startTimestamp;
+    entry->endTimestamp = endTimestamp;
+    entry->instanceClass = [instance class];
+    entry->instance = (__bridge const void *)instance;
+    entry->propertyName = propertyName;
+    entry->event = event;
+    OSMemoryBarrier();
+    
+    entry->sequence = index + 1;
+    buffer->_nextIndex = index + 1;
+}
+
+static double AKAncestorTraceMicroseconds(uint64_t timestamp)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    
+    return (double)timestamp * timebase.numer / timebase.denom / 1000.0;
+}
+
+static NSDictionary *AKAncestorTraceEventDictionary(AKAncestorTraceEntry entry, AKAncestorTraceBuffer *buffer)
+{
+    static NSString *const categories[] = {@"resolution", @"write", @"kvo", @"lifecycle", @"lifecycle"};
+    static NSString *const verbs[] = {@"Resolve", @"Write", @"Forward", @"Create", @"Deallocate"};
+    
+    NSString *className = NSStringFromClass(entry.instanceClass);
+    NSString *subject = (entry.propertyName) ? [NSString stringWithUTF8String:entry.propertyName] : className;
+    
+    NSMutableDictionary *dictionary = [@{@"name": [NSString stringWithFormat:@"%@ %@", verbs[entry.event], subject],
+                                         @"cat": categories[entry.event],
+                                         @"ts": @(AKAncestorTraceMicroseconds(entry.startTimestamp)),
+                                         @"pid": @(getpid()),
+                                         @"tid": @(buffer.threadID),
+                                         @"args": @{@"class": className,
+                                                    @"instance": [NSString stringWithFormat:@"%p", entry.instance]}} mutableCopy];
+    
+    if (entry.event == AKAncestorTraceEventDescendantCreation || entry.event == AKAncestorTraceEventDescendantDeallocation)
+    {
+        dictionary[@"ph"] = @"i";
+        dictionary[@"s"] = @"t";
+    }
+    else
+    {
+        dictionary[@"ph"] = @"X";
+        dictionary[@"dur"] = @(AKAncestorTraceMicroseconds(entry.endTimestamp - entry.startTimestamp));
+    }
+    
+    return dictionary;
+}
+
+
+@implementation AKAncestorTrace
+
+#pragma mark - Recording
+
++ (BOOL)isEnabled
+{
+    return AKAncestorTraceEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+    AKAncestorTraceEnabled = enabled;
+    OSMemoryBarrier();
+}
+
++ (NSUInteger)bufferCapacity
+{
+    return AKAncestorTraceBufferCapacity;
+}
+
++ (void)setBufferCapacity:(NSUInteger)bufferCapacity
+{
+    NSParameterAssert(bufferCapacity > 0);
+    
+    AKAncestorTraceBufferCapacity = MAX(bufferCapacity, (NSUInteger)1);
+    OSMemoryBarrier();
+}
+
++ (void)clear
+{
+    OSSpinLockLock(&AKAncestorTraceBuffersLock);
+    
+    NSMutableArray *buffers = AKAncestorAllTraceBuffers();
+    [buffers filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(AKAncestorTraceBuffer *buffer, NSDictionary *bindings) {
+        return !buffer->_retired;
+    }]];
+    
+    // Writers never look at the cleared index, so moving it up to the next index hides everything recorded so far without touching the entries.
+    for (AKAncestorTraceBuffer *buffer in buffers)
+    {
+        buffer->_clearedIndex = buffer->_nextIndex;
+    }
+    
+    OSSpinLockUnlock(&AKAncestorTraceBuffersLock);
+}
+
+
+#pragma mark - Exporting
+
++ (NSData *)chromeTraceData
+{
+    NSMutableArray *traceEvents = [NSMutableArray array];
+    
+    for (AKAncestorTraceBuffer *buffer in AKAncestorTraceBuffersSnapshot())
+    {
+        uint64_t nextIndex = buffer->_nextIndex;
+        OSMemoryBarrier();
+        
+        uint64_t firstIndex = MAX(buffer->_clearedIndex, (nextIndex > buffer->_capacity) ? nextIndex - buffer->_capacity : 0);
+        if (firstIndex >= nextIndex)
+        {
+            continue;
+        }
+        
+        [traceEvents addObject:@{@"name": @"thread_name",
+                                 @"ph": @"M",
+                                 @"pid": @(getpid()),
+                                 @"tid": @(buffer.threadID),
+                                 @"args": @{@"name": buffer.threadName}}];
+        
+        for (uint64_t index = firstIndex; index < nextIndex; index++)
+        {
+            AKAncestorTraceEntry *entry = &buffer->_entries[index % buffer->_capacity];
+            
+            uint64_t sequence = entry->sequence;
+            OSMemoryBarrier();
+            AKAncestorTraceEntry copy = *entry;
+            OSMemoryBarrier();
+            
+            // If the owning thread wrapped around onto this entry while it was copied, the copy may be torn, so it's skipped.
+            if (sequence != index + 1 || entry->sequence != sequence)
+            {
+                continue;
+            }
+            
+            [traceEvents addObject:AKAncestorTraceEventDictionary(copy, buffer)];
+        }
+    }
+    
+    return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": traceEvents, @"displayTimeUnit": @"ns"} options:0 error:NULL];
+}
+
++ (BOOL)writeChromeTraceToURL:(NSURL *)fileURL error:(NSError **)error
+{
+    NSParameterAssert(fileURL);
+    
+    return [[self chromeTraceData] writeToURL:fileURL options:NSDataWritingAtomic error:error];
+}
+
+@end
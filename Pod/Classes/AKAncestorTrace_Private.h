@@ -0,0 +1,62 @@
+//
+//  AKAncestorTrace_Private.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorTrace.h"
+#import "AKAncestorPlatform.h"
+
+/**
+ *  YES while AKAncestorTrace is recording events. Instrumented paths read this without synchronization, so events racing with enabling or disabling may or may not be recorded.
+ */
+FOUNDATION_EXPORT volatile BOOL AKAncestorTraceEnabled;
+
+/**
+ *  Returns a C string for a name which lives as long as the process, so it can be kept in a ring buffer without retaining anything.
+ */
+FOUNDATION_EXPORT const char *AKAncestorTraceInternedName(NSString *name);
+
+/**
+ *  Writes an event into the current thread's ring buffer. Call the inline functions below instead, which skip this while tracing is disabled.
+ *
+ *  @param event          The event which happened.
+ *  @param instance       The instance it happened on. Only its class and address are kept.
+ *  @param propertyName   The property it happened for, interned with AKAncestorTraceInternedName, or NULL.
+ *  @param startTimestamp The mach_absolute_time() when the event started.
+ *  @param endTimestamp   The mach_absolute_time() when the event ended, which is the start for instant events.
+ */
+FOUNDATION_EXPORT void AKAncestorTraceRecordEvent(AKAncestorTraceEvent event, id instance, const char *propertyName, uint64_t startTimestamp, uint64_t endTimestamp);
+
+/**
+ *  Returns the start of an event with a duration, or 0 if tracing is disabled.
+ */
+static inline uint64_t AKAncestorTraceBegin(void)
+{
+    return (__builtin_expect(AKAncestorTraceEnabled, NO)) ? mach_absolute_time() : 0;
+}
+
+/**
+ *  Records an event with a duration which was started by AKAncestorTraceBegin. Nothing is recorded if tracing was disabled when it started.
+ */
+static inline void AKAncestorTraceEnd(AKAncestorTraceEvent event, id instance, const char *propertyName, uint64_t startTimestamp)
+{
+    if (__builtin_expect(startTimestamp != 0, NO))
+    {
+        AKAncestorTraceRecordEvent(event, instance, propertyName, startTimestamp, mach_absolute_time());
+    }
+}
+
+/**
+ *  Records an instant event if tracing is enabled.
+ */
+static inline void AKAncestorTraceInstant(AKAncestorTraceEvent event, id instance)
+{
+    if (__builtin_expect(AKAncestorTraceEnabled, NO))
+    {
+        uint64_t timestamp = mach_absolute_time();
+        AKAncestorTraceRecordEvent(event, instance, NULL, timestamp, timestamp);
+    }
+}
@@ -0,0 +1,90 @@
+//
+//  AKAncestorVersionedTree.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class AKAncestor;
+
+/**
+ *  AKAncestorVersion is an immutable snapshot of the instances of an AKAncestorVersionedTree, taken when one of its commits finished. Its values never change, so it can be read from any thread without locks while the tree keeps committing newer versions.
+ *
+ *  Values are resolved from the instance's own value, or nothing if the property is ignored, or else from its first ancestor as it was in the same version. Fallback ancestors, value providers, merged properties and properties transformed by a subclass aren't captured, so values which depend on them may differ from the instances' getters.
+ */
+@interface AKAncestorVersion : NSObject
+
+/**
+ *  The number of the version, which starts at 1 for the version captured when the tree is initialized and grows by one with each commit.
+ */
+@property (assign, nonatomic, readonly) uint64_t number;
+
+/**
+ *  The root of the tree followed by each of its descendants when the version was captured, nearest generations first. Versions don't keep instances alive, so instances deallocated since are left out.
+ */
+@property (copy, nonatomic, readonly) NSArray *ancestors;
+
+/**
+ *  Returns whether the given instance was part of the tree when the version was captured.
+ */
+- (BOOL)containsAncestor:(AKAncestor *)ancestor;
+
+/**
+ *  Returns the value of a property for one of the instances as it would have resolved when the version was captured.
+ *
+ *  @param propertyName The name of a property passed to descendants by the instance's class, or an AKAncestorUnknownPropertyException is raised.
+ *  @param ancestor     One of the instances of the version, or an NSInvalidArgumentException is raised.
+ */
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestor:(AKAncestor *)ancestor;
+
+/**
+ *  Returns the instance's own value of a property when the version was captured, without consulting its ancestors.
+ *
+ *  @param propertyName The name of a property passed to descendants by the instance's class, or an AKAncestorUnknownPropertyException is raised.
+ *  @param ancestor     One of the instances of the version, or an NSInvalidArgumentException is raised.
+ */
+- (id)localValueForPropertyName:(NSString *)propertyName ofAncestor:(AKAncestor *)ancestor;
+
+@end
+
+
+/**
+ *  AKAncestorVersionedTree lets readers on other threads see changes to a tree of AKAncestor instances all at once instead of piecemeal. Writers make their changes to the instances inside commitChanges:, which then captures the whole tree as a new version and publishes it. Readers pin the currentVersion for as long as their work takes and read from it without locks, seeing neither half of a commit nor any commit made after they pinned it.
+ *
+ *  Versions share what they captured from instances which didn't change between commits, so a commit only copies the values of the instances it changed. A version is deallocated as soon as the tree has moved on and no reader holds it anymore. Versions don't retain instances, so a descendant released by the tree's owner is deallocated right away even while readers still hold versions which captured it. They find what they captured by each instance's address and a serial number, so reads never load weak references.
+ *
+ *  Changes made to the instances outside of commitChanges: are only published by the next commit, and readers of the instances themselves still see every change as it happens.
+ */
+@interface AKAncestorVersionedTree : NSObject
+
+/**
+ *  Designated initializer. Captures the first version of the tree.
+ *
+ *  @param root The instance at the root of the tree. Every instance returned by its descendants method is part of the tree. This must not be nil.
+ *
+ *  @return A versioned tree.
+ */
+- (instancetype)initWithRoot:(AKAncestor *)root NS_DESIGNATED_INITIALIZER;
+
+@property (strong, nonatomic, readonly) AKAncestor *root;
+
+/**
+ *  The most recently committed version. Reading it never takes a lock, since commits publish each version with an atomic pointer swap. Readers should still keep the returned version and read from it until their work is done, rather than asking for the current version again.
+ */
+@property (strong, readonly) AKAncestorVersion *currentVersion;
+
+/**
+ *  Runs the block, then captures and publishes the tree as a new version. Commits are serialized, but readers aren't blocked by them.
+ *
+ *  Each commit walks the root's descendants and builds a map with an entry for each of the N instances of the tree, so a commit costs O(N) even when it changed a single instance. Only the values of changed instances are copied, and records of the others are shared with the previous version. Before releasing the previous version, a commit waits for readers which are in the middle of retaining it from currentVersion.
+ *
+ *  @param changes A block which changes the instances of the tree, including creating or releasing descendants. This may be nil to publish changes made outside of a commit.
+ *
+ *  @return The new version.
+ */
+- (AKAncestorVersion *)commitChanges:(void (^)(void))changes;
+
+@end
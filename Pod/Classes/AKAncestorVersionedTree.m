@@ -0,0 +1,358 @@
+//
+//  AKAncestorVersionedTree.m
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestorVersionedTree.h"
+#import "AKAncestor.h"
+#import "AKAncestor_Private.h"
+#import "AKAncestorClassInfo.h"
+#import "AKAncestorPlatform.h"
+#import <objc/message.h>
+
+/**
+ *  What a version captured from one instance. Records are never changed once they're created, so versions can share the records of instances which didn't change between them. Reads find records by the instance's address and serial number and never touch the instance itself, so a version neither keeps instances alive nor goes through the runtime's weak references to read.
+ */
+@interface AKAncestorVersionRecord : NSObject
+{
+    @public
+    // The instance's own values, in the order of its class info's properties.
+    __strong id *_localValues;
+}
+
+- (instancetype)initWithNode:(AKAncestor *)node mutationCount:(int64_t)mutationCount;
+
+@property (strong, nonatomic, readonly) AKAncestorClassInfo *classInfo;
+@property (assign, nonatomic, readonly) const void *identity;
+@property (assign, nonatomic, readonly) int64_t serialNumber;
+@property (copy, nonatomic, readonly) NSSet *ignoredPropertyNames;
+@property (assign, nonatomic, readonly) int64_t mutationCount;
+
+// Only read by -[AKAncestorVersion ancestors]. It's set once per record rather than once per commit, since unchanged instances keep their records.
+@property (weak, nonatomic, readonly) AKAncestor *instance;
+
+@end
+
+@implementation AKAncestorVersionRecord
+
+- (instancetype)initWithNode:(AKAncestor *)node mutationCount:(int64_t)mutationCount
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _classInfo = [AKAncestorClassInfo classInfoForClass:[node class]];
+    _identity = (__bridge const void *)node;
+    _serialNumber = [node _serialNumber];
+    _ignoredPropertyNames = [node _ignoredPropertyNames];
+    _mutationCount = mutationCount;
+    _instance = node;
+    
+    NSUInteger propertyCount = _classInfo.propertyCount;
+    _localValues = (__strong id *)calloc(MAX(propertyCount, 1), sizeof(id));
+    for (NSUInteger index = 0; index < propertyCount; index++)
+    {
+        _localValues[index] = ((id (*)(id, SEL))objc_msgSend)(node, [_classInfo localGetterAtIndex:index]);
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    // ARC doesn't manage memory from calloc, so strong slots have to be cleared by hand before freeing them.
+    NSUInteger propertyCount = _classInfo.propertyCount;
+    for (NSUInteger index = 0; index < propertyCount; index++)
+    {
+        _localValues[index] = nil;
+    }
+    
+    free(_localValues);
+}
+
+@end
+
+
+@interface AKAncestorVersion ()
+{
+    // For the record at each position, the position of its ancestor's record, or NSNotFound. Links are resolved while capturing, since records are shared by versions in which the ancestor's record sits elsewhere.
+    NSUInteger *_ancestorPositions;
+}
+
+- (instancetype)initWithNumber:(uint64_t)number records:(NSArray *)records positionsByIdentity:(NSMapTable *)positionsByIdentity ancestorPositions:(NSUInteger *)ancestorPositions;
+
+// Records in the order instances were captured, and their positions plus one keyed by the instances' addresses. Neither retains the instances or registers weak references to them.
+@property (copy, nonatomic, readonly) NSArray *records;
+@property (strong, nonatomic, readonly) NSMapTable *positionsByIdentity;
+
+- (AKAncestorVersionRecord *)_recordForAncestor:(AKAncestor *)ancestor;
+
+@end
+
+@implementation AKAncestorVersion
+
+- (instancetype)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Versions are only created by an AKAncestorVersionedTree."];
+    return nil;
+}
+
+- (instancetype)initWithNumber:(uint64_t)number records:(NSArray *)records positionsByIdentity:(NSMapTable *)positionsByIdentity ancestorPositions:(NSUInteger *)ancestorPositions
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _number = number;
+    _records = [records copy];
+    _positionsByIdentity = positionsByIdentity;
+    _ancestorPositions = ancestorPositions;
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_ancestorPositions);
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> version %llu of %lu instances", NSStringFromClass([self class]), self, (unsigned long long)self.number, (unsigned long)self.records.count];
+}
+
+- (NSArray *)ancestors
+{
+    // Instances may have been deallocated since they were captured, which is only checked here rather than on every read.
+    NSMutableArray *ancestors = [NSMutableArray arrayWithCapacity:self.records.count];
+    for (AKAncestorVersionRecord *record in self.records)
+    {
+        AKAncestor *ancestor = record.instance;
+        if (ancestor)
+        {
+            [ancestors addObject:ancestor];
+        }
+    }
+    
+    return [ancestors copy];
+}
+
+- (NSUInteger)_positionOfAncestor:(AKAncestor *)ancestor
+{
+    if (!ancestor)
+    {
+        return NSNotFound;
+    }
+    
+    // Addresses are reused once instances are deallocated, so the serial number tells whether the record really belongs to the given instance.
+    NSUInteger position = (NSUInteger)NSMapGet(self.positionsByIdentity, (__bridge const void *)ancestor);
+    if (position == 0 || [self.records[position - 1] serialNumber] != [ancestor _serialNumber])
+    {
+        return NSNotFound;
+    }
+    
+    return position - 1;
+}
+
+- (AKAncestorVersionRecord *)_recordForAncestor:(AKAncestor *)ancestor
+{
+    NSUInteger position = [self _positionOfAncestor:ancestor];
+    return (position != NSNotFound) ? self.records[position] : nil;
+}
+
+- (BOOL)containsAncestor:(AKAncestor *)ancestor
+{
+    return ([self _positionOfAncestor:ancestor] != NSNotFound);
+}
+
+- (NSUInteger)_validPositionOfAncestor:(AKAncestor *)ancestor propertyName:(NSString *)propertyName index:(NSUInteger *)index
+{
+    NSUInteger position = [self _positionOfAncestor:ancestor];
+    if (position == NSNotFound)
+    {
+        [NSException raise:NSInvalidArgumentException format:@"%@ isn't part of version %llu.", ancestor, (unsigned long long)self.number];
+    }
+    
+    AKAncestorVersionRecord *record = self.records[position];
+    *index = [record.classInfo indexOfPropertyName:propertyName];
+    if (*index == NSNotFound)
+    {
+        [NSException raise:AKAncestorUnknownPropertyException format:@"No property with the name \"%@\" is being inherited by %@.", propertyName, record.classInfo.ancestorClass];
+    }
+    
+    return position;
+}
+
+- (id)localValueForPropertyName:(NSString *)propertyName ofAncestor:(AKAncestor *)ancestor
+{
+    NSUInteger index = NSNotFound;
+    NSUInteger position = [self _validPositionOfAncestor:ancestor propertyName:propertyName index:&index];
+    
+    AKAncestorVersionRecord *record = self.records[position];
+    return record->_localValues[index];
+}
+
+- (id)valueForPropertyName:(NSString *)propertyName ofAncestor:(AKAncestor *)ancestor
+{
+    NSUInteger index = NSNotFound;
+    NSUInteger position = [self _validPositionOfAncestor:ancestor propertyName:propertyName index:&index];
+    
+    // Ancestors are followed through the links captured with this version rather than to the live instances, so the whole chain resolves as it was when the version was captured.
+    while (position != NSNotFound)
+    {
+        AKAncestorVersionRecord *record = self.records[position];
+        id value = record->_localValues[index];
+        if (value || [record.ignoredPropertyNames containsObject:propertyName])
+        {
+            return value;
+        }
+        
+        position = _ancestorPositions[position];
+        if (position == NSNotFound)
+        {
+            return nil;
+        }
+        
+        index = [[self.records[position] classInfo] indexOfPropertyName:propertyName];
+        if (index == NSNotFound)
+        {
+            return nil;
+        }
+    }
+    
+    return nil;
+}
+
+@end
+
+
+@interface AKAncestorVersionedTree ()
+{
+    // Retained by hand, since ARC can't swap a strong reference atomically.
+    void * volatile _currentVersion;
+    
+    // Readers between loading and retaining the current version, counted apart by the parity of the epoch they read, so a commit only waits for readers which could still be retaining the version it replaced.
+    volatile int32_t _readerCounts[2];
+    volatile int32_t _readerEpoch;
+}
+
+@end
+
+@implementation AKAncestorVersionedTree
+
+- (instancetype)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use -initWithRoot: to create a versioned tree."];
+    return nil;
+}
+
+- (instancetype)initWithRoot:(AKAncestor *)root
+{
+    NSParameterAssert(root);
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _root = root;
+    _currentVersion = (__bridge_retained void *)[self _versionAfterVersion:nil];
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    (void)(__bridge_transfer id)_currentVersion;
+}
+
+- (AKAncestorVersion *)currentVersion
+{
+    // Being counted before loading tells a commit to hold on to the version it replaces until it's been retained here. Readers never wait, and a commit only waits for readers in the middle of these few instructions.
+    int32_t parity = _readerEpoch & 1;
+    OSAtomicIncrement32Barrier(&_readerCounts[parity]);
+    AKAncestorVersion *currentVersion = (__bridge AKAncestorVersion *)_currentVersion;
+    OSAtomicDecrement32Barrier(&_readerCounts[parity]);
+    
+    return currentVersion;
+}
+
+- (AKAncestorVersion *)commitChanges:(void (^)(void))changes
+{
+    // Blocks may raise, which @synchronized unwinds safely.
+    @synchronized(self)
+    {
+        if (changes)
+        {
+            changes();
+        }
+        
+        void *previousVersion = _currentVersion;
+        AKAncestorVersion *version = [self _versionAfterVersion:(__bridge AKAncestorVersion *)previousVersion];
+        OSAtomicCompareAndSwapPtrBarrier(previousVersion, (__bridge_retained void *)version, &_currentVersion);
+        
+        [self _waitForReadersOfPreviousVersions];
+        (void)(__bridge_transfer id)previousVersion;
+        
+        return version;
+    }
+}
+
+- (void)_waitForReadersOfPreviousVersions
+{
+    // Readers which loaded the previous version counted themselves before the swap, under either parity, since one may have read the epoch just before the last commit flipped it. Flipping twice and waiting for each parity to drain covers both, while readers arriving meanwhile count under the other parity and load the new version. Readers only stay counted for a load and a retain, so this is brief.
+    for (NSUInteger flip = 0; flip < 2; flip++)
+    {
+        int32_t parity = _readerEpoch & 1;
+        OSAtomicIncrement32Barrier(&_readerEpoch);
+        
+        while (_readerCounts[parity] != 0)
+        {
+            sched_yield();
+        }
+        
+        OSMemoryBarrier();
+    }
+}
+
+- (AKAncestorVersion *)_versionAfterVersion:(AKAncestorVersion *)previousVersion
+{
+    NSMutableArray *ancestors = [NSMutableArray arrayWithObject:self.root];
+    [ancestors addObjectsFromArray:self.root.descendants];
+    
+    NSUInteger count = ancestors.count;
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:count];
+    NSMapTable *positionsByIdentity = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory|NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsOpaqueMemory|NSPointerFunctionsIntegerPersonality capacity:count];
+    
+    for (AKAncestor *ancestor in ancestors)
+    {
+        // The count is read before the values, so a change racing with the capture is captured again by the next commit instead of being missed.
+        int64_t mutationCount = [ancestor _mutationCount];
+        AKAncestorVersionRecord *record = [previousVersion _recordForAncestor:ancestor];
+        if (!record || record.mutationCount != mutationCount)
+        {
+            record = [[AKAncestorVersionRecord alloc] initWithNode:ancestor mutationCount:mutationCount];
+        }
+        
+        [records addObject:record];
+        NSMapInsert(positionsByIdentity, record.identity, (const void *)(uintptr_t)records.count);
+    }
+    
+    // Every instance is alive and in place by now, so each ancestor's position can be looked up by address alone.
+    NSUInteger *ancestorPositions = calloc(MAX(count, 1), sizeof(NSUInteger));
+    for (NSUInteger position = 0; position < count; position++)
+    {
+        AKAncestor *ancestor = [ancestors[position] ancestor];
+        NSUInteger ancestorPosition = (ancestor) ? (NSUInteger)NSMapGet(positionsByIdentity, (__bridge const void *)ancestor) : 0;
+        ancestorPositions[position] = (ancestorPosition > 0) ? ancestorPosition - 1 : NSNotFound;
+    }
+    
+    return [[AKAncestorVersion alloc] initWithNumber:previousVersion.number + 1 records:records positionsByIdentity:positionsByIdentity ancestorPositions:ancestorPositions];
+}
+
+@end
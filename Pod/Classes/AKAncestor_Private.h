@@ -0,0 +1,100 @@
+//
+//  AKAncestor_Private.h
+//  AncestorKit
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "AKAncestor.h"
+
+/**
+ *  Methods AKAncestor shares with the rest of AncestorKit. These are not part of the public interface.
+ */
+@interface AKAncestor ()
+
+/**
+ *  Adds key-value observations on the ancestor of an instance which was initialized without inheriting key-value notifications, and sets inheritsKeyValueNotifications to YES. This lets bulk construction create instances without contending on key-value observing and wire them up afterwards. Calling this on an instance which already inherits notifications has no effect. This is not thread safe.
+ */
+- (void)_beginInheritingKeyValueNotifications;
+
+/**
+ *  Records that the receiver's own values or ignored properties changed, and bumps the lineage mutation count of the receiver and every descendant. Swizzled setters call this after every assignment.
+ */
+- (void)_noteLocalValuesDidChange;
+
+/**
+ *  Returns the number of times the receiver's own values or ignored properties changed. AKAncestorVersionedTree compares it between commits to reuse what it captured from unchanged instances.
+ */
+- (int64_t)_mutationCount;
+
+/**
+ *  Returns a number which no other instance created by the process shares. Unlike the receiver's address it's never reused, so it tells apart an instance from one which was deallocated at the same address.
+ */
+- (int64_t)_serialNumber;
+
+/**
+ *  Returns a count of the changes to the receiver and every instance it inherits from, including fallback ancestors and their chains. The count only grows, and it changes whenever a value the receiver could resolve changes through a setter or when inheritance is stopped or resumed anywhere in the chain. Caches derived from resolved values can store it and compare it later to check whether they're still valid. It's kept up to date by writes, so reading it costs the same however deep the chain is.
+ */
+- (int64_t)_lineageMutationCount;
+
+/**
+ *  Returns the cached value of a derived property, computing it with the given selector if there is no cached value or if anything it was computed from changed. Swizzled derived getters call this.
+ *
+ *  @param key               The name of the derived property. This must not be nil.
+ *  @param computingSelector The selector of the original getter, which computes the value.
+ *
+ *  @return The value of the derived property.
+ */
+- (id)_derivedValueForKey:(NSString *)key computingSelector:(SEL)computingSelector;
+
+/**
+ *  Runs the value provider registered for a property if there is one, assigning and returning its result. Threads arriving while the provider runs wait for it and receive the same result. Swizzled getters call this when the receiver has no value of its own and providers are registered.
+ *
+ *  @param propertyName The name of the property. This must not be nil.
+ *
+ *  @return The provided value, or nil if there's no provider or it returned nil.
+ */
+- (id)_providedValueForPropertyName:(NSString *)propertyName;
+
+/**
+ *  Returns the merged value of a property with a merge policy other than AKAncestorMergePolicyReplace, reusing the cached result if the local and inherited values haven't changed. Swizzled getters of properties which merge in any class call this when the receiver has its own value.
+ *
+ *  @param propertyName The name of the property. This must not be nil.
+ *  @param localValue   The receiver's own value of the property. This must not be nil.
+ *
+ *  @return The merged value, or the local value if the property doesn't merge in the receiver's class or nothing is inherited.
+ */
+- (id)_mergedValueForPropertyName:(NSString *)propertyName localValue:(id)localValue;
+
+/**
+ *  Returns the ancestor the receiver resolves an inherited value for the given property from, using its cached provenance. This is the first of its ancestors with a value, or nil if none have one.
+ */
+- (AKAncestor *)_ancestorResolvingPropertyName:(NSString *)propertyName;
+
+/**
+ *  Adds an instance to the receiver's weak registry of direct descendants. Initializers call this on the ancestor.
+ */
+- (void)_registerDescendant:(AKAncestor *)descendant;
+
+/**
+ *  Returns the live instances initialized with the receiver as their ancestor, in no particular order.
+ */
+- (NSArray *)_directDescendants;
+
+/**
+ *  Returns YES if the receiver has neither fallback ancestors nor value providers, so a property it doesn't merge or transform resolves to its own value, or nil if the property is ignored, or else its ancestor's value. AKAncestorResolvedValues reuses ancestors' values for such instances instead of calling their getters.
+ */
+- (BOOL)_resolvesValuesFromFirstAncestorOnly;
+
+/**
+ *  Returns a copy of the names passed to -stopInheritingValuesForPropertyName:, taken under the receiver's lock. Returns nil if no properties are ignored.
+ */
+- (NSSet *)_ignoredPropertyNames;
+
+/**
+ *  Returns every property declared by the receiving class up to and excluding AKAncestor, including those which are not inherited. The result is cached per class.
+ */
++ (NSSet *)_allInheritedProperties;
+
+@end
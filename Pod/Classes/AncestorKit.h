@@ -11,5 +11,15 @@
 
 #import <AncestorKit/AKAncestor.h>
 #import <AncestorKit/AKPropertyDescription.h>
+#import <AncestorKit/AKAncestorSnapshot.h>
+#import <AncestorKit/AKAncestorImporter.h>
+#import <AncestorKit/AKAncestorDescriptionWriter.h>
+#import <AncestorKit/AKAncestorStatistics.h>
+#import <AncestorKit/AKAncestorTrace.h>
+#import <AncestorKit/AKAncestorResolutionHistogram.h>
+#import <AncestorKit/AKAncestorTable.h>
+#import <AncestorKit/AKAncestorResolvedValues.h>
+#import <AncestorKit/AKAncestorVersionedTree.h>
+#import <AncestorKit/AKAncestorSharedSnapshot.h>
 
 #endif